@@ -29,12 +29,46 @@ FORMS = ui/czdialog.ui
 HEADERS = src/version.h \
 	src/czdialog.h \
 	src/czdeviceinfo.h \
+	src/czconsole.h \
+	src/czfleet.h \
+	src/czhtmlreport.h \
+	src/czstat.h \
 	src/log.h \
+	src/trace.h \
+	src/cpuinfo.h \
+	src/pciinfo.h \
+	src/peakinfo.h \
+	src/nvmlinfo.h \
+	src/hostmem.h \
+	src/kernelinfo.h \
+	src/coldstart.h \
+	src/contend.h \
+	src/aggregate.h \
+	src/ingest.h \
+	src/testconfig.h \
+	src/clinfo.h \
 	src/cudainfo.h
 mac:HEADERS += src/plist.h
 SOURCES = src/czdialog.cpp \
 	src/czdeviceinfo.cpp \
+	src/czconsole.cpp \
+	src/czfleet.cpp \
+	src/czhtmlreport.cpp \
+	src/czstat.cpp \
 	src/log.cpp \
+	src/trace.cpp \
+	src/cpuinfo.cpp \
+	src/pciinfo.cpp \
+	src/peakinfo.cpp \
+	src/nvmlinfo.cpp \
+	src/hostmem.cpp \
+	src/kernelinfo.cpp \
+	src/coldstart.cpp \
+	src/contend.cpp \
+	src/aggregate.cpp \
+	src/ingest.cpp \
+	src/testconfig.cpp \
+	src/clinfo.cpp \
 	src/main.cpp
 mac:SOURCES += src/plist.cpp
 CUSOURCES = src/cudainfo.cu
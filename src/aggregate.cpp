@@ -0,0 +1,360 @@
+/*!	\file aggregate.cpp
+	\brief Aggregate bandwidth test of all CUDA devices source file.
+	Every device gets its own host thread pinned to CPUs of the NUMA node
+	the device is attached to. Threads run pinned copies of one direction
+	for the same time window, first one by one to get solo rates, then
+	all at once. Devices sharing one PCI Express switch or root port get
+	less than the sum of their solo rates when they run together.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <QThread>
+#include <QSemaphore>
+#include <QElapsedTimer>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "log.h"
+#include "trace.h"
+#include "aggregate.h"
+#include "cpuinfo.h"
+#include "pciinfo.h"
+
+#define CZ_AGGREGATE_BATCH	4	/*!< Number of copies queued in each direction between checks of time window. */
+
+/*!	\brief Work of aggregate test thread.
+*/
+enum CZAggregateTask {
+	CZAggregateTaskAlloc = 0,		/*!< Allocate buffers. */
+	CZAggregateTaskCopy,			/*!< Run copies for time window. */
+	CZAggregateTaskFree,			/*!< Free buffers. */
+};
+
+/*!	\brief Host thread of one device.
+	Thread is pinned to NUMA node of device and runs one task. Thread
+	may be started many times. Copies start when all threads of round
+	are ready. Times are read from timer shared by all threads, which is
+	started when copies of round start, so all threads stop copying at
+	the end of the same window.
+*/
+class CZAggregateThread: public QThread {
+
+public:
+	CZAggregateThread(struct CZAggregateDevice *dev, int size, QSemaphore *ready, QSemaphore *go,
+		const QElapsedTimer *timer, volatile int *abortFlag);
+
+	void setup(int task, int mode, double windowUs);
+	double bytesNum() const;
+	double startUs() const;
+	double endUs() const;
+
+protected:
+	void run();
+
+private:
+	struct CZAggregateDevice *dev;
+	int size;
+	QSemaphore *ready;
+	QSemaphore *go;
+	const QElapsedTimer *timer;
+	volatile int *abortFlag;
+	void *data;
+	int task;
+	int mode;
+	double windowUs;
+	double bytes;
+	double copyStart;
+	double copyEnd;
+};
+
+/*!	\brief Creates host thread of device.
+*/
+CZAggregateThread::CZAggregateThread(
+	struct CZAggregateDevice *dev,	/*!<[in,out] Results of device. */
+	int size,			/*!<[in] Size of copy buffers. */
+	QSemaphore *ready,		/*!<[in,out] Semaphore released when thread is ready to copy. */
+	QSemaphore *go,			/*!<[in,out] Semaphore acquired before copies start. */
+	const QElapsedTimer *timer,	/*!<[in] Timer of round started before copies start. */
+	volatile int *abortFlag		/*!<[in] Copies are stopped as soon as this flag is set. May be \a NULL. */
+) {
+	this->dev = dev;
+	this->size = size;
+	this->ready = ready;
+	this->go = go;
+	this->timer = timer;
+	this->abortFlag = abortFlag;
+	data = NULL;
+	task = CZAggregateTaskAlloc;
+	mode = CZAggregateHD;
+	windowUs = 0;
+	bytes = 0;
+	copyStart = 0;
+	copyEnd = 0;
+}
+
+/*!	\brief Set task for next start.
+*/
+void CZAggregateThread::setup(
+	int task,			/*!<[in] Task of thread. See enum #CZAggregateTask. */
+	int mode,			/*!<[in] Copy direction. See enum #CZAggregateMode. */
+	double windowUs			/*!<[in] Time window of copies in us since start of round. */
+) {
+	this->task = task;
+	this->mode = mode;
+	this->windowUs = windowUs;
+	bytes = 0;
+	copyStart = 0;
+	copyEnd = 0;
+}
+
+/*!	\brief Number of bytes copied by the last run.
+	\return number of bytes.
+*/
+double CZAggregateThread::bytesNum() const {
+	return bytes;
+}
+
+/*!	\brief Start time of copies of the last run.
+	\return time in us since start of round.
+*/
+double CZAggregateThread::startUs() const {
+	return copyStart;
+}
+
+/*!	\brief End time of copies of the last run.
+	\return time in us since start of round.
+*/
+double CZAggregateThread::endUs() const {
+	return copyEnd;
+}
+
+/*!	\brief Main work function of the thread.
+*/
+void CZAggregateThread::run() {
+	dev->pinned = (CZCpuPinNode(dev->numaNode) == 0)? 1: 0;
+
+	switch(task) {
+	case CZAggregateTaskAlloc:
+		data = CZCudaAggregateAlloc(dev->num, size);
+		if(data == NULL)
+			dev->failed = 1;
+		break;
+
+	case CZAggregateTaskFree:
+		CZCudaAggregateFree(data);
+		data = NULL;
+		break;
+
+	case CZAggregateTaskCopy:
+		ready->release();
+		go->acquire();
+
+		copyStart = (double)timer->nsecsElapsed() / 1000.0;
+		do {
+			if((abortFlag != NULL) && (*abortFlag != 0))
+				break;
+			if(CZCudaAggregateCopy(data, mode, CZ_AGGREGATE_BATCH) != 0) {
+				dev->failed = 1;
+				break;
+			}
+			bytes += (double)size * CZ_AGGREGATE_BATCH * ((mode == CZAggregateBidir)? 2: 1);
+			copyEnd = (double)timer->nsecsElapsed() / 1000.0;
+		} while(copyEnd < windowUs);
+		break;
+	}
+}
+
+/*!	\brief Get name of copy direction of aggregate test.
+	\return name of copy direction.
+*/
+const char *CZAggregateModeName(
+	int mode			/*!<[in] Copy direction. See enum #CZAggregateMode. */
+) {
+	switch(mode) {
+	case CZAggregateHD:
+		return "hd";
+	case CZAggregateDH:
+		return "dh";
+	case CZAggregateBidir:
+		return "bidir";
+	default:
+		return "unknown";
+	}
+}
+
+/*!	\brief Run one round of copies on listed devices at once.
+	Data copied by each device are left in threads.
+	\return sum of bytes copied by all devices per second in KB/s.
+*/
+static float CZAggregateRound(
+	CZAggregateThread **thread,	/*!<[in,out] Host threads of devices. */
+	const int *list,		/*!<[in] Indexes of threads of round. */
+	int num,			/*!<[in] Number of threads of round. */
+	int mode,			/*!<[in] Copy direction. See enum #CZAggregateMode. */
+	double windowUs,		/*!<[in] Time window of copies in us. */
+	QSemaphore &ready,		/*!<[in,out] Semaphore released by ready threads. */
+	QSemaphore &go,			/*!<[in,out] Semaphore acquired by threads before copies. */
+	QElapsedTimer &timer		/*!<[in,out] Timer of round shared by threads. */
+) {
+	double bytes = 0;
+	double start = 0;
+	double end = 0;
+	int first = 1;
+	int i;
+
+	for(i = 0; i < num; i++) {
+		thread[list[i]]->setup(CZAggregateTaskCopy, mode, windowUs);
+		thread[list[i]]->start();
+	}
+
+	ready.acquire(num);
+	timer.start();
+	go.release(num);
+
+	for(i = 0; i < num; i++) {
+		CZAggregateThread *t = thread[list[i]];
+		t->wait();
+		if(t->bytesNum() == 0)
+			continue;
+		bytes += t->bytesNum();
+		if(first || (t->startUs() < start))
+			start = t->startUs();
+		first = 0;
+		if(t->endUs() > end)
+			end = t->endUs();
+	}
+
+	if(end <= start)
+		return 0;
+
+	return (float)(bytes / 1024.0 / ((end - start) / 1000000.0));
+}
+
+/*!	\brief Run pinned copies on all selected CUDA devices at once.
+	Devices are selected by \a config->aggregateDevices, all devices are
+	tested if it is \a 0. Each round of copies lasts
+	#CZ_AGGREGATE_WINDOW_MS, or time limit of test if it is shorter.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZAggregateCalc(
+	struct CZAggregateInfo *res,	/*!<[out] Results of test. */
+	const struct CZTestConfig *config,	/*!<[in] Test parameters. */
+	volatile int *abortFlag		/*!<[in] Test is stopped as soon as this flag is set. May be \a NULL. */
+) {
+	CZAggregateThread *thread[CZ_AGGREGATE_DEVICES_MAX];
+	int list[CZ_AGGREGATE_DEVICES_MAX];
+	QSemaphore ready;
+	QSemaphore go;
+	QElapsedTimer timer;
+	double windowUs;
+	int num;
+	int mode;
+	int i;
+
+	memset(res, 0, sizeof(*res));
+
+	if(!CZCudaCheck())
+		return -1;
+
+	num = CZCudaDeviceFound();
+	for(i = 0; (i < num) && (res->devices < CZ_AGGREGATE_DEVICES_MAX); i++) {
+		struct CZDeviceInfo info;
+		struct CZAggregateDevice *dev = &res->dev[res->devices];
+
+		if((config->aggregateDevices != 0) && ((i >= 31) || !(config->aggregateDevices & (1 << i))))
+			continue;
+
+		memset(&info, 0, sizeof(info));
+		if((CZCudaReadDeviceInfo(&info, i) != 0) || (info.major == 0))
+			continue;
+
+		dev->num = i;
+		dev->numaNode = CZPciNumaNode(&info);
+		snprintf(dev->deviceName, sizeof(dev->deviceName), "%s", info.deviceName);
+		res->devices++;
+	}
+
+	if(res->devices == 0) {
+		CZLog(CZLogLevelError, "No CUDA devices selected for aggregate bandwidth test!");
+		return -1;
+	}
+
+	windowUs = CZ_AGGREGATE_WINDOW_MS * 1000.0;
+	if((config->timeLimit > 0) && (config->timeLimit < CZ_AGGREGATE_WINDOW_MS))
+		windowUs = config->timeLimit * 1000.0;
+
+	CZLog(CZLogLevelLow, "Starting aggregate bandwidth test on %d device(s).", res->devices);
+
+	double testUs = CZTraceTimeUs();
+
+	for(i = 0; i < res->devices; i++) {
+		thread[i] = new CZAggregateThread(&res->dev[i], config->copyBufSize, &ready, &go, &timer, abortFlag);
+		thread[i]->setup(CZAggregateTaskAlloc, 0, 0);
+		thread[i]->start();
+	}
+	for(i = 0; i < res->devices; i++)
+		thread[i]->wait();
+
+	CZTraceHostSpan("aggregate", "alloc", -1, testUs);
+
+	for(mode = 0; (mode < CZAggregateModeNum) && !res->partial; mode++) {
+		double modeUs = CZTraceTimeUs();
+		double total = 0;
+		num = 0;
+
+		for(i = 0; i < res->devices; i++) {
+			if(res->dev[i].failed)
+				continue;
+			res->dev[i].solo[mode] = CZAggregateRound(thread, &i, 1, mode, windowUs, ready, go, timer);
+			res->soloSum[mode] += res->dev[i].solo[mode];
+			list[num++] = i;
+		}
+
+		if(num == 0)
+			break;
+
+		res->aggregate[mode] = CZAggregateRound(thread, list, num, mode, windowUs, ready, go, timer);
+
+		if((abortFlag != NULL) && (*abortFlag != 0)) {
+			CZLog(CZLogLevelLow, "Aggregate bandwidth test is aborted.");
+			res->partial = 1;
+		}
+
+		for(i = 0; i < num; i++)
+			total += thread[list[i]]->bytesNum();
+
+		for(i = 0; i < num; i++) {
+			struct CZAggregateDevice *dev = &res->dev[list[i]];
+			CZAggregateThread *t = thread[list[i]];
+
+			if(t->endUs() > t->startUs())
+				dev->rate[mode] = (float)(t->bytesNum() / 1024.0 / ((t->endUs() - t->startUs()) / 1000000.0));
+			if(total > 0)
+				dev->share[mode] = (float)(t->bytesNum() / total);
+
+			CZLogKV(CZLogLevelModerate, "aggregate", "mode=%s dev=%d node=%d pinned=%d solo=%f rate=%f share=%f",
+				CZAggregateModeName(mode), dev->num, dev->numaNode, dev->pinned, dev->solo[mode], dev->rate[mode], dev->share[mode]);
+		}
+
+		CZLogKV(CZLogLevelModerate, "aggregate", "mode=%s devices=%d aggregate=%f solo_sum=%f",
+			CZAggregateModeName(mode), num, res->aggregate[mode], res->soloSum[mode]);
+
+		CZTraceHostSpan("aggregate", CZAggregateModeName(mode), -1, modeUs);
+	}
+
+	for(i = 0; i < res->devices; i++) {
+		thread[i]->setup(CZAggregateTaskFree, 0, 0);
+		thread[i]->start();
+	}
+	for(i = 0; i < res->devices; i++) {
+		thread[i]->wait();
+		delete thread[i];
+	}
+
+	CZTraceHostSpan("aggregate", "test", -1, testUs);
+
+	return 0;
+}
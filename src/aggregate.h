@@ -0,0 +1,52 @@
+/*!	\file aggregate.h
+	\brief Aggregate bandwidth test of all CUDA devices definition.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#ifndef CZ_AGGREGATE_H
+#define CZ_AGGREGATE_H
+
+#include "cudainfo.h"
+
+#define CZ_AGGREGATE_DEVICES_MAX	16	/*!< Max number of devices of aggregate bandwidth test. */
+#define CZ_AGGREGATE_WINDOW_MS		500	/*!< Time window of each round of aggregate bandwidth test (ms). */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!	\brief Results of aggregate bandwidth test on one device.
+	Rates are in KB/s.
+*/
+struct CZAggregateDevice {
+	int		num;			/*!< Device index. */
+	char		deviceName[256];	/*!< ASCII string identifying the device. */
+	int		numaNode;		/*!< NUMA node of device, \a -1 if unknown. */
+	int		pinned;			/*!< 1 if host thread of device was pinned to its NUMA node. */
+	int		failed;			/*!< 1 if copies on device failed. */
+	float		solo[CZAggregateModeNum];	/*!< Copy rate of device running alone. See enum #CZAggregateMode. */
+	float		rate[CZAggregateModeNum];	/*!< Copy rate of device running together with others. */
+	float		share[CZAggregateModeNum];	/*!< Part of aggregate data copied by device, from 0 to 1. */
+};
+
+/*!	\brief Results of aggregate bandwidth test.
+	Rates are in KB/s.
+*/
+struct CZAggregateInfo {
+	int		devices;		/*!< Number of tested devices, \a 0 if test was not run. */
+	int		partial;		/*!< 1 if test was aborted before all rounds were done. */
+	struct CZAggregateDevice	dev[CZ_AGGREGATE_DEVICES_MAX];	/*!< Results of each device. */
+	float		aggregate[CZAggregateModeNum];	/*!< Copy rate of all devices running together. See enum #CZAggregateMode. */
+	float		soloSum[CZAggregateModeNum];	/*!< Sum of copy rates of devices running alone. */
+};
+
+int CZAggregateCalc(struct CZAggregateInfo *res, const struct CZTestConfig *config, volatile int *abortFlag);
+const char *CZAggregateModeName(int mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//CZ_AGGREGATE_H
@@ -0,0 +1,1131 @@
+/*!	\file clinfo.cpp
+	\brief OpenCL device information and test source file.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <QElapsedTimer>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#include "log.h"
+#include "trace.h"
+#include "cpuinfo.h"
+#include "clinfo.h"
+
+#if defined(Q_OS_WIN)
+#define CZ_CL_DLL_FNAME		"OpenCL.dll"		/*!< OpenCL dll file name. */
+#define CZ_CL_API		__stdcall		/*!< Calling convention of OpenCL API. */
+#elif defined(Q_OS_MAC)
+#define CZ_CL_DLL_FNAME		"/System/Library/Frameworks/OpenCL.framework/OpenCL"	/*!< OpenCL framework file name. */
+#define CZ_CL_API
+#else
+#define CZ_CL_DLL_FNAME		"libOpenCL.so.1"	/*!< OpenCL ICD loader file name. */
+#define CZ_CL_DLL_FNAME_DEV	"libOpenCL.so"		/*!< OpenCL ICD loader development link name. */
+#define CZ_CL_API
+#endif
+
+#define CZ_CL_PLATFORMS_MAX	16			/*!< Max number of OpenCL platforms. */
+#define CZ_CL_DEVICES_MAX	64			/*!< Max number of OpenCL devices. */
+#define CZ_CL_DIMS_MAX		16			/*!< Max number of work item dimensions. */
+#define CZ_CL_STR_LEN		256			/*!< Length of information string. */
+
+#define CZ_CL_COPY_BUF_SIZE_MIN	(64 * (1 << 10))	/*!< Minimal transfer size used under time limit. */
+
+#define CZ_CL_NVIDIA_PLATFORM	"NVIDIA CUDA"		/*!< Name of platform served by CUDA functions. */
+
+/*	OpenCL types and constants used here. They are copied from the
+	Khronos headers so OpenCL SDK is not needed to build the program.
+*/
+typedef int cl_int;
+typedef unsigned int cl_uint;
+typedef unsigned long long cl_ulong;
+typedef cl_uint cl_bool;
+typedef cl_ulong cl_bitfield;
+typedef struct _cl_platform_id *cl_platform_id;
+typedef struct _cl_device_id *cl_device_id;
+typedef struct _cl_context *cl_context;
+typedef struct _cl_command_queue *cl_command_queue;
+typedef struct _cl_mem *cl_mem;
+typedef struct _cl_program *cl_program;
+typedef struct _cl_kernel *cl_kernel;
+typedef struct _cl_event *cl_event;
+
+#define CL_SUCCESS				0
+#define CL_TRUE					1
+#define CL_PLATFORM_VERSION			0x0901
+#define CL_PLATFORM_NAME			0x0902
+#define CL_DEVICE_TYPE_ALL			0xFFFFFFFF
+#define CL_DEVICE_MAX_COMPUTE_UNITS		0x1002
+#define CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS	0x1003
+#define CL_DEVICE_MAX_WORK_GROUP_SIZE		0x1004
+#define CL_DEVICE_MAX_WORK_ITEM_SIZES		0x1005
+#define CL_DEVICE_MAX_CLOCK_FREQUENCY		0x100C
+#define CL_DEVICE_MAX_MEM_ALLOC_SIZE		0x1010
+#define CL_DEVICE_IMAGE2D_MAX_WIDTH		0x1011
+#define CL_DEVICE_IMAGE2D_MAX_HEIGHT		0x1012
+#define CL_DEVICE_IMAGE3D_MAX_WIDTH		0x1013
+#define CL_DEVICE_IMAGE3D_MAX_HEIGHT		0x1014
+#define CL_DEVICE_IMAGE3D_MAX_DEPTH		0x1015
+#define CL_DEVICE_MEM_BASE_ADDR_ALIGN		0x1019
+#define CL_DEVICE_GLOBAL_MEM_CACHE_SIZE		0x101E
+#define CL_DEVICE_GLOBAL_MEM_SIZE		0x101F
+#define CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE	0x1020
+#define CL_DEVICE_LOCAL_MEM_SIZE		0x1023
+#define CL_DEVICE_ERROR_CORRECTION_SUPPORT	0x1024
+#define CL_DEVICE_AVAILABLE			0x1027
+#define CL_DEVICE_NAME				0x102B
+#define CL_DRIVER_VERSION			0x102D
+#define CL_DEVICE_VERSION			0x102F
+#define CL_DEVICE_EXTENSIONS			0x1030
+#define CL_DEVICE_HOST_UNIFIED_MEMORY		0x1035
+#define CL_DEVICE_NATIVE_VECTOR_WIDTH_FLOAT	0x103A
+#define CL_DEVICE_PCI_BUS_INFO_KHR		0x410F
+#define CL_QUEUE_PROFILING_ENABLE		(1 << 1)
+#define CL_MEM_READ_WRITE			(1 << 0)
+#define CL_MEM_ALLOC_HOST_PTR			(1 << 4)
+#define CL_MAP_READ				(1 << 0)
+#define CL_MAP_WRITE				(1 << 1)
+#define CL_PROGRAM_BUILD_LOG			0x1183
+#define CL_KERNEL_WORK_GROUP_SIZE		0x11B0
+#define CL_PROFILING_COMMAND_START		0x1282
+#define CL_PROFILING_COMMAND_END		0x1283
+
+/*!	\brief PCI bus information of cl_khr_pci_bus_info extension.
+*/
+struct CZClPciBusInfo {
+	cl_uint		domain;			/*!< PCI domain. */
+	cl_uint		bus;			/*!< PCI bus. */
+	cl_uint		device;			/*!< PCI device. */
+	cl_uint		function;		/*!< PCI function. */
+};
+
+/*!	\brief List of OpenCL functions used here.
+	Each item gives return type, name and arguments of function.
+*/
+#define CZ_CL_FUNC_LIST \
+	CZ_CL_FUNC(cl_int, clGetPlatformIDs, (cl_uint numEntries, cl_platform_id *platforms, cl_uint *numPlatforms)) \
+	CZ_CL_FUNC(cl_int, clGetPlatformInfo, (cl_platform_id platform, cl_uint param, size_t size, void *value, size_t *sizeRet)) \
+	CZ_CL_FUNC(cl_int, clGetDeviceIDs, (cl_platform_id platform, cl_bitfield type, cl_uint numEntries, cl_device_id *devices, cl_uint *numDevices)) \
+	CZ_CL_FUNC(cl_int, clGetDeviceInfo, (cl_device_id device, cl_uint param, size_t size, void *value, size_t *sizeRet)) \
+	CZ_CL_FUNC(cl_context, clCreateContext, (const void *props, cl_uint numDevices, const cl_device_id *devices, void *notify, void *userData, cl_int *err)) \
+	CZ_CL_FUNC(cl_int, clReleaseContext, (cl_context context)) \
+	CZ_CL_FUNC(cl_command_queue, clCreateCommandQueue, (cl_context context, cl_device_id device, cl_bitfield props, cl_int *err)) \
+	CZ_CL_FUNC(cl_int, clReleaseCommandQueue, (cl_command_queue queue)) \
+	CZ_CL_FUNC(cl_mem, clCreateBuffer, (cl_context context, cl_bitfield flags, size_t size, void *hostPtr, cl_int *err)) \
+	CZ_CL_FUNC(cl_int, clReleaseMemObject, (cl_mem mem)) \
+	CZ_CL_FUNC(cl_int, clEnqueueWriteBuffer, (cl_command_queue queue, cl_mem mem, cl_bool blocking, size_t offset, size_t size, const void *ptr, cl_uint numWait, const cl_event *waitList, cl_event *event)) \
+	CZ_CL_FUNC(cl_int, clEnqueueReadBuffer, (cl_command_queue queue, cl_mem mem, cl_bool blocking, size_t offset, size_t size, void *ptr, cl_uint numWait, const cl_event *waitList, cl_event *event)) \
+	CZ_CL_FUNC(cl_int, clEnqueueCopyBuffer, (cl_command_queue queue, cl_mem src, cl_mem dst, size_t srcOffset, size_t dstOffset, size_t size, cl_uint numWait, const cl_event *waitList, cl_event *event)) \
+	CZ_CL_FUNC(void*, clEnqueueMapBuffer, (cl_command_queue queue, cl_mem mem, cl_bool blocking, cl_bitfield flags, size_t offset, size_t size, cl_uint numWait, const cl_event *waitList, cl_event *event, cl_int *err)) \
+	CZ_CL_FUNC(cl_int, clEnqueueUnmapMemObject, (cl_command_queue queue, cl_mem mem, void *ptr, cl_uint numWait, const cl_event *waitList, cl_event *event)) \
+	CZ_CL_FUNC(cl_program, clCreateProgramWithSource, (cl_context context, cl_uint count, const char **strings, const size_t *lengths, cl_int *err)) \
+	CZ_CL_FUNC(cl_int, clBuildProgram, (cl_program program, cl_uint numDevices, const cl_device_id *devices, const char *options, void *notify, void *userData)) \
+	CZ_CL_FUNC(cl_int, clGetProgramBuildInfo, (cl_program program, cl_device_id device, cl_uint param, size_t size, void *value, size_t *sizeRet)) \
+	CZ_CL_FUNC(cl_int, clReleaseProgram, (cl_program program)) \
+	CZ_CL_FUNC(cl_kernel, clCreateKernel, (cl_program program, const char *name, cl_int *err)) \
+	CZ_CL_FUNC(cl_int, clReleaseKernel, (cl_kernel kernel)) \
+	CZ_CL_FUNC(cl_int, clSetKernelArg, (cl_kernel kernel, cl_uint index, size_t size, const void *value)) \
+	CZ_CL_FUNC(cl_int, clGetKernelWorkGroupInfo, (cl_kernel kernel, cl_device_id device, cl_uint param, size_t size, void *value, size_t *sizeRet)) \
+	CZ_CL_FUNC(cl_int, clEnqueueNDRangeKernel, (cl_command_queue queue, cl_kernel kernel, cl_uint dims, const size_t *offset, const size_t *globalSize, const size_t *localSize, cl_uint numWait, const cl_event *waitList, cl_event *event)) \
+	CZ_CL_FUNC(cl_int, clFinish, (cl_command_queue queue)) \
+	CZ_CL_FUNC(cl_int, clWaitForEvents, (cl_uint numEvents, const cl_event *events)) \
+	CZ_CL_FUNC(cl_int, clGetEventProfilingInfo, (cl_event event, cl_uint param, size_t size, void *value, size_t *sizeRet)) \
+	CZ_CL_FUNC(cl_int, clReleaseEvent, (cl_event event))
+
+/*	Prototypes of OpenCL functions \a <name>_t and pointers to them
+	\a p_<name>. Pointers are initializaed by CZClIsInit().
+*/
+#define CZ_CL_FUNC(ret, name, args) \
+	typedef ret (CZ_CL_API *name##_t) args; \
+	static name##_t p_##name = NULL;
+CZ_CL_FUNC_LIST
+#undef CZ_CL_FUNC
+
+/*!	\brief Error handling of OpenCL calls.
+*/
+#define CZ_CL_CALL(funcCall, errProc) \
+	{ \
+		cl_int errCode; \
+		if((errCode = (funcCall)) != CL_SUCCESS) { \
+			CZLog(CZLogLevelError, "OpenCL Error: %d in %s", errCode, #funcCall); \
+			errProc; \
+		} \
+	}
+
+/*!	\brief OpenCL device found by CZClDeviceFound().
+*/
+struct CZClDevice {
+	cl_platform_id	platform;		/*!< Platform of device. */
+	cl_device_id	device;			/*!< Device. */
+	char		platformName[CZ_CL_STR_LEN];	/*!< Name of platform. */
+	char		platformVersion[CZ_CL_STR_LEN];	/*!< Version string of platform. */
+	char		driverVersion[CZ_CL_STR_LEN];	/*!< Driver version string of device. */
+};
+
+/*!	\brief List of OpenCL devices.
+*/
+static struct CZClDevice CZClDevices[CZ_CL_DEVICES_MAX];
+
+/*!	\brief Number of OpenCL devices in \a CZClDevices, \a -1 if devices were not searched yet.
+*/
+static int CZClDevicesNum = -1;
+
+/*!	\brief Check if OpenCL library is loaded.
+	This function loads OpenCL ICD loader library and finds all
+	functions of \a CZ_CL_FUNC_LIST.
+	\return \a true in case of success, \a false in case of error.
+*/
+static bool CZClIsInit(void) {
+	static int state = 0;
+
+	if(state != 0)
+		return state > 0;
+
+	state = -1;
+
+#if defined(Q_OS_WIN)
+	HMODULE hDll = LoadLibraryA(CZ_CL_DLL_FNAME);
+#define CZ_CL_SYMBOL(name) GetProcAddress(hDll, name)
+#else
+	void *hDll = dlopen(CZ_CL_DLL_FNAME, RTLD_LAZY);
+#if defined(CZ_CL_DLL_FNAME_DEV)
+	if(hDll == NULL)
+		hDll = dlopen(CZ_CL_DLL_FNAME_DEV, RTLD_LAZY);
+#endif
+#define CZ_CL_SYMBOL(name) dlsym(hDll, name)
+#endif
+
+	if(hDll == NULL) {
+		CZLog(CZLogLevelLow, "Can't load OpenCL library.");
+		return false;
+	}
+
+#define CZ_CL_FUNC(ret, name, args) \
+	p_##name = (name##_t)CZ_CL_SYMBOL(#name); \
+	if(p_##name == NULL) { \
+		CZLog(CZLogLevelError, "Can't find function %s in OpenCL library.", #name); \
+		return false; \
+	}
+CZ_CL_FUNC_LIST
+#undef CZ_CL_FUNC
+#undef CZ_CL_SYMBOL
+
+	state = 1;
+	return true;
+}
+
+/*!	\brief Check if OpenCL is present here.
+	\return \a true if OpenCL library is loaded, \a false otherwise.
+*/
+bool CZClCheck(void) {
+	return CZClIsInit();
+}
+
+/*!	\brief Get number of OpenCL devices.
+	Devices of all platforms are listed except devices of NVIDIA
+	platform. These devices are tested with CUDA functions.
+	\return number of OpenCL devices.
+*/
+int CZClDeviceFound(void) {
+	cl_platform_id platforms[CZ_CL_PLATFORMS_MAX];
+	cl_uint platformsNum = 0;
+	cl_uint i;
+
+	if(CZClDevicesNum >= 0)
+		return CZClDevicesNum;
+
+	CZClDevicesNum = 0;
+
+	if(!CZClIsInit())
+		return 0;
+
+	if(p_clGetPlatformIDs(CZ_CL_PLATFORMS_MAX, platforms, &platformsNum) != CL_SUCCESS) {
+		CZLog(CZLogLevelLow, "No OpenCL platforms found.");
+		return 0;
+	}
+	if(platformsNum > CZ_CL_PLATFORMS_MAX)
+		platformsNum = CZ_CL_PLATFORMS_MAX;
+
+	for(i = 0; i < platformsNum; i++) {
+		cl_device_id devices[CZ_CL_DEVICES_MAX];
+		cl_uint devicesNum = 0;
+		char name[CZ_CL_STR_LEN] = "";
+		char version[CZ_CL_STR_LEN] = "";
+		cl_uint j;
+
+		p_clGetPlatformInfo(platforms[i], CL_PLATFORM_NAME, sizeof(name), name, NULL);
+		p_clGetPlatformInfo(platforms[i], CL_PLATFORM_VERSION, sizeof(version), version, NULL);
+		CZLog(CZLogLevelLow, "OpenCL platform %d: %s (%s).", i, name, version);
+
+		if(strcmp(name, CZ_CL_NVIDIA_PLATFORM) == 0)
+			continue;
+
+		if(p_clGetDeviceIDs(platforms[i], CL_DEVICE_TYPE_ALL, CZ_CL_DEVICES_MAX, devices, &devicesNum) != CL_SUCCESS)
+			continue;
+		if(devicesNum > CZ_CL_DEVICES_MAX)
+			devicesNum = CZ_CL_DEVICES_MAX;
+
+		for(j = 0; (j < devicesNum) && (CZClDevicesNum < CZ_CL_DEVICES_MAX); j++) {
+			struct CZClDevice *dev = &CZClDevices[CZClDevicesNum++];
+
+			dev->platform = platforms[i];
+			dev->device = devices[j];
+			strcpy(dev->platformName, name);
+			strcpy(dev->platformVersion, version);
+			dev->driverVersion[0] = 0;
+			p_clGetDeviceInfo(devices[j], CL_DRIVER_VERSION, sizeof(dev->driverVersion), dev->driverVersion, NULL);
+		}
+	}
+
+	CZLog(CZLogLevelLow, "OpenCL devices found: %d.", CZClDevicesNum);
+
+	return CZClDevicesNum;
+}
+
+/*!	\brief Read one value of OpenCL device information.
+	Value is set to zero if information can't be read.
+*/
+static void CZClGetDeviceInfo(
+	cl_device_id device,		/*!<[in] OpenCL device. */
+	cl_uint param,			/*!<[in] Information parameter. */
+	size_t size,			/*!<[in] Size of value. */
+	void *value			/*!<[out] Value. */
+) {
+	if(p_clGetDeviceInfo(device, param, size, value, NULL) != CL_SUCCESS)
+		memset(value, 0, size);
+}
+
+/*!	\brief Check if OpenCL device supports extension.
+	\return \a true if extension is supported, \a false otherwise.
+*/
+static bool CZClHasExtension(
+	cl_device_id device,		/*!<[in] OpenCL device. */
+	const char *name		/*!<[in] Name of extension. */
+) {
+	size_t size = 0;
+	char *list;
+	bool res;
+
+	if((p_clGetDeviceInfo(device, CL_DEVICE_EXTENSIONS, 0, NULL, &size) != CL_SUCCESS) || (size == 0))
+		return false;
+
+	list = (char*)malloc(size + 1);
+	if(list == NULL)
+		return false;
+
+	if(p_clGetDeviceInfo(device, CL_DEVICE_EXTENSIONS, size, list, NULL) != CL_SUCCESS) {
+		free(list);
+		return false;
+	}
+	list[size] = 0;
+
+	res = false;
+	for(char *p = strstr(list, name); p != NULL; p = strstr(p + 1, name)) {
+		char end = p[strlen(name)];
+		if(((p == list) || (p[-1] == ' ')) && ((end == ' ') || (end == 0))) {
+			res = true;
+			break;
+		}
+	}
+
+	free(list);
+	return res;
+}
+
+/*!	\brief Read information about OpenCL device.
+	Compute capability is the OpenCL version of device, runtime
+	version is the OpenCL version of platform. Number of multiprocessors
+	is the number of compute units, warp size is the native float
+	vector width and shared memory per block is the local memory size.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZClReadDeviceInfo(
+	struct CZDeviceInfo *info,	/*!<[in,out] Device information. */
+	int num				/*!<[in] Number (index) of OpenCL device. */
+) {
+	struct CZClDevice *dev;
+	char version[CZ_CL_STR_LEN] = "";
+	size_t sizes[CZ_CL_DIMS_MAX];
+	size_t sizeValue;
+	cl_ulong ulongValue;
+	cl_uint uintValue;
+	cl_bool boolValue;
+	int major = 0;
+	int minor = 0;
+	int i;
+
+	if(info == NULL)
+		return -1;
+
+	if((num < 0) || (num >= CZClDeviceFound()))
+		return -1;
+
+	dev = &CZClDevices[num];
+
+	info->num = num;
+	info->deviceType = CZDeviceTypeOpenCL;
+	CZClGetDeviceInfo(dev->device, CL_DEVICE_NAME, sizeof(info->deviceName), info->deviceName);
+	info->deviceName[sizeof(info->deviceName) - 1] = 0;
+
+	CZClGetDeviceInfo(dev->device, CL_DEVICE_VERSION, sizeof(version) - 1, version);
+	sscanf(version, "OpenCL %d.%d", &major, &minor);
+	info->major = major;
+	info->minor = minor;
+
+	major = minor = 0;
+	sscanf(dev->platformVersion, "OpenCL %d.%d", &major, &minor);
+	info->drvVersion = dev->driverVersion;
+	info->drvDllVer = 0;
+	info->drvDllVerStr = dev->platformName;
+	info->rtDllVer = major * 1000 + minor * 10;
+	info->rtDllVerStr = dev->platformVersion;
+	info->tccDriver = 0;
+
+	CZClGetDeviceInfo(dev->device, CL_DEVICE_NATIVE_VECTOR_WIDTH_FLOAT, sizeof(uintValue), &uintValue);
+	info->core.SIMDWidth = uintValue;
+	CZClGetDeviceInfo(dev->device, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(sizeValue), &sizeValue);
+	info->core.maxThreadsPerBlock = (int)sizeValue;
+	CZClGetDeviceInfo(dev->device, CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS, sizeof(uintValue), &uintValue);
+	memset(sizes, 0, sizeof(sizes));
+	if((uintValue > 0) && (uintValue <= CZ_CL_DIMS_MAX))
+		CZClGetDeviceInfo(dev->device, CL_DEVICE_MAX_WORK_ITEM_SIZES, uintValue * sizeof(size_t), sizes);
+	for(i = 0; i < 3; i++)
+		info->core.maxThreadsDim[i] = (int)sizes[i];
+	CZClGetDeviceInfo(dev->device, CL_DEVICE_MAX_CLOCK_FREQUENCY, sizeof(uintValue), &uintValue);
+	info->core.clockRate = uintValue * 1000;
+	CZClGetDeviceInfo(dev->device, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(uintValue), &uintValue);
+	info->core.muliProcCount = uintValue;
+	info->core.watchdogEnabled = -1;
+	CZClGetDeviceInfo(dev->device, CL_DEVICE_HOST_UNIFIED_MEMORY, sizeof(boolValue), &boolValue);
+	info->core.integratedGpu = boolValue? 1: 0;
+	info->mem.unifiedAddressing = boolValue? 1: 0;
+	CZClGetDeviceInfo(dev->device, CL_DEVICE_AVAILABLE, sizeof(boolValue), &boolValue);
+	info->core.computeMode = boolValue? CZComputeModeDefault: CZComputeModeProhibited;
+	info->core.doublePrecision = CZClHasExtension(dev->device, "cl_khr_fp64")? 1: 0;
+
+	if(CZClHasExtension(dev->device, "cl_khr_pci_bus_info")) {
+		struct CZClPciBusInfo pci;
+		CZClGetDeviceInfo(dev->device, CL_DEVICE_PCI_BUS_INFO_KHR, sizeof(pci), &pci);
+		info->core.pciDomainID = pci.domain;
+		info->core.pciBusID = pci.bus;
+		info->core.pciDeviceID = pci.device;
+	}
+
+	CZClGetDeviceInfo(dev->device, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(ulongValue), &ulongValue);
+	info->mem.totalGlobal = (size_t)ulongValue;
+	CZClGetDeviceInfo(dev->device, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(ulongValue), &ulongValue);
+	info->mem.sharedPerBlock = (size_t)ulongValue;
+	CZClGetDeviceInfo(dev->device, CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE, sizeof(ulongValue), &ulongValue);
+	info->mem.totalConst = (size_t)ulongValue;
+	CZClGetDeviceInfo(dev->device, CL_DEVICE_MEM_BASE_ADDR_ALIGN, sizeof(uintValue), &uintValue);
+	info->mem.textureAlignment = uintValue / 8;
+	CZClGetDeviceInfo(dev->device, CL_DEVICE_IMAGE2D_MAX_WIDTH, sizeof(sizeValue), &sizeValue);
+	info->mem.texture1D[0] = sizeValue;
+	info->mem.texture2D[0] = sizeValue;
+	CZClGetDeviceInfo(dev->device, CL_DEVICE_IMAGE2D_MAX_HEIGHT, sizeof(sizeValue), &sizeValue);
+	info->mem.texture2D[1] = sizeValue;
+	CZClGetDeviceInfo(dev->device, CL_DEVICE_IMAGE3D_MAX_WIDTH, sizeof(sizeValue), &sizeValue);
+	info->mem.texture3D[0] = sizeValue;
+	CZClGetDeviceInfo(dev->device, CL_DEVICE_IMAGE3D_MAX_HEIGHT, sizeof(sizeValue), &sizeValue);
+	info->mem.texture3D[1] = sizeValue;
+	CZClGetDeviceInfo(dev->device, CL_DEVICE_IMAGE3D_MAX_DEPTH, sizeof(sizeValue), &sizeValue);
+	info->mem.texture3D[2] = sizeValue;
+	info->mem.mapHostMemory = 1;
+	CZClGetDeviceInfo(dev->device, CL_DEVICE_ERROR_CORRECTION_SUPPORT, sizeof(boolValue), &boolValue);
+	info->mem.errorCorrection = boolValue? 1: 0;
+	CZClGetDeviceInfo(dev->device, CL_DEVICE_GLOBAL_MEM_CACHE_SIZE, sizeof(ulongValue), &ulongValue);
+	info->mem.l2CacheSize = (int)ulongValue;
+
+	CZLog(CZLogLevelLow, "OpenCL device %d is %s: OpenCL %d.%d, %d compute unit(s), platform %s.",
+		num, info->deviceName, info->major, info->minor, info->core.muliProcCount, dev->platformName);
+
+	return 0;
+}
+
+/*!	\brief Select OpenCL device for tests.
+	\return \a 0, nothing has to be done.
+*/
+int CZClCalcDeviceSelect(
+	struct CZDeviceInfo *info	/*!<[in,out] Device information. */
+) {
+	(void)info;
+	return 0;
+}
+
+#define CZ_CL_CALC_MODE_FLOAT		0	/*!< Single-precision float point test mode. */
+#define CZ_CL_CALC_MODE_DOUBLE		1	/*!< Double-precision float point test mode. */
+#define CZ_CL_CALC_MODE_INTEGER32	2	/*!< 32-bit integer test mode. */
+#define CZ_CL_CALC_MODE_INTEGER24	3	/*!< 24-bit integer test mode. */
+#define CZ_CL_CALC_MODE_INTEGER64	4	/*!< 64-bit integer test mode. */
+#define CZ_CL_CALC_MODE_NUM		5	/*!< Number of test modes. */
+
+/*!	\brief Names of calculation kernels of test modes.
+*/
+static const char *CZClCalcKernelNames[CZ_CL_CALC_MODE_NUM] = {
+	"CZClCalcKernelFloat",
+	"CZClCalcKernelDouble",
+	"CZClCalcKernelInteger32",
+	"CZClCalcKernelInteger24",
+	"CZClCalcKernelInteger64",
+};
+
+/*!	\brief OpenCL C code of calculation tests.
+	Kernels are the same MAD chains as GPU code of CUDA-devices.
+	Double-precision kernel is built if \a CZ_CL_FP64 is defined.
+*/
+static const char CZClCalcSource[] =
+	"#ifdef CZ_CL_FP64\n"
+	"#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
+	"#endif\n"
+	"\n"
+	"#define CZ_CALC_MAD_16(a, b) \\\n"
+	"	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \\\n"
+	"	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \\\n"
+	"	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \\\n"
+	"	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b;\n"
+	"\n"
+	"#define CZ_CALC_MAD_256(a, b) \\\n"
+	"	CZ_CALC_MAD_16(a, b) CZ_CALC_MAD_16(a, b) CZ_CALC_MAD_16(a, b) CZ_CALC_MAD_16(a, b) \\\n"
+	"	CZ_CALC_MAD_16(a, b) CZ_CALC_MAD_16(a, b) CZ_CALC_MAD_16(a, b) CZ_CALC_MAD_16(a, b) \\\n"
+	"	CZ_CALC_MAD_16(a, b) CZ_CALC_MAD_16(a, b) CZ_CALC_MAD_16(a, b) CZ_CALC_MAD_16(a, b) \\\n"
+	"	CZ_CALC_MAD_16(a, b) CZ_CALC_MAD_16(a, b) CZ_CALC_MAD_16(a, b) CZ_CALC_MAD_16(a, b)\n"
+	"\n"
+	"#define CZ_CALC_MAD24_16(a, b) \\\n"
+	"	a = mad24(a, a, a); b = mad24(b, b, b); a = mad24(a, a, a); b = mad24(b, b, b); \\\n"
+	"	a = mad24(a, a, a); b = mad24(b, b, b); a = mad24(a, a, a); b = mad24(b, b, b); \\\n"
+	"	a = mad24(a, a, a); b = mad24(b, b, b); a = mad24(a, a, a); b = mad24(b, b, b); \\\n"
+	"	a = mad24(a, a, a); b = mad24(b, b, b); a = mad24(a, a, a); b = mad24(b, b, b);\n"
+	"\n"
+	"#define CZ_CALC_MAD24_256(a, b) \\\n"
+	"	CZ_CALC_MAD24_16(a, b) CZ_CALC_MAD24_16(a, b) CZ_CALC_MAD24_16(a, b) CZ_CALC_MAD24_16(a, b) \\\n"
+	"	CZ_CALC_MAD24_16(a, b) CZ_CALC_MAD24_16(a, b) CZ_CALC_MAD24_16(a, b) CZ_CALC_MAD24_16(a, b) \\\n"
+	"	CZ_CALC_MAD24_16(a, b) CZ_CALC_MAD24_16(a, b) CZ_CALC_MAD24_16(a, b) CZ_CALC_MAD24_16(a, b) \\\n"
+	"	CZ_CALC_MAD24_16(a, b) CZ_CALC_MAD24_16(a, b) CZ_CALC_MAD24_16(a, b) CZ_CALC_MAD24_16(a, b)\n"
+	"\n"
+	"#define CZ_CALC_KERNEL(name, type, mad) \\\n"
+	"__kernel void name(__global type *arr, int loops) { \\\n"
+	"	int index = get_global_id(0); \\\n"
+	"	type val1 = index; \\\n"
+	"	type val2 = arr[index]; \\\n"
+	"	int i; \\\n"
+	"	for(i = 0; i < loops; i++) { \\\n"
+	"		mad(val1, val2) mad(val1, val2) mad(val1, val2) mad(val1, val2) \\\n"
+	"		mad(val1, val2) mad(val1, val2) mad(val1, val2) mad(val1, val2) \\\n"
+	"		mad(val1, val2) mad(val1, val2) mad(val1, val2) mad(val1, val2) \\\n"
+	"		mad(val1, val2) mad(val1, val2) mad(val1, val2) mad(val1, val2) \\\n"
+	"	} \\\n"
+	"	arr[index] = val1 + val2; \\\n"
+	"}\n"
+	"\n"
+	"CZ_CALC_KERNEL(CZClCalcKernelFloat, float, CZ_CALC_MAD_256)\n"
+	"#ifdef CZ_CL_FP64\n"
+	"CZ_CALC_KERNEL(CZClCalcKernelDouble, double, CZ_CALC_MAD_256)\n"
+	"#endif\n"
+	"CZ_CALC_KERNEL(CZClCalcKernelInteger32, int, CZ_CALC_MAD_256)\n"
+	"CZ_CALC_KERNEL(CZClCalcKernelInteger24, int, CZ_CALC_MAD24_256)\n"
+	"CZ_CALC_KERNEL(CZClCalcKernelInteger64, long, CZ_CALC_MAD_256)\n";
+
+/*!	\brief Local service data structure for bandwith and performance calulations.
+*/
+struct CZClBandLocalData {
+	cl_context	context;		/*!< Context of device. */
+	cl_command_queue	queue;		/*!< Profiling command queue. */
+	cl_program	program;		/*!< Program of calculation kernels. */
+	cl_kernel	kernels[CZ_CL_CALC_MODE_NUM];	/*!< Calculation kernels, \a NULL if not built. */
+	size_t		size;			/*!< Size of buffers. */
+	void		*memHostPage;		/*!< Pageable host memory. */
+	cl_mem		memHostPinBuf;		/*!< Host accessible buffer mapped to \a memHostPin. */
+	void		*memHostPin;		/*!< Pinned host memory. */
+	cl_mem		memDevice1;		/*!< Device memory buffer 1. */
+	cl_mem		memDevice2;		/*!< Device memory buffer 2. */
+};
+
+/*!	\brief Release OpenCL objects of local data and local data itself.
+*/
+static void CZClFreeLocalData(
+	struct CZClBandLocalData *lData	/*!<[in] Local data. */
+) {
+	int i;
+
+	for(i = 0; i < CZ_CL_CALC_MODE_NUM; i++) {
+		if(lData->kernels[i] != NULL)
+			p_clReleaseKernel(lData->kernels[i]);
+	}
+	if(lData->program != NULL)
+		p_clReleaseProgram(lData->program);
+	if(lData->memHostPin != NULL)
+		p_clEnqueueUnmapMemObject(lData->queue, lData->memHostPinBuf, lData->memHostPin, 0, NULL, NULL);
+	if(lData->queue != NULL)
+		p_clFinish(lData->queue);
+	if(lData->memHostPinBuf != NULL)
+		p_clReleaseMemObject(lData->memHostPinBuf);
+	if(lData->memDevice1 != NULL)
+		p_clReleaseMemObject(lData->memDevice1);
+	if(lData->memDevice2 != NULL)
+		p_clReleaseMemObject(lData->memDevice2);
+	if(lData->queue != NULL)
+		p_clReleaseCommandQueue(lData->queue);
+	if(lData->context != NULL)
+		p_clReleaseContext(lData->context);
+	free(lData->memHostPage);
+	free(lData);
+}
+
+/*!	\brief Build calculation kernels for OpenCL device.
+	Copy tests can run without kernels, so build errors are logged only.
+*/
+static void CZClBuildKernels(
+	struct CZDeviceInfo *info,	/*!<[in] Device information. */
+	struct CZClBandLocalData *lData	/*!<[in,out] Local data. */
+) {
+	cl_device_id device = CZClDevices[info->num].device;
+	const char *source = CZClCalcSource;
+	cl_int err;
+	int i;
+
+	lData->program = p_clCreateProgramWithSource(lData->context, 1, &source, NULL, &err);
+	if(lData->program == NULL) {
+		CZLog(CZLogLevelError, "OpenCL Error: %d, can't create program.", err);
+		return;
+	}
+
+	err = p_clBuildProgram(lData->program, 1, &device,
+		info->core.doublePrecision? "-cl-mad-enable -DCZ_CL_FP64": "-cl-mad-enable", NULL, NULL);
+	if(err != CL_SUCCESS) {
+		size_t size = 0;
+		char *log;
+
+		CZLog(CZLogLevelError, "OpenCL Error: %d, can't build program for %s.", err, info->deviceName);
+		p_clGetProgramBuildInfo(lData->program, device, CL_PROGRAM_BUILD_LOG, 0, NULL, &size);
+		log = (char*)malloc(size + 1);
+		if(log != NULL) {
+			if(p_clGetProgramBuildInfo(lData->program, device, CL_PROGRAM_BUILD_LOG, size, log, NULL) == CL_SUCCESS) {
+				log[size] = 0;
+				CZLog(CZLogLevelError, "%s", log);
+			}
+			free(log);
+		}
+		p_clReleaseProgram(lData->program);
+		lData->program = NULL;
+		return;
+	}
+
+	for(i = 0; i < CZ_CL_CALC_MODE_NUM; i++) {
+		if((i == CZ_CL_CALC_MODE_DOUBLE) && !info->core.doublePrecision)
+			continue;
+		lData->kernels[i] = p_clCreateKernel(lData->program, CZClCalcKernelNames[i], &err);
+		if(lData->kernels[i] == NULL)
+			CZLog(CZLogLevelError, "OpenCL Error: %d, can't create kernel %s.", err, CZClCalcKernelNames[i]);
+	}
+}
+
+/*!	\brief Allocate buffers and build kernels for OpenCL device tests.
+	Pinned host memory is a mapped buffer allocated with flag
+	\a CL_MEM_ALLOC_HOST_PTR, it stays mapped while device is used.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZClPrepareDevice(
+	struct CZDeviceInfo *info	/*!<[in,out] Device information. */
+) {
+	struct CZClBandLocalData *lData;
+	cl_device_id device;
+	cl_ulong maxAlloc = 0;
+	cl_int err;
+
+	if(info == NULL)
+		return -1;
+
+	if(info->band.localData != NULL)
+		return 0;
+
+	if((info->num < 0) || (info->num >= CZClDeviceFound()))
+		return -1;
+
+	device = CZClDevices[info->num].device;
+
+	CZLog(CZLogLevelLow, "Alloc local buffers for %s.", info->deviceName);
+
+	lData = (struct CZClBandLocalData*)malloc(sizeof(*lData));
+	if(lData == NULL)
+		return -1;
+	memset(lData, 0, sizeof(*lData));
+
+	lData->size = (size_t)info->config.copyBufSize;
+	CZClGetDeviceInfo(device, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(maxAlloc), &maxAlloc);
+	if((maxAlloc != 0) && (maxAlloc < lData->size))
+		lData->size = (size_t)maxAlloc;
+
+	lData->context = p_clCreateContext(NULL, 1, &device, NULL, NULL, &err);
+	if(lData->context == NULL) {
+		CZLog(CZLogLevelError, "OpenCL Error: %d, can't create context.", err);
+		CZClFreeLocalData(lData);
+		return -1;
+	}
+
+	lData->queue = p_clCreateCommandQueue(lData->context, device, CL_QUEUE_PROFILING_ENABLE, &err);
+	if(lData->queue == NULL) {
+		CZLog(CZLogLevelError, "OpenCL Error: %d, can't create command queue.", err);
+		CZClFreeLocalData(lData);
+		return -1;
+	}
+
+	lData->memHostPage = malloc(lData->size);
+	lData->memHostPinBuf = p_clCreateBuffer(lData->context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, lData->size, NULL, &err);
+	lData->memDevice1 = p_clCreateBuffer(lData->context, CL_MEM_READ_WRITE, lData->size, NULL, &err);
+	lData->memDevice2 = p_clCreateBuffer(lData->context, CL_MEM_READ_WRITE, lData->size, NULL, &err);
+	if((lData->memHostPage == NULL) || (lData->memHostPinBuf == NULL) ||
+		(lData->memDevice1 == NULL) || (lData->memDevice2 == NULL)) {
+		CZLog(CZLogLevelError, "OpenCL Error: %d, can't allocate buffers.", err);
+		CZClFreeLocalData(lData);
+		return -1;
+	}
+
+	lData->memHostPin = p_clEnqueueMapBuffer(lData->queue, lData->memHostPinBuf, CL_TRUE,
+		CL_MAP_READ | CL_MAP_WRITE, 0, lData->size, 0, NULL, NULL, &err);
+	if(lData->memHostPin == NULL) {
+		CZLog(CZLogLevelError, "OpenCL Error: %d, can't map host buffer.", err);
+		CZClFreeLocalData(lData);
+		return -1;
+	}
+
+	memset(lData->memHostPage, 0, lData->size);
+	memset(lData->memHostPin, 0, lData->size);
+
+	CZClBuildKernels(info, lData);
+
+	info->band.localData = (void*)lData;
+
+	return 0;
+}
+
+/*!	\brief Free buffers and kernels of OpenCL device tests.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZClCleanDevice(
+	struct CZDeviceInfo *info	/*!<[in,out] Device information. */
+) {
+
+	if(info == NULL)
+		return -1;
+
+	if(info->band.localData == NULL)
+		return 0;
+
+	CZLog(CZLogLevelLow, "Free local buffers for %s.", info->deviceName);
+
+	CZClFreeLocalData((struct CZClBandLocalData*)info->band.localData);
+	info->band.localData = NULL;
+
+	return 0;
+}
+
+/*!	\brief Check if running test has to be stopped.
+	Rules are the same as for CUDA-device tests.
+	\return \a true if test has to be stopped, \a false otherwise.
+*/
+static bool CZClCalcDeviceTestBreak(
+	struct CZDeviceInfo *info,	/*!<[in] Device information. */
+	QElapsedTimer &timer,		/*!<[in] Timer started with test. */
+	int loop			/*!<[in] Index of loop going to be started. */
+) {
+
+	if((info->abortFlag != NULL) && (*info->abortFlag != 0)) {
+		CZLog(CZLogLevelLow, "Test is aborted on %s.", info->deviceName);
+		return true;
+	}
+
+	if((loop != 0) && (info->timeLimit > 0) && (timer.elapsed() >= info->timeLimit)) {
+		CZLog(CZLogLevelLow, "Test is out of time limit on %s.", info->deviceName);
+		return true;
+	}
+
+	return false;
+}
+
+/*!	\brief Wait for OpenCL command and get its execution time.
+	Host time is returned if device profiling information is not
+	available. Event is released.
+	\return time of command in ms, \a -1 in case of error.
+*/
+static double CZClEventMs(
+	cl_event event,			/*!<[in] Event of command. */
+	QElapsedTimer &timer		/*!<[in] Timer started before command. */
+) {
+	cl_ulong start = 0;
+	cl_ulong end = 0;
+	double ms;
+
+	CZ_CL_CALL(p_clWaitForEvents(1, &event),
+		p_clReleaseEvent(event);
+		return -1);
+
+	ms = (double)timer.nsecsElapsed() / 1000000.0;
+
+	if((p_clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(start), &start, NULL) == CL_SUCCESS) &&
+		(p_clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(end), &end, NULL) == CL_SUCCESS) &&
+		(end > start))
+		ms = (double)(end - start) / 1000000.0;
+
+	p_clReleaseEvent(event);
+
+	return ms;
+}
+
+/*!	\brief Run one OpenCL data transfer test.
+	Test runs up to \a info->config.copyLoops loops. If time limit of the
+	device is set the size of transfer is reduced after the first loop
+	to fit all loops into the limit.
+	\return \a 0 in case of error, \a other is value in KiB/s.
+*/
+static float CZClCalcDeviceBandwidthTest(
+	struct CZDeviceInfo *info,	/*!<[in,out] Device information. */
+	int test,			/*!<[in] Test identifier. See enum #CZTest. */
+	struct CZDeviceInfoTime *time	/*!<[out] Host side timing of test. */
+) {
+	struct CZClBandLocalData *lData = (struct CZClBandLocalData*)info->band.localData;
+	QElapsedTimer timer;
+	double timeMs = 0;
+	double bytes = 0;
+	double testUs;
+	size_t size = lData->size;
+	int i;
+
+	CZLog(CZLogLevelLow, "Starting %s test on %s.",
+		(test == CZTestCopyHDPage)? "host to device (pageable)":
+		(test == CZTestCopyHDPin)? "host to device (pinned)":
+		(test == CZTestCopyDHPage)? "device to host (pageable)":
+		(test == CZTestCopyDHPin)? "device to host (pinned)":
+		(test == CZTestCopyDD)? "device to device": "unknown",
+		info->deviceName);
+
+	timer.start();
+	testUs = CZTraceTimeUs();
+
+	for(i = 0; i < info->config.copyLoops; i++) {
+		QElapsedTimer loopTimer;
+		cl_event event = NULL;
+		double loopUs;
+		double loopMs;
+		double cpuMs;
+
+		if(CZClCalcDeviceTestBreak(info, timer, i)) {
+			info->partialMask |= test;
+			break;
+		}
+
+		loopUs = CZTraceTimeUs();
+		cpuMs = CZCpuThreadTimeMs();
+		loopTimer.start();
+
+		switch(test) {
+		case CZTestCopyHDPage:
+		case CZTestCopyHDPin:
+			CZ_CL_CALL(p_clEnqueueWriteBuffer(lData->queue, lData->memDevice1, CL_TRUE, 0, size,
+				(test == CZTestCopyHDPin)? lData->memHostPin: lData->memHostPage, 0, NULL, &event),
+				return 0);
+			break;
+
+		case CZTestCopyDHPage:
+		case CZTestCopyDHPin:
+			CZ_CL_CALL(p_clEnqueueReadBuffer(lData->queue, lData->memDevice2, CL_TRUE, 0, size,
+				(test == CZTestCopyDHPin)? lData->memHostPin: lData->memHostPage, 0, NULL, &event),
+				return 0);
+			break;
+
+		case CZTestCopyDD:
+			CZ_CL_CALL(p_clEnqueueCopyBuffer(lData->queue, lData->memDevice1, lData->memDevice2, 0, 0, size, 0, NULL, &event),
+				return 0);
+			break;
+
+		default: // WTF!
+			return 0;
+		}
+
+		loopMs = CZClEventMs(event, loopTimer);
+		if(loopMs < 0)
+			return 0;
+
+		timeMs += loopMs;
+		bytes += (double)size;
+
+		time->deviceMs += (float)loopMs;
+		time->wallMs += (float)((double)loopTimer.nsecsElapsed() / 1000000.0);
+		time->cpuMs += (float)(CZCpuThreadTimeMs() - cpuMs);
+		time->amount += (double)size;
+
+		CZTraceHostSpan("copy", CZTestName(test), info->num, loopUs);
+		CZTraceDeviceSpan("copy", CZTestName(test), info->num, loopUs, loopMs * 1000.0);
+
+		CZLogKV(CZLogLevelLow, "cl-copy-loop", "dev=%d test=0x%x loop=%d bytes=%lu ms=%f",
+			info->num, test, i, (unsigned long)size, loopMs);
+
+		if((i == 0) && (info->timeLimit > 0)) {
+			double loopLimitMs = (double)info->timeLimit / info->config.copyLoops;
+			double hostMs = (double)timer.nsecsElapsed() / 1000000.0;
+			if(hostMs > loopLimitMs) {
+				size = (size_t)((double)size * loopLimitMs / hostMs);
+				size &= ~((size_t)CZ_CL_COPY_BUF_SIZE_MIN - 1);
+				if(size < CZ_CL_COPY_BUF_SIZE_MIN)
+					size = CZ_CL_COPY_BUF_SIZE_MIN;
+				CZLog(CZLogLevelLow, "Transfer size is reduced to %d bytes.", (int)size);
+			}
+		}
+	}
+
+	CZTraceHostSpan("copy", "test", info->num, testUs);
+
+	CZLog(CZLogLevelLow, "Test complete in %f ms (%d loops).", timeMs, i);
+	CZLog(CZLogLevelLow, "Host wall time %f ms, CPU time %f ms.", time->wallMs, time->cpuMs);
+
+	if(timeMs == 0)
+		return 0;
+
+	return (float)(1000.0 * bytes / (timeMs * 1024.0));
+}
+
+/*!	\brief Run OpenCL device memory transfer tests.
+	Transfers are done with \a clEnqueueWriteBuffer(),
+	\a clEnqueueReadBuffer() and \a clEnqueueCopyBuffer().
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZClCalcDeviceBandwidth(
+	struct CZDeviceInfo *info	/*!<[in,out] Device information. */
+) {
+
+	if(info == NULL)
+		return -1;
+
+	info->band.copyHDPage = 0;
+	info->band.copyHDPin = 0;
+	info->band.copyDHPage = 0;
+	info->band.copyDHPin = 0;
+	info->band.copyDD = 0;
+	memset(&info->band.copyHDPageTime, 0, sizeof(info->band.copyHDPageTime));
+	memset(&info->band.copyHDPinTime, 0, sizeof(info->band.copyHDPinTime));
+	memset(&info->band.copyDHPageTime, 0, sizeof(info->band.copyDHPageTime));
+	memset(&info->band.copyDHPinTime, 0, sizeof(info->band.copyDHPinTime));
+	memset(&info->band.copyDDTime, 0, sizeof(info->band.copyDDTime));
+	info->partialMask &= ~CZTestCopyAll;
+
+	if((info->testMask & CZTestCopyAll) == 0)
+		return 0;
+
+	if(info->band.localData == NULL)
+		return -1;
+
+	if(info->testMask & CZTestCopyHDPage)
+		info->band.copyHDPage = CZClCalcDeviceBandwidthTest(info, CZTestCopyHDPage, &info->band.copyHDPageTime);
+	if(info->testMask & CZTestCopyHDPin)
+		info->band.copyHDPin = CZClCalcDeviceBandwidthTest(info, CZTestCopyHDPin, &info->band.copyHDPinTime);
+	if(info->testMask & CZTestCopyDHPage)
+		info->band.copyDHPage = CZClCalcDeviceBandwidthTest(info, CZTestCopyDHPage, &info->band.copyDHPageTime);
+	if(info->testMask & CZTestCopyDHPin)
+		info->band.copyDHPin = CZClCalcDeviceBandwidthTest(info, CZTestCopyDHPin, &info->band.copyDHPinTime);
+	if(info->testMask & CZTestCopyDD)
+		info->band.copyDD = CZClCalcDeviceBandwidthTest(info, CZTestCopyDD, &info->band.copyDDTime);
+
+	return 0;
+}
+
+/*!	\brief Launch OpenCL calculation kernel and wait for it.
+	\return time of kernel in ms, \a -1 in case of error.
+*/
+static double CZClCalcDevicePerformanceLaunch(
+	struct CZClBandLocalData *lData,	/*!<[in] Local data. */
+	cl_kernel kernel,		/*!<[in] Calculation kernel. */
+	size_t blocksNum,		/*!<[in] Number of work groups. */
+	size_t threadsNum,		/*!<[in] Number of work items per work group. */
+	int loops			/*!<[in] Number of calculation loops. */
+) {
+	QElapsedTimer timer;
+	cl_event event = NULL;
+	size_t globalSize = blocksNum * threadsNum;
+
+	CZ_CL_CALL(p_clSetKernelArg(kernel, 0, sizeof(cl_mem), &lData->memDevice1),
+		return -1);
+	CZ_CL_CALL(p_clSetKernelArg(kernel, 1, sizeof(int), &loops),
+		return -1);
+
+	timer.start();
+
+	CZ_CL_CALL(p_clEnqueueNDRangeKernel(lData->queue, kernel, 1, NULL, &globalSize, &threadsNum, 0, NULL, &event),
+		return -1);
+
+	return CZClEventMs(event, timer);
+}
+
+/*!	\brief Run one OpenCL calculation performance test.
+	Work group size is the largest one allowed for the kernel.
+	Result is counted the same way as for CUDA-devices.
+	\return \a 0 in case of error, \a other is value in KOPS.
+*/
+static float CZClCalcDevicePerformanceTest(
+	struct CZDeviceInfo *info,	/*!<[in,out] Device information. */
+	int mode,			/*!<[in] Run performance test in one of modes. */
+	int test,			/*!<[in] Test identifier. See enum #CZTest. */
+	struct CZDeviceInfoTime *time	/*!<[out] Host side timing of test. */
+) {
+	struct CZClBandLocalData *lData = (struct CZClBandLocalData*)info->band.localData;
+	cl_kernel kernel = lData->kernels[mode];
+	QElapsedTimer timer;
+	double timeMs = 0;
+	double opsNum = 0;
+	double testUs;
+	size_t blocksNum;
+	size_t threadsNum = 0;
+	int blockLoops = info->config.calcBlockLoops;
+	int i;
+
+	if(kernel == NULL)
+		return 0;
+
+	blocksNum = info->heavyMode? info->core.muliProcCount: 1;
+	if(blocksNum < 1)
+		blocksNum = 1;
+
+	p_clGetKernelWorkGroupInfo(kernel, CZClDevices[info->num].device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(threadsNum), &threadsNum, NULL);
+	if((threadsNum == 0) || ((info->core.maxThreadsPerBlock > 0) && (threadsNum > (size_t)info->core.maxThreadsPerBlock)))
+		threadsNum = info->core.maxThreadsPerBlock;
+	if(threadsNum == 0)
+		threadsNum = 1;
+	while((blocksNum * threadsNum * sizeof(cl_ulong) > lData->size) && (threadsNum > 1))
+		threadsNum /= 2;
+
+	CZLog(CZLogLevelLow, "Starting %s test on %s on %d work group(s) %d work item(s) each.",
+		(mode == CZ_CL_CALC_MODE_FLOAT)? "single-precision float":
+		(mode == CZ_CL_CALC_MODE_DOUBLE)? "double-precision float":
+		(mode == CZ_CL_CALC_MODE_INTEGER32)? "32-bit integer":
+		(mode == CZ_CL_CALC_MODE_INTEGER24)? "24-bit integer":
+		(mode == CZ_CL_CALC_MODE_INTEGER64)? "64-bit integer": "unknown",
+		info->deviceName,
+		(int)blocksNum,
+		(int)threadsNum);
+
+	timer.start();
+	testUs = CZTraceTimeUs();
+
+	if(info->timeLimit > 0) {
+		double probeMs;
+		double loopLimitMs = (double)info->timeLimit / info->config.calcLoops;
+		double probeUs = CZTraceTimeUs();
+
+		if(CZClCalcDevicePerformanceLaunch(lData, kernel, blocksNum, threadsNum, 1) < 0)
+			return 0;
+
+		CZTraceHostSpan("calc", "probe", info->num, probeUs);
+
+		probeMs = (double)timer.nsecsElapsed() / 1000000.0;
+		if(probeMs * blockLoops > loopLimitMs) {
+			blockLoops = (int)(loopLimitMs / probeMs);
+			if(blockLoops < 1)
+				blockLoops = 1;
+			CZLog(CZLogLevelLow, "Calculation loops are reduced to %d.", blockLoops);
+		}
+	}
+
+	for(i = 0; i < info->config.calcLoops; i++) {
+		QElapsedTimer loopTimer;
+		double loopUs;
+		double loopMs;
+		double cpuMs;
+
+		if(CZClCalcDeviceTestBreak(info, timer, i)) {
+			info->partialMask |= test;
+			break;
+		}
+
+		loopUs = CZTraceTimeUs();
+		cpuMs = CZCpuThreadTimeMs();
+		loopTimer.start();
+
+		loopMs = CZClCalcDevicePerformanceLaunch(lData, kernel, blocksNum, threadsNum, blockLoops);
+		if(loopMs < 0)
+			return 0;
+
+		timeMs += loopMs;
+		opsNum += (double)blockLoops;
+
+		time->deviceMs += (float)loopMs;
+		time->wallMs += (float)((double)loopTimer.nsecsElapsed() / 1000000.0);
+		time->cpuMs += (float)(CZCpuThreadTimeMs() - cpuMs);
+
+		CZTraceHostSpan("calc", CZTestName(test), info->num, loopUs);
+		CZTraceDeviceSpan("calc", CZTestName(test), info->num, loopUs, loopMs * 1000.0);
+
+		CZLogKV(CZLogLevelLow, "cl-calc-loop", "dev=%d test=0x%x loop=%d blocks=%d threads=%d block_loops=%d ms=%f",
+			info->num, test, i, (int)blocksNum, (int)threadsNum, blockLoops, loopMs);
+	}
+
+	CZTraceHostSpan("calc", "test", info->num, testUs);
+
+	CZLog(CZLogLevelLow, "Test complete in %f ms (%d loops).", timeMs, i);
+	CZLog(CZLogLevelLow, "Host wall time %f ms, CPU time %f ms.", time->wallMs, time->cpuMs);
+
+	time->amount = (double)info->core.muliProcCount *
+		opsNum *
+		(double)threadsNum *
+		(double)CZ_CALC_OPS_NUM *
+		(double)CZ_CALC_BLOCK_SIZE *
+		(double)CZ_CALC_BLOCK_NUM;
+
+	if(timeMs == 0)
+		return 0;
+
+	return (float)(time->amount / timeMs);
+}
+
+/*!	\brief Run OpenCL device calculation performance tests.
+	Only tests selected in \a info->testMask are run, results of other
+	tests are reset to \a 0.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZClCalcDevicePerformance(
+	struct CZDeviceInfo *info	/*!<[in,out] Device information. */
+) {
+	struct CZClBandLocalData *lData;
+
+	if(info == NULL)
+		return -1;
+
+	info->perf.calcFloat = 0;
+	info->perf.calcDouble = 0;
+	info->perf.calcInteger32 = 0;
+	info->perf.calcInteger24 = 0;
+	info->perf.calcInteger64 = 0;
+	memset(&info->perf.calcFloatTime, 0, sizeof(info->perf.calcFloatTime));
+	memset(&info->perf.calcDoubleTime, 0, sizeof(info->perf.calcDoubleTime));
+	memset(&info->perf.calcInteger32Time, 0, sizeof(info->perf.calcInteger32Time));
+	memset(&info->perf.calcInteger24Time, 0, sizeof(info->perf.calcInteger24Time));
+	memset(&info->perf.calcInteger64Time, 0, sizeof(info->perf.calcInteger64Time));
+	info->partialMask &= ~CZTestCalcAll;
+
+	if((info->testMask & CZTestCalcAll) == 0)
+		return 0;
+
+	lData = (struct CZClBandLocalData*)info->band.localData;
+	if((lData == NULL) || (lData->program == NULL))
+		return -1;
+
+	if(info->testMask & CZTestCalcFloat)
+		info->perf.calcFloat = CZClCalcDevicePerformanceTest(info, CZ_CL_CALC_MODE_FLOAT, CZTestCalcFloat, &info->perf.calcFloatTime);
+	if((info->testMask & CZTestCalcDouble) && info->core.doublePrecision)
+		info->perf.calcDouble = CZClCalcDevicePerformanceTest(info, CZ_CL_CALC_MODE_DOUBLE, CZTestCalcDouble, &info->perf.calcDoubleTime);
+	if(info->testMask & CZTestCalcInteger32)
+		info->perf.calcInteger32 = CZClCalcDevicePerformanceTest(info, CZ_CL_CALC_MODE_INTEGER32, CZTestCalcInteger32, &info->perf.calcInteger32Time);
+	if(info->testMask & CZTestCalcInteger24)
+		info->perf.calcInteger24 = CZClCalcDevicePerformanceTest(info, CZ_CL_CALC_MODE_INTEGER24, CZTestCalcInteger24, &info->perf.calcInteger24Time);
+	if(info->testMask & CZTestCalcInteger64)
+		info->perf.calcInteger64 = CZClCalcDevicePerformanceTest(info, CZ_CL_CALC_MODE_INTEGER64, CZTestCalcInteger64, &info->perf.calcInteger64Time);
+
+	return 0;
+}
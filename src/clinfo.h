@@ -0,0 +1,30 @@
+/*!	\file clinfo.h
+	\brief OpenCL device information and test definition.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#ifndef CZ_CLINFO_H
+#define CZ_CLINFO_H
+
+#include "cudainfo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool CZClCheck(void);
+int CZClDeviceFound(void);
+int CZClReadDeviceInfo(struct CZDeviceInfo *info, int num);
+int CZClCalcDeviceSelect(struct CZDeviceInfo *info);
+int CZClPrepareDevice(struct CZDeviceInfo *info);
+int CZClCalcDeviceBandwidth(struct CZDeviceInfo *info);
+int CZClCalcDevicePerformance(struct CZDeviceInfo *info);
+int CZClCleanDevice(struct CZDeviceInfo *info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//CZ_CLINFO_H
@@ -0,0 +1,473 @@
+/*!	\file coldstart.cpp
+	\brief CUDA cold-start latency test source file.
+	Each cold start is a fresh child process of this program started
+	with \a --cold-child option. The child loads CUDA driver, creates
+	primary context, compiles PTX of many small kernels into cubin,
+	loads the cubin and launches one of its kernels, timing each stage,
+	and prints one line to standard output:
+	\code
+	cold-start library_ms=0.8 init_ms=95.1 context_ms=120.4 jit_ms=40.2 module_ms=2.3 function_ms=0.0 launch_ms=0.1
+	\endcode
+	JIT cache is disabled in the child, so JIT runs every time and is
+	reported as its own stage. Module stage loads ready cubin, so it
+	shows how much eager loading of all kernels costs against lazy one.
+	The parent repeats cold starts for each module loading mode and
+	summarizes latency of every stage.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <QtGlobal>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QProcess>
+#include <QStringList>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#include "log.h"
+#include "trace.h"
+#include "coldstart.h"
+
+#if defined(Q_OS_WIN)
+#define CZ_COLD_DLL_FNAME	"nvcuda.dll"		/*!< CUDA driver dll file name. */
+#elif defined(Q_OS_MAC)
+#define CZ_COLD_DLL_FNAME	"/usr/local/cuda/lib/libcuda.dylib"	/*!< CUDA driver library file name. */
+#else
+#define CZ_COLD_DLL_FNAME	"libcuda.so.1"		/*!< CUDA driver library file name. */
+#endif
+
+#define CZ_COLD_CHILD_OPTION	"--cold-child="		/*!< Command line option of child process. */
+#define CZ_COLD_OUTPUT_PREFIX	"cold-start "		/*!< Prefix of result line of child process. */
+#define CZ_COLD_TIMEOUT_MS	60000			/*!< Max run time of child process in ms. */
+#define CZ_COLD_KERNELS		256			/*!< Number of kernels in module. */
+#define CZ_COLD_PTX_LEN		(CZ_COLD_KERNELS * 320 + 256)	/*!< Size of PTX text buffer. */
+
+/*	CUDA driver API types and constants used here. They are copied from
+	cuda.h so the file is built without CUDA SDK.
+*/
+typedef int CUresult;
+typedef int CUdevice;
+typedef struct CUctx_st *CUcontext;
+typedef struct CUmod_st *CUmodule;
+typedef struct CUfunc_st *CUfunction;
+typedef struct CUstream_st *CUstream;
+typedef struct CUlinkState_st *CUlinkState;
+typedef int CUjit_option;
+typedef int CUjitInputType;
+
+#define CUDA_SUCCESS				0
+#define CU_JIT_INPUT_PTX			1
+
+#if defined(Q_OS_WIN)
+#define CZ_CU_API	__stdcall
+#else
+#define CZ_CU_API
+#endif
+
+/*!	\brief List of CUDA driver functions used here.
+	Each item gives return type, name and arguments of function.
+*/
+#define CZ_CU_FUNC_LIST \
+	CZ_CU_FUNC(CUresult, cuInit, (unsigned int flags)) \
+	CZ_CU_FUNC(CUresult, cuDeviceGet, (CUdevice *device, int ordinal)) \
+	CZ_CU_FUNC(CUresult, cuDevicePrimaryCtxRetain, (CUcontext *ctx, CUdevice dev)) \
+	CZ_CU_FUNC(CUresult, cuCtxPushCurrent_v2, (CUcontext ctx)) \
+	CZ_CU_FUNC(CUresult, cuCtxSynchronize, (void)) \
+	CZ_CU_FUNC(CUresult, cuLinkCreate_v2, (unsigned int numOptions, CUjit_option *options, void **optionValues, CUlinkState *stateOut)) \
+	CZ_CU_FUNC(CUresult, cuLinkAddData_v2, (CUlinkState state, CUjitInputType type, void *data, size_t size, const char *name, \
+		unsigned int numOptions, CUjit_option *options, void **optionValues)) \
+	CZ_CU_FUNC(CUresult, cuLinkComplete, (CUlinkState state, void **cubinOut, size_t *sizeOut)) \
+	CZ_CU_FUNC(CUresult, cuLinkDestroy, (CUlinkState state)) \
+	CZ_CU_FUNC(CUresult, cuModuleLoadDataEx, (CUmodule *module, const void *image, unsigned int numOptions, int *options, void **optionValues)) \
+	CZ_CU_FUNC(CUresult, cuModuleGetFunction, (CUfunction *func, CUmodule module, const char *name)) \
+	CZ_CU_FUNC(CUresult, cuLaunchKernel, (CUfunction func, unsigned int gridX, unsigned int gridY, unsigned int gridZ, \
+		unsigned int blockX, unsigned int blockY, unsigned int blockZ, unsigned int shared, CUstream stream, \
+		void **params, void **extra))
+
+/*	Prototypes of CUDA driver functions \a <name>_t and pointers to
+	them \a p_<name>. Pointers are initializaed by CZColdLoadDriver().
+*/
+#define CZ_CU_FUNC(ret, name, args) \
+	typedef ret (CZ_CU_API *name##_t) args; \
+	static name##_t p_##name = NULL;
+CZ_CU_FUNC_LIST
+#undef CZ_CU_FUNC
+
+/*!	\brief Error handling of CUDA driver calls.
+*/
+#define CZ_CU_CALL(funcCall, errProc) \
+	{ \
+		CUresult errCode; \
+		if((errCode = (funcCall)) != CUDA_SUCCESS) { \
+			CZLog(CZLogLevelError, "CUDA Driver Error: %d in %s", errCode, #funcCall); \
+			errProc; \
+		} \
+	}
+
+/*!	\brief Make PTX of module loaded by child process.
+	Module has #CZ_COLD_KERNELS different kernels, so eager loading
+	of all of them takes visibly longer than lazy loading of one.
+	Kernel \a CZColdKernel0 is launched.
+*/
+static void CZColdMakePtx(
+	char *ptx,			/*!<[out] PTX text. */
+	int size			/*!<[in] Size of \a ptx. */
+) {
+	int len = snprintf(ptx, size,
+		".version 4.0\n"
+		".target sm_50\n"
+		".address_size 64\n");
+
+	for(int i = 0; (i < CZ_COLD_KERNELS) && (len < size); i++) {
+		len += snprintf(ptx + len, size - len,
+			"\n.visible .entry CZColdKernel%d(.param .u64 out)\n"
+			"{\n"
+			"\t.reg .pred %%p<2>;\n"
+			"\t.reg .b32 %%r<2>;\n"
+			"\t.reg .b64 %%rd<3>;\n"
+			"\tld.param.u64 %%rd1, [out];\n"
+			"\tsetp.eq.u64 %%p1, %%rd1, 0;\n"
+			"\t@%%p1 bra DONE;\n"
+			"\tcvta.to.global.u64 %%rd2, %%rd1;\n"
+			"\tmov.u32 %%r1, %d;\n"
+			"\tst.global.u32 [%%rd2], %%r1;\n"
+			"DONE:\n"
+			"\tret;\n"
+			"}\n", i, i);
+	}
+}
+
+/*!	\brief Load CUDA driver library and find all functions of
+	\a CZ_CU_FUNC_LIST.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZColdLoadDriver(void) {
+
+#if defined(Q_OS_WIN)
+	HMODULE hDll = LoadLibraryA(CZ_COLD_DLL_FNAME);
+#define CZ_CU_SYMBOL(name) GetProcAddress(hDll, name)
+#else
+	void *hDll = dlopen(CZ_COLD_DLL_FNAME, RTLD_NOW);
+#define CZ_CU_SYMBOL(name) dlsym(hDll, name)
+#endif
+
+	if(hDll == NULL) {
+		CZLog(CZLogLevelError, "Can't load CUDA driver.");
+		return -1;
+	}
+
+#define CZ_CU_FUNC(ret, name, args) \
+	p_##name = (name##_t)CZ_CU_SYMBOL(#name); \
+	if(p_##name == NULL) { \
+		CZLog(CZLogLevelError, "Can't find function %s in CUDA driver.", #name); \
+		return -1; \
+	}
+CZ_CU_FUNC_LIST
+#undef CZ_CU_FUNC
+#undef CZ_CU_SYMBOL
+
+	return 0;
+}
+
+/*!	\brief Get time elapsed since previous call and restart timer.
+	\return elapsed time in ms.
+*/
+static double CZColdLap(
+	QElapsedTimer &timer		/*!<[in,out] Timer. */
+) {
+	double ms = (double)timer.nsecsElapsed() / 1000000.0;
+	timer.restart();
+	return ms;
+}
+
+/*!	\brief Run one cold start in child process.
+	This function is called by \a main() of child process before any
+	CUDA call. Stage latencies are printed to standard output.
+	\return exit code of child process, \a 0 in case of success, \a 1
+	in case of error.
+*/
+int CZColdChild(
+	int num				/*!<[in] Device index. */
+) {
+	static char ptx[CZ_COLD_PTX_LEN];
+	double ms[CZColdStageNum];
+	QElapsedTimer timer;
+	CUdevice dev;
+	CUcontext ctx;
+	CUlinkState link;
+	void *cubin;
+	size_t cubinSize;
+	CUmodule module;
+	CUfunction func;
+	unsigned long long out = 0;
+	void *params[] = {&out};
+
+	CZColdMakePtx(ptx, sizeof(ptx));
+
+	memset(ms, 0, sizeof(ms));
+	timer.start();
+
+	if(CZColdLoadDriver() != 0)
+		return 1;
+	ms[CZColdLibrary] = CZColdLap(timer);
+
+	CZ_CU_CALL(p_cuInit(0),
+		return 1);
+	ms[CZColdInit] = CZColdLap(timer);
+
+	CZ_CU_CALL(p_cuDeviceGet(&dev, num),
+		return 1);
+	CZ_CU_CALL(p_cuDevicePrimaryCtxRetain(&ctx, dev),
+		return 1);
+	CZ_CU_CALL(p_cuCtxPushCurrent_v2(ctx),
+		return 1);
+	ms[CZColdContext] = CZColdLap(timer);
+
+	CZ_CU_CALL(p_cuLinkCreate_v2(0, NULL, NULL, &link),
+		return 1);
+	CZ_CU_CALL(p_cuLinkAddData_v2(link, CU_JIT_INPUT_PTX, ptx, strlen(ptx) + 1, "cold.ptx", 0, NULL, NULL),
+		return 1);
+	CZ_CU_CALL(p_cuLinkComplete(link, &cubin, &cubinSize),
+		return 1);
+	ms[CZColdJit] = CZColdLap(timer);
+
+	CZ_CU_CALL(p_cuModuleLoadDataEx(&module, cubin, 0, NULL, NULL),
+		return 1);
+	ms[CZColdModule] = CZColdLap(timer);
+
+	p_cuLinkDestroy(link);
+	timer.restart();
+
+	CZ_CU_CALL(p_cuModuleGetFunction(&func, module, "CZColdKernel0"),
+		return 1);
+	ms[CZColdFunction] = CZColdLap(timer);
+
+	CZ_CU_CALL(p_cuLaunchKernel(func, 1, 1, 1, 1, 1, 1, 0, NULL, params, NULL),
+		return 1);
+	CZ_CU_CALL(p_cuCtxSynchronize(),
+		return 1);
+	ms[CZColdLaunch] = CZColdLap(timer);
+
+	printf(CZ_COLD_OUTPUT_PREFIX "library_ms=%f init_ms=%f context_ms=%f jit_ms=%f module_ms=%f function_ms=%f launch_ms=%f\n",
+		ms[CZColdLibrary], ms[CZColdInit], ms[CZColdContext], ms[CZColdJit],
+		ms[CZColdModule], ms[CZColdFunction], ms[CZColdLaunch]);
+	fflush(stdout);
+
+	/* Process exit tears the context down like in a short-lived job. */
+	return 0;
+}
+
+/*!	\brief Get name of cold-start stage.
+	\return name of stage.
+*/
+const char *CZColdStageName(
+	int stage			/*!<[in] Stage. See enum #CZColdStage. */
+) {
+	switch(stage) {
+	case CZColdLibrary:	return "library";
+	case CZColdInit:	return "init";
+	case CZColdContext:	return "context";
+	case CZColdJit:		return "jit";
+	case CZColdModule:	return "module";
+	case CZColdFunction:	return "function";
+	case CZColdLaunch:	return "launch";
+	case CZColdProcess:	return "process";
+	default:		return "unknown";
+	}
+}
+
+/*!	\brief Get name of module loading mode.
+	\return name of mode.
+*/
+const char *CZColdLoadingName(
+	int mode			/*!<[in] Mode. See enum #CZColdLoading. */
+) {
+	switch(mode) {
+	case CZColdLoadingDefault:	return "default";
+	case CZColdLoadingEager:	return "eager";
+	case CZColdLoadingLazy:		return "lazy";
+	default:			return "unknown";
+	}
+}
+
+/*!	\brief Run one cold start in child process and read its result.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZColdRun(
+	struct CZDeviceInfo *info,	/*!<[in] CUDA-device information. */
+	int mode,			/*!<[in] Module loading mode. See enum #CZColdLoading. */
+	double ms[CZColdStageNum]	/*!<[out] Latency of each stage in ms. */
+) {
+	QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+	QProcess process;
+	QElapsedTimer timer;
+
+	/* JIT cache would turn JIT stage into cache lookup after the
+	   first run. */
+	env.insert("CUDA_CACHE_DISABLE", "1");
+	if(mode == CZColdLoadingEager)
+		env.insert("CUDA_MODULE_LOADING", "EAGER");
+	else if(mode == CZColdLoadingLazy)
+		env.insert("CUDA_MODULE_LOADING", "LAZY");
+
+	process.setProcessEnvironment(env);
+	process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+
+	timer.start();
+	process.start(QCoreApplication::applicationFilePath(),
+		QStringList() << QString(CZ_COLD_CHILD_OPTION "%1").arg(info->num));
+
+	if(!process.waitForFinished(CZ_COLD_TIMEOUT_MS)) {
+		CZLog(CZLogLevelError, "Cold-start process on %s failed: %s.",
+			info->deviceName, process.errorString().toLocal8Bit().constData());
+		process.kill();
+		process.waitForFinished();
+		return -1;
+	}
+	ms[CZColdProcess] = (double)timer.nsecsElapsed() / 1000000.0;
+
+	if((process.exitStatus() != QProcess::NormalExit) || (process.exitCode() != 0)) {
+		CZLog(CZLogLevelError, "Cold-start process on %s exited with code %d.",
+			info->deviceName, process.exitCode());
+		return -1;
+	}
+
+	QByteArray out = process.readAllStandardOutput();
+	int pos = out.indexOf(CZ_COLD_OUTPUT_PREFIX);
+	if((pos < 0) || (sscanf(out.constData() + pos,
+		CZ_COLD_OUTPUT_PREFIX "library_ms=%lf init_ms=%lf context_ms=%lf jit_ms=%lf module_ms=%lf function_ms=%lf launch_ms=%lf",
+		&ms[CZColdLibrary], &ms[CZColdInit], &ms[CZColdContext], &ms[CZColdJit],
+		&ms[CZColdModule], &ms[CZColdFunction], &ms[CZColdLaunch]) != 7)) {
+		CZLog(CZLogLevelError, "Cold-start process on %s printed no result.", info->deviceName);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*!	\brief Compare two latencies for \a qsort().
+	\return negative, zero or positive value like \a strcmp().
+*/
+static int CZColdCompare(
+	const void *a,			/*!<[in] The first latency. */
+	const void *b			/*!<[in] The second latency. */
+) {
+	double x = *(const double*)a;
+	double y = *(const double*)b;
+
+	return (x < y)? -1: (x > y)? 1: 0;
+}
+
+/*!	\brief Summarize latencies of one stage.
+*/
+static void CZColdStat(
+	struct CZDeviceInfoColdStat *stat,	/*!<[out] Latency distribution. */
+	double *samples,		/*!<[in,out] Latencies. They are sorted. */
+	int num				/*!<[in] Number of latencies. */
+) {
+	double sum = 0;
+
+	qsort(samples, num, sizeof(samples[0]), CZColdCompare);
+
+	for(int i = 0; i < num; i++)
+		sum += samples[i];
+
+	stat->samples = num;
+	stat->minMs = (float)samples[0];
+	stat->medianMs = (float)samples[num / 2];
+	stat->p90Ms = (float)samples[(num * 9) / 10];
+	stat->maxMs = (float)samples[num - 1];
+	stat->meanMs = (float)(sum / num);
+}
+
+/*!	\brief Measure CUDA cold-start latency of device.
+	\a info->config.coldRuns cold starts are run for each module loading
+	mode. Time limit is not applied because number of runs is given
+	explicitly, abort flag stops the test. Test runs only if
+	\a CZTestColdStart is selected in \a info->testMask.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZColdCalcDevice(
+	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
+) {
+	int runs = info->config.coldRuns;
+
+	memset(&info->cold, 0, sizeof(info->cold));
+	info->partialMask &= ~CZTestColdStart;
+
+	if(((info->testMask & CZTestColdStart) == 0) || (info->deviceType != CZDeviceTypeCuda))
+		return 0;
+
+	if(runs < 1)
+		runs = 1;
+
+	double *samples = (double*)malloc(sizeof(double) * CZColdStageNum * runs);
+	if(samples == NULL)
+		return -1;
+
+	CZLog(CZLogLevelLow, "Starting cold-start test on %s.", info->deviceName);
+
+	double testUs = CZTraceTimeUs();
+	int res = 0;
+
+	for(int mode = 0; (mode < CZColdLoadingNum) && (res == 0); mode++) {
+		double modeUs = CZTraceTimeUs();
+		int num;
+
+		for(num = 0; num < runs; num++) {
+			double ms[CZColdStageNum];
+
+			if((info->abortFlag != NULL) && (*info->abortFlag != 0)) {
+				info->partialMask |= CZTestColdStart;
+				break;
+			}
+
+			if(CZColdRun(info, mode, ms) != 0) {
+				res = -1;
+				break;
+			}
+
+			for(int stage = 0; stage < CZColdStageNum; stage++)
+				samples[stage * runs + num] = ms[stage];
+
+			CZLogKV(CZLogLevelLow, "cold-start", "dev=%d loading=%s run=%d library_ms=%f init_ms=%f context_ms=%f jit_ms=%f module_ms=%f function_ms=%f launch_ms=%f process_ms=%f",
+				info->num, CZColdLoadingName(mode), num,
+				ms[CZColdLibrary], ms[CZColdInit], ms[CZColdContext], ms[CZColdJit], ms[CZColdModule],
+				ms[CZColdFunction], ms[CZColdLaunch], ms[CZColdProcess]);
+		}
+
+		CZTraceHostSpan("cold", CZColdLoadingName(mode), info->num, modeUs);
+
+		if(num == 0)
+			break;
+
+		for(int stage = 0; stage < CZColdStageNum; stage++) {
+			struct CZDeviceInfoColdStat *stat = &info->cold.stat[mode][stage];
+
+			CZColdStat(stat, &samples[stage * runs], num);
+
+			CZLogKV(CZLogLevelModerate, "cold-stage", "dev=%d loading=%s stage=%s samples=%d min_ms=%f median_ms=%f p90_ms=%f max_ms=%f mean_ms=%f",
+				info->num, CZColdLoadingName(mode), CZColdStageName(stage), stat->samples,
+				stat->minMs, stat->medianMs, stat->p90Ms, stat->maxMs, stat->meanMs);
+		}
+
+		if(num < runs)
+			break;
+	}
+
+	CZTraceHostSpan("cold", "test", info->num, testUs);
+
+	free(samples);
+
+	return res;
+}
@@ -0,0 +1,26 @@
+/*!	\file coldstart.h
+	\brief CUDA cold-start latency test definition.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#ifndef CZ_COLDSTART_H
+#define CZ_COLDSTART_H
+
+#include "cudainfo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int CZColdChild(int num);
+int CZColdCalcDevice(struct CZDeviceInfo *info);
+const char *CZColdStageName(int stage);
+const char *CZColdLoadingName(int mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//CZ_COLDSTART_H
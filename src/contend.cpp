@@ -0,0 +1,387 @@
+/*!	\file contend.cpp
+	\brief Multi-process contention test source file.
+	Several worker processes run copy and calculation tests on one device
+	at the same time, like co-located jobs do. Workers are fresh child
+	processes of this program started with \a --contend-child option,
+	because CUDA context can not be inherited over \a fork(). Parent and
+	workers share one block of memory with test parameters, barrier
+	counter and results. Before each test workers report they are ready
+	and wait on the system semaphore of the test, which parent releases
+	for all of them at once when all of them are ready.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <QtGlobal>
+#include <QCoreApplication>
+#include <QProcess>
+#include <QSharedMemory>
+#include <QStringList>
+#include <QSystemSemaphore>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log.h"
+#include "trace.h"
+#include "contend.h"
+#include "peakinfo.h"
+
+#define CZ_CONTEND_CHILD_OPTION	"--contend-child="	/*!< Command line option of worker process. */
+#define CZ_CONTEND_KEY_LEN	64			/*!< Length of shared memory key. */
+#define CZ_CONTEND_POLL_MS	10			/*!< Period of checking workers in ms. */
+#define CZ_CONTEND_READY_MS	60000			/*!< Max time to wait for workers to get ready in ms. */
+
+/*!	\brief State of worker process.
+*/
+enum CZContendStatus {
+	CZContendFailed = -1,			/*!< Worker failed. */
+	CZContendRunning = 0,			/*!< Worker is running. */
+	CZContendDone = 1,			/*!< Worker stored its results. */
+};
+
+/*!	\brief Memory shared by parent and worker processes.
+*/
+struct CZContendShared {
+	int		device;			/*!< Device index. */
+	int		testMask;		/*!< Tests run by workers. See enum #CZTest. */
+	struct CZTestConfig	config;		/*!< Test parameters. */
+	int		procs;			/*!< Number of workers of current round. */
+	int		ready;			/*!< Number of arrivals of workers at barriers in current round. */
+	volatile int	abort;			/*!< Abort flag of workers. */
+	struct {
+		int	status;			/*!< State of worker. See enum #CZContendStatus. */
+		float	value[CZ_CONTEND_TESTS_NUM];	/*!< Results indexed by bit number of test. */
+	}		slot[CZ_CONTEND_PROCS_MAX];	/*!< Results of workers. */
+};
+
+/*!	\brief Get system semaphore key of barrier before test.
+	\return key of semaphore.
+*/
+static QString CZContendBarrierKey(
+	const QString &key,		/*!<[in] Shared memory key. */
+	int bit				/*!<[in] Bit number of test. */
+) {
+	return QString("%1-test-%2").arg(key).arg(bit);
+}
+
+/*!	\brief Wait for other workers before test.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZContendWait(
+	QSharedMemory &shm,		/*!<[in,out] Shared memory. */
+	int bit				/*!<[in] Bit number of test. */
+) {
+	struct CZContendShared *sh = (struct CZContendShared*)shm.data();
+	QSystemSemaphore barrier(CZContendBarrierKey(shm.key(), bit), 0, QSystemSemaphore::Open);
+
+	shm.lock();
+	sh->ready++;
+	shm.unlock();
+
+	if(!barrier.acquire())
+		return -1;
+
+	return (sh->abort == 0)? 0: -1;
+}
+
+/*!	\brief Run tests in worker process.
+	Tests are run one by one. All workers start each test at once.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZContendWork(
+	QSharedMemory &shm,		/*!<[in,out] Shared memory. */
+	int slot,			/*!<[in] Index of worker. */
+	struct CZDeviceInfo *info	/*!<[out] Device information of worker. */
+) {
+	struct CZContendShared *sh = (struct CZContendShared*)shm.data();
+	int r = 0;
+
+	memset(info, 0, sizeof(*info));
+
+	if(!CZCudaCheck() || (CZCudaReadDeviceInfo(info, sh->device) != 0))
+		return -1;
+
+	info->config = sh->config;
+	info->testMask = sh->testMask;
+	info->timeLimit = info->config.timeLimit;
+	info->abortFlag = &sh->abort;
+
+	if((CZCudaCalcDeviceSelect(info) != 0) || (CZCudaPrepareDevice(info) != 0))
+		return -1;
+
+	CZLog(CZLogLevelLow, "Worker %d started on %s.", slot, info->deviceName);
+
+	for(int bit = 0; bit < CZ_CONTEND_TESTS_NUM; bit++) {
+		if((sh->testMask & (1 << bit)) == 0)
+			continue;
+
+		if(CZContendWait(shm, bit) != 0) {
+			r = -1;
+			break;
+		}
+
+		info->testMask = 1 << bit;
+		r = CZCudaCalcDeviceBandwidth(info);
+		if(r != -1)
+			r = CZCudaCalcDevicePerformance(info);
+		if(r == -1)
+			break;
+
+		shm.lock();
+		sh->slot[slot].value[bit] = CZTestValue(info, 1 << bit);
+		shm.unlock();
+	}
+
+	CZCudaCleanDevice(info);
+
+	return (r == -1)? -1: 0;
+}
+
+/*!	\brief Run worker process of contention test.
+	This function is called by \a main() of child process. \a arg is
+	\a <key>,<slot> where \a key names shared memory and \a slot is index
+	of worker.
+	\return exit code of child process, \a 0 in case of success, \a 1
+	in case of error.
+*/
+int CZContendChild(
+	const char *arg			/*!<[in] Value of command line option. */
+) {
+	char key[CZ_CONTEND_KEY_LEN];
+	struct CZDeviceInfo info;
+	const char *comma = strrchr(arg, ',');
+	int slot;
+	int r;
+
+	if((comma == NULL) || ((size_t)(comma - arg) >= sizeof(key)))
+		return 1;
+	memcpy(key, arg, comma - arg);
+	key[comma - arg] = 0;
+	slot = atoi(comma + 1);
+	if((slot < 0) || (slot >= CZ_CONTEND_PROCS_MAX))
+		return 1;
+
+	QSharedMemory shm(QString::fromLatin1(key));
+	if(!shm.attach()) {
+		CZLog(CZLogLevelError, "Can't attach shared memory %s: %s.",
+			key, shm.errorString().toLocal8Bit().constData());
+		return 1;
+	}
+	r = CZContendWork(shm, slot, &info);
+
+	struct CZContendShared *sh = (struct CZContendShared*)shm.data();
+	shm.lock();
+	sh->slot[slot].status = (r == 0)? CZContendDone: CZContendFailed;
+	shm.unlock();
+	shm.detach();
+
+	return (r == 0)? 0: 1;
+}
+
+/*!	\brief Wait for all workers at barrier.
+	\return \a 0 if all workers are ready, \a -1 in case of error.
+*/
+static int CZContendWaitReady(
+	struct CZDeviceInfo *info,	/*!<[in,out] CUDA-device information. */
+	QSharedMemory &shm,		/*!<[in,out] Shared memory. */
+	QProcess *process,		/*!<[in,out] Worker processes. */
+	int ready,			/*!<[in] Number of arrivals when all workers are ready. */
+	int timeout			/*!<[in] Max time to wait in ms, \a 0 to wait for ever. */
+) {
+	struct CZContendShared *sh = (struct CZContendShared*)shm.data();
+
+	for(int waitMs = 0;; waitMs += CZ_CONTEND_POLL_MS) {
+		shm.lock();
+		int passed = sh->ready;
+		shm.unlock();
+		if(passed == ready)
+			return 0;
+
+		if(((info->abortFlag != NULL) && (*info->abortFlag != 0)) ||
+			((timeout != 0) && (waitMs >= timeout)))
+			return -1;
+
+		for(int i = 0; i < sh->procs; i++) {
+			if(process[i].state() == QProcess::NotRunning) {
+				CZLog(CZLogLevelError, "Contention worker %d on %s exited before test.", i, info->deviceName);
+				return -1;
+			}
+		}
+
+		process[0].waitForFinished(CZ_CONTEND_POLL_MS);
+	}
+}
+
+/*!	\brief Run one round of contention test with \a procs workers.
+	Results of workers are left in shared memory.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZContendRound(
+	struct CZDeviceInfo *info,	/*!<[in,out] CUDA-device information. */
+	QSharedMemory &shm,		/*!<[in,out] Shared memory. */
+	int procs			/*!<[in] Number of workers. */
+) {
+	struct CZContendShared *sh = (struct CZContendShared*)shm.data();
+	QProcess process[CZ_CONTEND_PROCS_MAX];
+	QSystemSemaphore *barrier[CZ_CONTEND_TESTS_NUM];
+	int tests = 0;
+	int res = 0;
+	int bit;
+	int i;
+
+	shm.lock();
+	sh->procs = procs;
+	sh->ready = 0;
+	sh->abort = 0;
+	memset(sh->slot, 0, sizeof(sh->slot));
+	shm.unlock();
+
+	/* Semaphores are created for each round, so permits left by an
+	   aborted round don't let workers pass. */
+	for(bit = 0; bit < CZ_CONTEND_TESTS_NUM; bit++) {
+		barrier[bit] = NULL;
+		if(sh->testMask & (1 << bit))
+			barrier[bit] = new QSystemSemaphore(CZContendBarrierKey(shm.key(), bit), 0, QSystemSemaphore::Create);
+	}
+
+	for(i = 0; i < procs; i++) {
+		process[i].setProcessChannelMode(QProcess::ForwardedChannels);
+		process[i].start(QCoreApplication::applicationFilePath(),
+			QStringList() << QString(CZ_CONTEND_CHILD_OPTION "%1,%2").arg(shm.key()).arg(i));
+	}
+
+	CZLog(CZLogLevelLow, "Starting %d contention workers on %s.", procs, info->deviceName);
+
+	/* Start each test when all workers are ready for it. Workers are
+	   released from all barriers left if round is aborted. */
+	for(bit = 0; bit < CZ_CONTEND_TESTS_NUM; bit++) {
+		if(barrier[bit] == NULL)
+			continue;
+
+		if(res == 0) {
+			tests++;
+			res = CZContendWaitReady(info, shm, process, procs * tests, (tests == 1)? CZ_CONTEND_READY_MS: 0);
+			if(res != 0)
+				sh->abort = 1;
+		}
+
+		barrier[bit]->release(procs);
+	}
+
+	for(i = 0; i < procs; i++) {
+		while(!process[i].waitForFinished(CZ_CONTEND_POLL_MS)) {
+			if((info->abortFlag != NULL) && (*info->abortFlag != 0) && (sh->abort == 0)) {
+				sh->abort = 1;
+				info->partialMask |= CZTestContend;
+			}
+		}
+		if(sh->slot[i].status != CZContendDone) {
+			CZLog(CZLogLevelError, "Contention worker %d on %s failed.", i, info->deviceName);
+			res = -1;
+		}
+	}
+
+	for(bit = 0; bit < CZ_CONTEND_TESTS_NUM; bit++)
+		delete barrier[bit];
+
+	return res;
+}
+
+/*!	\brief Run selected tests in several processes at once.
+	Tests of #CZTestAll selected together with #CZTestContend are run, all
+	of them if none is selected. One worker runs them alone first to get
+	solo results, then \a info->config.contendProcs workers run them
+	together. Workers run tests one by one and start each of them at
+	once, so every test is measured against copies of itself.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZContendCalcDevice(
+	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
+) {
+	int procs = info->config.contendProcs;
+	struct CZContendShared *sh;
+	int bit;
+	int i;
+
+	memset(&info->contend, 0, sizeof(info->contend));
+	info->partialMask &= ~CZTestContend;
+
+	if(((info->testMask & CZTestContend) == 0) || (info->deviceType != CZDeviceTypeCuda))
+		return 0;
+
+	if(procs < 2)
+		procs = 2;
+	if(procs > CZ_CONTEND_PROCS_MAX)
+		procs = CZ_CONTEND_PROCS_MAX;
+
+	QString key = QString("cuda-z-contend-%1-%2").arg(QCoreApplication::applicationPid()).arg(info->num);
+	QSharedMemory shm(key);
+	if(!shm.create(sizeof(struct CZContendShared))) {
+		CZLog(CZLogLevelError, "Can't create shared memory %s: %s.",
+			key.toLocal8Bit().constData(), shm.errorString().toLocal8Bit().constData());
+		return -1;
+	}
+
+	sh = (struct CZContendShared*)shm.data();
+	memset(sh, 0, sizeof(*sh));
+	sh->device = info->num;
+	sh->testMask = info->testMask & CZTestAll;
+	if(sh->testMask == 0)
+		sh->testMask = CZTestAll;
+	sh->config = info->config;
+
+	CZLog(CZLogLevelLow, "Starting contention test on %s.", info->deviceName);
+
+	double testUs = CZTraceTimeUs();
+
+	if(CZContendRound(info, shm, 1) != 0)
+		return -1;
+	for(bit = 0; bit < CZ_CONTEND_TESTS_NUM; bit++)
+		info->contend.test[bit].solo = sh->slot[0].value[bit];
+
+	CZTraceHostSpan("contend", "solo", info->num, testUs);
+
+	double roundUs = CZTraceTimeUs();
+
+	if(CZContendRound(info, shm, procs) != 0)
+		return -1;
+
+	CZTraceHostSpan("contend", "together", info->num, roundUs);
+
+	info->contend.procs = procs;
+
+	for(bit = 0; bit < CZ_CONTEND_TESTS_NUM; bit++) {
+		struct CZDeviceInfoContendTest *test = &info->contend.test[bit];
+		double sum = 0;
+		double sumSq = 0;
+		float worst = 0;
+
+		if((sh->testMask & (1 << bit)) == 0)
+			continue;
+
+		for(i = 0; i < procs; i++) {
+			float value = sh->slot[i].value[bit];
+			test->value[i] = value;
+			sum += value;
+			sumSq += (double)value * value;
+			if((i == 0) || (value < worst))
+				worst = value;
+		}
+
+		test->aggregate = (float)sum;
+		if(sumSq > 0)
+			test->fairness = (float)((sum * sum) / (procs * sumSq));
+		if(worst > 0)
+			test->slowdown = test->solo / worst;
+
+		CZLogKV(CZLogLevelModerate, "contend", "dev=%d test=0x%x procs=%d solo=%f aggregate=%f fairness=%f slowdown=%f",
+			info->num, 1 << bit, procs, test->solo, test->aggregate, test->fairness, test->slowdown);
+	}
+
+	CZTraceHostSpan("contend", "test", info->num, testUs);
+
+	return 0;
+}
@@ -0,0 +1,24 @@
+/*!	\file contend.h
+	\brief Multi-process contention test definition.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#ifndef CZ_CONTEND_H
+#define CZ_CONTEND_H
+
+#include "cudainfo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int CZContendChild(const char *arg);
+int CZContendCalcDevice(struct CZDeviceInfo *info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//CZ_CONTEND_H
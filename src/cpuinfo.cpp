@@ -0,0 +1,1548 @@
+/*!	\file cpuinfo.cpp
+	\brief Host CPU device information and test source file.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <QThread>
+#include <QSemaphore>
+#include <QVector>
+#include <QElapsedTimer>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(Q_OS_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#elif defined(Q_OS_MAC)
+#include <sys/types.h>
+#include <sys/sysctl.h>
+#include <sys/mman.h>
+#include <mach/mach.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CZ_CPU_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#if !defined(_MSC_VER) || (_MSC_VER >= 1910)
+#define CZ_CPU_AVX512
+#endif
+#endif//x86
+
+#include "log.h"
+#include "trace.h"
+#include "cpuinfo.h"
+
+#define CZ_CPU_CALC_VECTORS	4	/*!< Number of vector pairs processed by one thread together. */
+#define CZ_CPU_CALC_BUF_SIZE	(2 * CZ_CPU_CALC_VECTORS * 64)	/*!< Size of result buffer of one thread. */
+#define CZ_CPU_CALC_PROBE_LOOPS	16	/*!< Number of loops of calibration run. */
+#define CZ_CPU_CALC_ROUND_MS	100	/*!< Duration of one test loop if time limit is not set (ms). */
+
+#define CZ_CPU_COPY_BUF_SIZE	(64 * (1 << 20))	/*!< Transfer buffer size. It is larger than CPU caches. */
+
+#define CZ_CPU_NODES_MAX	64	/*!< Max number of NUMA nodes to look for. */
+#define CZ_CPU_CACHES_MAX	8	/*!< Max number of cache descriptions per CPU. */
+#define CZ_CPU_LINE_LEN		1024	/*!< Length of line read from system files. */
+
+/*!	\def CZ_CPU_TARGET(isa)
+	\brief Allow the compiler to use instruction set \a isa in one function.
+	MSVC does not need this, it allows intrinsics of any instruction set.
+*/
+#if defined(_MSC_VER)
+#define CZ_CPU_TARGET(isa)
+#else
+#define CZ_CPU_TARGET(isa)	__attribute__((target(isa)))
+#endif
+
+#define CZ_CPU_TARGET_SCALAR			/*!< No special instruction set. */
+#define CZ_CPU_TARGET_SSE	CZ_CPU_TARGET("sse4.1")	/*!< SSE4.1 instruction set. */
+#define CZ_CPU_TARGET_AVX2	CZ_CPU_TARGET("avx2,fma")	/*!< AVX2 and FMA3 instruction sets. */
+#define CZ_CPU_TARGET_AVX512	CZ_CPU_TARGET("avx512f,avx512dq")	/*!< AVX-512 instruction set. */
+
+/*!	\brief Calculation function.
+	\return number of operations done.
+*/
+typedef double (*CZCpuCalcFunc)(
+	int loops,			/*!<[in] Number of calculation loops. */
+	int seed,			/*!<[in] Initial value of calculation chains. */
+	void *buf			/*!<[out] Buffer for results of #CZ_CPU_CALC_BUF_SIZE bytes. */
+);
+
+/*!	\brief Define calculation function of one data type and SIMD level.
+	Every vector lane runs the same two MAD chains as one GPU thread
+	does in CZCudaCalcKernel*() functions. #CZ_CPU_CALC_VECTORS pairs
+	of vectors are processed together to hide instruction latency.
+	Results are stored to \a buf to keep the chains alive.
+*/
+#define CZ_CPU_CALC_FUNC(name, target, vtype, lanes, set1, mad, store) \
+static target double name(int loops, int seed, void *buf) { \
+	vtype a0 = set1(seed + 1), a1 = set1(seed + 2), a2 = set1(seed + 3), a3 = set1(seed + 4); \
+	vtype b0 = set1(seed + 5), b1 = set1(seed + 6), b2 = set1(seed + 7), b3 = set1(seed + 8); \
+	int i, j; \
+	for(i = 0; i < loops; i++) { \
+		for(j = 0; j < (CZ_CALC_BLOCK_SIZE * CZ_CALC_BLOCK_NUM / 2); j++) { \
+			a0 = mad(a0); b0 = mad(b0); a1 = mad(a1); b1 = mad(b1); \
+			a2 = mad(a2); b2 = mad(b2); a3 = mad(a3); b3 = mad(b3); \
+		} \
+	} \
+	store(buf, 0, a0); store(buf, 1, a1); store(buf, 2, a2); store(buf, 3, a3); \
+	store(buf, 4, b0); store(buf, 5, b1); store(buf, 6, b2); store(buf, 7, b3); \
+	return (double)loops * CZ_CPU_CALC_VECTORS * (lanes) * \
+		CZ_CALC_BLOCK_SIZE * CZ_CALC_BLOCK_NUM * CZ_CALC_OPS_NUM; \
+}
+
+/*	Plain C code. Unsigned integers are used to keep overflows defined. */
+#define CZ_CPU_MAD(a)			((a) * (a) + (a))
+#define CZ_CPU_SET1_F32(v)		((float)(v))
+#define CZ_CPU_SET1_F64(v)		((double)(v))
+#define CZ_CPU_SET1_U32(v)		((unsigned int)(v))
+#define CZ_CPU_SET1_U64(v)		((unsigned long long)(v))
+#define CZ_CPU_STORE_F32(buf, n, v)	(((float*)(buf))[n] = (v))
+#define CZ_CPU_STORE_F64(buf, n, v)	(((double*)(buf))[n] = (v))
+#define CZ_CPU_STORE_U32(buf, n, v)	(((unsigned int*)(buf))[n] = (v))
+#define CZ_CPU_STORE_U64(buf, n, v)	(((unsigned long long*)(buf))[n] = (v))
+
+CZ_CPU_CALC_FUNC(CZCpuCalcFloatScalar, CZ_CPU_TARGET_SCALAR, float, 1, CZ_CPU_SET1_F32, CZ_CPU_MAD, CZ_CPU_STORE_F32)
+CZ_CPU_CALC_FUNC(CZCpuCalcDoubleScalar, CZ_CPU_TARGET_SCALAR, double, 1, CZ_CPU_SET1_F64, CZ_CPU_MAD, CZ_CPU_STORE_F64)
+CZ_CPU_CALC_FUNC(CZCpuCalcInteger32Scalar, CZ_CPU_TARGET_SCALAR, unsigned int, 1, CZ_CPU_SET1_U32, CZ_CPU_MAD, CZ_CPU_STORE_U32)
+CZ_CPU_CALC_FUNC(CZCpuCalcInteger64Scalar, CZ_CPU_TARGET_SCALAR, unsigned long long, 1, CZ_CPU_SET1_U64, CZ_CPU_MAD, CZ_CPU_STORE_U64)
+
+#ifdef CZ_CPU_X86
+/*	SSE4.1 code. There is no FMA in SSE, so MAD is multiplication and addition. */
+#define CZ_CPU_MAD_PS128(a)		_mm_add_ps(_mm_mul_ps(a, a), a)
+#define CZ_CPU_MAD_PD128(a)		_mm_add_pd(_mm_mul_pd(a, a), a)
+#define CZ_CPU_MAD_EPI32_128(a)		_mm_add_epi32(_mm_mullo_epi32(a, a), a)
+#define CZ_CPU_SET1_PS128(v)		_mm_set1_ps((float)(v))
+#define CZ_CPU_SET1_PD128(v)		_mm_set1_pd((double)(v))
+#define CZ_CPU_SET1_EPI32_128(v)	_mm_set1_epi32(v)
+#define CZ_CPU_STORE_PS128(buf, n, v)	_mm_storeu_ps((float*)(buf) + (n) * 4, v)
+#define CZ_CPU_STORE_PD128(buf, n, v)	_mm_storeu_pd((double*)(buf) + (n) * 2, v)
+#define CZ_CPU_STORE_SI128(buf, n, v)	_mm_storeu_si128((__m128i*)(buf) + (n), v)
+
+CZ_CPU_CALC_FUNC(CZCpuCalcFloatSSE, CZ_CPU_TARGET_SSE, __m128, 4, CZ_CPU_SET1_PS128, CZ_CPU_MAD_PS128, CZ_CPU_STORE_PS128)
+CZ_CPU_CALC_FUNC(CZCpuCalcDoubleSSE, CZ_CPU_TARGET_SSE, __m128d, 2, CZ_CPU_SET1_PD128, CZ_CPU_MAD_PD128, CZ_CPU_STORE_PD128)
+CZ_CPU_CALC_FUNC(CZCpuCalcInteger32SSE, CZ_CPU_TARGET_SSE, __m128i, 4, CZ_CPU_SET1_EPI32_128, CZ_CPU_MAD_EPI32_128, CZ_CPU_STORE_SI128)
+
+/*	AVX2 and FMA3 code. There is no 64-bit integer multiplication in AVX2. */
+#define CZ_CPU_MAD_PS256(a)		_mm256_fmadd_ps(a, a, a)
+#define CZ_CPU_MAD_PD256(a)		_mm256_fmadd_pd(a, a, a)
+#define CZ_CPU_MAD_EPI32_256(a)		_mm256_add_epi32(_mm256_mullo_epi32(a, a), a)
+#define CZ_CPU_SET1_PS256(v)		_mm256_set1_ps((float)(v))
+#define CZ_CPU_SET1_PD256(v)		_mm256_set1_pd((double)(v))
+#define CZ_CPU_SET1_EPI32_256(v)	_mm256_set1_epi32(v)
+#define CZ_CPU_STORE_PS256(buf, n, v)	_mm256_storeu_ps((float*)(buf) + (n) * 8, v)
+#define CZ_CPU_STORE_PD256(buf, n, v)	_mm256_storeu_pd((double*)(buf) + (n) * 4, v)
+#define CZ_CPU_STORE_SI256(buf, n, v)	_mm256_storeu_si256((__m256i*)(buf) + (n), v)
+
+CZ_CPU_CALC_FUNC(CZCpuCalcFloatAVX2, CZ_CPU_TARGET_AVX2, __m256, 8, CZ_CPU_SET1_PS256, CZ_CPU_MAD_PS256, CZ_CPU_STORE_PS256)
+CZ_CPU_CALC_FUNC(CZCpuCalcDoubleAVX2, CZ_CPU_TARGET_AVX2, __m256d, 4, CZ_CPU_SET1_PD256, CZ_CPU_MAD_PD256, CZ_CPU_STORE_PD256)
+CZ_CPU_CALC_FUNC(CZCpuCalcInteger32AVX2, CZ_CPU_TARGET_AVX2, __m256i, 8, CZ_CPU_SET1_EPI32_256, CZ_CPU_MAD_EPI32_256, CZ_CPU_STORE_SI256)
+
+#ifdef CZ_CPU_AVX512
+/*	AVX-512 code. 64-bit integer multiplication requires AVX-512DQ. */
+#define CZ_CPU_MAD_PS512(a)		_mm512_fmadd_ps(a, a, a)
+#define CZ_CPU_MAD_PD512(a)		_mm512_fmadd_pd(a, a, a)
+#define CZ_CPU_MAD_EPI32_512(a)		_mm512_add_epi32(_mm512_mullo_epi32(a, a), a)
+#define CZ_CPU_MAD_EPI64_512(a)		_mm512_add_epi64(_mm512_mullo_epi64(a, a), a)
+#define CZ_CPU_SET1_PS512(v)		_mm512_set1_ps((float)(v))
+#define CZ_CPU_SET1_PD512(v)		_mm512_set1_pd((double)(v))
+#define CZ_CPU_SET1_EPI32_512(v)	_mm512_set1_epi32(v)
+#define CZ_CPU_SET1_EPI64_512(v)	_mm512_set1_epi64((long long)(v))
+#define CZ_CPU_STORE_PS512(buf, n, v)	_mm512_storeu_ps((float*)(buf) + (n) * 16, v)
+#define CZ_CPU_STORE_PD512(buf, n, v)	_mm512_storeu_pd((double*)(buf) + (n) * 8, v)
+#define CZ_CPU_STORE_SI512(buf, n, v)	_mm512_storeu_si512((void*)((__m512i*)(buf) + (n)), v)
+
+CZ_CPU_CALC_FUNC(CZCpuCalcFloatAVX512, CZ_CPU_TARGET_AVX512, __m512, 16, CZ_CPU_SET1_PS512, CZ_CPU_MAD_PS512, CZ_CPU_STORE_PS512)
+CZ_CPU_CALC_FUNC(CZCpuCalcDoubleAVX512, CZ_CPU_TARGET_AVX512, __m512d, 8, CZ_CPU_SET1_PD512, CZ_CPU_MAD_PD512, CZ_CPU_STORE_PD512)
+CZ_CPU_CALC_FUNC(CZCpuCalcInteger32AVX512, CZ_CPU_TARGET_AVX512, __m512i, 16, CZ_CPU_SET1_EPI32_512, CZ_CPU_MAD_EPI32_512, CZ_CPU_STORE_SI512)
+CZ_CPU_CALC_FUNC(CZCpuCalcInteger64AVX512, CZ_CPU_TARGET_AVX512, __m512i, 8, CZ_CPU_SET1_EPI64_512, CZ_CPU_MAD_EPI64_512, CZ_CPU_STORE_SI512)
+#endif//CZ_CPU_AVX512
+#endif//CZ_CPU_X86
+
+#ifdef CZ_CPU_X86
+/*!	\brief Run CPUID instruction.
+*/
+static void CZCpuId(
+	unsigned int leaf,		/*!<[in] CPUID leaf. */
+	unsigned int subleaf,		/*!<[in] CPUID subleaf. */
+	unsigned int regs[4]		/*!<[out] Values of EAX, EBX, ECX and EDX. */
+) {
+#if defined(_MSC_VER)
+	int r[4];
+	__cpuidex(r, (int)leaf, (int)subleaf);
+	regs[0] = r[0]; regs[1] = r[1]; regs[2] = r[2]; regs[3] = r[3];
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+/*!	\brief Read extended control register 0.
+	\return mask of register states saved by OS.
+*/
+static unsigned long long CZCpuXcr0(void) {
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	unsigned int eax, edx;
+	__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return ((unsigned long long)edx << 32) | eax;
+#endif
+}
+#endif//CZ_CPU_X86
+
+/*!	\brief Detect SIMD instruction set level supported by CPU and OS.
+	\return SIMD level. See enum #CZCpuSimd.
+*/
+int CZCpuSimdLevel(void) {
+	static int level = -1;
+
+	if(level != -1)
+		return level;
+
+	level = CZCpuSimdScalar;
+
+#ifdef CZ_CPU_X86
+	unsigned int regs[4];
+
+	CZCpuId(0, 0, regs);
+	unsigned int maxLeaf = regs[0];
+
+	if(maxLeaf < 1)
+		return level;
+
+	CZCpuId(1, 0, regs);
+	bool sse41 = (regs[2] & (1 << 19)) != 0;
+	bool osxsave = (regs[2] & (1 << 27)) != 0;
+	bool avx = (regs[2] & (1 << 28)) != 0;
+	bool fma = (regs[2] & (1 << 12)) != 0;
+
+	if(!sse41)
+		return level;
+	level = CZCpuSimdSSE;
+
+	if(!osxsave || !avx || !fma || (maxLeaf < 7))
+		return level;
+
+	unsigned long long xcr0 = CZCpuXcr0();
+	if((xcr0 & 0x06) != 0x06)
+		return level;
+
+	CZCpuId(7, 0, regs);
+	bool avx2 = (regs[1] & (1 << 5)) != 0;
+	bool avx512f = (regs[1] & (1 << 16)) != 0;
+	bool avx512dq = (regs[1] & (1 << 17)) != 0;
+
+	if(!avx2)
+		return level;
+	level = CZCpuSimdAVX2;
+
+#ifdef CZ_CPU_AVX512
+	if(avx512f && avx512dq && ((xcr0 & 0xe6) == 0xe6))
+		level = CZCpuSimdAVX512;
+#else
+	(void)avx512f;
+	(void)avx512dq;
+#endif
+#endif//CZ_CPU_X86
+
+	CZLog(CZLogLevelLow, "CPU SIMD level is %s.", CZCpuSimdName(level));
+
+	return level;
+}
+
+/*!	\brief Get name of SIMD instruction set level.
+	\return name of SIMD level.
+*/
+const char *CZCpuSimdName(
+	int level			/*!<[in] SIMD level. See enum #CZCpuSimd. */
+) {
+	switch(level) {
+	case CZCpuSimdScalar:	return "Scalar";
+	case CZCpuSimdSSE:	return "SSE4.1";
+	case CZCpuSimdAVX2:	return "AVX2";
+	case CZCpuSimdAVX512:	return "AVX-512";
+	default:		return "Unknown";
+	}
+}
+
+/*!	\brief Select calculation function of test for SIMD level.
+	If a test is not implemented for given level the best lower level
+	is used.
+	\return calculation function, \a NULL if test is unknown.
+*/
+static CZCpuCalcFunc CZCpuCalcSelect(
+	int test,			/*!<[in] Test identifier. See enum #CZTest. */
+	int level			/*!<[in] SIMD level. See enum #CZCpuSimd. */
+) {
+	switch(test) {
+	case CZTestCalcFloat:
+#ifdef CZ_CPU_X86
+#ifdef CZ_CPU_AVX512
+		if(level >= CZCpuSimdAVX512)
+			return CZCpuCalcFloatAVX512;
+#endif
+		if(level >= CZCpuSimdAVX2)
+			return CZCpuCalcFloatAVX2;
+		if(level >= CZCpuSimdSSE)
+			return CZCpuCalcFloatSSE;
+#endif
+		return CZCpuCalcFloatScalar;
+
+	case CZTestCalcDouble:
+#ifdef CZ_CPU_X86
+#ifdef CZ_CPU_AVX512
+		if(level >= CZCpuSimdAVX512)
+			return CZCpuCalcDoubleAVX512;
+#endif
+		if(level >= CZCpuSimdAVX2)
+			return CZCpuCalcDoubleAVX2;
+		if(level >= CZCpuSimdSSE)
+			return CZCpuCalcDoubleSSE;
+#endif
+		return CZCpuCalcDoubleScalar;
+
+	case CZTestCalcInteger32:
+	case CZTestCalcInteger24: // CPU has no 24-bit multiplication, use 32-bit one.
+#ifdef CZ_CPU_X86
+#ifdef CZ_CPU_AVX512
+		if(level >= CZCpuSimdAVX512)
+			return CZCpuCalcInteger32AVX512;
+#endif
+		if(level >= CZCpuSimdAVX2)
+			return CZCpuCalcInteger32AVX2;
+		if(level >= CZCpuSimdSSE)
+			return CZCpuCalcInteger32SSE;
+#endif
+		return CZCpuCalcInteger32Scalar;
+
+	case CZTestCalcInteger64:
+#if defined(CZ_CPU_X86) && defined(CZ_CPU_AVX512)
+		if(level >= CZCpuSimdAVX512)
+			return CZCpuCalcInteger64AVX512;
+#endif
+		return CZCpuCalcInteger64Scalar;
+
+	default:
+		(void)level;
+		return NULL;
+	}
+}
+
+/*!	\brief Checksum words of buffer starting from word \a start.
+	Checksum is the sum of words multiplied by odd weights
+	\a (2*index+1) modulo 2^32, so it depends on order of words too.
+	CZCudaChecksumKernel() calculates the same sum on CUDA-device.
+	\return checksum.
+*/
+static unsigned long long CZCpuChecksumScalar(
+	const unsigned int *buf,	/*!<[in] Buffer. */
+	size_t start,			/*!<[in] Index of first word. */
+	size_t words			/*!<[in] Size of buffer in words. */
+) {
+	unsigned long long sum = 0;
+	size_t i;
+
+	for(i = start; i < words; i++)
+		sum += (unsigned long long)buf[i] * (unsigned int)(2 * i + 1);
+
+	return sum;
+}
+
+#ifdef CZ_CPU_X86
+/*!	\brief Checksum of buffer with SSE4.1 code.
+	Even and odd words are multiplied in separate 64-bit lanes.
+	\return checksum.
+*/
+static CZ_CPU_TARGET_SSE unsigned long long CZCpuChecksumSSE(
+	const unsigned int *buf,	/*!<[in] Buffer. */
+	size_t words			/*!<[in] Size of buffer in words. */
+) {
+	__m128i sum = _mm_setzero_si128();
+	__m128i weight = _mm_setr_epi32(1, 3, 5, 7);
+	__m128i step = _mm_set1_epi32(8);
+	unsigned long long lanes[2];
+	size_t n = words & ~(size_t)3;
+	size_t i;
+
+	for(i = 0; i < n; i += 4) {
+		__m128i val = _mm_loadu_si128((const __m128i*)(buf + i));
+		sum = _mm_add_epi64(sum, _mm_mul_epu32(val, weight));
+		sum = _mm_add_epi64(sum, _mm_mul_epu32(_mm_srli_epi64(val, 32), _mm_srli_epi64(weight, 32)));
+		weight = _mm_add_epi32(weight, step);
+	}
+
+	_mm_storeu_si128((__m128i*)lanes, sum);
+
+	return lanes[0] + lanes[1] + CZCpuChecksumScalar(buf, n, words);
+}
+
+/*!	\brief Checksum of buffer with AVX2 code.
+	\return checksum.
+*/
+static CZ_CPU_TARGET_AVX2 unsigned long long CZCpuChecksumAVX2(
+	const unsigned int *buf,	/*!<[in] Buffer. */
+	size_t words			/*!<[in] Size of buffer in words. */
+) {
+	__m256i sum = _mm256_setzero_si256();
+	__m256i weight = _mm256_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15);
+	__m256i step = _mm256_set1_epi32(16);
+	unsigned long long lanes[4];
+	size_t n = words & ~(size_t)7;
+	size_t i;
+
+	for(i = 0; i < n; i += 8) {
+		__m256i val = _mm256_loadu_si256((const __m256i*)(buf + i));
+		sum = _mm256_add_epi64(sum, _mm256_mul_epu32(val, weight));
+		sum = _mm256_add_epi64(sum, _mm256_mul_epu32(_mm256_srli_epi64(val, 32), _mm256_srli_epi64(weight, 32)));
+		weight = _mm256_add_epi32(weight, step);
+	}
+
+	_mm256_storeu_si256((__m256i*)lanes, sum);
+
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] + CZCpuChecksumScalar(buf, n, words);
+}
+#endif//CZ_CPU_X86
+
+/*!	\brief Calculate checksum of host buffer.
+	The best SIMD code supported by CPU is used. Trailing bytes of
+	buffer which do not make a whole 32-bit word are ignored.
+	\return checksum.
+*/
+unsigned long long CZCpuChecksum(
+	const void *buf,		/*!<[in] Buffer. */
+	size_t size			/*!<[in] Size of buffer in bytes. */
+) {
+	size_t words = size / sizeof(unsigned int);
+
+#ifdef CZ_CPU_X86
+	int level = CZCpuSimdLevel();
+	if(level >= CZCpuSimdAVX2)
+		return CZCpuChecksumAVX2((const unsigned int*)buf, words);
+	if(level >= CZCpuSimdSSE)
+		return CZCpuChecksumSSE((const unsigned int*)buf, words);
+#endif
+	return CZCpuChecksumScalar((const unsigned int*)buf, 0, words);
+}
+
+/*!	\brief Fill host buffer with pseudo-random pattern.
+	Trailing bytes of buffer which do not make a whole 32-bit word are
+	not changed.
+*/
+void CZCpuFillPattern(
+	void *buf,			/*!<[out] Buffer. */
+	size_t size,			/*!<[in] Size of buffer in bytes. */
+	unsigned int seed		/*!<[in] Seed of pattern. */
+) {
+	unsigned int *word = (unsigned int*)buf;
+	unsigned int val = seed | 1;
+	size_t i;
+
+	for(i = 0; i < size / sizeof(unsigned int); i++) {
+		val ^= val << 13;
+		val ^= val >> 17;
+		val ^= val << 5;
+		word[i] = val;
+	}
+}
+
+/*!	\brief Get list of CPUs the process may run on.
+	\return list of CPU indexes.
+*/
+static const QVector<int> &CZCpuList(void) {
+	static QVector<int> list;
+
+	if(!list.isEmpty())
+		return list;
+
+#if defined(Q_OS_LINUX)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if(sched_getaffinity(0, sizeof(set), &set) == 0) {
+		for(int i = 0; i < CPU_SETSIZE; i++) {
+			if(CPU_ISSET(i, &set))
+				list.append(i);
+		}
+	}
+#elif defined(Q_OS_WIN)
+	DWORD_PTR processMask, systemMask;
+	if(GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) {
+		for(int i = 0; i < (int)(sizeof(DWORD_PTR) * 8); i++) {
+			if(processMask & ((DWORD_PTR)1 << i))
+				list.append(i);
+		}
+	}
+#endif
+
+	if(list.isEmpty()) {
+		int num = QThread::idealThreadCount();
+		if(num < 1)
+			num = 1;
+		for(int i = 0; i < num; i++)
+			list.append(i);
+	}
+
+	return list;
+}
+
+/*!	\brief Get number of CPU cores available to the process.
+	\return number of logical CPU cores.
+*/
+int CZCpuCoreCount(void) {
+	return CZCpuList().size();
+}
+
+/*!	\brief Get CPU time consumed by calling thread.
+	\return time in milliseconds spent in user and kernel mode.
+*/
+double CZCpuThreadTimeMs(void) {
+#if defined(Q_OS_LINUX)
+	struct timespec ts;
+
+	if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+		return 0;
+
+	return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+#elif defined(Q_OS_WIN)
+	FILETIME creationTime, exitTime, kernelTime, userTime;
+
+	if(!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime))
+		return 0;
+
+	return ((double)(((unsigned long long)kernelTime.dwHighDateTime << 32) | kernelTime.dwLowDateTime) +
+		(double)(((unsigned long long)userTime.dwHighDateTime << 32) | userTime.dwLowDateTime)) / 10000.0;
+#elif defined(Q_OS_MAC)
+	thread_basic_info_data_t threadInfo;
+	mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+	mach_port_t thread = mach_thread_self();
+	kern_return_t res;
+
+	res = thread_info(thread, THREAD_BASIC_INFO, (thread_info_t)&threadInfo, &count);
+	mach_port_deallocate(mach_task_self(), thread);
+
+	if(res != KERN_SUCCESS)
+		return 0;
+
+	return (double)threadInfo.user_time.seconds * 1000.0 + (double)threadInfo.user_time.microseconds / 1000.0 +
+		(double)threadInfo.system_time.seconds * 1000.0 + (double)threadInfo.system_time.microseconds / 1000.0;
+#else
+	return 0;
+#endif
+}
+
+/*!	\brief Pin calling thread to one CPU.
+	Mac OS X has no hard thread affinity, threads are not pinned there.
+*/
+static void CZCpuPinThread(
+	int cpu				/*!<[in] CPU index. */
+) {
+#if defined(Q_OS_LINUX)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	if(pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+		CZLog(CZLogLevelLow, "Can't pin thread to CPU %d.", cpu);
+#elif defined(Q_OS_WIN)
+	if(SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) == 0)
+		CZLog(CZLogLevelLow, "Can't pin thread to CPU %d.", cpu);
+#else
+	(void)cpu;
+#endif
+}
+
+/*!	\brief Pin calling thread to CPUs of one NUMA node.
+	Only CPUs the process may run on are used. Only Linux reports CPUs
+	of NUMA nodes, threads are not pinned on other systems.
+	\return \a 0 in case of success, \a -1 if thread was not pinned.
+*/
+int CZCpuPinNode(
+	int node			/*!<[in] NUMA node index. */
+) {
+#if defined(Q_OS_LINUX)
+	const QVector<int> &cpus = CZCpuList();
+	char path[CZ_CPU_LINE_LEN];
+	char line[CZ_CPU_LINE_LEN];
+	cpu_set_t set;
+	int count = 0;
+	FILE *file;
+
+	if(node < 0)
+		return -1;
+
+	sprintf(path, "/sys/devices/system/node/node%d/cpulist", node);
+	file = fopen(path, "r");
+	if(file == NULL)
+		return -1;
+
+	CPU_ZERO(&set);
+	if(fgets(line, sizeof(line), file) != NULL) {
+		char *p = line;
+		while((*p >= '0') && (*p <= '9')) {
+			int first = (int)strtol(p, &p, 10);
+			int last = first;
+			if(*p == '-')
+				last = (int)strtol(p + 1, &p, 10);
+			for(int cpu = first; (cpu <= last) && (cpu < CPU_SETSIZE); cpu++) {
+				if(cpus.contains(cpu)) {
+					CPU_SET(cpu, &set);
+					count++;
+				}
+			}
+			if(*p == ',')
+				p++;
+		}
+	}
+	fclose(file);
+
+	if(count == 0)
+		return -1;
+
+	if(pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+		CZLog(CZLogLevelLow, "Can't pin thread to NUMA node %d.", node);
+		return -1;
+	}
+
+	return 0;
+#else
+	(void)node;
+	return -1;
+#endif
+}
+
+/*!	\brief Host CPU worker thread.
+	Worker is pinned to its own CPU once and then runs one calculation
+	or copy task per round. Workers of a round wait on a common start
+	barrier, so thread start and scheduling stay out of timed work.
+	Copy task fills \a dst if no source buffer is given. Filling is used
+	to place pages of buffer on NUMA node of the CPU.
+*/
+class CZCpuWorker: public QThread {
+
+public:
+	CZCpuWorker(int cpu, int seed);
+	~CZCpuWorker();
+
+	void setupCalc(CZCpuCalcFunc func, int loops);
+	void setupCopy(void *dst, const void *src, size_t size);
+	void post(QSemaphore *ready, QSemaphore *go, QSemaphore *done);
+	double opsNum() const;
+	double timeMs() const;
+
+protected:
+	void run();
+
+private:
+	int cpu;
+	int seed;
+	QSemaphore task;
+	QSemaphore *ready;
+	QSemaphore *go;
+	QSemaphore *done;
+	bool quit;
+	CZCpuCalcFunc func;
+	int loops;
+	void *dst;
+	const void *src;
+	size_t size;
+	double ops;
+	double ms;
+	char buf[CZ_CPU_CALC_BUF_SIZE];
+};
+
+/*!	\brief Creates and starts host CPU worker thread.
+*/
+CZCpuWorker::CZCpuWorker(
+	int cpu,			/*!<[in] CPU index to pin thread to. */
+	int seed			/*!<[in] Initial value of calculation chains. */
+) {
+	this->cpu = cpu;
+	this->seed = seed;
+	ready = NULL;
+	go = NULL;
+	done = NULL;
+	quit = false;
+	func = NULL;
+	loops = 0;
+	dst = NULL;
+	src = NULL;
+	size = 0;
+	ops = 0;
+	ms = 0;
+	start();
+}
+
+/*!	\brief Stops host CPU worker thread.
+*/
+CZCpuWorker::~CZCpuWorker() {
+	quit = true;
+	task.release();
+	wait();
+}
+
+/*!	\brief Set calculation task for next round.
+*/
+void CZCpuWorker::setupCalc(
+	CZCpuCalcFunc func,		/*!<[in] Calculation function. */
+	int loops			/*!<[in] Number of calculation loops. */
+) {
+	this->func = func;
+	this->loops = loops;
+	ops = 0;
+}
+
+/*!	\brief Set copy task for next round.
+*/
+void CZCpuWorker::setupCopy(
+	void *dst,			/*!<[out] Destination buffer. */
+	const void *src,		/*!<[in] Source buffer or \a NULL to fill \a dst. */
+	size_t size			/*!<[in] Number of bytes to copy. */
+) {
+	func = NULL;
+	this->dst = dst;
+	this->src = src;
+	this->size = size;
+}
+
+/*!	\brief Give task to the worker.
+	Worker releases \a ready, waits for \a go, runs its task and
+	releases \a done.
+*/
+void CZCpuWorker::post(
+	QSemaphore *ready,		/*!<[in,out] Semaphore released when worker is ready. */
+	QSemaphore *go,			/*!<[in,out] Semaphore acquired before task starts. */
+	QSemaphore *done		/*!<[in,out] Semaphore released when task is done. */
+) {
+	this->ready = ready;
+	this->go = go;
+	this->done = done;
+	task.release();
+}
+
+/*!	\brief Number of operations done by the last calculation task.
+	\return number of operations.
+*/
+double CZCpuWorker::opsNum() const {
+	return ops;
+}
+
+/*!	\brief Time of the last task.
+	\return time in ms.
+*/
+double CZCpuWorker::timeMs() const {
+	return ms;
+}
+
+/*!	\brief Main work function of the thread.
+*/
+void CZCpuWorker::run() {
+	QElapsedTimer timer;
+
+	CZCpuPinThread(cpu);
+
+	forever {
+		task.acquire();
+		if(quit)
+			break;
+
+		ready->release();
+		go->acquire();
+
+		timer.start();
+		if(func != NULL)
+			ops = func(loops, seed, buf);
+		else if(src == NULL)
+			memset(dst, 0, size);
+		else
+			memcpy(dst, src, size);
+		ms = (double)timer.nsecsElapsed() / 1000000.0;
+
+		done->release();
+	}
+}
+
+/*!	\brief Run tasks set on workers at once and wait for them.
+	Time runs from the release of start barrier to the end of the last
+	task.
+	\return time of round in ms.
+*/
+static double CZCpuWorkRound(
+	CZCpuWorker * const *workers,	/*!<[in,out] Workers of round. */
+	int num				/*!<[in] Number of workers. */
+) {
+	QSemaphore ready;
+	QSemaphore go;
+	QSemaphore done;
+	QElapsedTimer timer;
+	int i;
+
+	for(i = 0; i < num; i++)
+		workers[i]->post(&ready, &go, &done);
+
+	ready.acquire(num);
+	timer.start();
+	go.release(num);
+	done.acquire(num);
+
+	return (double)timer.nsecsElapsed() / 1000000.0;
+}
+
+/*!	\brief Check if running test has to be stopped.
+	Rules are the same as for CUDA-device tests.
+	\return \a true if test has to be stopped, \a false otherwise.
+*/
+static bool CZCpuCalcTestBreak(
+	struct CZDeviceInfo *info,	/*!<[in] Device information. */
+	QElapsedTimer &timer,		/*!<[in] Timer started with test. */
+	int loop			/*!<[in] Index of loop going to be started. */
+) {
+
+	if((info->abortFlag != NULL) && (*info->abortFlag != 0)) {
+		CZLog(CZLogLevelLow, "Test is aborted on %s.", info->deviceName);
+		return true;
+	}
+
+	if((loop != 0) && (info->timeLimit > 0) && (timer.elapsed() >= info->timeLimit)) {
+		CZLog(CZLogLevelLow, "Test is out of time limit on %s.", info->deviceName);
+		return true;
+	}
+
+	return false;
+}
+
+/*!	\brief Run one CPU calculation test on all threads.
+	Number of calculation loops is calibrated with a short single
+	thread run so each of \a info->config.calcLoops test loops takes
+	about 1/\a info->config.calcLoops of time limit or
+	#CZ_CPU_CALC_ROUND_MS.
+	\return \a 0 in case of error, \a other is value in KOPS.
+*/
+static float CZCpuCalcDevicePerformanceTest(
+	struct CZDeviceInfo *info,	/*!<[in,out] Device information. */
+	int test,			/*!<[in] Test identifier. See enum #CZTest. */
+	QVector<CZCpuWorker*> &threads	/*!<[in,out] Calculation threads. */
+) {
+	CZCpuCalcFunc func;
+	QElapsedTimer timer;
+	char buf[CZ_CPU_CALC_BUF_SIZE];
+	double timeMs = 0;
+	double opsNum = 0;
+	double probeMs;
+	double roundMs;
+	int loops;
+	int i, j;
+
+	func = CZCpuCalcSelect(test, CZCpuSimdLevel());
+	if(func == NULL)
+		return 0;
+
+	CZLog(CZLogLevelLow, "Starting %s test on %s on %d thread(s).",
+		(test == CZTestCalcFloat)? "single-precision float":
+		(test == CZTestCalcDouble)? "double-precision float":
+		(test == CZTestCalcInteger32)? "32-bit integer":
+		(test == CZTestCalcInteger24)? "24-bit integer":
+		(test == CZTestCalcInteger64)? "64-bit integer": "unknown",
+		info->deviceName,
+		threads.size());
+
+	timer.start();
+
+	func(CZ_CPU_CALC_PROBE_LOOPS, 0, buf);
+	probeMs = (double)timer.nsecsElapsed() / 1000000.0;
+
+	roundMs = (info->timeLimit > 0)? (double)info->timeLimit / info->config.calcLoops: CZ_CPU_CALC_ROUND_MS;
+	loops = CZ_CPU_CALC_PROBE_LOOPS;
+	if(probeMs > 0)
+		loops = (int)(CZ_CPU_CALC_PROBE_LOOPS * roundMs / probeMs);
+	if(loops < 1)
+		loops = 1;
+	CZLog(CZLogLevelLow, "Calculation loops are set to %d.", loops);
+
+	for(i = 0; i < info->config.calcLoops; i++) {
+		double loopUs;
+		double loopMs;
+		double loopOps = 0;
+
+		if(CZCpuCalcTestBreak(info, timer, i)) {
+			info->partialMask |= test;
+			break;
+		}
+
+		for(j = 0; j < threads.size(); j++)
+			threads[j]->setupCalc(func, loops);
+
+		loopUs = CZTraceTimeUs();
+		loopMs = CZCpuWorkRound(threads.constData(), threads.size());
+
+		for(j = 0; j < threads.size(); j++)
+			loopOps += threads[j]->opsNum();
+
+		timeMs += loopMs;
+		opsNum += loopOps;
+
+		CZTraceHostSpan("cpu", "calc", info->num, loopUs);
+
+		CZLogKV(CZLogLevelLow, "cpu-calc-loop", "test=0x%x loop=%d threads=%d block_loops=%d ms=%f",
+			test, i, threads.size(), loops, loopMs);
+	}
+
+	CZLog(CZLogLevelLow, "Test complete in %f ms (%d loops).", timeMs, i);
+
+	if(timeMs == 0)
+		return 0;
+
+	return (float)(opsNum / timeMs);
+}
+
+/*!	\brief Run host CPU calculation performance tests.
+	Tests use the same MAD chains and the same units as GPU tests.
+	Number of threads is taken from \a info->core.muliProcCount, all
+	available CPU cores are used if it is \a 0. Each thread is pinned
+	to its own core.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZCpuCalcDevicePerformance(
+	struct CZDeviceInfo *info	/*!<[in,out] Device information. */
+) {
+	QVector<CZCpuWorker*> threads;
+	const QVector<int> &cpus = CZCpuList();
+	int threadsNum;
+	int i;
+
+	if(info == NULL)
+		return -1;
+
+	info->perf.calcFloat = 0;
+	info->perf.calcDouble = 0;
+	info->perf.calcInteger32 = 0;
+	info->perf.calcInteger24 = 0;
+	info->perf.calcInteger64 = 0;
+	info->partialMask &= ~CZTestCalcAll;
+
+	if((info->testMask & CZTestCalcAll) == 0)
+		return 0;
+
+	threadsNum = info->core.muliProcCount;
+	if(threadsNum <= 0)
+		threadsNum = cpus.size();
+
+	for(i = 0; i < threadsNum; i++)
+		threads.append(new CZCpuWorker(cpus[i % cpus.size()], i));
+
+	if(info->testMask & CZTestCalcFloat)
+		info->perf.calcFloat = CZCpuCalcDevicePerformanceTest(info, CZTestCalcFloat, threads);
+	if(info->testMask & CZTestCalcDouble)
+		info->perf.calcDouble = CZCpuCalcDevicePerformanceTest(info, CZTestCalcDouble, threads);
+	if(info->testMask & CZTestCalcInteger32)
+		info->perf.calcInteger32 = CZCpuCalcDevicePerformanceTest(info, CZTestCalcInteger32, threads);
+	if(info->testMask & CZTestCalcInteger24)
+		info->perf.calcInteger24 = CZCpuCalcDevicePerformanceTest(info, CZTestCalcInteger24, threads);
+	if(info->testMask & CZTestCalcInteger64)
+		info->perf.calcInteger64 = CZCpuCalcDevicePerformanceTest(info, CZTestCalcInteger64, threads);
+
+	for(i = 0; i < threads.size(); i++)
+		delete threads[i];
+
+	return 0;
+}
+
+/*!	\brief Empty version string of host CPU device.
+*/
+static char CZCpuEmptyStr[] = "";
+
+/*!	\brief Local service data structure for bandwith calulations.
+*/
+struct CZCpuBandLocalData {
+	void		*memHostPage;		/*!< Pageable buffer on host NUMA node. */
+	void		*memHostPin;		/*!< Locked buffer on host NUMA node. */
+	void		*memDevice1;		/*!< Buffer 1 on device NUMA node. */
+	void		*memDevice2;		/*!< Buffer 2 on device NUMA node. */
+	int		hostPinLocked;		/*!< 1 if \a memHostPin was really locked. */
+	CZCpuWorker	*hostWorker;		/*!< Worker on CPU of host NUMA node. */
+	CZCpuWorker	*deviceWorker;		/*!< Worker on CPU of device NUMA node. */
+};
+
+/*!	\brief Get list of NUMA nodes with CPUs the process may run on.
+	The first node is the host node, the last node is the device node.
+	\return list of the first available CPU index of every node.
+*/
+static const QVector<int> &CZCpuNodes(void) {
+	static QVector<int> nodes;
+
+	if(!nodes.isEmpty())
+		return nodes;
+
+#if defined(Q_OS_LINUX)
+	const QVector<int> &cpus = CZCpuList();
+
+	for(int node = 0; node < CZ_CPU_NODES_MAX; node++) {
+		char path[CZ_CPU_LINE_LEN];
+		char line[CZ_CPU_LINE_LEN];
+		FILE *file;
+
+		sprintf(path, "/sys/devices/system/node/node%d/cpulist", node);
+		file = fopen(path, "r");
+		if(file == NULL)
+			continue;
+
+		if(fgets(line, sizeof(line), file) != NULL) {
+			char *p = line;
+			bool found = false;
+			while(!found && (*p >= '0') && (*p <= '9')) {
+				int first = (int)strtol(p, &p, 10);
+				int last = first;
+				if(*p == '-')
+					last = (int)strtol(p + 1, &p, 10);
+				for(int cpu = first; cpu <= last; cpu++) {
+					if(cpus.contains(cpu)) {
+						nodes.append(cpu);
+						found = true;
+						break;
+					}
+				}
+				if(*p == ',')
+					p++;
+			}
+		}
+
+		fclose(file);
+	}
+#endif
+
+	if(nodes.isEmpty())
+		nodes.append(CZCpuList()[0]);
+
+	CZLog(CZLogLevelLow, "Found %d NUMA node(s) with CPUs.", nodes.size());
+
+	return nodes;
+}
+
+/*!	\brief Read name of host CPU.
+*/
+static void CZCpuReadName(
+	char *name,			/*!<[out] CPU name. */
+	int len				/*!<[in] Size of \a name buffer. */
+) {
+	name[0] = 0;
+
+#ifdef CZ_CPU_X86
+	unsigned int regs[12];
+
+	CZCpuId(0x80000000, 0, regs);
+	if(regs[0] >= 0x80000004) {
+		CZCpuId(0x80000002, 0, &regs[0]);
+		CZCpuId(0x80000003, 0, &regs[4]);
+		CZCpuId(0x80000004, 0, &regs[8]);
+		char brand[sizeof(regs) + 1];
+		memcpy(brand, regs, sizeof(regs));
+		brand[sizeof(regs)] = 0;
+		char *p = brand;
+		while(*p == ' ')
+			p++;
+		strncpy(name, p, len - 1);
+		name[len - 1] = 0;
+	}
+#endif
+
+#if defined(Q_OS_LINUX)
+	if(name[0] == 0) {
+		FILE *file = fopen("/proc/cpuinfo", "r");
+		if(file != NULL) {
+			char line[CZ_CPU_LINE_LEN];
+			while(fgets(line, sizeof(line), file) != NULL) {
+				if((strncmp(line, "model name", 10) == 0) || (strncmp(line, "Hardware", 8) == 0)) {
+					char *p = strchr(line, ':');
+					if(p != NULL) {
+						p++;
+						while(*p == ' ')
+							p++;
+						p[strcspn(p, "\n")] = 0;
+						strncpy(name, p, len - 1);
+						name[len - 1] = 0;
+						break;
+					}
+				}
+			}
+			fclose(file);
+		}
+	}
+#elif defined(Q_OS_MAC)
+	if(name[0] == 0) {
+		size_t size = len;
+		if(sysctlbyname("machdep.cpu.brand_string", name, &size, NULL, 0) != 0)
+			name[0] = 0;
+		name[len - 1] = 0;
+	}
+#endif
+
+	if(name[0] == 0) {
+		strncpy(name, "Host CPU", len - 1);
+		name[len - 1] = 0;
+	}
+}
+
+/*!	\brief Read CPU clock, memory and cache information of host.
+*/
+static void CZCpuReadSystemInfo(
+	struct CZDeviceInfo *info	/*!<[in,out] Device information. */
+) {
+#if defined(Q_OS_LINUX)
+	FILE *file;
+	char path[CZ_CPU_LINE_LEN];
+	char line[CZ_CPU_LINE_LEN];
+	int cpu = CZCpuList()[0];
+
+	sprintf(path, "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", cpu);
+	file = fopen(path, "r");
+	if(file != NULL) {
+		if(fgets(line, sizeof(line), file) != NULL)
+			info->core.clockRate = atoi(line);
+		fclose(file);
+	}
+
+	long pages = sysconf(_SC_PHYS_PAGES);
+	long pageSize = sysconf(_SC_PAGESIZE);
+	if((pages > 0) && (pageSize > 0))
+		info->mem.totalGlobal = (size_t)pages * (size_t)pageSize;
+
+	for(int i = 0; i < CZ_CPU_CACHES_MAX; i++) {
+		int level = 0;
+		int size = 0;
+		char type[CZ_CPU_LINE_LEN] = "";
+
+		sprintf(path, "/sys/devices/system/cpu/cpu%d/cache/index%d/level", cpu, i);
+		file = fopen(path, "r");
+		if(file == NULL)
+			break;
+		if(fgets(line, sizeof(line), file) != NULL)
+			level = atoi(line);
+		fclose(file);
+
+		sprintf(path, "/sys/devices/system/cpu/cpu%d/cache/index%d/type", cpu, i);
+		file = fopen(path, "r");
+		if(file != NULL) {
+			if(fgets(type, sizeof(type), file) == NULL)
+				type[0] = 0;
+			fclose(file);
+		}
+
+		sprintf(path, "/sys/devices/system/cpu/cpu%d/cache/index%d/size", cpu, i);
+		file = fopen(path, "r");
+		if(file != NULL) {
+			if(fgets(line, sizeof(line), file) != NULL) {
+				char *p;
+				size = (int)strtol(line, &p, 10);
+				if(*p == 'K')
+					size *= 1024;
+				else if(*p == 'M')
+					size *= 1024 * 1024;
+			}
+			fclose(file);
+		}
+
+		if(strncmp(type, "Instruction", 11) == 0)
+			continue;
+		if(level == 1)
+			info->mem.l1CacheSize = size;
+		else if(level == 2)
+			info->mem.l2CacheSize = size;
+		else if(level == 3)
+			info->mem.l3CacheSize = size;
+	}
+#elif defined(Q_OS_WIN)
+	MEMORYSTATUSEX status;
+	status.dwLength = sizeof(status);
+	if(GlobalMemoryStatusEx(&status))
+		info->mem.totalGlobal = (size_t)status.ullTotalPhys;
+
+	DWORD len = 0;
+	GetLogicalProcessorInformation(NULL, &len);
+	SYSTEM_LOGICAL_PROCESSOR_INFORMATION *procInfo = (SYSTEM_LOGICAL_PROCESSOR_INFORMATION*)malloc(len);
+	if(procInfo != NULL) {
+		if(GetLogicalProcessorInformation(procInfo, &len)) {
+			int nodes = 0;
+			for(DWORD i = 0; i < len / sizeof(*procInfo); i++) {
+				if(procInfo[i].Relationship == RelationNumaNode) {
+					nodes++;
+				} else if((procInfo[i].Relationship == RelationCache) &&
+					(procInfo[i].Cache.Type != CacheInstruction)) {
+					if(procInfo[i].Cache.Level == 1)
+						info->mem.l1CacheSize = procInfo[i].Cache.Size;
+					else if(procInfo[i].Cache.Level == 2)
+						info->mem.l2CacheSize = procInfo[i].Cache.Size;
+					else if(procInfo[i].Cache.Level == 3)
+						info->mem.l3CacheSize = procInfo[i].Cache.Size;
+				}
+			}
+			if(nodes > 0)
+				info->mem.numaNodes = nodes;
+		}
+		free(procInfo);
+	}
+#elif defined(Q_OS_MAC)
+	unsigned long long value;
+	size_t size;
+
+	size = sizeof(value);
+	if(sysctlbyname("hw.cpufrequency_max", &value, &size, NULL, 0) == 0)
+		info->core.clockRate = (int)(value / 1000);
+	size = sizeof(value);
+	if(sysctlbyname("hw.memsize", &value, &size, NULL, 0) == 0)
+		info->mem.totalGlobal = (size_t)value;
+	size = sizeof(value);
+	if(sysctlbyname("hw.l1dcachesize", &value, &size, NULL, 0) == 0)
+		info->mem.l1CacheSize = (int)value;
+	size = sizeof(value);
+	if(sysctlbyname("hw.l2cachesize", &value, &size, NULL, 0) == 0)
+		info->mem.l2CacheSize = (int)value;
+	size = sizeof(value);
+	if(sysctlbyname("hw.l3cachesize", &value, &size, NULL, 0) == 0)
+		info->mem.l3CacheSize = (int)value;
+#endif
+}
+
+/*!	\brief Check if host CPU device may be used.
+	\return \a true, host CPU is always here.
+*/
+bool CZCpuCheck(void) {
+	return true;
+}
+
+/*!	\brief Get number of host CPU devices.
+	All CPUs of the host are presented as one device.
+	\return number of host CPU devices.
+*/
+int CZCpuDeviceFound(void) {
+	return 1;
+}
+
+/*!	\brief Read information about host CPU device.
+	Compute capability major number is set to SIMD level of CPU, see
+	enum #CZCpuSimd. Number of multiprocessors is the number of logical
+	CPU cores available to the process, warp size is the number of
+	single-precision float lanes of SIMD unit. Shared memory per block
+	is the size of L1 data cache.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZCpuReadDeviceInfo(
+	struct CZDeviceInfo *info,	/*!<[in,out] Device information. */
+	int num				/*!<[in] Number (index) of host CPU device. */
+) {
+	int level;
+
+	if(info == NULL)
+		return -1;
+
+	if(num >= CZCpuDeviceFound())
+		return -1;
+
+	level = CZCpuSimdLevel();
+
+	info->num = num;
+	info->deviceType = CZDeviceTypeCpu;
+	CZCpuReadName(info->deviceName, sizeof(info->deviceName));
+	info->major = level;
+	info->minor = 0;
+	info->drvVersion = CZCpuEmptyStr;
+	info->drvDllVer = 0;
+	info->drvDllVerStr = CZCpuEmptyStr;
+	info->rtDllVer = 0;
+	info->rtDllVerStr = CZCpuEmptyStr;
+	info->tccDriver = 0;
+
+	info->core.SIMDWidth =
+		(level == CZCpuSimdAVX512)? 16:
+		(level == CZCpuSimdAVX2)? 8:
+		(level == CZCpuSimdSSE)? 4: 1;
+	info->core.maxThreadsPerBlock = 1;
+	info->core.maxThreadsDim[0] = 1;
+	info->core.maxThreadsDim[1] = 1;
+	info->core.maxThreadsDim[2] = 1;
+	info->core.maxGridSize[0] = CZCpuCoreCount();
+	info->core.maxGridSize[1] = 1;
+	info->core.maxGridSize[2] = 1;
+	info->core.muliProcCount = CZCpuCoreCount();
+	info->core.maxThreadsPerMultiProcessor = 1;
+	info->core.watchdogEnabled = 0;
+	info->core.integratedGpu = 0;
+	info->core.concurrentKernels = 1;
+	info->core.computeMode = CZComputeModeDefault;
+	info->core.doublePrecision = 1;
+
+	info->mem.numaNodes = CZCpuNodes().size();
+	info->mem.mapHostMemory = 1;
+	info->mem.unifiedAddressing = 1;
+
+	CZCpuReadSystemInfo(info);
+
+	info->mem.sharedPerBlock = info->mem.l1CacheSize;
+
+	CZLog(CZLogLevelLow, "Host CPU device is %s: %d core(s), %s, %d NUMA node(s).",
+		info->deviceName, info->core.muliProcCount, CZCpuSimdName(level), info->mem.numaNodes);
+
+	return 0;
+}
+
+/*!	\brief Select host CPU device for tests.
+	\return \a 0, nothing has to be done.
+*/
+int CZCpuCalcDeviceSelect(
+	struct CZDeviceInfo *info	/*!<[in,out] Device information. */
+) {
+	(void)info;
+	return 0;
+}
+
+/*!	\brief Lock or unlock memory buffer in RAM.
+	\return \a true in case of success, \a false otherwise.
+*/
+static bool CZCpuLockMemory(
+	void *buf,			/*!<[in] Memory buffer. */
+	size_t size,			/*!<[in] Size of buffer. */
+	bool lock			/*!<[in] Lock \a (=true) or unlock \a (=false). */
+) {
+#if defined(Q_OS_WIN)
+	return lock? (VirtualLock(buf, size) != 0): (VirtualUnlock(buf, size) != 0);
+#else
+	return lock? (mlock(buf, size) == 0): (munlock(buf, size) == 0);
+#endif
+}
+
+/*!	\brief Run copy on given worker and wait for it.
+	\return time of copy in ms.
+*/
+static double CZCpuCopyOn(
+	CZCpuWorker *worker,		/*!<[in,out] Worker pinned to CPU of copy. */
+	void *dst,			/*!<[out] Destination buffer. */
+	const void *src,		/*!<[in] Source buffer or \a NULL to fill \a dst. */
+	size_t size			/*!<[in] Number of bytes to copy. */
+) {
+	worker->setupCopy(dst, src, size);
+	CZCpuWorkRound(&worker, 1);
+
+	return worker->timeMs();
+}
+
+/*!	\brief Allocate buffers for host CPU bandwidth tests.
+	Host buffers are placed on the first NUMA node and device buffers
+	on the last one by first touch from a CPU of that node.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZCpuPrepareDevice(
+	struct CZDeviceInfo *info	/*!<[in,out] Device information. */
+) {
+	struct CZCpuBandLocalData *lData;
+	const QVector<int> &nodes = CZCpuNodes();
+	int hostCpu = nodes.first();
+	int deviceCpu = nodes.last();
+
+	if(info == NULL)
+		return -1;
+
+	if(info->band.localData != NULL)
+		return 0;
+
+	CZLog(CZLogLevelLow, "Alloc local buffers for %s.", info->deviceName);
+
+	lData = (struct CZCpuBandLocalData*)malloc(sizeof(*lData));
+	if(lData == NULL)
+		return -1;
+	memset(lData, 0, sizeof(*lData));
+
+	lData->memHostPage = malloc(CZ_CPU_COPY_BUF_SIZE);
+	lData->memHostPin = malloc(CZ_CPU_COPY_BUF_SIZE);
+	lData->memDevice1 = malloc(CZ_CPU_COPY_BUF_SIZE);
+	lData->memDevice2 = malloc(CZ_CPU_COPY_BUF_SIZE);
+	if((lData->memHostPage == NULL) || (lData->memHostPin == NULL) ||
+		(lData->memDevice1 == NULL) || (lData->memDevice2 == NULL)) {
+		free(lData->memHostPage);
+		free(lData->memHostPin);
+		free(lData->memDevice1);
+		free(lData->memDevice2);
+		free(lData);
+		return -1;
+	}
+
+	lData->hostWorker = new CZCpuWorker(hostCpu, 0);
+	lData->deviceWorker = new CZCpuWorker(deviceCpu, 0);
+
+	CZCpuCopyOn(lData->hostWorker, lData->memHostPage, NULL, CZ_CPU_COPY_BUF_SIZE);
+	CZCpuCopyOn(lData->hostWorker, lData->memHostPin, NULL, CZ_CPU_COPY_BUF_SIZE);
+	CZCpuCopyOn(lData->deviceWorker, lData->memDevice1, NULL, CZ_CPU_COPY_BUF_SIZE);
+	CZCpuCopyOn(lData->deviceWorker, lData->memDevice2, NULL, CZ_CPU_COPY_BUF_SIZE);
+
+	lData->hostPinLocked = CZCpuLockMemory(lData->memHostPin, CZ_CPU_COPY_BUF_SIZE, true)? 1: 0;
+	if(!lData->hostPinLocked)
+		CZLog(CZLogLevelWarning, "Can't lock host buffer in memory, pinned tests use pageable memory.");
+
+	info->band.localData = (void*)lData;
+
+	return 0;
+}
+
+/*!	\brief Free buffers for host CPU bandwidth tests.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZCpuCleanDevice(
+	struct CZDeviceInfo *info	/*!<[in,out] Device information. */
+) {
+	struct CZCpuBandLocalData *lData;
+
+	if(info == NULL)
+		return -1;
+
+	lData = (struct CZCpuBandLocalData*)info->band.localData;
+	if(lData == NULL)
+		return 0;
+
+	CZLog(CZLogLevelLow, "Free local buffers for %s.", info->deviceName);
+
+	delete lData->hostWorker;
+	delete lData->deviceWorker;
+	if(lData->hostPinLocked)
+		CZCpuLockMemory(lData->memHostPin, CZ_CPU_COPY_BUF_SIZE, false);
+	free(lData->memHostPage);
+	free(lData->memHostPin);
+	free(lData->memDevice1);
+	free(lData->memDevice2);
+	free(lData);
+
+	info->band.localData = NULL;
+
+	return 0;
+}
+
+/*!	\brief Run one host CPU transfer test.
+	Host to device and device to host copies run on a CPU of the host
+	NUMA node, device to device copy runs on a CPU of the device node.
+	\return \a 0 in case of error, \a other is value in KiB/s.
+*/
+static float CZCpuCalcDeviceBandwidthTest(
+	struct CZDeviceInfo *info,	/*!<[in,out] Device information. */
+	int test			/*!<[in] Test identifier. See enum #CZTest. */
+) {
+	struct CZCpuBandLocalData *lData = (struct CZCpuBandLocalData*)info->band.localData;
+	const QVector<int> &nodes = CZCpuNodes();
+	QElapsedTimer timer;
+	double timeMs = 0;
+	double bytes = 0;
+	void *dst;
+	const void *src;
+	CZCpuWorker *worker = lData->hostWorker;
+	int cpu = nodes.first();
+	int i;
+
+	switch(test) {
+	case CZTestCopyHDPage:
+		src = lData->memHostPage;
+		dst = lData->memDevice1;
+		break;
+	case CZTestCopyHDPin:
+		src = lData->memHostPin;
+		dst = lData->memDevice1;
+		break;
+	case CZTestCopyDHPage:
+		src = lData->memDevice2;
+		dst = lData->memHostPage;
+		break;
+	case CZTestCopyDHPin:
+		src = lData->memDevice2;
+		dst = lData->memHostPin;
+		break;
+	case CZTestCopyDD:
+		src = lData->memDevice1;
+		dst = lData->memDevice2;
+		worker = lData->deviceWorker;
+		cpu = nodes.last();
+		break;
+	default: // WTF!
+		return 0;
+	}
+
+	CZLog(CZLogLevelLow, "Starting %s test on %s on CPU %d.",
+		(test == CZTestCopyHDPage)? "host to device (pageable)":
+		(test == CZTestCopyHDPin)? "host to device (pinned)":
+		(test == CZTestCopyDHPage)? "device to host (pageable)":
+		(test == CZTestCopyDHPin)? "device to host (pinned)":
+		(test == CZTestCopyDD)? "device to device": "unknown",
+		info->deviceName, cpu);
+
+	timer.start();
+
+	for(i = 0; i < info->config.copyLoops; i++) {
+		double loopUs;
+		double loopMs;
+
+		if(CZCpuCalcTestBreak(info, timer, i)) {
+			info->partialMask |= test;
+			break;
+		}
+
+		loopUs = CZTraceTimeUs();
+		loopMs = CZCpuCopyOn(worker, dst, src, CZ_CPU_COPY_BUF_SIZE);
+		timeMs += loopMs;
+		bytes += (double)CZ_CPU_COPY_BUF_SIZE;
+
+		CZTraceHostSpan("cpu", "copy", info->num, loopUs);
+
+		CZLogKV(CZLogLevelLow, "cpu-copy-loop", "test=0x%x loop=%d cpu=%d bytes=%d ms=%f",
+			test, i, cpu, CZ_CPU_COPY_BUF_SIZE, loopMs);
+	}
+
+	CZLog(CZLogLevelLow, "Test complete in %f ms (%d loops).", timeMs, i);
+
+	if(timeMs == 0)
+		return 0;
+
+	return (float)(1000.0 * bytes / (timeMs * 1024.0));
+}
+
+/*!	\brief Run host CPU memory transfer tests.
+	Transfers are plain memcpy() between buffers of host and device
+	NUMA nodes. On a host with one NUMA node all buffers are local.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZCpuCalcDeviceBandwidth(
+	struct CZDeviceInfo *info	/*!<[in,out] Device information. */
+) {
+
+	if(info == NULL)
+		return -1;
+
+	info->band.copyHDPage = 0;
+	info->band.copyHDPin = 0;
+	info->band.copyDHPage = 0;
+	info->band.copyDHPin = 0;
+	info->band.copyDD = 0;
+	info->partialMask &= ~CZTestCopyAll;
+
+	if((info->testMask & CZTestCopyAll) == 0)
+		return 0;
+
+	if(info->band.localData == NULL)
+		return -1;
+
+	if(info->testMask & CZTestCopyHDPage)
+		info->band.copyHDPage = CZCpuCalcDeviceBandwidthTest(info, CZTestCopyHDPage);
+	if(info->testMask & CZTestCopyHDPin)
+		info->band.copyHDPin = CZCpuCalcDeviceBandwidthTest(info, CZTestCopyHDPin);
+	if(info->testMask & CZTestCopyDHPage)
+		info->band.copyDHPage = CZCpuCalcDeviceBandwidthTest(info, CZTestCopyDHPage);
+	if(info->testMask & CZTestCopyDHPin)
+		info->band.copyDHPin = CZCpuCalcDeviceBandwidthTest(info, CZTestCopyDHPin);
+	if(info->testMask & CZTestCopyDD)
+		info->band.copyDD = CZCpuCalcDeviceBandwidthTest(info, CZTestCopyDD);
+
+	return 0;
+}
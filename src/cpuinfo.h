@@ -0,0 +1,47 @@
+/*!	\file cpuinfo.h
+	\brief Host CPU device information and test definition.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#ifndef CZ_CPUINFO_H
+#define CZ_CPUINFO_H
+
+#include "cudainfo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!	\brief SIMD instruction set levels of host CPU.
+*/
+enum CZCpuSimd {
+	CZCpuSimdScalar = 0,			/*!< Plain C code. */
+	CZCpuSimdSSE,				/*!< SSE4.1 instructions. */
+	CZCpuSimdAVX2,				/*!< AVX2 and FMA3 instructions. */
+	CZCpuSimdAVX512,			/*!< AVX-512F and AVX-512DQ instructions. */
+};
+
+int CZCpuSimdLevel(void);
+const char *CZCpuSimdName(int level);
+int CZCpuCoreCount(void);
+double CZCpuThreadTimeMs(void);
+int CZCpuPinNode(int node);
+unsigned long long CZCpuChecksum(const void *buf, size_t size);
+void CZCpuFillPattern(void *buf, size_t size, unsigned int seed);
+
+bool CZCpuCheck(void);
+int CZCpuDeviceFound(void);
+int CZCpuReadDeviceInfo(struct CZDeviceInfo *info, int num);
+int CZCpuCalcDeviceSelect(struct CZDeviceInfo *info);
+int CZCpuPrepareDevice(struct CZDeviceInfo *info);
+int CZCpuCalcDeviceBandwidth(struct CZDeviceInfo *info);
+int CZCpuCalcDevicePerformance(struct CZDeviceInfo *info);
+int CZCpuCleanDevice(struct CZDeviceInfo *info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//CZ_CPUINFO_H
@@ -8,6 +8,7 @@
 #include <cuda.h>
 #include <cuda_runtime.h>
 #include <host_defines.h>
+#include <stdlib.h>
 #include <string.h>
 
 #if CUDA_VERSION < 5050
@@ -15,7 +16,12 @@
 #endif
 
 #include "log.h"
+#include "trace.h"
 #include "cudainfo.h"
+#include "peakinfo.h"
+#include "nvmlinfo.h"
+#include "cpuinfo.h"
+#include "hostmem.h"
 
 #if (defined(WIN64) || defined(_WIN64) || defined(__WIN64__)) || (defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__))
 #define Q_OS_WIN
@@ -27,14 +33,13 @@
 #error Unknown/unsupported platform!
 #endif
 
-#define CZ_COPY_BUF_SIZE	(16 * (1 << 20))	/*!< Transfer buffer size. */
-#define CZ_COPY_LOOPS_NUM	8			/*!< Number of loops to run transfer test to. */
-
-#define CZ_CALC_BLOCK_LOOPS	16			/*!< Number of loops to run calculation loop. */
-#define CZ_CALC_BLOCK_SIZE	256			/*!< Size of instruction block. */
-#define CZ_CALC_BLOCK_NUM	16			/*!< Number of instruction blocks in loop. */
-#define CZ_CALC_OPS_NUM		2			/*!< Number of operations per one loop. */
-#define CZ_CALC_LOOPS_NUM	8			/*!< Number of loops to run performance test to. */
+#define CZ_COPY_BUF_SIZE_MIN	(64 * (1 << 10))	/*!< Minimal transfer size used under time limit. */
+#define CZ_SWEEP_SIZE_MIN	(4 * (1 << 10))		/*!< Smallest transfer size of copy sweep. */
+#define CZ_SWEEP_BYTES		(64 * (1 << 20))	/*!< Amount of data moved for each size of copy sweep. */
+#define CZ_SWEEP_REPS_MAX	1024			/*!< Max number of transfers for each size of copy sweep. */
+#define CZ_STAGE_REPS		3			/*!< Number of runs of each staged transfer, the best one is taken. */
+#define CZ_CHECKSUM_THREADS_NUM	256			/*!< Threads per block of checksum kernels. */
+#define CZ_CHECKSUM_BLOCKS_NUM	64			/*!< Number of blocks of checksum kernels. */
 
 #define CZ_DEF_WARP_SIZE	32			/*!< Default warp size value. */
 #define CZ_DEF_THREADS_MAX	512			/*!< Default max threads value value. */
@@ -113,6 +118,7 @@ typedef void *LPVOID;
 typedef const void *LPCVOID;
 typedef bool BOOL;
 typedef int (WINAPI *FARPROC)();
+typedef long long LONGLONG;
 HMODULE WINAPI LoadLibraryA(__in LPCSTR lpLibFileName);
 FARPROC WINAPI GetProcAddress(__in HMODULE hModule, __in LPCSTR lpProcName);
 DWORD WINAPI GetFileVersionInfoSizeA(LPCSTR lptstrFilename, LPDWORD lpdwHandle);
@@ -122,6 +128,10 @@ HANDLE WINAPI GetCurrentProcess(void);
 BOOL WINAPI EnumProcessModules(HANDLE hProcess, HMODULE *lphModule, DWORD cb, LPDWORD lpcbNeeded);
 DWORD WINAPI GetModuleBaseNameA(HANDLE hProcess, HMODULE hModule, LPSTR lpBaseName, DWORD nSize);
 DWORD WINAPI GetModuleFileNameA(HMODULE hModule, LPSTR lpFilename, DWORD nSize);
+BOOL WINAPI QueryPerformanceCounter(LONGLONG *lpPerformanceCount);
+BOOL WINAPI QueryPerformanceFrequency(LONGLONG *lpFrequency);
+HANDLE WINAPI GetCurrentThread(void);
+BOOL WINAPI GetThreadTimes(HANDLE hThread, LONGLONG *lpCreationTime, LONGLONG *lpExitTime, LONGLONG *lpKernelTime, LONGLONG *lpUserTime);
 #ifdef __cplusplus
 }
 #endif
@@ -277,11 +287,28 @@ static bool CZCudaIsInit(void) {
 	return true;
 }
 
+/*!	\brief Get value of monotonic host timer.
+	\return time in milliseconds from some unspecified point.
+*/
+static double CZGetTimeMs(void) {
+	static LONGLONG freq = 0;
+	LONGLONG count = 0;
+
+	if(freq == 0) {
+		QueryPerformanceFrequency(&freq);
+	}
+
+	QueryPerformanceCounter(&count);
+
+	return (double)count * 1000.0 / (double)freq;
+}
+
 #elif defined(Q_OS_LINUX)
 #include <dlfcn.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <time.h>
 #define CZ_FILE_STR_LEN		256			/*!< Version file string length. */
 #define CZ_VER_FILE_NAME	"/proc/driver/nvidia/version"	/*!< Driver version file name. */
 #define CZ_PROC_MAP_NAME	"/proc/self/maps"	/*!< Process memory map file. */
@@ -467,9 +494,21 @@ static bool CZCudaIsInit(void) {
 	return true;
 }
 
+/*!	\brief Get value of monotonic host timer.
+	\return time in milliseconds from some unspecified point.
+*/
+static double CZGetTimeMs(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+}
+
 #elif defined(Q_OS_MAC)
 #include <dlfcn.h>
 #include <stdio.h>
+#include <mach/mach_time.h>
 #include "plist.h"
 #define CZ_FILE_STR_LEN		256			/*!< Version file string length. */
 #define CZ_PLIST_PATH		"/Contents/Info.plist"	/*!< Path to Info.plist inside of kext/app. */
@@ -629,8 +668,21 @@ static bool CZCudaIsInit(void) {
 	return true;
 }
 
+/*!	\brief Get value of monotonic host timer.
+	\return time in milliseconds from some unspecified point.
+*/
+static double CZGetTimeMs(void) {
+	static mach_timebase_info_data_t timebase = {0, 0};
+
+	if(timebase.denom == 0) {
+		mach_timebase_info(&timebase);
+	}
+
+	return (double)mach_absolute_time() * timebase.numer / timebase.denom / 1000000.0;
+}
+
 #else//!Q_OS_WIN && !Q_OS_LINUX && !Q_OS_MAC
-#error Function CZCudaIsInit() is not implemented for your platform!
+#error Functions CZCudaIsInit() and CZGetTimeMs() are not implemented for your platform!
 #endif//Q_OS_WIN
 
 /*!	\brief Check if CUDA is present here.
@@ -670,36 +722,6 @@ int CZCudaDeviceFound(void) {
 	return count;
 }
 
-/*!	\def ConvertSMVer2Cores(major, minor)
-	\brief Get number of CUDA cores per multiprocessor.
-	\arg[in] major GPU Architecture major version.
-	\arg[in] minor GPU Architecture minor version.
-	\returns 0 if GPU Architecture is unknown, or number of CUDA cores per multiprocessor.
-*/
-#define ConvertSMVer2Cores(major, minor) \
-	(((major) == 1)? ( /* Tesla */ \
-		((minor) == 0)? 8: /* G80*/ \
-		((minor) == 1)? 8: /* G8x, G9x */ \
-		((minor) == 2)? 8: /* GT21x */ \
-		((minor) == 3)? 8: /* GT200 */ \
-		0): \
-	((major) == 2)? ( /* Fermi */ \
-		((minor) == 0)? 32: /* GF100, GF110 */ \
-		((minor) == 1)? 48: /* GF10x, FG11x */ \
-		0): \
-	((major) == 3)? ( /* Kepler */ \
-		((minor) == 0)? 192: /* GK10x */ \
-		((minor) == 2)? 192: /* Tegra K1 */ \
-		((minor) == 5)? 192: /* GK11x, GK208 */ \
-		((minor) == 7)? 192: /* GK210 */ \
-		0): \
-	((major) == 5)? ( /* Maxwell */ \
-		((minor) == 0)? 128: /* GM10X */ \
-		((minor) == 2)? 128: /* GM20X */ \
-		((minor) == 3)? 128: /* Tegra X1 */ \
-		0): \
-	0)
-
 /*!	\def COMPILE_ASSERT(cond)
 	\arg[in] cond Static condition.
 	\brief Compile time assert() for constant conditions.
@@ -714,6 +736,7 @@ int CZCudaReadDeviceInfo(
 	int num				/*!<[in] Number (index) of CUDA-device. */
 ) {
 	cudaDeviceProp prop;
+	const struct CZArchInfo *arch;
 //	int ecc;
 
 	if(info == NULL)
@@ -762,8 +785,10 @@ int CZCudaReadDeviceInfo(
 	info->core.pciDeviceID = prop.pciDeviceID;
 	info->core.pciDomainID = prop.pciDomainID;
 	info->core.maxThreadsPerMultiProcessor = prop.maxThreadsPerMultiProcessor;
-	info->core.cudaCores = ConvertSMVer2Cores(prop.major, prop.minor) * prop.multiProcessorCount;
+	arch = CZArchFind(prop.major, prop.minor);
+	info->core.cudaCores = (arch == NULL)? 0: arch->coresPerSM * prop.multiProcessorCount;
 	info->core.streamPrioritiesSupported = prop.streamPrioritiesSupported;
+	info->core.doublePrecision = ((prop.major > 1) || ((prop.major == 1) && (prop.minor >= 3)))? 1: 0;
 
 	info->mem.totalGlobal = prop.totalGlobalMem;
 	info->mem.sharedPerBlock = prop.sharedMemPerBlock;
@@ -799,6 +824,7 @@ struct CZDeviceInfoBandLocalData {
 	void		*memHostPin;	/*!< Pinned host memory. */
 	void		*memDevice1;	/*!< Device memory buffer 1. */
 	void		*memDevice2;	/*!< Device memory buffer 2. */
+	size_t		size;		/*!< Size of each buffer. */
 };
 
 /*!	\brief Set device for current thread.
@@ -815,19 +841,33 @@ int CZCudaCalcDeviceSelect(
 	return 0;
 }
 
+static int CZCudaCalcDeviceBandwidthFree(struct CZDeviceInfo *info);
+
 /*!	\brief Allocate buffers for bandwidth calculations.
+	Buffers are allocated again if transfer buffer size of the device
+	was changed.
 	\return \a 0 in case of success, \a -1 in case of error.
 */
 static int CZCudaCalcDeviceBandwidthAlloc(
 	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
 ) {
 	CZDeviceInfoBandLocalData *lData;
+	size_t size;
+	double allocUs;
+	double traceUs;
 
 	if(info == NULL)
 		return -1;
 
+	size = (size_t)info->config.copyBufSize;
+	lData = (CZDeviceInfoBandLocalData*)info->band.localData;
+	if((lData != NULL) && (lData->size != size))
+		CZCudaCalcDeviceBandwidthFree(info);
+
 	if(info->band.localData == NULL) {
 
+		allocUs = CZTraceTimeUs();
+
 		CZLog(CZLogLevelLow, "Alloc local buffers for %s.", info->deviceName);
 
 		lData = (CZDeviceInfoBandLocalData*)malloc(sizeof(*lData));
@@ -837,45 +877,64 @@ static int CZCudaCalcDeviceBandwidthAlloc(
 
 		CZLog(CZLogLevelLow, "Alloc host pageable for %s.", info->deviceName);
 
-		lData->memHostPage = (void*)malloc(CZ_COPY_BUF_SIZE);
+		traceUs = CZTraceTimeUs();
+
+		lData->size = size;
+		lData->memHostPage = (void*)malloc(size);
 		if(lData->memHostPage == NULL) {
 			free(lData);
 			return -1;
 		}
 
+		CZTraceHostSpan("alloc", "malloc", info->num, traceUs);
+
 		CZLog(CZLogLevelLow, "Host pageable is at 0x%08X.", lData->memHostPage);
 
 		CZLog(CZLogLevelLow, "Alloc host pinned for %s.", info->deviceName);
 
-		CZ_CUDA_CALL(cudaMallocHost((void**)&lData->memHostPin, CZ_COPY_BUF_SIZE),
+		traceUs = CZTraceTimeUs();
+
+		CZ_CUDA_CALL(cudaMallocHost((void**)&lData->memHostPin, size),
 			free(lData->memHostPage);
 			free(lData);
 			return -1);
 
+		CZTraceHostSpan("alloc", "cudaMallocHost", info->num, traceUs);
+
 		CZLog(CZLogLevelLow, "Host pinned is at 0x%08X.", lData->memHostPin);
 
 		CZLog(CZLogLevelLow, "Alloc device buffer 1 for %s.", info->deviceName);
 
-		CZ_CUDA_CALL(cudaMalloc((void**)&lData->memDevice1, CZ_COPY_BUF_SIZE),
+		traceUs = CZTraceTimeUs();
+
+		CZ_CUDA_CALL(cudaMalloc((void**)&lData->memDevice1, size),
 			cudaFreeHost(lData->memHostPin);
 			free(lData->memHostPage);
 			free(lData);
 			return -1);
 
+		CZTraceHostSpan("alloc", "cudaMalloc", info->num, traceUs);
+
 		CZLog(CZLogLevelLow, "Device buffer 1 is at 0x%08X.", lData->memDevice1);
 
 		CZLog(CZLogLevelLow, "Alloc device buffer 2 for %s.", info->deviceName);
 
-		CZ_CUDA_CALL(cudaMalloc((void**)&lData->memDevice2, CZ_COPY_BUF_SIZE),
+		traceUs = CZTraceTimeUs();
+
+		CZ_CUDA_CALL(cudaMalloc((void**)&lData->memDevice2, size),
 			cudaFree(lData->memDevice1);
 			cudaFreeHost(lData->memHostPin);
 			free(lData->memHostPage);
 			free(lData);
 			return -1);
 
+		CZTraceHostSpan("alloc", "cudaMalloc", info->num, traceUs);
+
 		CZLog(CZLogLevelLow, "Device buffer 2 is at 0x%08X.", lData->memDevice2);
 
 		info->band.localData = (void*)lData;
+
+		CZTraceHostSpan("alloc", "alloc", info->num, allocUs);
 	}
 
 	return 0;
@@ -939,6 +998,16 @@ static int CZCudaCalcDeviceBandwidthReset(
 	info->band.copyDHPage = 0;
 	info->band.copyDHPin = 0;
 	info->band.copyDD = 0;
+	memset(&info->band.copyHDPageTime, 0, sizeof(info->band.copyHDPageTime));
+	memset(&info->band.copyHDPinTime, 0, sizeof(info->band.copyHDPinTime));
+	memset(&info->band.copyDHPageTime, 0, sizeof(info->band.copyDHPageTime));
+	memset(&info->band.copyDHPinTime, 0, sizeof(info->band.copyDHPinTime));
+	memset(&info->band.copyDDTime, 0, sizeof(info->band.copyDDTime));
+	memset(&info->band.sweep, 0, sizeof(info->band.sweep));
+	memset(&info->band.staged, 0, sizeof(info->band.staged));
+	memset(&info->band.hostMem, 0, sizeof(info->band.hostMem));
+	info->partialMask &= ~(CZTestCopyAll | CZTestCopySweep | CZTestCopyStaged | CZTestCopyHostMem);
+	info->corruptMask &= ~CZTestCopyAll;
 
 	return 0;
 }
@@ -947,22 +1016,298 @@ static int CZCudaCalcDeviceBandwidthReset(
 #define CZ_COPY_MODE_D2H	1	/*!< Device to host data copy mode. */
 #define CZ_COPY_MODE_D2D	2	/*!< Device to device data copy mode. */
 
+/*!	\brief Names of tests and test groups used in test lists and traces.
+*/
+static const struct {
+	const char	*name;		/*!< Name of test. */
+	int		mask;		/*!< Mask of test. See enum #CZTest. */
+} CZTestNames[] = {
+	{"hd-page",	CZTestCopyHDPage},
+	{"hd-pin",	CZTestCopyHDPin},
+	{"dh-page",	CZTestCopyDHPage},
+	{"dh-pin",	CZTestCopyDHPin},
+	{"dd",		CZTestCopyDD},
+	{"sweep",	CZTestCopySweep},
+	{"staged",	CZTestCopyStaged},
+	{"hostmem",	CZTestCopyHostMem},
+	{"float",	CZTestCalcFloat},
+	{"double",	CZTestCalcDouble},
+	{"int32",	CZTestCalcInteger32},
+	{"int24",	CZTestCalcInteger24},
+	{"int64",	CZTestCalcInteger64},
+	{"memory",	CZTestMemory},
+	{"alloc",	CZTestAlloc},
+	{"user",	CZTestUser},
+	{"coldstart",	CZTestColdStart},
+	{"contend",	CZTestContend},
+	{"aggregate",	CZTestAggregate},
+	{"ingest",	CZTestIngest},
+	{"copy",	CZTestCopyAll},
+	{"calc",	CZTestCalcAll},
+	{"all",		CZTestAll},
+};
+
+/*!	\brief Get short name of test used in test lists and traces.
+	\return name of test, \a "unknown" if \a test is not a single known test.
+*/
+const char *CZTestName(
+	int test			/*!<[in] Test identifier. See enum #CZTest. */
+) {
+	for(unsigned int i = 0; i < sizeof(CZTestNames) / sizeof(CZTestNames[0]); i++) {
+		if(test == CZTestNames[i].mask)
+			return CZTestNames[i].name;
+	}
+
+	return "unknown";
+}
+
+/*!	\brief Get mask of test or test group by its short name.
+	\return mask of tests, \a -1 in case of unknown test name.
+*/
+int CZTestMask(
+	const char *name		/*!<[in] Name of test or test group. */
+) {
+	for(unsigned int i = 0; i < sizeof(CZTestNames) / sizeof(CZTestNames[0]); i++) {
+		if(strcmp(name, CZTestNames[i].name) == 0)
+			return CZTestNames[i].mask;
+	}
+
+	return -1;
+}
+
+/*!	\brief Check if running test has to be stopped.
+	Test is stopped if abort flag is set or if it runs longer than
+	time limit of the device. The first loop of test is never stopped
+	by time limit.
+	\return \a true if test has to be stopped, \a false otherwise.
+*/
+static bool CZCudaCalcDeviceTestBreak(
+	struct CZDeviceInfo *info,	/*!<[in] CUDA-device information. */
+	double startMs,			/*!<[in] Host time the test was started at. */
+	int loop			/*!<[in] Index of loop going to be started. */
+) {
+
+	if((info->abortFlag != NULL) && (*info->abortFlag != 0)) {
+		CZLog(CZLogLevelLow, "Test is aborted on %s.", info->deviceName);
+		return true;
+	}
+
+	if((loop != 0) && (info->timeLimit > 0) && ((CZGetTimeMs() - startMs) >= (double)info->timeLimit)) {
+		CZLog(CZLogLevelLow, "Test is out of time limit on %s.", info->deviceName);
+		return true;
+	}
+
+	return false;
+}
+
+/*!	\brief GPU code filling buffer with pseudo-random pattern.
+*/
+__global__ void CZCudaChecksumKernelFill(
+	unsigned int *buf,		/*!<[out] Buffer. */
+	size_t words,			/*!<[in] Size of buffer in words. */
+	unsigned int seed		/*!<[in] Seed of pattern. */
+) {
+	size_t step = (size_t)gridDim.x * blockDim.x;
+	size_t i;
+
+	for(i = (size_t)blockIdx.x * blockDim.x + threadIdx.x; i < words; i += step) {
+		unsigned int val = (unsigned int)i * 0x9e3779b9u + seed;
+		val ^= val >> 16;
+		val *= 0x85ebca6bu;
+		val ^= val >> 13;
+		buf[i] = val;
+	}
+}
+
+/*!	\brief GPU code calculating checksum of buffer.
+	The sum is the same as CZCpuChecksum() calculates on host. Partial
+	sums of blocks are added to \a sum.
+*/
+__global__ void CZCudaChecksumKernel(
+	const unsigned int *buf,	/*!<[in] Buffer. */
+	size_t words,			/*!<[in] Size of buffer in words. */
+	unsigned long long *sum		/*!<[in,out] Checksum. */
+) {
+	__shared__ unsigned long long part[CZ_CHECKSUM_THREADS_NUM];
+	unsigned long long val = 0;
+	size_t step = (size_t)gridDim.x * blockDim.x;
+	size_t i;
+	int n;
+
+	for(i = (size_t)blockIdx.x * blockDim.x + threadIdx.x; i < words; i += step)
+		val += (unsigned long long)buf[i] * (unsigned int)(2 * i + 1);
+
+	part[threadIdx.x] = val;
+	__syncthreads();
+
+	for(n = blockDim.x / 2; n > 0; n >>= 1) {
+		if(threadIdx.x < n)
+			part[threadIdx.x] += part[threadIdx.x + n];
+		__syncthreads();
+	}
+
+	if(threadIdx.x == 0)
+		atomicAdd(sum, part[0]);
+}
+
+/*!	\brief Calculate checksum of device buffer.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZCudaChecksumDevice(
+	const void *buf,		/*!<[in] Device buffer. */
+	size_t size,			/*!<[in] Size of buffer in bytes. */
+	unsigned long long *sum		/*!<[out] Checksum. */
+) {
+	unsigned long long *devSum;
+
+	CZ_CUDA_CALL(cudaMalloc((void**)&devSum, sizeof(*devSum)),
+		return -1);
+
+	CZ_CUDA_CALL(cudaMemset(devSum, 0, sizeof(*devSum)),
+		cudaFree(devSum);
+		return -1);
+
+	CZCudaChecksumKernel<<<CZ_CHECKSUM_BLOCKS_NUM, CZ_CHECKSUM_THREADS_NUM>>>((const unsigned int*)buf, size / sizeof(unsigned int), devSum);
+
+	CZ_CUDA_CALL(cudaGetLastError(),
+		cudaFree(devSum);
+		return -1);
+
+	CZ_CUDA_CALL(cudaMemcpy(sum, devSum, sizeof(*sum), cudaMemcpyDeviceToHost),
+		cudaFree(devSum);
+		return -1);
+
+	cudaFree(devSum);
+
+	return 0;
+}
+
+/*!	\brief Fill source buffer of transfer test with seeded pattern.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZCudaCalcDeviceBandwidthFill(
+	int mode,			/*!<[in] Bandwidth test mode. */
+	void *memHost,			/*!<[out] Host buffer. */
+	void *memDevice1,		/*!<[out] Device buffer 1. */
+	void *memDevice2,		/*!<[out] Device buffer 2. */
+	size_t size,			/*!<[in] Size of transfer. */
+	unsigned int seed		/*!<[in] Seed of pattern. */
+) {
+
+	switch(mode) {
+	case CZ_COPY_MODE_H2D:
+		CZCpuFillPattern(memHost, size, seed);
+		return 0;
+
+	case CZ_COPY_MODE_D2H:
+		CZCudaChecksumKernelFill<<<CZ_CHECKSUM_BLOCKS_NUM, CZ_CHECKSUM_THREADS_NUM>>>((unsigned int*)memDevice2, size / sizeof(unsigned int), seed);
+		break;
+
+	case CZ_COPY_MODE_D2D:
+		CZCudaChecksumKernelFill<<<CZ_CHECKSUM_BLOCKS_NUM, CZ_CHECKSUM_THREADS_NUM>>>((unsigned int*)memDevice1, size / sizeof(unsigned int), seed);
+		break;
+
+	default: // WTF!
+		return -1;
+	}
+
+	CZ_CUDA_CALL(cudaGetLastError(),
+		return -1);
+
+	CZ_CUDA_CALL(cudaDeviceSynchronize(),
+		return -1);
+
+	return 0;
+}
+
+/*!	\brief Verify destination buffer of transfer test.
+	Checksums of source and destination are compared. Host buffers are
+	summed with SIMD code on host, device buffers with reduction kernel
+	on device. Only the last \a size bytes transfer is checked, it is
+	a prefix of all previous transfers of the test.
+	\return \a 0 if data are intact, \a 1 if data are corrupted,
+	\a -1 in case of error.
+*/
+static int CZCudaCalcDeviceBandwidthVerify(
+	struct CZDeviceInfo *info,	/*!<[in] CUDA-device information. */
+	int mode,			/*!<[in] Bandwidth test mode. */
+	int test,			/*!<[in] Test identifier. See enum #CZTest. */
+	void *memHost,			/*!<[in] Host buffer. */
+	void *memDevice1,		/*!<[in] Device buffer 1. */
+	void *memDevice2,		/*!<[in] Device buffer 2. */
+	size_t size			/*!<[in] Size of the last transfer. */
+) {
+	unsigned long long srcSum = 0;
+	unsigned long long dstSum = 0;
+	double traceUs = CZTraceTimeUs();
+
+	switch(mode) {
+	case CZ_COPY_MODE_H2D:
+		srcSum = CZCpuChecksum(memHost, size);
+		if(CZCudaChecksumDevice(memDevice1, size, &dstSum) != 0)
+			return -1;
+		break;
+
+	case CZ_COPY_MODE_D2H:
+		if(CZCudaChecksumDevice(memDevice2, size, &srcSum) != 0)
+			return -1;
+		dstSum = CZCpuChecksum(memHost, size);
+		break;
+
+	case CZ_COPY_MODE_D2D:
+		if(CZCudaChecksumDevice(memDevice1, size, &srcSum) != 0)
+			return -1;
+		if(CZCudaChecksumDevice(memDevice2, size, &dstSum) != 0)
+			return -1;
+		break;
+
+	default: // WTF!
+		return -1;
+	}
+
+	CZTraceHostSpan("copy", "verify", info->num, traceUs);
+
+	CZLogKV(CZLogLevelLow, "copy-verify", "dev=%d test=0x%x bytes=%lu src=%016llx dst=%016llx",
+		info->num, test, (unsigned long)size, srcSum, dstSum);
+
+	if(srcSum != dstSum) {
+		CZLog(CZLogLevelError, "Data transferred by %s test are corrupted on %s!",
+			CZTestName(test), info->deviceName);
+		return 1;
+	}
+
+	return 0;
+}
+
 /*!	\brief Run data transfer bandwidth tests.
-	\return \a 0 in case of success, \a other is value in KiB/s.
+	Test runs up to \a info->config.copyLoops loops. If time limit of the device
+	is set the size of transfer is reduced after the first loop to fit
+	all loops into the limit. Test marks its result as partial in
+	\a info->partialMask if not all loops were done. If
+	\a info->config.copyVerify is set, source buffer is filled with seeded
+	pattern before timed loops and destination is verified after them.
+	Corrupted data are marked in \a info->corruptMask.
+	\return \a 0 in case of error, \a other is value in KiB/s.
 */
 static float CZCudaCalcDeviceBandwidthTestCommon (
 	struct CZDeviceInfo *info,	/*!<[in,out] CUDA-device information. */
 	int mode,			/*!<[in] Run bandwidth test in one of modes. */
-	int pinned			/*!<[in] Use pinned \a (=1) memory buffer instead of pagable \a (=0). */
+	int pinned,			/*!<[in] Use pinned \a (=1) memory buffer instead of pagable \a (=0). */
+	int test,			/*!<[in] Test identifier. See enum #CZTest. */
+	struct CZDeviceInfoTime *time	/*!<[out] Host side timing of test. */
 ) {
 	CZDeviceInfoBandLocalData *lData;
 	float timeMs = 0.0;
+	double bytes = 0.0;
+	double startMs;
+	double testUs;
 	float bandwidthKiBs = 0.0;
 	cudaEvent_t start;
 	cudaEvent_t stop;
 	void *memHost;
 	void *memDevice1;
 	void *memDevice2;
+	size_t size;
 	int i;
 
 	if(info == NULL)
@@ -980,6 +1325,7 @@ static float CZCudaCalcDeviceBandwidthTestCommon (
 	memHost = pinned? lData->memHostPin: lData->memHostPage;
 	memDevice1 = lData->memDevice1;
 	memDevice2 = lData->memDevice2;
+	size = lData->size;
 
 	CZLog(CZLogLevelLow, "Starting %s test (%s) on %s.",
 		(mode == CZ_COPY_MODE_H2D)? "host to device":
@@ -988,9 +1334,33 @@ static float CZCudaCalcDeviceBandwidthTestCommon (
 		pinned? "pinned": "pageable",
 		info->deviceName);
 
-	for(i = 0; i < CZ_COPY_LOOPS_NUM; i++) {
+	if(info->config.copyVerify) {
+		if(CZCudaCalcDeviceBandwidthFill(mode, memHost, memDevice1, memDevice2, size,
+			(unsigned int)test * 0x9e3779b9u + (unsigned int)CZGetTimeMs()) != 0) {
+			cudaEventDestroy(start);
+			cudaEventDestroy(stop);
+			return 0;
+		}
+	}
+
+	startMs = CZGetTimeMs();
+	testUs = CZTraceTimeUs();
+
+	for(i = 0; i < info->config.copyLoops; i++) {
 
 		float loopMs = 0.0;
+		double loopUs;
+		double wallMs;
+		double cpuMs;
+
+		if(CZCudaCalcDeviceTestBreak(info, startMs, i)) {
+			info->partialMask |= test;
+			break;
+		}
+
+		loopUs = CZTraceTimeUs();
+		wallMs = CZGetTimeMs();
+		cpuMs = CZCpuThreadTimeMs();
 
 		CZ_CUDA_CALL(cudaEventRecord(start, 0),
 			cudaEventDestroy(start);
@@ -999,21 +1369,21 @@ static float CZCudaCalcDeviceBandwidthTestCommon (
 
 		switch(mode) {
 		case CZ_COPY_MODE_H2D:
-			CZ_CUDA_CALL(cudaMemcpy(memDevice1, memHost, CZ_COPY_BUF_SIZE, cudaMemcpyHostToDevice),
+			CZ_CUDA_CALL(cudaMemcpy(memDevice1, memHost, size, cudaMemcpyHostToDevice),
 				cudaEventDestroy(start);
 				cudaEventDestroy(stop);
 				return 0);
 			break;
 
 		case CZ_COPY_MODE_D2H:
-			CZ_CUDA_CALL(cudaMemcpy(memHost, memDevice2, CZ_COPY_BUF_SIZE, cudaMemcpyDeviceToHost),
+			CZ_CUDA_CALL(cudaMemcpy(memHost, memDevice2, size, cudaMemcpyDeviceToHost),
 				cudaEventDestroy(start);
 				cudaEventDestroy(stop);
 				return 0);
 			break;
 
 		case CZ_COPY_MODE_D2D:
-			CZ_CUDA_CALL(cudaMemcpy(memDevice2, memDevice1, CZ_COPY_BUF_SIZE, cudaMemcpyDeviceToDevice),
+			CZ_CUDA_CALL(cudaMemcpy(memDevice2, memDevice1, size, cudaMemcpyDeviceToDevice),
 				cudaEventDestroy(start);
 				cudaEventDestroy(stop);
 				return 0);
@@ -1040,19 +1410,61 @@ static float CZCudaCalcDeviceBandwidthTestCommon (
 			cudaEventDestroy(stop);
 			return 0);
 
+		wallMs = CZGetTimeMs() - wallMs;
+		cpuMs = CZCpuThreadTimeMs() - cpuMs;
+
 		timeMs += loopMs;
+		bytes += (double)size;
+
+		time->deviceMs += loopMs;
+		time->wallMs += (float)wallMs;
+		time->cpuMs += (float)cpuMs;
+		time->amount += (double)size;
+
+		CZTraceHostSpan("copy", CZTestName(test), info->num, loopUs);
+		CZTraceDeviceSpan("copy", CZTestName(test), info->num, loopUs, loopMs * 1000.0);
+
+		CZLogKV(CZLogLevelLow, "copy-loop", "dev=%d test=0x%x loop=%d bytes=%lu ms=%f",
+			info->num, test, i, (unsigned long)size, loopMs);
+
+		if((i == 0) && (info->timeLimit > 0)) {
+			double loopLimitMs = (double)info->timeLimit / info->config.copyLoops;
+			double hostMs = CZGetTimeMs() - startMs;
+			if(hostMs > loopLimitMs) {
+				size = (size_t)((double)size * loopLimitMs / hostMs);
+				size &= ~((size_t)CZ_COPY_BUF_SIZE_MIN - 1);
+				if(size < CZ_COPY_BUF_SIZE_MIN)
+					size = CZ_COPY_BUF_SIZE_MIN;
+				CZLog(CZLogLevelLow, "Transfer size is reduced to %d bytes.", (int)size);
+			}
+		}
 	}
 
-	CZLog(CZLogLevelLow, "Test complete in %f ms.", timeMs);
+	CZTraceHostSpan("copy", "test", info->num, testUs);
+
+	CZLog(CZLogLevelLow, "Test complete in %f ms (%d loops).", timeMs, i);
+	CZLog(CZLogLevelLow, "Host wall time %f ms, CPU time %f ms.", time->wallMs, time->cpuMs);
+
+	if(info->config.copyVerify && (i != 0)) {
+		int r = CZCudaCalcDeviceBandwidthVerify(info, mode, test, memHost, memDevice1, memDevice2, size);
+		if(r == 1)
+			info->corruptMask |= test;
+		if(r == -1) {
+			cudaEventDestroy(start);
+			cudaEventDestroy(stop);
+			return 0;
+		}
+	}
 
-	bandwidthKiBs = (
-		1000 *
-		(float)CZ_COPY_BUF_SIZE *
-		(float)CZ_COPY_LOOPS_NUM
-	) / (
-		timeMs *
-		(float)(1 << 10)
-	);
+	if(timeMs != 0) {
+		bandwidthKiBs = (
+			1000 *
+			(float)bytes
+		) / (
+			timeMs *
+			(float)(1 << 10)
+		);
+	}
 
 	cudaEventDestroy(start);
 	cudaEventDestroy(stop);
@@ -1060,113 +1472,969 @@ static float CZCudaCalcDeviceBandwidthTestCommon (
 	return bandwidthKiBs;
 }
 
-/*!	\brief Run several bandwidth tests.
-	\return \a 0 in case of success, \a -1 in case of error.
+/*!	\brief Measure host pinned copy rate for one transfer size.
+	Transfer is repeated to move about #CZ_SWEEP_BYTES bytes, so rates
+	of small transfers include their launch latency.
+	\return \a 0 in case of error, \a other is value in KiB/s.
 */
-static int CZCudaCalcDeviceBandwidthTest(
-	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
+static float CZCudaCalcDeviceBandwidthSize(
+	struct CZDeviceInfo *info,	/*!<[in,out] CUDA-device information. */
+	int mode,			/*!<[in] Run bandwidth test in one of modes. */
+	size_t size,			/*!<[in] Transfer size in bytes. */
+	cudaEvent_t start,		/*!<[in] Start event. */
+	cudaEvent_t stop		/*!<[in] Stop event. */
 ) {
+	CZDeviceInfoBandLocalData *lData = (CZDeviceInfoBandLocalData*)info->band.localData;
+	float timeMs = 0.0;
+	int reps = (int)(CZ_SWEEP_BYTES / size);
+	int i;
 
-	info->band.copyHDPage = CZCudaCalcDeviceBandwidthTestCommon(info, CZ_COPY_MODE_H2D, 0);
-	info->band.copyHDPin = CZCudaCalcDeviceBandwidthTestCommon(info, CZ_COPY_MODE_H2D, 1);
-	info->band.copyDHPage = CZCudaCalcDeviceBandwidthTestCommon(info, CZ_COPY_MODE_D2H, 0);
-	info->band.copyDHPin = CZCudaCalcDeviceBandwidthTestCommon(info, CZ_COPY_MODE_D2H, 1);
-	info->band.copyDD = CZCudaCalcDeviceBandwidthTestCommon(info, CZ_COPY_MODE_D2D, 0);
+	if(reps < 1)
+		reps = 1;
+	if(reps > CZ_SWEEP_REPS_MAX)
+		reps = CZ_SWEEP_REPS_MAX;
 
-	return 0;
-}
+	CZ_CUDA_CALL(cudaEventRecord(start, 0),
+		return 0);
 
-/*!	\brief Prepare buffers bandwidth tests.
-	\return \a 0 in case of success, \a -1 in case of error.
-*/
-int CZCudaPrepareDevice(
-	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
-) {
+	for(i = 0; i < reps; i++) {
+		if(mode == CZ_COPY_MODE_H2D) {
+			CZ_CUDA_CALL(cudaMemcpy(lData->memDevice1, lData->memHostPin, size, cudaMemcpyHostToDevice),
+				return 0);
+		} else {
+			CZ_CUDA_CALL(cudaMemcpy(lData->memHostPin, lData->memDevice2, size, cudaMemcpyDeviceToHost),
+				return 0);
+		}
+	}
 
-	if(info == NULL)
-		return -1;
+	CZ_CUDA_CALL(cudaEventRecord(stop, 0),
+		return 0);
 
-	if(!CZCudaIsInit())
-		return -1;
+	CZ_CUDA_CALL(cudaEventSynchronize(stop),
+		return 0);
 
-	if(CZCudaCalcDeviceBandwidthAlloc(info) != 0)
-		return -1;
+	CZ_CUDA_CALL(cudaEventElapsedTime(&timeMs, start, stop),
+		return 0);
 
-	return 0;
+	if(timeMs == 0)
+		return 0;
+
+	return (float)((1000.0 * (double)size * reps) / ((double)timeMs * (double)(1 << 10)));
 }
 
-/*!	\brief Calculate bandwidth information about CUDA-device.
+/*!	\brief Measure host pinned copy rates versus transfer size.
+	Sizes grow twice from #CZ_SWEEP_SIZE_MIN up to transfer buffer size.
+	Sweep is stopped by abort flag and time limit like other tests.
 	\return \a 0 in case of success, \a -1 in case of error.
 */
-int CZCudaCalcDeviceBandwidth(
+static int CZCudaCalcDeviceBandwidthSweep(
 	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
 ) {
+	CZDeviceInfoBandLocalData *lData = (CZDeviceInfoBandLocalData*)info->band.localData;
+	struct CZDeviceInfoSweep *sweep = &info->band.sweep;
+	cudaEvent_t start;
+	cudaEvent_t stop;
+	double startMs;
+	double testUs;
+	size_t size;
+	int i;
 
-	if(info == NULL)
-		return -1;
+	CZ_CUDA_CALL(cudaEventCreate(&start),
+		return -1);
 
-	if(CZCudaCalcDeviceBandwidthReset(info) != 0)
-		return -1;
+	CZ_CUDA_CALL(cudaEventCreate(&stop),
+		cudaEventDestroy(start);
+		return -1);
 
-	if(!CZCudaIsInit())
-		return -1;
+	CZLog(CZLogLevelLow, "Starting copy sweep on %s.", info->deviceName);
 
-	if(CZCudaCalcDeviceBandwidthAlloc(info) != 0)
-		return -1;
+	startMs = CZGetTimeMs();
+	testUs = CZTraceTimeUs();
 
-	if(CZCudaCalcDeviceBandwidthTest(info) != 0)
-		return -1;
+	for(i = 0, size = CZ_SWEEP_SIZE_MIN; (i < CZ_SWEEP_POINTS_MAX) && (size <= lData->size); i++, size *= 2) {
+
+		if(CZCudaCalcDeviceTestBreak(info, startMs, i)) {
+			info->partialMask |= CZTestCopySweep;
+			break;
+		}
+
+		sweep->size[i] = (double)size;
+		sweep->copyHDPin[i] = CZCudaCalcDeviceBandwidthSize(info, CZ_COPY_MODE_H2D, size, start, stop);
+		sweep->copyDHPin[i] = CZCudaCalcDeviceBandwidthSize(info, CZ_COPY_MODE_D2H, size, start, stop);
+		sweep->num = i + 1;
+
+		CZLogKV(CZLogLevelLow, "copy-sweep", "dev=%d bytes=%lu hd_kibs=%f dh_kibs=%f",
+			info->num, (unsigned long)size, sweep->copyHDPin[i], sweep->copyDHPin[i]);
+	}
+
+	CZTraceHostSpan("copy", "sweep", info->num, testUs);
+
+	cudaEventDestroy(start);
+	cudaEventDestroy(stop);
 
 	return 0;
 }
 
-/*!	\brief Cleanup after test and bandwidth calculations.
+/*!	\brief Ring of pinned chunks of staged transfer.
+*/
+struct CZStageRing {
+	void		*chunk[CZ_STAGE_DEPTHS_MAX];	/*!< Pinned chunks. */
+	cudaEvent_t	ready[CZ_STAGE_DEPTHS_MAX];	/*!< Events of the last copy of each chunk. */
+	cudaStream_t	stream;			/*!< Stream of chunk copies. */
+};
+
+/*!	\brief Free ring of pinned chunks.
+*/
+static void CZCudaStageRingFree(
+	struct CZStageRing *ring	/*!<[in,out] Ring of pinned chunks. */
+) {
+	int i;
+
+	for(i = 0; i < CZ_STAGE_DEPTHS_MAX; i++) {
+		if(ring->chunk[i] != NULL)
+			cudaFreeHost(ring->chunk[i]);
+		if(ring->ready[i] != NULL)
+			cudaEventDestroy(ring->ready[i]);
+	}
+	if(ring->stream != NULL)
+		cudaStreamDestroy(ring->stream);
+	memset(ring, 0, sizeof(*ring));
+}
+
+/*!	\brief Allocate ring of pinned chunks.
 	\return \a 0 in case of success, \a -1 in case of error.
 */
-int CZCudaCleanDevice(
-	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
+static int CZCudaStageRingAlloc(
+	struct CZStageRing *ring,	/*!<[out] Ring of pinned chunks. */
+	int depth,			/*!<[in] Number of chunks. */
+	size_t chunk			/*!<[in] Size of chunk. */
 ) {
+	int i;
 
-	if(info == NULL)
-		return -1;
+	memset(ring, 0, sizeof(*ring));
 
-	if(CZCudaCalcDeviceBandwidthFree(info) != 0)
-		return -1;
+	for(i = 0; i < depth; i++) {
+		CZ_CUDA_CALL(cudaMallocHost(&ring->chunk[i], chunk),
+			CZCudaStageRingFree(ring);
+			return -1);
+
+		CZ_CUDA_CALL(cudaEventCreateWithFlags(&ring->ready[i], cudaEventDisableTiming),
+			CZCudaStageRingFree(ring);
+			return -1);
+	}
+
+	CZ_CUDA_CALL(cudaStreamCreate(&ring->stream),
+		CZCudaStageRingFree(ring);
+		return -1);
 
 	return 0;
 }
 
-/*!	\brief Reset results of preformance calculations.
+/*!	\brief Queue copy of one chunk from device to pinned chunk of ring.
 	\return \a 0 in case of success, \a -1 in case of error.
 */
-static int CZCudaCalcDevicePerformanceReset(
-	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
+static int CZCudaStageFetch(
+	struct CZStageRing *ring,	/*!<[in,out] Ring of pinned chunks. */
+	int slot,			/*!<[in] Index of pinned chunk. */
+	const void *memDevice,		/*!<[in] Device buffer. */
+	size_t offset,			/*!<[in] Offset of chunk in buffer. */
+	size_t size			/*!<[in] Size of chunk. */
 ) {
 
-	if(info == NULL)
-		return -1;
+	CZ_CUDA_CALL(cudaMemcpyAsync(ring->chunk[slot], (const char*)memDevice + offset, size, cudaMemcpyDeviceToHost, ring->stream),
+		return -1);
 
-	info->perf.calcFloat = 0;
-	info->perf.calcDouble = 0;
-	info->perf.calcInteger32 = 0;
-	info->perf.calcInteger24 = 0;
-	info->perf.calcInteger64 = 0;
+	CZ_CUDA_CALL(cudaEventRecord(ring->ready[slot], ring->stream),
+		return -1);
 
 	return 0;
 }
 
-/*!	\brief 16 MAD instructions for float point test.
+/*!	\brief Copy pageable buffer through ring of pinned chunks.
+	Host copy of a chunk waits only for the copy which used the same
+	pinned chunk \a depth chunks ago.
+	\return \a 0 in case of success, \a -1 in case of error.
 */
-#define CZ_CALC_FMAD_16(a, b) \
-	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
-	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
-	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
-	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
+static int CZCudaStageCopy(
+	struct CZStageRing *ring,	/*!<[in,out] Ring of pinned chunks. */
+	int depth,			/*!<[in] Number of pinned chunks used. */
+	size_t chunk,			/*!<[in] Size of chunk. */
+	int mode,			/*!<[in] Copy mode, #CZ_COPY_MODE_H2D or #CZ_COPY_MODE_D2H. */
+	void *memPage,			/*!<[in,out] Pageable host buffer. */
+	void *memDevice,		/*!<[in,out] Device buffer. */
+	size_t size			/*!<[in] Size of buffers. */
+) {
+	size_t num = (size + chunk - 1) / chunk;
+	size_t k;
 
-/*!	\brief 256 MAD instructions for float point test.
-*/
-#define CZ_CALC_FMAD_256(a, b) \
-	CZ_CALC_FMAD_16(a, b) CZ_CALC_FMAD_16(a, b) \
+	if(mode == CZ_COPY_MODE_D2H) {
+		for(k = 0; (k < num) && (k < (size_t)depth); k++) {
+			if(CZCudaStageFetch(ring, (int)k, memDevice, k * chunk, (size - k * chunk < chunk)? size - k * chunk: chunk) != 0)
+				return -1;
+		}
+	}
+
+	for(k = 0; k < num; k++) {
+		int slot = (int)(k % depth);
+		size_t offset = k * chunk;
+		size_t n = (size - offset < chunk)? size - offset: chunk;
+
+		if(mode == CZ_COPY_MODE_H2D) {
+			if(k >= (size_t)depth) {
+				CZ_CUDA_CALL(cudaEventSynchronize(ring->ready[slot]),
+					return -1);
+			}
+
+			memcpy(ring->chunk[slot], (char*)memPage + offset, n);
+
+			CZ_CUDA_CALL(cudaMemcpyAsync((char*)memDevice + offset, ring->chunk[slot], n, cudaMemcpyHostToDevice, ring->stream),
+				return -1);
+
+			CZ_CUDA_CALL(cudaEventRecord(ring->ready[slot], ring->stream),
+				return -1);
+		} else {
+			size_t next = k + depth;
+
+			CZ_CUDA_CALL(cudaEventSynchronize(ring->ready[slot]),
+				return -1);
+
+			memcpy((char*)memPage + offset, ring->chunk[slot], n);
+
+			if(next < num) {
+				if(CZCudaStageFetch(ring, slot, memDevice, next * chunk, (size - next * chunk < chunk)? size - next * chunk: chunk) != 0)
+					return -1;
+			}
+		}
+	}
+
+	CZ_CUDA_CALL(cudaStreamSynchronize(ring->stream),
+		return -1);
+
+	return 0;
+}
+
+/*!	\brief Measure copy rate of pageable buffer.
+	Buffer is copied directly if \a depth is \a 0, through \a depth
+	pinned chunks of \a ring otherwise. Direct copy from pinned buffer is
+	measured if \a ring is \a NULL. Host wall time is measured because
+	staged copy includes host memcpy. The best of #CZ_STAGE_REPS runs is
+	taken.
+	\return \a 0 in case of error, \a other is value in KiB/s.
+*/
+static float CZCudaCalcDeviceStagedRate(
+	struct CZDeviceInfo *info,	/*!<[in] CUDA-device information. */
+	int mode,			/*!<[in] Copy mode, #CZ_COPY_MODE_H2D or #CZ_COPY_MODE_D2H. */
+	struct CZStageRing *ring,	/*!<[in,out] Ring of pinned chunks. */
+	int depth,			/*!<[in] Number of pinned chunks used. */
+	size_t chunk			/*!<[in] Size of chunk. */
+) {
+	CZDeviceInfoBandLocalData *lData = (CZDeviceInfoBandLocalData*)info->band.localData;
+	void *memHost = (ring == NULL)? lData->memHostPin: lData->memHostPage;
+	size_t size = lData->size;
+	float best = 0;
+	int i;
+
+	for(i = 0; i < CZ_STAGE_REPS; i++) {
+		double timeMs = CZGetTimeMs();
+
+		if((ring != NULL) && (depth != 0)) {
+			if(CZCudaStageCopy(ring, depth, chunk, mode, memHost, lData->memDevice1, size) != 0)
+				return 0;
+		} else if(mode == CZ_COPY_MODE_H2D) {
+			CZ_CUDA_CALL(cudaMemcpy(lData->memDevice1, memHost, size, cudaMemcpyHostToDevice),
+				return 0);
+		} else {
+			CZ_CUDA_CALL(cudaMemcpy(memHost, lData->memDevice1, size, cudaMemcpyDeviceToHost),
+				return 0);
+		}
+
+		timeMs = CZGetTimeMs() - timeMs;
+		if(timeMs > 0) {
+			float rate = (float)((1000.0 * (double)size) / (timeMs * (double)(1 << 10)));
+			if(rate > best)
+				best = rate;
+		}
+	}
+
+	return best;
+}
+
+/*!	\brief Study pageable copy staged through pinned chunks.
+	Chunk sizes grow twice from \a info->config.stageChunkMin up to
+	\a info->config.stageChunkMax or transfer buffer size, pipeline depth
+	grows from 1 to \a info->config.stageDepth. Direct pageable and
+	pinned copies of the same buffer are measured for comparison. Study
+	is stopped by abort flag and time limit like other tests.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZCudaCalcDeviceBandwidthStaged(
+	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
+) {
+	CZDeviceInfoBandLocalData *lData = (CZDeviceInfoBandLocalData*)info->band.localData;
+	struct CZDeviceInfoStaged *staged = &info->band.staged;
+	struct CZStageRing ring;
+	size_t chunkMin = (size_t)info->config.stageChunkMin;
+	size_t chunkMax = (size_t)info->config.stageChunkMax;
+	int depthMax = info->config.stageDepth;
+	double startMs;
+	double testUs;
+	size_t chunk;
+	int i;
+	int d;
+
+	if(chunkMax > lData->size)
+		chunkMax = lData->size;
+	if(chunkMin > chunkMax)
+		chunkMin = chunkMax;
+	if(depthMax < 1)
+		depthMax = 1;
+	if(depthMax > CZ_STAGE_DEPTHS_MAX)
+		depthMax = CZ_STAGE_DEPTHS_MAX;
+
+	if(CZCudaStageRingAlloc(&ring, depthMax, chunkMax) != 0)
+		return -1;
+
+	CZLog(CZLogLevelLow, "Starting staged copy study on %s.", info->deviceName);
+
+	startMs = CZGetTimeMs();
+	testUs = CZTraceTimeUs();
+
+	staged->pageHD = CZCudaCalcDeviceStagedRate(info, CZ_COPY_MODE_H2D, &ring, 0, 0);
+	staged->pageDH = CZCudaCalcDeviceStagedRate(info, CZ_COPY_MODE_D2H, &ring, 0, 0);
+	staged->pinHD = CZCudaCalcDeviceStagedRate(info, CZ_COPY_MODE_H2D, NULL, 0, 0);
+	staged->pinDH = CZCudaCalcDeviceStagedRate(info, CZ_COPY_MODE_D2H, NULL, 0, 0);
+	staged->numDepths = depthMax;
+	staged->bestHD[1] = 1;
+	staged->bestDH[1] = 1;
+
+	for(i = 0, chunk = chunkMin; (i < CZ_STAGE_CHUNKS_MAX) && (chunk <= chunkMax); i++, chunk *= 2) {
+
+		if(CZCudaCalcDeviceTestBreak(info, startMs, i)) {
+			info->partialMask |= CZTestCopyStaged;
+			break;
+		}
+
+		staged->chunk[i] = (double)chunk;
+
+		for(d = 1; d <= depthMax; d++) {
+			staged->copyHD[i][d - 1] = CZCudaCalcDeviceStagedRate(info, CZ_COPY_MODE_H2D, &ring, d, chunk);
+			staged->copyDH[i][d - 1] = CZCudaCalcDeviceStagedRate(info, CZ_COPY_MODE_D2H, &ring, d, chunk);
+
+			if(staged->copyHD[i][d - 1] > staged->copyHD[staged->bestHD[0]][staged->bestHD[1] - 1]) {
+				staged->bestHD[0] = i;
+				staged->bestHD[1] = d;
+			}
+			if(staged->copyDH[i][d - 1] > staged->copyDH[staged->bestDH[0]][staged->bestDH[1] - 1]) {
+				staged->bestDH[0] = i;
+				staged->bestDH[1] = d;
+			}
+
+			CZLogKV(CZLogLevelLow, "copy-staged", "dev=%d chunk=%lu depth=%d hd_kibs=%f dh_kibs=%f",
+				info->num, (unsigned long)chunk, d, staged->copyHD[i][d - 1], staged->copyDH[i][d - 1]);
+		}
+
+		staged->numChunks = i + 1;
+	}
+
+	CZTraceHostSpan("copy", "staged", info->num, testUs);
+
+	CZCudaStageRingFree(&ring);
+
+	if(staged->numChunks != 0) {
+		CZLogKV(CZLogLevelModerate, "copy-staged-best", "dev=%d hd_chunk=%.0f hd_depth=%d hd_kibs=%f hd_page_kibs=%f hd_pin_kibs=%f dh_chunk=%.0f dh_depth=%d dh_kibs=%f dh_page_kibs=%f dh_pin_kibs=%f",
+			info->num,
+			staged->chunk[staged->bestHD[0]], staged->bestHD[1], staged->copyHD[staged->bestHD[0]][staged->bestHD[1] - 1],
+			staged->pageHD, staged->pinHD,
+			staged->chunk[staged->bestDH[0]], staged->bestDH[1], staged->copyDH[staged->bestDH[0]][staged->bestDH[1] - 1],
+			staged->pageDH, staged->pinDH);
+	}
+
+	return 0;
+}
+
+/*!	\brief Copy host buffer of one memory policy.
+	Buffer is allocated, copied up to \a info->config.copyLoops times and
+	freed. Page faults and TLB misses are counted around copies only.
+	Host wall time is measured because page faults are served on host.
+	\return \a 0 in case of success, \a 1 if policy is not supported,
+	\a -1 in case of error.
+*/
+static int CZCudaCalcDeviceHostMemCopy(
+	struct CZDeviceInfo *info,	/*!<[in,out] CUDA-device information. */
+	int mode,			/*!<[in] Copy mode, #CZ_COPY_MODE_H2D or #CZ_COPY_MODE_D2H. */
+	int policy,			/*!<[in] Memory policy. See enum #CZHostMemPolicy. */
+	struct CZDeviceInfoHostMemStat *stat	/*!<[in,out] Results of policy. */
+) {
+	CZDeviceInfoBandLocalData *lData = (CZDeviceInfoBandLocalData*)info->band.localData;
+	struct CZHostMemCount count;
+	struct CZHostMem mem;
+	double totalMs = 0;
+	double bytes = 0;
+	double startMs;
+	void *counter;
+	float first = 0;
+	float rate = 0;
+	int i;
+
+	startMs = CZGetTimeMs();
+	if(CZHostMemAlloc(&mem, lData->size, policy) != 0)
+		return 1;
+	stat->prepareMs += (float)(CZGetTimeMs() - startMs);
+
+	counter = CZHostMemCountStart();
+
+	for(i = 0; i < info->config.copyLoops; i++) {
+		double timeMs = CZGetTimeMs();
+
+		if(mode == CZ_COPY_MODE_H2D) {
+			CZ_CUDA_CALL(cudaMemcpy(lData->memDevice1, mem.ptr, mem.size, cudaMemcpyHostToDevice),
+				CZHostMemCountStop(counter, &count);
+				CZHostMemFree(&mem);
+				return -1);
+		} else {
+			CZ_CUDA_CALL(cudaMemcpy(mem.ptr, lData->memDevice1, mem.size, cudaMemcpyDeviceToHost),
+				CZHostMemCountStop(counter, &count);
+				CZHostMemFree(&mem);
+				return -1);
+		}
+
+		timeMs = CZGetTimeMs() - timeMs;
+		if((i == 0) && (timeMs > 0))
+			first = (float)((1000.0 * (double)mem.size) / (timeMs * (double)(1 << 10)));
+		totalMs += timeMs;
+		bytes += (double)mem.size;
+	}
+
+	CZHostMemCountStop(counter, &count);
+	CZHostMemFree(&mem);
+
+	if(totalMs > 0)
+		rate = (float)((1000.0 * bytes) / (totalMs * (double)(1 << 10)));
+
+	if(mode == CZ_COPY_MODE_H2D) {
+		stat->firstHD = first;
+		stat->copyHD = rate;
+	} else {
+		stat->firstDH = first;
+		stat->copyDH = rate;
+	}
+
+	if((count.minorFaults < 0) || (stat->minorFaults < 0)) {
+		stat->minorFaults = -1;
+		stat->majorFaults = -1;
+	} else {
+		stat->minorFaults += count.minorFaults;
+		stat->majorFaults += count.majorFaults;
+	}
+	if((count.tlbMisses < 0) || (stat->tlbMisses < 0))
+		stat->tlbMisses = -1;
+	else
+		stat->tlbMisses += count.tlbMisses;
+
+	return 0;
+}
+
+/*!	\brief Study pageable copy versus host memory policy.
+	Fresh host buffer of each policy is copied to and from device, so the
+	first copy shows page fault cost and the average shows steady rate.
+	Policies are ranked by average rate. Study is stopped by abort flag
+	and time limit like other tests.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZCudaCalcDeviceBandwidthHostMem(
+	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
+) {
+	struct CZDeviceInfoHostMem *hostMem = &info->band.hostMem;
+	double startMs;
+	double testUs;
+	int policy;
+
+	CZLog(CZLogLevelLow, "Starting host memory policy study on %s.", info->deviceName);
+
+	startMs = CZGetTimeMs();
+	testUs = CZTraceTimeUs();
+
+	hostMem->bestHD = -1;
+	hostMem->bestDH = -1;
+
+	for(policy = 0; policy < CZHostMemPolicyNum; policy++) {
+		struct CZDeviceInfoHostMemStat *stat = &hostMem->stat[policy];
+		double policyUs = CZTraceTimeUs();
+		int r;
+
+		if(CZCudaCalcDeviceTestBreak(info, startMs, policy)) {
+			info->partialMask |= CZTestCopyHostMem;
+			break;
+		}
+
+		r = CZCudaCalcDeviceHostMemCopy(info, CZ_COPY_MODE_H2D, policy, stat);
+		if(r == 0)
+			r = CZCudaCalcDeviceHostMemCopy(info, CZ_COPY_MODE_D2H, policy, stat);
+		if(r == -1)
+			return -1;
+		if(r == 1) {
+			memset(stat, 0, sizeof(*stat));
+			continue;
+		}
+
+		stat->valid = 1;
+
+		if((hostMem->bestHD == -1) || (stat->copyHD > hostMem->stat[hostMem->bestHD].copyHD))
+			hostMem->bestHD = policy;
+		if((hostMem->bestDH == -1) || (stat->copyDH > hostMem->stat[hostMem->bestDH].copyDH))
+			hostMem->bestDH = policy;
+
+		CZTraceHostSpan("copy", CZHostMemPolicyName(policy), info->num, policyUs);
+
+		CZLogKV(CZLogLevelLow, "copy-hostmem", "dev=%d policy=%s prepare_ms=%f hd_first_kibs=%f hd_kibs=%f dh_first_kibs=%f dh_kibs=%f minor_faults=%.0f major_faults=%.0f tlb_misses=%.0f",
+			info->num, CZHostMemPolicyName(policy), stat->prepareMs,
+			stat->firstHD, stat->copyHD, stat->firstDH, stat->copyDH,
+			stat->minorFaults, stat->majorFaults, stat->tlbMisses);
+	}
+
+	CZTraceHostSpan("copy", "hostmem", info->num, testUs);
+
+	if((hostMem->bestHD != -1) && (hostMem->bestDH != -1)) {
+		CZLogKV(CZLogLevelModerate, "copy-hostmem-best", "dev=%d hd_policy=%s hd_kibs=%f dh_policy=%s dh_kibs=%f",
+			info->num,
+			CZHostMemPolicyName(hostMem->bestHD), hostMem->stat[hostMem->bestHD].copyHD,
+			CZHostMemPolicyName(hostMem->bestDH), hostMem->stat[hostMem->bestDH].copyDH);
+	}
+
+	return 0;
+}
+
+/*!	\brief Run data transfer bandwidth test with telemetry sampling.
+	\return \a 0 in case of error, \a other is value in KiB/s.
+*/
+static float CZCudaCalcDeviceBandwidthTestSampled(
+	struct CZDeviceInfo *info,	/*!<[in,out] CUDA-device information. */
+	int mode,			/*!<[in] Run bandwidth test in one of modes. */
+	int pinned,			/*!<[in] Use pinned \a (=1) memory buffer instead of pagable \a (=0). */
+	int test,			/*!<[in] Test identifier. See enum #CZTest. */
+	struct CZDeviceInfoTime *time	/*!<[out] Host side timing of test. */
+) {
+	void *sampler = CZNvmlSampleStart(info);
+	float bandwidthKiBs = CZCudaCalcDeviceBandwidthTestCommon(info, mode, pinned, test, time);
+	CZNvmlSampleStop(sampler, &time->tele);
+	return bandwidthKiBs;
+}
+
+/*!	\brief Run bandwidth tests selected in \a info->testMask.
+	\return \a 0 in case of success, \a -1 in case of error or if
+	transferred data were corrupted.
+*/
+static int CZCudaCalcDeviceBandwidthTest(
+	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
+) {
+
+	if(info->testMask & CZTestCopyHDPage)
+		info->band.copyHDPage = CZCudaCalcDeviceBandwidthTestSampled(info, CZ_COPY_MODE_H2D, 0, CZTestCopyHDPage, &info->band.copyHDPageTime);
+	if(info->testMask & CZTestCopyHDPin)
+		info->band.copyHDPin = CZCudaCalcDeviceBandwidthTestSampled(info, CZ_COPY_MODE_H2D, 1, CZTestCopyHDPin, &info->band.copyHDPinTime);
+	if(info->testMask & CZTestCopyDHPage)
+		info->band.copyDHPage = CZCudaCalcDeviceBandwidthTestSampled(info, CZ_COPY_MODE_D2H, 0, CZTestCopyDHPage, &info->band.copyDHPageTime);
+	if(info->testMask & CZTestCopyDHPin)
+		info->band.copyDHPin = CZCudaCalcDeviceBandwidthTestSampled(info, CZ_COPY_MODE_D2H, 1, CZTestCopyDHPin, &info->band.copyDHPinTime);
+	if(info->testMask & CZTestCopyDD)
+		info->band.copyDD = CZCudaCalcDeviceBandwidthTestSampled(info, CZ_COPY_MODE_D2D, 0, CZTestCopyDD, &info->band.copyDDTime);
+	if(info->testMask & CZTestCopySweep)
+		CZCudaCalcDeviceBandwidthSweep(info);
+	if(info->testMask & CZTestCopyStaged)
+		CZCudaCalcDeviceBandwidthStaged(info);
+	if(info->testMask & CZTestCopyHostMem)
+		CZCudaCalcDeviceBandwidthHostMem(info);
+
+	if(info->corruptMask & CZTestCopyAll)
+		return -1;
+
+	return 0;
+}
+
+/*!	\brief Prepare buffers bandwidth tests.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZCudaPrepareDevice(
+	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
+) {
+
+	if(info == NULL)
+		return -1;
+
+	if(!CZCudaIsInit())
+		return -1;
+
+	if(CZCudaCalcDeviceBandwidthAlloc(info) != 0)
+		return -1;
+
+	return 0;
+}
+
+/*!	\brief Calculate bandwidth information about CUDA-device.
+	Only tests selected in \a info->testMask are run, results of other
+	tests are reset to \a 0.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZCudaCalcDeviceBandwidth(
+	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
+) {
+
+	if(info == NULL)
+		return -1;
+
+	if(CZCudaCalcDeviceBandwidthReset(info) != 0)
+		return -1;
+
+	if((info->testMask & (CZTestCopyAll | CZTestCopySweep | CZTestCopyStaged | CZTestCopyHostMem)) == 0)
+		return 0;
+
+	if(!CZCudaIsInit())
+		return -1;
+
+	if(CZCudaCalcDeviceBandwidthAlloc(info) != 0)
+		return -1;
+
+	if(CZCudaCalcDeviceBandwidthTest(info) != 0)
+		return -1;
+
+	return 0;
+}
+
+/*!	\brief Cleanup after test and bandwidth calculations.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZCudaCleanDevice(
+	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
+) {
+
+	if(info == NULL)
+		return -1;
+
+	if(CZCudaCalcDeviceBandwidthFree(info) != 0)
+		return -1;
+
+	return 0;
+}
+
+/*!	\brief Buffers of aggregate bandwidth test on one device.
+*/
+struct CZAggregateLocalData {
+	int		num;			/*!< Device index. */
+	size_t		size;			/*!< Size of each buffer. */
+	void		*memHostHD;		/*!< Pinned source of host to device copies. */
+	void		*memHostDH;		/*!< Pinned target of device to host copies. */
+	void		*memDeviceHD;		/*!< Device target of host to device copies. */
+	void		*memDeviceDH;		/*!< Device source of device to host copies. */
+	cudaStream_t	streamHD;		/*!< Stream of host to device copies. */
+	cudaStream_t	streamDH;		/*!< Stream of device to host copies. */
+};
+
+/*!	\brief Free buffers of aggregate bandwidth test.
+*/
+void CZCudaAggregateFree(
+	void *data			/*!<[in,out] Buffers returned by CZCudaAggregateAlloc(). */
+) {
+	struct CZAggregateLocalData *aData = (struct CZAggregateLocalData*)data;
+
+	if(aData == NULL)
+		return;
+
+	cudaSetDevice(aData->num);
+
+	if(aData->streamHD != NULL)
+		cudaStreamDestroy(aData->streamHD);
+	if(aData->streamDH != NULL)
+		cudaStreamDestroy(aData->streamDH);
+	if(aData->memDeviceHD != NULL)
+		cudaFree(aData->memDeviceHD);
+	if(aData->memDeviceDH != NULL)
+		cudaFree(aData->memDeviceDH);
+	if(aData->memHostHD != NULL)
+		cudaFreeHost(aData->memHostHD);
+	if(aData->memHostDH != NULL)
+		cudaFreeHost(aData->memHostDH);
+
+	free(aData);
+}
+
+/*!	\brief Allocate buffers of aggregate bandwidth test on one device.
+	Pinned buffers are written by the calling thread, so they are placed
+	on the NUMA node of the thread. Device of calling thread is switched
+	to \a num.
+	\return buffers, \a NULL in case of error.
+*/
+void *CZCudaAggregateAlloc(
+	int num,			/*!<[in] Device index. */
+	int size			/*!<[in] Size of each buffer. */
+) {
+	struct CZAggregateLocalData *aData;
+
+	CZ_CUDA_CALL(cudaSetDevice(num),
+		return NULL);
+
+	aData = (struct CZAggregateLocalData*)calloc(1, sizeof(*aData));
+	if(aData == NULL)
+		return NULL;
+	aData->num = num;
+	aData->size = size;
+
+	CZ_CUDA_CALL(cudaMallocHost(&aData->memHostHD, size),
+		CZCudaAggregateFree(aData);
+		return NULL);
+
+	CZ_CUDA_CALL(cudaMallocHost(&aData->memHostDH, size),
+		CZCudaAggregateFree(aData);
+		return NULL);
+
+	CZ_CUDA_CALL(cudaMalloc(&aData->memDeviceHD, size),
+		CZCudaAggregateFree(aData);
+		return NULL);
+
+	CZ_CUDA_CALL(cudaMalloc(&aData->memDeviceDH, size),
+		CZCudaAggregateFree(aData);
+		return NULL);
+
+	CZ_CUDA_CALL(cudaStreamCreateWithFlags(&aData->streamHD, cudaStreamNonBlocking),
+		CZCudaAggregateFree(aData);
+		return NULL);
+
+	CZ_CUDA_CALL(cudaStreamCreateWithFlags(&aData->streamDH, cudaStreamNonBlocking),
+		CZCudaAggregateFree(aData);
+		return NULL);
+
+	memset(aData->memHostHD, 0x55, size);
+	memset(aData->memHostDH, 0xaa, size);
+
+	return aData;
+}
+
+/*!	\brief Run pinned copies of aggregate bandwidth test on one device.
+	Copies of both directions go to their own streams, so they overlap
+	in #CZAggregateBidir mode. Device of calling thread is switched to the
+	device of buffers.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZCudaAggregateCopy(
+	void *data,			/*!<[in,out] Buffers returned by CZCudaAggregateAlloc(). */
+	int mode,			/*!<[in] Copy direction. See enum #CZAggregateMode. */
+	int loops			/*!<[in] Number of copies in each direction. */
+) {
+	struct CZAggregateLocalData *aData = (struct CZAggregateLocalData*)data;
+	bool hd = (mode == CZAggregateHD) || (mode == CZAggregateBidir);
+	bool dh = (mode == CZAggregateDH) || (mode == CZAggregateBidir);
+	int i;
+
+	CZ_CUDA_CALL(cudaSetDevice(aData->num),
+		return -1);
+
+	for(i = 0; i < loops; i++) {
+		if(hd) {
+			CZ_CUDA_CALL(cudaMemcpyAsync(aData->memDeviceHD, aData->memHostHD, aData->size, cudaMemcpyHostToDevice, aData->streamHD),
+				return -1);
+		}
+		if(dh) {
+			CZ_CUDA_CALL(cudaMemcpyAsync(aData->memHostDH, aData->memDeviceDH, aData->size, cudaMemcpyDeviceToHost, aData->streamDH),
+				return -1);
+		}
+	}
+
+	CZ_CUDA_CALL(cudaStreamSynchronize(aData->streamHD),
+		return -1);
+
+	CZ_CUDA_CALL(cudaStreamSynchronize(aData->streamDH),
+		return -1);
+
+	return 0;
+}
+
+/*!	\brief Buffers of storage ingest test on one device.
+*/
+struct CZIngestLocalData {
+	int		num;			/*!< Device index. */
+	size_t		chunk;			/*!< Size of chunk. */
+	void		*memHost;		/*!< Pinned chunks. */
+	void		*memDevice;		/*!< Device chunks. */
+	cudaEvent_t	done[CZ_INGEST_DEPTH_MAX];	/*!< Events of the last copy of each chunk. */
+	cudaStream_t	stream;			/*!< Stream of chunk copies. */
+};
+
+/*!	\brief Free buffers of storage ingest test.
+*/
+void CZCudaIngestFree(
+	void *data			/*!<[in,out] Buffers returned by CZCudaIngestAlloc(). */
+) {
+	struct CZIngestLocalData *iData = (struct CZIngestLocalData*)data;
+	int i;
+
+	if(iData == NULL)
+		return;
+
+	cudaSetDevice(iData->num);
+
+	for(i = 0; i < CZ_INGEST_DEPTH_MAX; i++) {
+		if(iData->done[i] != NULL)
+			cudaEventDestroy(iData->done[i]);
+	}
+	if(iData->stream != NULL)
+		cudaStreamDestroy(iData->stream);
+	if(iData->memDevice != NULL)
+		cudaFree(iData->memDevice);
+	if(iData->memHost != NULL)
+		cudaFreeHost(iData->memHost);
+
+	free(iData);
+}
+
+/*!	\brief Allocate chunks of storage ingest test on one device.
+	Pinned chunks are page aligned, so they may be targets of direct
+	file reads.
+	\return buffers, \a NULL in case of error.
+*/
+void *CZCudaIngestAlloc(
+	int num,			/*!<[in] Device index. */
+	int chunk,			/*!<[in] Size of chunk. */
+	int depth			/*!<[in] Number of chunks. */
+) {
+	struct CZIngestLocalData *iData;
+	int i;
+
+	if((depth < 1) || (depth > CZ_INGEST_DEPTH_MAX))
+		return NULL;
+
+	CZ_CUDA_CALL(cudaSetDevice(num),
+		return NULL);
+
+	iData = (struct CZIngestLocalData*)calloc(1, sizeof(*iData));
+	if(iData == NULL)
+		return NULL;
+	iData->num = num;
+	iData->chunk = chunk;
+
+	CZ_CUDA_CALL(cudaMallocHost(&iData->memHost, (size_t)chunk * depth),
+		CZCudaIngestFree(iData);
+		return NULL);
+
+	CZ_CUDA_CALL(cudaMalloc(&iData->memDevice, (size_t)chunk * depth),
+		CZCudaIngestFree(iData);
+		return NULL);
+
+	for(i = 0; i < depth; i++) {
+		CZ_CUDA_CALL(cudaEventCreateWithFlags(&iData->done[i], cudaEventDisableTiming),
+			CZCudaIngestFree(iData);
+			return NULL);
+	}
+
+	CZ_CUDA_CALL(cudaStreamCreateWithFlags(&iData->stream, cudaStreamNonBlocking),
+		CZCudaIngestFree(iData);
+		return NULL);
+
+	return iData;
+}
+
+/*!	\brief Get pinned chunk of storage ingest test.
+	\return pointer to chunk.
+*/
+void *CZCudaIngestBuffer(
+	void *data,			/*!<[in] Buffers returned by CZCudaIngestAlloc(). */
+	int slot			/*!<[in] Index of chunk. */
+) {
+	struct CZIngestLocalData *iData = (struct CZIngestLocalData*)data;
+
+	return (char*)iData->memHost + iData->chunk * slot;
+}
+
+/*!	\brief Queue copy of pinned chunk to device.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZCudaIngestCopy(
+	void *data,			/*!<[in,out] Buffers returned by CZCudaIngestAlloc(). */
+	int slot,			/*!<[in] Index of chunk. */
+	int size			/*!<[in] Number of bytes to copy. */
+) {
+	struct CZIngestLocalData *iData = (struct CZIngestLocalData*)data;
+
+	CZ_CUDA_CALL(cudaMemcpyAsync((char*)iData->memDevice + iData->chunk * slot, (char*)iData->memHost + iData->chunk * slot,
+		size, cudaMemcpyHostToDevice, iData->stream),
+		return -1);
+
+	CZ_CUDA_CALL(cudaEventRecord(iData->done[slot], iData->stream),
+		return -1);
+
+	return 0;
+}
+
+/*!	\brief Check if copy of pinned chunk is done.
+	\return \a 1 if copy is done, \a 0 if it is running, \a -1 in case
+	of error.
+*/
+int CZCudaIngestQuery(
+	void *data,			/*!<[in] Buffers returned by CZCudaIngestAlloc(). */
+	int slot			/*!<[in] Index of chunk. */
+) {
+	struct CZIngestLocalData *iData = (struct CZIngestLocalData*)data;
+	cudaError_t errCode = cudaEventQuery(iData->done[slot]);
+
+	if(errCode == cudaErrorNotReady)
+		return 0;
+
+	CZ_CUDA_CALL(errCode,
+		return -1);
+
+	return 1;
+}
+
+/*!	\brief Wait for copy of pinned chunk.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZCudaIngestWait(
+	void *data,			/*!<[in] Buffers returned by CZCudaIngestAlloc(). */
+	int slot			/*!<[in] Index of chunk. */
+) {
+	struct CZIngestLocalData *iData = (struct CZIngestLocalData*)data;
+
+	CZ_CUDA_CALL(cudaEventSynchronize(iData->done[slot]),
+		return -1);
+
+	return 0;
+}
+
+/*!	\brief Reset results of preformance calculations.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZCudaCalcDevicePerformanceReset(
+	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
+) {
+
+	if(info == NULL)
+		return -1;
+
+	info->perf.calcFloat = 0;
+	info->perf.calcDouble = 0;
+	info->perf.calcInteger32 = 0;
+	info->perf.calcInteger24 = 0;
+	info->perf.calcInteger64 = 0;
+	memset(&info->perf.calcFloatTime, 0, sizeof(info->perf.calcFloatTime));
+	memset(&info->perf.calcDoubleTime, 0, sizeof(info->perf.calcDoubleTime));
+	memset(&info->perf.calcInteger32Time, 0, sizeof(info->perf.calcInteger32Time));
+	memset(&info->perf.calcInteger24Time, 0, sizeof(info->perf.calcInteger24Time));
+	memset(&info->perf.calcInteger64Time, 0, sizeof(info->perf.calcInteger64Time));
+	info->partialMask &= ~CZTestCalcAll;
+
+	return 0;
+}
+
+/*!	\brief 16 MAD instructions for float point test.
+*/
+#define CZ_CALC_FMAD_16(a, b) \
+	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
+	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
+	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
+	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
+
+/*!	\brief 256 MAD instructions for float point test.
+*/
+#define CZ_CALC_FMAD_256(a, b) \
+	CZ_CALC_FMAD_16(a, b) CZ_CALC_FMAD_16(a, b) \
 	CZ_CALC_FMAD_16(a, b) CZ_CALC_FMAD_16(a, b) \
 	CZ_CALC_FMAD_16(a, b) CZ_CALC_FMAD_16(a, b) \
 	CZ_CALC_FMAD_16(a, b) CZ_CALC_FMAD_16(a, b) \
@@ -1175,413 +2443,1328 @@ static int CZCudaCalcDevicePerformanceReset(
 	CZ_CALC_FMAD_16(a, b) CZ_CALC_FMAD_16(a, b) \
 	CZ_CALC_FMAD_16(a, b) CZ_CALC_FMAD_16(a, b) \
 
-/*!	\brief 16 DMAD instructions for double-precision test.
+/*!	\brief 16 DMAD instructions for double-precision test.
+*/
+#define CZ_CALC_DFMAD_16(a, b) \
+	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
+	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
+	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
+	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
+
+/*	a = fma(a, a, a); b = fma(b, b, b); a = fma(a, a, a); b = fma(b, b, b); \
+	a = fma(a, a, a); b = fma(b, b, b); a = fma(a, a, a); b = fma(b, b, b); \
+	a = fma(a, a, a); b = fma(b, b, b); a = fma(a, a, a); b = fma(b, b, b); \
+	a = fma(a, a, a); b = fma(b, b, b); a = fma(a, a, a); b = fma(b, b, b); \*/
+
+/*!	\brief 256 MAD instructions for float point test.
+*/
+#define CZ_CALC_DFMAD_256(a, b) \
+	CZ_CALC_DFMAD_16(a, b) CZ_CALC_DFMAD_16(a, b) \
+	CZ_CALC_DFMAD_16(a, b) CZ_CALC_DFMAD_16(a, b) \
+	CZ_CALC_DFMAD_16(a, b) CZ_CALC_DFMAD_16(a, b) \
+	CZ_CALC_DFMAD_16(a, b) CZ_CALC_DFMAD_16(a, b) \
+	CZ_CALC_DFMAD_16(a, b) CZ_CALC_DFMAD_16(a, b) \
+	CZ_CALC_DFMAD_16(a, b) CZ_CALC_DFMAD_16(a, b) \
+	CZ_CALC_DFMAD_16(a, b) CZ_CALC_DFMAD_16(a, b) \
+	CZ_CALC_DFMAD_16(a, b) CZ_CALC_DFMAD_16(a, b) \
+
+/*!	\brief 16 MAD instructions for 32-bit integer test.
+*/
+#define CZ_CALC_IMAD32_16(a, b) \
+	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
+	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
+	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
+	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
+
+/*!	\brief 256 MAD instructions for 32-bit integer test.
+*/
+#define CZ_CALC_IMAD32_256(a, b) \
+	CZ_CALC_IMAD32_16(a, b) CZ_CALC_IMAD32_16(a, b) \
+	CZ_CALC_IMAD32_16(a, b) CZ_CALC_IMAD32_16(a, b) \
+	CZ_CALC_IMAD32_16(a, b) CZ_CALC_IMAD32_16(a, b) \
+	CZ_CALC_IMAD32_16(a, b) CZ_CALC_IMAD32_16(a, b) \
+	CZ_CALC_IMAD32_16(a, b) CZ_CALC_IMAD32_16(a, b) \
+	CZ_CALC_IMAD32_16(a, b) CZ_CALC_IMAD32_16(a, b) \
+	CZ_CALC_IMAD32_16(a, b) CZ_CALC_IMAD32_16(a, b) \
+	CZ_CALC_IMAD32_16(a, b) CZ_CALC_IMAD32_16(a, b) \
+
+/*!	\brief 16 MAD instructions for 64-bit integer test.
+*/
+#define CZ_CALC_IMAD64_16(a, b) \
+	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
+	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
+	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
+	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
+
+/*!	\brief 256 MAD instructions for 64-bit integer test.
+*/
+#define CZ_CALC_IMAD64_256(a, b) \
+	CZ_CALC_IMAD64_16(a, b) CZ_CALC_IMAD64_16(a, b) \
+	CZ_CALC_IMAD64_16(a, b) CZ_CALC_IMAD64_16(a, b) \
+	CZ_CALC_IMAD64_16(a, b) CZ_CALC_IMAD64_16(a, b) \
+	CZ_CALC_IMAD64_16(a, b) CZ_CALC_IMAD64_16(a, b) \
+	CZ_CALC_IMAD64_16(a, b) CZ_CALC_IMAD64_16(a, b) \
+	CZ_CALC_IMAD64_16(a, b) CZ_CALC_IMAD64_16(a, b) \
+	CZ_CALC_IMAD64_16(a, b) CZ_CALC_IMAD64_16(a, b) \
+	CZ_CALC_IMAD64_16(a, b) CZ_CALC_IMAD64_16(a, b) \
+
+/*!	\brief 16 MAD instructions for 24-bit integer test.
+*/
+#define CZ_CALC_IMAD24_16(a, b) \
+	a = __mul24(a, a) + a; b = __mul24(b, b) + b; \
+	a = __mul24(a, a) + a; b = __mul24(b, b) + b; \
+	a = __mul24(a, a) + a; b = __mul24(b, b) + b; \
+	a = __mul24(a, a) + a; b = __mul24(b, b) + b; \
+	a = __mul24(a, a) + a; b = __mul24(b, b) + b; \
+	a = __mul24(a, a) + a; b = __mul24(b, b) + b; \
+	a = __mul24(a, a) + a; b = __mul24(b, b) + b; \
+	a = __mul24(a, a) + a; b = __mul24(b, b) + b; \
+
+/*!	\brief 256 MAD instructions for 24-bit integer test.
+*/
+#define CZ_CALC_IMAD24_256(a, b) \
+	CZ_CALC_IMAD24_16(a, b) CZ_CALC_IMAD24_16(a, b)\
+	CZ_CALC_IMAD24_16(a, b) CZ_CALC_IMAD24_16(a, b)\
+	CZ_CALC_IMAD24_16(a, b) CZ_CALC_IMAD24_16(a, b)\
+	CZ_CALC_IMAD24_16(a, b) CZ_CALC_IMAD24_16(a, b)\
+	CZ_CALC_IMAD24_16(a, b) CZ_CALC_IMAD24_16(a, b)\
+	CZ_CALC_IMAD24_16(a, b) CZ_CALC_IMAD24_16(a, b)\
+	CZ_CALC_IMAD24_16(a, b) CZ_CALC_IMAD24_16(a, b)\
+	CZ_CALC_IMAD24_16(a, b) CZ_CALC_IMAD24_16(a, b)\
+
+#define CZ_CALC_MODE_FLOAT	0	/*!< Single-precision float point test mode. */
+#define CZ_CALC_MODE_DOUBLE	1	/*!< Double-precision float point test mode. */
+#define CZ_CALC_MODE_INTEGER32	2	/*!< 32-bit integer test mode. */
+#define CZ_CALC_MODE_INTEGER24	3	/*!< 24-bit integer test mode. */
+#define CZ_CALC_MODE_INTEGER64	4	/*!< 64-bit integer test mode. */
+
+/*!	\brief GPU code for float point test.
+*/
+__global__ void CZCudaCalcKernelFloat(
+	void *buf,			/*!<[in] Data buffer. */
+	int loops			/*!<[in] Number of calculation loops. */
+) {
+	int index = blockIdx.x * blockDim.x + threadIdx.x;
+	float *arr = (float*)buf;
+	float val1 = index;
+	float val2 = arr[index];
+	int i;
+
+	for(i = 0; i < loops; i++) {
+		CZ_CALC_FMAD_256(val1, val2);
+		CZ_CALC_FMAD_256(val1, val2);
+		CZ_CALC_FMAD_256(val1, val2);
+		CZ_CALC_FMAD_256(val1, val2);
+		CZ_CALC_FMAD_256(val1, val2);
+		CZ_CALC_FMAD_256(val1, val2);
+		CZ_CALC_FMAD_256(val1, val2);
+		CZ_CALC_FMAD_256(val1, val2);
+		CZ_CALC_FMAD_256(val1, val2);
+		CZ_CALC_FMAD_256(val1, val2);
+		CZ_CALC_FMAD_256(val1, val2);
+		CZ_CALC_FMAD_256(val1, val2);
+		CZ_CALC_FMAD_256(val1, val2);
+		CZ_CALC_FMAD_256(val1, val2);
+		CZ_CALC_FMAD_256(val1, val2);
+		CZ_CALC_FMAD_256(val1, val2);
+	}
+
+	arr[index] = val1 + val2;
+}
+
+/*!	\brief GPU code for double-precision test.
+*/
+__global__ void CZCudaCalcKernelDouble(
+	void *buf,			/*!<[in] Data buffer. */
+	int loops			/*!<[in] Number of calculation loops. */
+) {
+	int index = blockIdx.x * blockDim.x + threadIdx.x;
+	double *arr = (double*)buf;
+	double val1 = index;
+	double val2 = arr[index];
+	int i;
+
+	for(i = 0; i < loops; i++) {
+		CZ_CALC_DFMAD_256(val1, val2);
+		CZ_CALC_DFMAD_256(val1, val2);
+		CZ_CALC_DFMAD_256(val1, val2);
+		CZ_CALC_DFMAD_256(val1, val2);
+		CZ_CALC_DFMAD_256(val1, val2);
+		CZ_CALC_DFMAD_256(val1, val2);
+		CZ_CALC_DFMAD_256(val1, val2);
+		CZ_CALC_DFMAD_256(val1, val2);
+		CZ_CALC_DFMAD_256(val1, val2);
+		CZ_CALC_DFMAD_256(val1, val2);
+		CZ_CALC_DFMAD_256(val1, val2);
+		CZ_CALC_DFMAD_256(val1, val2);
+		CZ_CALC_DFMAD_256(val1, val2);
+		CZ_CALC_DFMAD_256(val1, val2);
+		CZ_CALC_DFMAD_256(val1, val2);
+		CZ_CALC_DFMAD_256(val1, val2);
+	}
+
+	arr[index] = val1 + val2;
+}
+
+/*!	\brief GPU code for 32-bit integer test.
+*/
+__global__ void CZCudaCalcKernelInteger32(
+	void *buf,			/*!<[in] Data buffer. */
+	int loops			/*!<[in] Number of calculation loops. */
+) {
+	int index = blockIdx.x * blockDim.x + threadIdx.x;
+	int *arr = (int*)buf;
+	int val1 = index;
+	int val2 = arr[index];
+	int i;
+
+	for(i = 0; i < loops; i++) {
+		CZ_CALC_IMAD32_256(val1, val2);
+		CZ_CALC_IMAD32_256(val1, val2);
+		CZ_CALC_IMAD32_256(val1, val2);
+		CZ_CALC_IMAD32_256(val1, val2);
+		CZ_CALC_IMAD32_256(val1, val2);
+		CZ_CALC_IMAD32_256(val1, val2);
+		CZ_CALC_IMAD32_256(val1, val2);
+		CZ_CALC_IMAD32_256(val1, val2);
+		CZ_CALC_IMAD32_256(val1, val2);
+		CZ_CALC_IMAD32_256(val1, val2);
+		CZ_CALC_IMAD32_256(val1, val2);
+		CZ_CALC_IMAD32_256(val1, val2);
+		CZ_CALC_IMAD32_256(val1, val2);
+		CZ_CALC_IMAD32_256(val1, val2);
+		CZ_CALC_IMAD32_256(val1, val2);
+		CZ_CALC_IMAD32_256(val1, val2);
+	}
+
+	arr[index] = val1 + val2;
+}
+
+/*!	\brief GPU code for 24-bit integer test.
+*/
+__global__ void CZCudaCalcKernelInteger24(
+	void *buf,			/*!<[in] Data buffer. */
+	int loops			/*!<[in] Number of calculation loops. */
+) {
+	int index = blockIdx.x * blockDim.x + threadIdx.x;
+	int *arr = (int*)buf;
+	int val1 = index;
+	int val2 = arr[index];
+	int i;
+
+	for(i = 0; i < loops; i++) {
+		CZ_CALC_IMAD24_256(val1, val2);
+		CZ_CALC_IMAD24_256(val1, val2);
+		CZ_CALC_IMAD24_256(val1, val2);
+		CZ_CALC_IMAD24_256(val1, val2);
+		CZ_CALC_IMAD24_256(val1, val2);
+		CZ_CALC_IMAD24_256(val1, val2);
+		CZ_CALC_IMAD24_256(val1, val2);
+		CZ_CALC_IMAD24_256(val1, val2);
+		CZ_CALC_IMAD24_256(val1, val2);
+		CZ_CALC_IMAD24_256(val1, val2);
+		CZ_CALC_IMAD24_256(val1, val2);
+		CZ_CALC_IMAD24_256(val1, val2);
+		CZ_CALC_IMAD24_256(val1, val2);
+		CZ_CALC_IMAD24_256(val1, val2);
+		CZ_CALC_IMAD24_256(val1, val2);
+		CZ_CALC_IMAD24_256(val1, val2);
+	}
+
+	arr[index] = val1 + val2;
+}
+
+/*!	\brief GPU code for 64-bit integer test.
+*/
+__global__ void CZCudaCalcKernelInteger64(
+	void *buf,			/*!<[in] Data buffer. */
+	int loops			/*!<[in] Number of calculation loops. */
+) {
+	int index = blockIdx.x * blockDim.x + threadIdx.x;
+	long long *arr = (long long*)buf;
+	long long val1 = index;
+	long long val2 = arr[index];
+	int i;
+
+	for(i = 0; i < loops; i++) {
+		CZ_CALC_IMAD64_256(val1, val2);
+		CZ_CALC_IMAD64_256(val1, val2);
+		CZ_CALC_IMAD64_256(val1, val2);
+		CZ_CALC_IMAD64_256(val1, val2);
+		CZ_CALC_IMAD64_256(val1, val2);
+		CZ_CALC_IMAD64_256(val1, val2);
+		CZ_CALC_IMAD64_256(val1, val2);
+		CZ_CALC_IMAD64_256(val1, val2);
+		CZ_CALC_IMAD64_256(val1, val2);
+		CZ_CALC_IMAD64_256(val1, val2);
+		CZ_CALC_IMAD64_256(val1, val2);
+		CZ_CALC_IMAD64_256(val1, val2);
+		CZ_CALC_IMAD64_256(val1, val2);
+		CZ_CALC_IMAD64_256(val1, val2);
+		CZ_CALC_IMAD64_256(val1, val2);
+		CZ_CALC_IMAD64_256(val1, val2);
+	}
+
+	arr[index] = val1 + val2;
+}
+
+/*!	\brief Launch GPU calculation kernel.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZCudaCalcDevicePerformanceLaunch(
+	int mode,			/*!<[in] Run performance test in one of modes. */
+	int blocksNum,			/*!<[in] Number of blocks. */
+	int threadsNum,			/*!<[in] Number of threads per block. */
+	void *buf,			/*!<[in] Data buffer. */
+	int loops			/*!<[in] Number of calculation loops. */
+) {
+
+	switch(mode) {
+	case CZ_CALC_MODE_FLOAT:
+		CZCudaCalcKernelFloat<<<blocksNum, threadsNum>>>(buf, loops);
+		break;
+
+	case CZ_CALC_MODE_DOUBLE:
+		CZCudaCalcKernelDouble<<<blocksNum, threadsNum>>>(buf, loops);
+		break;
+
+	case CZ_CALC_MODE_INTEGER32:
+		CZCudaCalcKernelInteger32<<<blocksNum, threadsNum>>>(buf, loops);
+		break;
+
+	case CZ_CALC_MODE_INTEGER24:
+		CZCudaCalcKernelInteger24<<<blocksNum, threadsNum>>>(buf, loops);
+		break;
+
+	case CZ_CALC_MODE_INTEGER64:
+		CZCudaCalcKernelInteger64<<<blocksNum, threadsNum>>>(buf, loops);
+		break;
+
+	default: // WTF!
+		return -1;
+	}
+
+	CZ_CUDA_CALL(cudaGetLastError(),
+		return -1);
+
+	return 0;
+}
+
+/*!	\brief Run GPU calculation performace tests.
+	Test runs up to \a info->config.calcLoops loops. If time limit of the device
+	is set the number of calculation loops in kernel is calibrated with
+	a short probe run to fit all loops into the limit. Test marks its
+	result as partial in \a info->partialMask if not all loops were done.
+	\return \a 0 in case of error, \a other is value in KOPS.
+*/
+static float CZCudaCalcDevicePerformanceTest(
+	struct CZDeviceInfo *info,	/*!<[in,out] CUDA-device information. */
+	int mode,			/*!<[in] Run performance test in one of modes. */
+	int test,			/*!<[in] Test identifier. See enum #CZTest. */
+	struct CZDeviceInfoTime *time	/*!<[out] Host side timing of test. */
+) {
+	CZDeviceInfoBandLocalData *lData;
+	float timeMs = 0.0;
+	double opsNum = 0.0;
+	double startMs;
+	double testUs;
+	float performanceKOPs = 0.0;
+	cudaEvent_t start;
+	cudaEvent_t stop;
+	int blocksNum;
+	int blockLoops = info->config.calcBlockLoops;
+	int i;
+
+	if(info == NULL)
+		return 0;
+
+	blocksNum = info->heavyMode? info->core.muliProcCount: 1;
+
+	CZ_CUDA_CALL(cudaEventCreate(&start),
+		return 0);
+
+	CZ_CUDA_CALL(cudaEventCreate(&stop),
+		cudaEventDestroy(start);
+		return 0);
+
+	lData = (CZDeviceInfoBandLocalData*)info->band.localData;
+
+	int threadsNum = info->core.maxThreadsPerBlock;
+	if(threadsNum == 0) {
+		int warpSize = info->core.SIMDWidth;
+		if(warpSize == 0)
+			warpSize = CZ_DEF_WARP_SIZE;
+		threadsNum = warpSize * 2;
+		if(threadsNum > CZ_DEF_THREADS_MAX)
+			threadsNum = CZ_DEF_THREADS_MAX;
+	}
+	if((info->config.calcThreads > 0) && (info->config.calcThreads < threadsNum))
+		threadsNum = info->config.calcThreads;
+
+	CZLog(CZLogLevelLow, "Starting %s test on %s on %d block(s) %d thread(s) each.",
+		(mode == CZ_CALC_MODE_FLOAT)? "single-precision float":
+		(mode == CZ_CALC_MODE_DOUBLE)? "double-precision float":
+		(mode == CZ_CALC_MODE_INTEGER32)? "32-bit integer":
+		(mode == CZ_CALC_MODE_INTEGER24)? "24-bit integer":
+		(mode == CZ_CALC_MODE_INTEGER64)? "64-bit integer": "unknown",
+		info->deviceName,
+		blocksNum,
+		threadsNum);
+
+	startMs = CZGetTimeMs();
+	testUs = CZTraceTimeUs();
+
+	if(info->timeLimit > 0) {
+		double probeMs;
+		double loopLimitMs = (double)info->timeLimit / info->config.calcLoops;
+		double probeUs = CZTraceTimeUs();
+
+		if(CZCudaCalcDevicePerformanceLaunch(mode, blocksNum, threadsNum, lData->memDevice1, 1) != 0) {
+			cudaEventDestroy(start);
+			cudaEventDestroy(stop);
+			return 0;
+		}
+
+		CZ_CUDA_CALL(cudaDeviceSynchronize(),
+			cudaEventDestroy(start);
+			cudaEventDestroy(stop);
+			return 0);
+
+		CZTraceHostSpan("calc", "probe", info->num, probeUs);
+
+		probeMs = CZGetTimeMs() - startMs;
+		if(probeMs * blockLoops > loopLimitMs) {
+			blockLoops = (int)(loopLimitMs / probeMs);
+			if(blockLoops < 1)
+				blockLoops = 1;
+			CZLog(CZLogLevelLow, "Calculation loops are reduced to %d.", blockLoops);
+		}
+	}
+
+	for(i = 0; i < info->config.calcLoops; i++) {
+
+		float loopMs = 0.0;
+		double loopUs;
+		double wallMs;
+		double cpuMs;
+
+		if(CZCudaCalcDeviceTestBreak(info, startMs, i)) {
+			info->partialMask |= test;
+			break;
+		}
+
+		loopUs = CZTraceTimeUs();
+		wallMs = CZGetTimeMs();
+		cpuMs = CZCpuThreadTimeMs();
+
+		CZ_CUDA_CALL(cudaEventRecord(start, 0),
+			cudaEventDestroy(start);
+			cudaEventDestroy(stop);
+			return 0);
+
+		if(CZCudaCalcDevicePerformanceLaunch(mode, blocksNum, threadsNum, lData->memDevice1, blockLoops) != 0) {
+			cudaEventDestroy(start);
+			cudaEventDestroy(stop);
+			return 0;
+		}
+
+		CZTraceHostSpan("calc", "launch", info->num, loopUs);
+
+		CZ_CUDA_CALL(cudaEventRecord(stop, 0),
+			cudaEventDestroy(start);
+			cudaEventDestroy(stop);
+			return 0);
+
+		CZ_CUDA_CALL(cudaEventSynchronize(stop),
+			cudaEventDestroy(start);
+			cudaEventDestroy(stop);
+			return 0);
+
+		CZ_CUDA_CALL(cudaEventElapsedTime(&loopMs, start, stop),
+			cudaEventDestroy(start);
+			cudaEventDestroy(stop);
+			return 0);
+
+		wallMs = CZGetTimeMs() - wallMs;
+		cpuMs = CZCpuThreadTimeMs() - cpuMs;
+
+		timeMs += loopMs;
+		opsNum += (double)blockLoops;
+
+		time->deviceMs += loopMs;
+		time->wallMs += (float)wallMs;
+		time->cpuMs += (float)cpuMs;
+
+		CZTraceHostSpan("calc", CZTestName(test), info->num, loopUs);
+		CZTraceDeviceSpan("calc", CZTestName(test), info->num, loopUs, loopMs * 1000.0);
+
+		CZLogKV(CZLogLevelLow, "calc-loop", "dev=%d test=0x%x loop=%d blocks=%d threads=%d block_loops=%d ms=%f",
+			info->num, test, i, blocksNum, threadsNum, blockLoops, loopMs);
+	}
+
+	CZTraceHostSpan("calc", "test", info->num, testUs);
+
+	CZLog(CZLogLevelLow, "Test complete in %f ms (%d loops).", timeMs, i);
+	CZLog(CZLogLevelLow, "Host wall time %f ms, CPU time %f ms.", time->wallMs, time->cpuMs);
+
+	time->amount = (double)info->core.muliProcCount *
+		opsNum *
+		(double)threadsNum *
+		(double)CZ_CALC_OPS_NUM *
+		(double)CZ_CALC_BLOCK_SIZE *
+		(double)CZ_CALC_BLOCK_NUM;
+
+	if(timeMs != 0) {
+		performanceKOPs = (
+			(float)info->core.muliProcCount *
+			(float)opsNum *
+			(float)threadsNum *
+			(float)CZ_CALC_OPS_NUM *
+			(float)CZ_CALC_BLOCK_SIZE *
+			(float)CZ_CALC_BLOCK_NUM
+		) / (float)timeMs;
+	}
+
+	cudaEventDestroy(start);
+	cudaEventDestroy(stop);
+
+	return performanceKOPs;
+}
+
+/*!	\brief Run performance test with telemetry sampling.
+	\return \a 0 in case of error, \a other is value in Kop/s.
+*/
+static float CZCudaCalcDevicePerformanceTestSampled(
+	struct CZDeviceInfo *info,	/*!<[in,out] CUDA-device information. */
+	int mode,			/*!<[in] Run performance test in one of modes. */
+	int test,			/*!<[in] Test identifier. See enum #CZTest. */
+	struct CZDeviceInfoTime *time	/*!<[out] Host side timing of test. */
+) {
+	void *sampler = CZNvmlSampleStart(info);
+	float performanceKOPs = CZCudaCalcDevicePerformanceTest(info, mode, test, time);
+	CZNvmlSampleStop(sampler, &time->tele);
+	return performanceKOPs;
+}
+
+/*!	\brief Calculate performance information about CUDA-device.
+	Only tests selected in \a info->testMask are run, results of other
+	tests are reset to \a 0.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZCudaCalcDevicePerformance(
+	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
+) {
+
+	if(info == NULL)
+		return -1;
+
+	if(CZCudaCalcDevicePerformanceReset(info) != 0)
+		return -1;
+
+	if((info->testMask & CZTestCalcAll) == 0)
+		return 0;
+
+	if(!CZCudaIsInit())
+		return -1;
+
+	if(info->testMask & CZTestCalcFloat)
+		info->perf.calcFloat = CZCudaCalcDevicePerformanceTestSampled(info, CZ_CALC_MODE_FLOAT, CZTestCalcFloat, &info->perf.calcFloatTime);
+	if((info->testMask & CZTestCalcDouble) &&
+		(((info->major > 1)) ||
+		((info->major == 1) && (info->minor >= 3))))
+		info->perf.calcDouble = CZCudaCalcDevicePerformanceTestSampled(info, CZ_CALC_MODE_DOUBLE, CZTestCalcDouble, &info->perf.calcDoubleTime);
+	if(info->testMask & CZTestCalcInteger32)
+		info->perf.calcInteger32 = CZCudaCalcDevicePerformanceTestSampled(info, CZ_CALC_MODE_INTEGER32, CZTestCalcInteger32, &info->perf.calcInteger32Time);
+	if(info->testMask & CZTestCalcInteger24)
+		info->perf.calcInteger24 = CZCudaCalcDevicePerformanceTestSampled(info, CZ_CALC_MODE_INTEGER24, CZTestCalcInteger24, &info->perf.calcInteger24Time);
+	if(info->testMask & CZTestCalcInteger64)
+		info->perf.calcInteger64 = CZCudaCalcDevicePerformanceTestSampled(info, CZ_CALC_MODE_INTEGER64, CZTestCalcInteger64, &info->perf.calcInteger64Time);
+
+	return 0;
+}
+
+#define CZ_MEM_TEST_SIZE	(256 * (1 << 20))	/*!< Size of memory test region in normal mode. */
+#define CZ_MEM_TEST_SIZE_MIN	(16 * (1 << 20))	/*!< Minimal size of memory test region. */
+#define CZ_MEM_TEST_FREE_PART	0.9			/*!< Part of free memory tested in heavy mode. */
+#define CZ_MEM_THREADS_NUM	256			/*!< Threads per block of memory test kernels. */
+#define CZ_MEM_BLOCKS_PER_MP	8			/*!< Blocks per multiprocessor of memory test kernels. */
+
+/*!	\brief Mismatches recorded on device by memory test.
 */
-#define CZ_CALC_DFMAD_16(a, b) \
-	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
-	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
-	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
-	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
+struct CZMemErrorLog {
+	unsigned int	count;			/*!< Number of mismatching words. */
+	int		pattern[CZ_MEM_ERRORS_MAX];	/*!< Pattern of pass. */
+	unsigned int	expected[CZ_MEM_ERRORS_MAX];	/*!< Value written. */
+	unsigned int	actual[CZ_MEM_ERRORS_MAX];	/*!< Value read back. */
+	unsigned long long	offset[CZ_MEM_ERRORS_MAX];	/*!< Offset of word in region in bytes. */
+};
 
-/*	a = fma(a, a, a); b = fma(b, b, b); a = fma(a, a, a); b = fma(b, b, b); \
-	a = fma(a, a, a); b = fma(b, b, b); a = fma(a, a, a); b = fma(b, b, b); \
-	a = fma(a, a, a); b = fma(b, b, b); a = fma(a, a, a); b = fma(b, b, b); \
-	a = fma(a, a, a); b = fma(b, b, b); a = fma(a, a, a); b = fma(b, b, b); \*/
+/*!	\brief Local service data of memory test.
+*/
+struct CZMemTestLocalData {
+	unsigned int	*region;	/*!< Tested device memory region. */
+	size_t		words;		/*!< Size of region in words. */
+	struct CZMemErrorLog	*log;	/*!< Device log of mismatches. */
+	cudaStream_t	memStream;	/*!< Stream of pattern kernels. */
+	cudaStream_t	stressStream;	/*!< Stream of concurrent copy and calculation load. */
+	cudaEvent_t	start;		/*!< Start event of pattern passes. */
+	cudaEvent_t	stop;		/*!< Stop event of pattern passes. */
+};
 
-/*!	\brief 256 MAD instructions for float point test.
+/*!	\brief Value of pattern word.
+	Value is computed from address of word, so pattern is verified
+	without a reference copy.
+	\return value of word.
 */
-#define CZ_CALC_DFMAD_256(a, b) \
-	CZ_CALC_DFMAD_16(a, b) CZ_CALC_DFMAD_16(a, b) \
-	CZ_CALC_DFMAD_16(a, b) CZ_CALC_DFMAD_16(a, b) \
-	CZ_CALC_DFMAD_16(a, b) CZ_CALC_DFMAD_16(a, b) \
-	CZ_CALC_DFMAD_16(a, b) CZ_CALC_DFMAD_16(a, b) \
-	CZ_CALC_DFMAD_16(a, b) CZ_CALC_DFMAD_16(a, b) \
-	CZ_CALC_DFMAD_16(a, b) CZ_CALC_DFMAD_16(a, b) \
-	CZ_CALC_DFMAD_16(a, b) CZ_CALC_DFMAD_16(a, b) \
-	CZ_CALC_DFMAD_16(a, b) CZ_CALC_DFMAD_16(a, b) \
+__device__ unsigned int CZCudaMemPatternValue(
+	int pattern,			/*!<[in] Pattern. See enum #CZMemPattern. */
+	const unsigned int *word,	/*!<[in] Address of word. */
+	size_t index,			/*!<[in] Index of word in region. */
+	unsigned int seed		/*!<[in] Seed of pass. */
+) {
+	unsigned int val;
+
+	switch(pattern) {
+	case CZMemPatternWalkingOnes:
+		return 1u << ((unsigned int)(index + seed) & 31);
+
+	case CZMemPatternRandom:
+		val = (unsigned int)index ^ ((unsigned int)((unsigned long long)index >> 32) * 0x27d4eb2du) ^ seed;
+		val ^= val >> 16;
+		val *= 0x85ebca6bu;
+		val ^= val >> 13;
+		val *= 0xc2b2ae35u;
+		val ^= val >> 16;
+		return val;
+
+	default:
+		return (unsigned int)(size_t)word ^ seed;
+	}
+}
 
-/*!	\brief 16 MAD instructions for 32-bit integer test.
+/*!	\brief GPU code writing pattern to memory region.
 */
-#define CZ_CALC_IMAD32_16(a, b) \
-	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
-	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
-	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
-	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
+__global__ void CZCudaMemKernelWrite(
+	unsigned int *buf,		/*!<[out] Memory region. */
+	size_t words,			/*!<[in] Size of region in words. */
+	int pattern,			/*!<[in] Pattern. See enum #CZMemPattern. */
+	unsigned int seed		/*!<[in] Seed of pass. */
+) {
+	size_t step = (size_t)gridDim.x * blockDim.x;
+	size_t i;
 
-/*!	\brief 256 MAD instructions for 32-bit integer test.
+	for(i = (size_t)blockIdx.x * blockDim.x + threadIdx.x; i < words; i += step)
+		buf[i] = CZCudaMemPatternValue(pattern, buf + i, i, seed);
+}
+
+/*!	\brief GPU code verifying pattern in memory region.
+	The first #CZ_MEM_ERRORS_MAX mismatches are recorded in \a log,
+	all of them are counted.
 */
-#define CZ_CALC_IMAD32_256(a, b) \
-	CZ_CALC_IMAD32_16(a, b) CZ_CALC_IMAD32_16(a, b) \
-	CZ_CALC_IMAD32_16(a, b) CZ_CALC_IMAD32_16(a, b) \
-	CZ_CALC_IMAD32_16(a, b) CZ_CALC_IMAD32_16(a, b) \
-	CZ_CALC_IMAD32_16(a, b) CZ_CALC_IMAD32_16(a, b) \
-	CZ_CALC_IMAD32_16(a, b) CZ_CALC_IMAD32_16(a, b) \
-	CZ_CALC_IMAD32_16(a, b) CZ_CALC_IMAD32_16(a, b) \
-	CZ_CALC_IMAD32_16(a, b) CZ_CALC_IMAD32_16(a, b) \
-	CZ_CALC_IMAD32_16(a, b) CZ_CALC_IMAD32_16(a, b) \
+__global__ void CZCudaMemKernelVerify(
+	const unsigned int *buf,	/*!<[in] Memory region. */
+	size_t words,			/*!<[in] Size of region in words. */
+	int pattern,			/*!<[in] Pattern. See enum #CZMemPattern. */
+	unsigned int seed,		/*!<[in] Seed of pass. */
+	struct CZMemErrorLog *log	/*!<[in,out] Log of mismatches. */
+) {
+	size_t step = (size_t)gridDim.x * blockDim.x;
+	size_t i;
+
+	for(i = (size_t)blockIdx.x * blockDim.x + threadIdx.x; i < words; i += step) {
+		unsigned int expected = CZCudaMemPatternValue(pattern, buf + i, i, seed);
+		unsigned int actual = buf[i];
+		if(actual != expected) {
+			unsigned int n = atomicAdd(&log->count, 1u);
+			if(n < CZ_MEM_ERRORS_MAX) {
+				log->pattern[n] = pattern;
+				log->expected[n] = expected;
+				log->actual[n] = actual;
+				log->offset[n] = (unsigned long long)i * sizeof(unsigned int);
+			}
+		}
+	}
+}
 
-/*!	\brief 16 MAD instructions for 64-bit integer test.
+/*!	\brief Reset results of memory test.
+	\return \a 0 in case of success, \a -1 in case of error.
 */
-#define CZ_CALC_IMAD64_16(a, b) \
-	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
-	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
-	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
-	a = a * a + a; b = b * b + b; a = a * a + a; b = b * b + b; \
+static int CZCudaCalcDeviceMemoryReset(
+	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
+) {
 
-/*!	\brief 256 MAD instructions for 64-bit integer test.
+	if(info == NULL)
+		return -1;
+
+	memset(&info->memTest, 0, sizeof(info->memTest));
+	info->partialMask &= ~CZTestMemory;
+
+	return 0;
+}
+
+/*!	\brief Free resources of memory test.
 */
-#define CZ_CALC_IMAD64_256(a, b) \
-	CZ_CALC_IMAD64_16(a, b) CZ_CALC_IMAD64_16(a, b) \
-	CZ_CALC_IMAD64_16(a, b) CZ_CALC_IMAD64_16(a, b) \
-	CZ_CALC_IMAD64_16(a, b) CZ_CALC_IMAD64_16(a, b) \
-	CZ_CALC_IMAD64_16(a, b) CZ_CALC_IMAD64_16(a, b) \
-	CZ_CALC_IMAD64_16(a, b) CZ_CALC_IMAD64_16(a, b) \
-	CZ_CALC_IMAD64_16(a, b) CZ_CALC_IMAD64_16(a, b) \
-	CZ_CALC_IMAD64_16(a, b) CZ_CALC_IMAD64_16(a, b) \
-	CZ_CALC_IMAD64_16(a, b) CZ_CALC_IMAD64_16(a, b) \
+static void CZCudaCalcDeviceMemoryFree(
+	struct CZMemTestLocalData *mData	/*!<[in,out] Local data of memory test. */
+) {
 
-/*!	\brief 16 MAD instructions for 24-bit integer test.
+	if(mData->start != NULL)
+		cudaEventDestroy(mData->start);
+	if(mData->stop != NULL)
+		cudaEventDestroy(mData->stop);
+	if(mData->memStream != NULL)
+		cudaStreamDestroy(mData->memStream);
+	if(mData->stressStream != NULL)
+		cudaStreamDestroy(mData->stressStream);
+	if(mData->log != NULL)
+		cudaFree(mData->log);
+	if(mData->region != NULL)
+		cudaFree(mData->region);
+	memset(mData, 0, sizeof(*mData));
+}
+
+/*!	\brief Allocate resources of memory test.
+	Region takes most of free device memory in heavy mode and up to
+	#CZ_MEM_TEST_SIZE bytes otherwise. Size is halved if allocation fails.
+	\return \a 0 in case of success, \a -1 in case of error.
 */
-#define CZ_CALC_IMAD24_16(a, b) \
-	a = __mul24(a, a) + a; b = __mul24(b, b) + b; \
-	a = __mul24(a, a) + a; b = __mul24(b, b) + b; \
-	a = __mul24(a, a) + a; b = __mul24(b, b) + b; \
-	a = __mul24(a, a) + a; b = __mul24(b, b) + b; \
-	a = __mul24(a, a) + a; b = __mul24(b, b) + b; \
-	a = __mul24(a, a) + a; b = __mul24(b, b) + b; \
-	a = __mul24(a, a) + a; b = __mul24(b, b) + b; \
-	a = __mul24(a, a) + a; b = __mul24(b, b) + b; \
+static int CZCudaCalcDeviceMemoryAlloc(
+	struct CZDeviceInfo *info,	/*!<[in,out] CUDA-device information. */
+	struct CZMemTestLocalData *mData	/*!<[out] Local data of memory test. */
+) {
+	size_t freeMem = 0;
+	size_t totalMem = 0;
+	size_t size;
+	double traceUs = CZTraceTimeUs();
 
-/*!	\brief 256 MAD instructions for 24-bit integer test.
+	memset(mData, 0, sizeof(*mData));
+
+	CZ_CUDA_CALL(cudaMemGetInfo(&freeMem, &totalMem),
+		return -1);
+
+	if(info->heavyMode)
+		size = (size_t)((double)freeMem * CZ_MEM_TEST_FREE_PART);
+	else
+		size = (freeMem / 2 < CZ_MEM_TEST_SIZE)? freeMem / 2: CZ_MEM_TEST_SIZE;
+	size &= ~((size_t)(1 << 20) - 1);
+
+	while(size >= CZ_MEM_TEST_SIZE_MIN) {
+		if(cudaMalloc((void**)&mData->region, size) == cudaSuccess)
+			break;
+		cudaGetLastError();
+		mData->region = NULL;
+		size /= 2;
+	}
+
+	if(mData->region == NULL) {
+		CZLog(CZLogLevelError, "Can't allocate memory test region on %s.", info->deviceName);
+		return -1;
+	}
+
+	CZTraceHostSpan("alloc", "cudaMalloc", info->num, traceUs);
+
+	CZLog(CZLogLevelLow, "Memory test region of %lu bytes is at 0x%08lX.",
+		(unsigned long)size, (unsigned long)(size_t)mData->region);
+
+	mData->words = size / sizeof(unsigned int);
+	info->memTest.size = size;
+
+	CZ_CUDA_CALL(cudaMalloc((void**)&mData->log, sizeof(struct CZMemErrorLog)),
+		CZCudaCalcDeviceMemoryFree(mData);
+		return -1);
+
+	CZ_CUDA_CALL(cudaStreamCreate(&mData->memStream),
+		CZCudaCalcDeviceMemoryFree(mData);
+		return -1);
+
+	CZ_CUDA_CALL(cudaStreamCreate(&mData->stressStream),
+		CZCudaCalcDeviceMemoryFree(mData);
+		return -1);
+
+	CZ_CUDA_CALL(cudaEventCreate(&mData->start),
+		CZCudaCalcDeviceMemoryFree(mData);
+		return -1);
+
+	CZ_CUDA_CALL(cudaEventCreate(&mData->stop),
+		CZCudaCalcDeviceMemoryFree(mData);
+		return -1);
+
+	return 0;
+}
+
+/*!	\brief Queue copy and calculation load on stress stream.
+	Load uses buffers of bandwidth test, so it does not touch the
+	tested region.
+	\return \a 0 in case of success, \a -1 in case of error.
 */
-#define CZ_CALC_IMAD24_256(a, b) \
-	CZ_CALC_IMAD24_16(a, b) CZ_CALC_IMAD24_16(a, b)\
-	CZ_CALC_IMAD24_16(a, b) CZ_CALC_IMAD24_16(a, b)\
-	CZ_CALC_IMAD24_16(a, b) CZ_CALC_IMAD24_16(a, b)\
-	CZ_CALC_IMAD24_16(a, b) CZ_CALC_IMAD24_16(a, b)\
-	CZ_CALC_IMAD24_16(a, b) CZ_CALC_IMAD24_16(a, b)\
-	CZ_CALC_IMAD24_16(a, b) CZ_CALC_IMAD24_16(a, b)\
-	CZ_CALC_IMAD24_16(a, b) CZ_CALC_IMAD24_16(a, b)\
-	CZ_CALC_IMAD24_16(a, b) CZ_CALC_IMAD24_16(a, b)\
+static int CZCudaCalcDeviceMemoryStress(
+	struct CZDeviceInfo *info,	/*!<[in] CUDA-device information. */
+	struct CZMemTestLocalData *mData	/*!<[in] Local data of memory test. */
+) {
+	CZDeviceInfoBandLocalData *lData = (CZDeviceInfoBandLocalData*)info->band.localData;
+	int blocksNum = info->core.muliProcCount;
 
-#define CZ_CALC_MODE_FLOAT	0	/*!< Single-precision float point test mode. */
-#define CZ_CALC_MODE_DOUBLE	1	/*!< Double-precision float point test mode. */
-#define CZ_CALC_MODE_INTEGER32	2	/*!< 32-bit integer test mode. */
-#define CZ_CALC_MODE_INTEGER24	3	/*!< 24-bit integer test mode. */
-#define CZ_CALC_MODE_INTEGER64	4	/*!< 64-bit integer test mode. */
+	if((size_t)blocksNum * CZ_MEM_THREADS_NUM * sizeof(float) > lData->size)
+		blocksNum = (int)(lData->size / (CZ_MEM_THREADS_NUM * sizeof(float)));
 
-/*!	\brief GPU code for float point test.
+	CZ_CUDA_CALL(cudaMemcpyAsync(lData->memDevice2, lData->memDevice1, lData->size, cudaMemcpyDeviceToDevice, mData->stressStream),
+		return -1);
+
+	CZCudaCalcKernelFloat<<<blocksNum, CZ_MEM_THREADS_NUM, 0, mData->stressStream>>>(lData->memDevice1, info->config.calcBlockLoops);
+
+	CZ_CUDA_CALL(cudaGetLastError(),
+		return -1);
+
+	return 0;
+}
+
+/*!	\brief Run one loop of memory test.
+	Each pattern is written and verified while copy and calculation
+	load runs on the other stream.
+	\return \a 0 in case of success, \a -1 in case of error.
 */
-__global__ void CZCudaCalcKernelFloat(
-	void *buf			/*!<[in] Data buffer. */
+static int CZCudaCalcDeviceMemoryLoop(
+	struct CZDeviceInfo *info,	/*!<[in,out] CUDA-device information. */
+	struct CZMemTestLocalData *mData,	/*!<[in] Local data of memory test. */
+	int loop,			/*!<[in] Index of loop. */
+	float *loopMs			/*!<[out] Device time of pattern passes. */
 ) {
-	int index = blockIdx.x * blockDim.x + threadIdx.x;
-	float *arr = (float*)buf;
-	float val1 = index;
-	float val2 = arr[index];
+	struct CZMemErrorLog log;
+	int blocksNum = info->core.muliProcCount * CZ_MEM_BLOCKS_PER_MP;
+	int pattern;
 	int i;
 
-	for(i = 0; i < CZ_CALC_BLOCK_LOOPS; i++) {
-		CZ_CALC_FMAD_256(val1, val2);
-		CZ_CALC_FMAD_256(val1, val2);
-		CZ_CALC_FMAD_256(val1, val2);
-		CZ_CALC_FMAD_256(val1, val2);
-		CZ_CALC_FMAD_256(val1, val2);
-		CZ_CALC_FMAD_256(val1, val2);
-		CZ_CALC_FMAD_256(val1, val2);
-		CZ_CALC_FMAD_256(val1, val2);
-		CZ_CALC_FMAD_256(val1, val2);
-		CZ_CALC_FMAD_256(val1, val2);
-		CZ_CALC_FMAD_256(val1, val2);
-		CZ_CALC_FMAD_256(val1, val2);
-		CZ_CALC_FMAD_256(val1, val2);
-		CZ_CALC_FMAD_256(val1, val2);
-		CZ_CALC_FMAD_256(val1, val2);
-		CZ_CALC_FMAD_256(val1, val2);
+	if(blocksNum == 0)
+		blocksNum = CZ_MEM_BLOCKS_PER_MP;
+
+	CZ_CUDA_CALL(cudaMemsetAsync(mData->log, 0, sizeof(struct CZMemErrorLog), mData->memStream),
+		return -1);
+
+	CZ_CUDA_CALL(cudaEventRecord(mData->start, mData->memStream),
+		return -1);
+
+	for(pattern = 0; pattern < CZMemPatternNum; pattern++) {
+		unsigned int seed =
+			(pattern == CZMemPatternWalkingOnes)? (unsigned int)loop:
+			(pattern == CZMemPatternRandom)? (unsigned int)(loop + 1) * 0x9e3779b9u:
+			(loop & 1)? 0xffffffffu: 0;
+
+		if(CZCudaCalcDeviceMemoryStress(info, mData) != 0)
+			return -1;
+
+		CZCudaMemKernelWrite<<<blocksNum, CZ_MEM_THREADS_NUM, 0, mData->memStream>>>(mData->region, mData->words, pattern, seed);
+		CZCudaMemKernelVerify<<<blocksNum, CZ_MEM_THREADS_NUM, 0, mData->memStream>>>(mData->region, mData->words, pattern, seed, mData->log);
+
+		CZ_CUDA_CALL(cudaGetLastError(),
+			return -1);
+	}
+
+	CZ_CUDA_CALL(cudaEventRecord(mData->stop, mData->memStream),
+		return -1);
+
+	CZ_CUDA_CALL(cudaMemcpyAsync(&log, mData->log, sizeof(log), cudaMemcpyDeviceToHost, mData->memStream),
+		return -1);
+
+	CZ_CUDA_CALL(cudaStreamSynchronize(mData->memStream),
+		return -1);
+
+	CZ_CUDA_CALL(cudaStreamSynchronize(mData->stressStream),
+		return -1);
+
+	CZ_CUDA_CALL(cudaEventElapsedTime(loopMs, mData->start, mData->stop),
+		return -1);
+
+	info->memTest.passes += CZMemPatternNum;
+	info->memTest.errors += log.count;
+
+	for(i = 0; (i < (int)log.count) && (i < CZ_MEM_ERRORS_MAX); i++) {
+		struct CZDeviceInfoMemError *error;
+
+		CZLogKV(CZLogLevelError, "mem-error", "dev=%d loop=%d pattern=%d offset=%llu address=0x%llx expected=0x%08x actual=0x%08x",
+			info->num, loop, log.pattern[i], log.offset[i],
+			(unsigned long long)(size_t)mData->region + log.offset[i],
+			log.expected[i], log.actual[i]);
+
+		if(info->memTest.errorNum == CZ_MEM_ERRORS_MAX)
+			continue;
+
+		error = &info->memTest.error[info->memTest.errorNum++];
+		error->offset = (size_t)log.offset[i];
+		error->address = (size_t)mData->region + error->offset;
+		error->expected = log.expected[i];
+		error->actual = log.actual[i];
+		error->pattern = log.pattern[i];
+	}
+
+	return 0;
+}
+
+/*!	\brief Run device memory integrity test.
+	Test runs up to \a info->config.calcLoops loops, each loop writes and
+	verifies all patterns of enum #CZMemPattern. Test marks its result
+	as partial in \a info->partialMask if not all loops were done.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZCudaCalcDeviceMemoryTest(
+	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
+) {
+	struct CZMemTestLocalData mData;
+	struct CZDeviceInfoTime *time = &info->memTest.time;
+	double eccCorrected = 0;
+	double eccUncorrected = 0;
+	float timeMs = 0.0;
+	double startMs;
+	double testUs;
+	int r = 0;
+	int i;
+
+	if(CZCudaCalcDeviceMemoryAlloc(info, &mData) != 0)
+		return -1;
+
+	info->memTest.eccValid = (CZNvmlReadEcc(info, &eccCorrected, &eccUncorrected) == 0);
+
+	CZLog(CZLogLevelLow, "Starting memory test on %s.", info->deviceName);
+
+	startMs = CZGetTimeMs();
+	testUs = CZTraceTimeUs();
+
+	for(i = 0; i < info->config.calcLoops; i++) {
+
+		float loopMs = 0.0;
+		double loopUs;
+		double wallMs;
+		double cpuMs;
+
+		if(CZCudaCalcDeviceTestBreak(info, startMs, i)) {
+			info->partialMask |= CZTestMemory;
+			break;
+		}
+
+		loopUs = CZTraceTimeUs();
+		wallMs = CZGetTimeMs();
+		cpuMs = CZCpuThreadTimeMs();
+
+		if(CZCudaCalcDeviceMemoryLoop(info, &mData, i, &loopMs) != 0) {
+			r = -1;
+			break;
+		}
+
+		wallMs = CZGetTimeMs() - wallMs;
+		cpuMs = CZCpuThreadTimeMs() - cpuMs;
+
+		timeMs += loopMs;
+
+		time->deviceMs += loopMs;
+		time->wallMs += (float)wallMs;
+		time->cpuMs += (float)cpuMs;
+		time->amount += 2.0 * CZMemPatternNum * (double)info->memTest.size;
+
+		CZTraceHostSpan("memory", CZTestName(CZTestMemory), info->num, loopUs);
+		CZTraceDeviceSpan("memory", CZTestName(CZTestMemory), info->num, loopUs, loopMs * 1000.0);
+
+		CZLogKV(CZLogLevelLow, "mem-loop", "dev=%d loop=%d bytes=%lu ms=%f errors=%.0f",
+			info->num, i, (unsigned long)info->memTest.size, loopMs, info->memTest.errors);
+	}
+
+	CZTraceHostSpan("memory", "test", info->num, testUs);
+
+	CZCudaCalcDeviceMemoryFree(&mData);
+
+	if(info->memTest.eccValid) {
+		double corrected;
+		double uncorrected;
+		if(CZNvmlReadEcc(info, &corrected, &uncorrected) == 0) {
+			info->memTest.eccCorrected = corrected - eccCorrected;
+			info->memTest.eccUncorrected = uncorrected - eccUncorrected;
+		} else {
+			info->memTest.eccValid = 0;
+		}
 	}
 
-	arr[index] = val1 + val2;
+	CZLog(CZLogLevelLow, "Test complete in %f ms (%d loops).", timeMs, i);
+
+	if(timeMs != 0)
+		info->memTest.band = (float)(1000.0 * time->amount / (timeMs * (double)(1 << 10)));
+
+	if(info->memTest.errors != 0)
+		CZLog(CZLogLevelError, "Memory test found %.0f mismatching words on %s!",
+			info->memTest.errors, info->deviceName);
+
+	CZLogKV(CZLogLevelModerate, "mem-test", "dev=%d bytes=%lu passes=%d errors=%.0f kib_s=%f ecc=%d ecc_valid=%d ecc_corrected=%.0f ecc_uncorrected=%.0f",
+		info->num, (unsigned long)info->memTest.size, info->memTest.passes, info->memTest.errors,
+		info->memTest.band, info->mem.errorCorrection, info->memTest.eccValid,
+		info->memTest.eccCorrected, info->memTest.eccUncorrected);
+
+	return r;
+}
+
+/*!	\brief Check integrity of CUDA-device memory.
+	Walking ones, pseudo-random and address patterns are written to a
+	large device memory region and verified on device while copy and
+	calculation load runs concurrently. Mismatching words are counted and
+	the first of them are recorded. ECC error counters are read before
+	and after test if NVML is available. Test runs only if it is selected
+	in \a info->testMask, otherwise its results are reset to \a 0.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZCudaCalcDeviceMemory(
+	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
+) {
+	void *sampler;
+	int r;
+
+	if(info == NULL)
+		return -1;
+
+	if(CZCudaCalcDeviceMemoryReset(info) != 0)
+		return -1;
+
+	if((info->testMask & CZTestMemory) == 0)
+		return 0;
+
+	if(!CZCudaIsInit())
+		return -1;
+
+	if(CZCudaCalcDeviceBandwidthAlloc(info) != 0)
+		return -1;
+
+	sampler = CZNvmlSampleStart(info);
+	r = CZCudaCalcDeviceMemoryTest(info);
+	CZNvmlSampleStop(sampler, &info->memTest.time.tele);
+
+	return r;
 }
 
-/*!	\brief GPU code for double-precision test.
+#define CZ_ALLOC_SIZE_MIN	(4 * (1 << 10))		/*!< Smallest buffer of allocation test. */
+#define CZ_ALLOC_BYTES		(256 * (1 << 20))	/*!< Amount of memory allocated for each size of allocation test. */
+#define CZ_ALLOC_REPS_MIN	4			/*!< Minimal number of allocations of each size and kind. */
+#define CZ_ALLOC_REPS_MAX	64			/*!< Maximal number of allocations of each size and kind. */
+
+/*!	\brief Local service data of allocation test.
 */
-__global__ void CZCudaCalcKernelDouble(
-	void *buf			/*!<[in] Data buffer. */
+struct CZAllocLocalData {
+	void		*memPage;	/*!< Pageable buffer to be registered. */
+	cudaStream_t	stream;		/*!< Stream of pool allocations. */
+	int		poolSupported;	/*!< 1 if memory pools are supported. */
+#if CUDART_VERSION >= 11020
+	cudaMemPool_t	pool;		/*!< Memory pool keeping released memory. */
+#endif
+};
+
+/*!	\brief Compare two latencies for \a qsort().
+	\return negative, zero or positive value like \a strcmp().
+*/
+static int CZCudaAllocCompare(
+	const void *a,			/*!<[in] The first latency. */
+	const void *b			/*!<[in] The second latency. */
 ) {
-	int index = blockIdx.x * blockDim.x + threadIdx.x;
-	double *arr = (double*)buf;
-	double val1 = index;
-	double val2 = arr[index];
-	int i;
+	double x = *(const double*)a;
+	double y = *(const double*)b;
 
-	for(i = 0; i < CZ_CALC_BLOCK_LOOPS; i++) {
-		CZ_CALC_DFMAD_256(val1, val2);
-		CZ_CALC_DFMAD_256(val1, val2);
-		CZ_CALC_DFMAD_256(val1, val2);
-		CZ_CALC_DFMAD_256(val1, val2);
-		CZ_CALC_DFMAD_256(val1, val2);
-		CZ_CALC_DFMAD_256(val1, val2);
-		CZ_CALC_DFMAD_256(val1, val2);
-		CZ_CALC_DFMAD_256(val1, val2);
-		CZ_CALC_DFMAD_256(val1, val2);
-		CZ_CALC_DFMAD_256(val1, val2);
-		CZ_CALC_DFMAD_256(val1, val2);
-		CZ_CALC_DFMAD_256(val1, val2);
-		CZ_CALC_DFMAD_256(val1, val2);
-		CZ_CALC_DFMAD_256(val1, val2);
-		CZ_CALC_DFMAD_256(val1, val2);
-		CZ_CALC_DFMAD_256(val1, val2);
-	}
+	return (x < y)? -1: (x > y)? 1: 0;
+}
 
-	arr[index] = val1 + val2;
+/*!	\brief Get name of allocation kind.
+	\return name of kind.
+*/
+static const char *CZCudaAllocName(
+	int kind			/*!<[in] Allocation kind. See enum #CZAllocKind. */
+) {
+	switch(kind) {
+	case CZAllocHostPinned:		return "pinned";
+	case CZAllocHostRegister:	return "register";
+	case CZAllocDevice:		return "device";
+	case CZAllocDevicePool:		return "pool";
+	default:			return "unknown";
+	}
 }
 
-/*!	\brief GPU code for 32-bit integer test.
+/*!	\brief Reset results of allocation test.
+	\return \a 0 in case of success, \a -1 in case of error.
 */
-__global__ void CZCudaCalcKernelInteger32(
-	void *buf			/*!<[in] Data buffer. */
+static int CZCudaCalcDeviceAllocReset(
+	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
 ) {
-	int index = blockIdx.x * blockDim.x + threadIdx.x;
-	int *arr = (int*)buf;
-	int val1 = index;
-	int val2 = arr[index];
-	int i;
 
-	for(i = 0; i < CZ_CALC_BLOCK_LOOPS; i++) {
-		CZ_CALC_IMAD32_256(val1, val2);
-		CZ_CALC_IMAD32_256(val1, val2);
-		CZ_CALC_IMAD32_256(val1, val2);
-		CZ_CALC_IMAD32_256(val1, val2);
-		CZ_CALC_IMAD32_256(val1, val2);
-		CZ_CALC_IMAD32_256(val1, val2);
-		CZ_CALC_IMAD32_256(val1, val2);
-		CZ_CALC_IMAD32_256(val1, val2);
-		CZ_CALC_IMAD32_256(val1, val2);
-		CZ_CALC_IMAD32_256(val1, val2);
-		CZ_CALC_IMAD32_256(val1, val2);
-		CZ_CALC_IMAD32_256(val1, val2);
-		CZ_CALC_IMAD32_256(val1, val2);
-		CZ_CALC_IMAD32_256(val1, val2);
-		CZ_CALC_IMAD32_256(val1, val2);
-		CZ_CALC_IMAD32_256(val1, val2);
-	}
+	if(info == NULL)
+		return -1;
 
-	arr[index] = val1 + val2;
+	memset(&info->alloc, 0, sizeof(info->alloc));
+	info->partialMask &= ~CZTestAlloc;
+
+	return 0;
 }
 
-/*!	\brief GPU code for 24-bit integer test.
+/*!	\brief Free resources of allocation test.
 */
-__global__ void CZCudaCalcKernelInteger24(
-	void *buf			/*!<[in] Data buffer. */
+static void CZCudaCalcDeviceAllocFree(
+	struct CZAllocLocalData *aData	/*!<[in,out] Local data of allocation test. */
 ) {
-	int index = blockIdx.x * blockDim.x + threadIdx.x;
-	int *arr = (int*)buf;
-	int val1 = index;
-	int val2 = arr[index];
-	int i;
-
-	for(i = 0; i < CZ_CALC_BLOCK_LOOPS; i++) {
-		CZ_CALC_IMAD24_256(val1, val2);
-		CZ_CALC_IMAD24_256(val1, val2);
-		CZ_CALC_IMAD24_256(val1, val2);
-		CZ_CALC_IMAD24_256(val1, val2);
-		CZ_CALC_IMAD24_256(val1, val2);
-		CZ_CALC_IMAD24_256(val1, val2);
-		CZ_CALC_IMAD24_256(val1, val2);
-		CZ_CALC_IMAD24_256(val1, val2);
-		CZ_CALC_IMAD24_256(val1, val2);
-		CZ_CALC_IMAD24_256(val1, val2);
-		CZ_CALC_IMAD24_256(val1, val2);
-		CZ_CALC_IMAD24_256(val1, val2);
-		CZ_CALC_IMAD24_256(val1, val2);
-		CZ_CALC_IMAD24_256(val1, val2);
-		CZ_CALC_IMAD24_256(val1, val2);
-		CZ_CALC_IMAD24_256(val1, val2);
-	}
 
-	arr[index] = val1 + val2;
+#if CUDART_VERSION >= 11020
+	if(aData->pool != NULL)
+		cudaMemPoolDestroy(aData->pool);
+#endif
+	if(aData->stream != NULL)
+		cudaStreamDestroy(aData->stream);
+	memset(aData, 0, sizeof(*aData));
 }
 
-/*!	\brief GPU code for 64-bit integer test.
+/*!	\brief Prepare resources of allocation test.
+	Memory pool is created with unlimited release threshold, so it
+	keeps released memory like a long-lived pool of a service does.
+	\return \a 0 in case of success, \a -1 in case of error.
 */
-__global__ void CZCudaCalcKernelInteger64(
-	void *buf			/*!<[in] Data buffer. */
+static int CZCudaCalcDeviceAllocInit(
+	struct CZDeviceInfo *info,	/*!<[in] CUDA-device information. */
+	struct CZAllocLocalData *aData	/*!<[out] Local data of allocation test. */
 ) {
-	int index = blockIdx.x * blockDim.x + threadIdx.x;
-	long long *arr = (long long*)buf;
-	long long val1 = index;
-	long long val2 = arr[index];
-	int i;
+	CZDeviceInfoBandLocalData *lData = (CZDeviceInfoBandLocalData*)info->band.localData;
 
-	for(i = 0; i < CZ_CALC_BLOCK_LOOPS; i++) {
-		CZ_CALC_IMAD64_256(val1, val2);
-		CZ_CALC_IMAD64_256(val1, val2);
-		CZ_CALC_IMAD64_256(val1, val2);
-		CZ_CALC_IMAD64_256(val1, val2);
-		CZ_CALC_IMAD64_256(val1, val2);
-		CZ_CALC_IMAD64_256(val1, val2);
-		CZ_CALC_IMAD64_256(val1, val2);
-		CZ_CALC_IMAD64_256(val1, val2);
-		CZ_CALC_IMAD64_256(val1, val2);
-		CZ_CALC_IMAD64_256(val1, val2);
-		CZ_CALC_IMAD64_256(val1, val2);
-		CZ_CALC_IMAD64_256(val1, val2);
-		CZ_CALC_IMAD64_256(val1, val2);
-		CZ_CALC_IMAD64_256(val1, val2);
-		CZ_CALC_IMAD64_256(val1, val2);
-		CZ_CALC_IMAD64_256(val1, val2);
+	memset(aData, 0, sizeof(*aData));
+	aData->memPage = lData->memHostPage;
+
+	CZ_CUDA_CALL(cudaStreamCreate(&aData->stream),
+		return -1);
+
+#if CUDART_VERSION >= 11020
+	int supported = 0;
+	if((cudaDeviceGetAttribute(&supported, cudaDevAttrMemoryPoolsSupported, info->num) == cudaSuccess) && supported) {
+		cudaMemPoolProps props;
+		unsigned long long threshold = ~0ULL;
+
+		memset(&props, 0, sizeof(props));
+		props.allocType = cudaMemAllocationTypePinned;
+		props.location.type = cudaMemLocationTypeDevice;
+		props.location.id = info->num;
+
+		CZ_CUDA_CALL(cudaMemPoolCreate(&aData->pool, &props),
+			CZCudaCalcDeviceAllocFree(aData);
+			return -1);
+
+		CZ_CUDA_CALL(cudaMemPoolSetAttribute(aData->pool, cudaMemPoolAttrReleaseThreshold, &threshold),
+			CZCudaCalcDeviceAllocFree(aData);
+			return -1);
+
+		aData->poolSupported = 1;
 	}
+	cudaGetLastError();
+#endif
 
-	arr[index] = val1 + val2;
+	if(!aData->poolSupported)
+		CZLog(CZLogLevelLow, "Memory pools are not supported on %s.", info->deviceName);
+
+	return 0;
 }
 
-/*!	\brief Run GPU calculation performace tests.
+/*!	\brief Allocate and release one buffer.
 	\return \a 0 in case of success, \a -1 in case of error.
 */
-static float CZCudaCalcDevicePerformanceTest(
-	struct CZDeviceInfo *info,	/*!<[in,out] CUDA-device information. */
-	int mode			/*!<[in] Run performance test in one of modes. */
+static int CZCudaCalcDeviceAllocOnce(
+	struct CZAllocLocalData *aData,	/*!<[in] Local data of allocation test. */
+	int kind,			/*!<[in] Allocation kind. See enum #CZAllocKind. */
+	size_t size,			/*!<[in] Size of buffer. */
+	double *allocUs,		/*!<[out] Latency of allocation in us. */
+	double *releaseUs		/*!<[out] Latency of release in us. */
 ) {
-	CZDeviceInfoBandLocalData *lData;
-	float timeMs = 0.0;
-	float performanceKOPs = 0.0;
-	cudaEvent_t start;
-	cudaEvent_t stop;
-	int blocksNum = info->heavyMode? info->core.muliProcCount: 1;
-	int i;
+	void *buf = NULL;
+	double timeMs;
 
-	if(info == NULL)
-		return 0;
+	timeMs = CZGetTimeMs();
 
-	CZ_CUDA_CALL(cudaEventCreate(&start),
-		return 0);
+	switch(kind) {
+	case CZAllocHostPinned:
+		CZ_CUDA_CALL(cudaMallocHost(&buf, size),
+			return -1);
+		break;
 
-	CZ_CUDA_CALL(cudaEventCreate(&stop),
-		cudaEventDestroy(start);
-		return 0);
+	case CZAllocHostRegister:
+		CZ_CUDA_CALL(cudaHostRegister(aData->memPage, size, cudaHostRegisterDefault),
+			return -1);
+		break;
 
-	lData = (CZDeviceInfoBandLocalData*)info->band.localData;
+	case CZAllocDevice:
+		CZ_CUDA_CALL(cudaMalloc(&buf, size),
+			return -1);
+		break;
 
-	int threadsNum = info->core.maxThreadsPerBlock;
-	if(threadsNum == 0) {
-		int warpSize = info->core.SIMDWidth;
-		if(warpSize == 0)
-			warpSize = CZ_DEF_WARP_SIZE;
-		threadsNum = warpSize * 2;
-		if(threadsNum > CZ_DEF_THREADS_MAX)
-			threadsNum = CZ_DEF_THREADS_MAX;
+#if CUDART_VERSION >= 11020
+	case CZAllocDevicePool:
+		CZ_CUDA_CALL(cudaMallocFromPoolAsync(&buf, size, aData->pool, aData->stream),
+			return -1);
+		break;
+#endif
+
+	default: // WTF!
+		return -1;
 	}
 
-	CZLog(CZLogLevelLow, "Starting %s test on %s on %d block(s) %d thread(s) each.",
-		(mode == CZ_CALC_MODE_FLOAT)? "single-precision float":
-		(mode == CZ_CALC_MODE_DOUBLE)? "double-precision float":
-		(mode == CZ_CALC_MODE_INTEGER32)? "32-bit integer":
-		(mode == CZ_CALC_MODE_INTEGER24)? "24-bit integer":
-		(mode == CZ_CALC_MODE_INTEGER64)? "64-bit integer": "unknown",
-		info->deviceName,
-		blocksNum,
-		threadsNum);
+	*allocUs = (CZGetTimeMs() - timeMs) * 1000.0;
 
-	for(i = 0; i < CZ_CALC_LOOPS_NUM; i++) {
+	timeMs = CZGetTimeMs();
 
-		float loopMs = 0.0;
+	switch(kind) {
+	case CZAllocHostPinned:
+		CZ_CUDA_CALL(cudaFreeHost(buf),
+			return -1);
+		break;
 
-		CZ_CUDA_CALL(cudaEventRecord(start, 0),
-			cudaEventDestroy(start);
-			cudaEventDestroy(stop);
-			return 0);
+	case CZAllocHostRegister:
+		CZ_CUDA_CALL(cudaHostUnregister(aData->memPage),
+			return -1);
+		break;
 
-		switch(mode) {
-		case CZ_CALC_MODE_FLOAT:
-			CZCudaCalcKernelFloat<<<blocksNum, threadsNum>>>(lData->memDevice1);
-			break;
+	case CZAllocDevice:
+		CZ_CUDA_CALL(cudaFree(buf),
+			return -1);
+		break;
 
-		case CZ_CALC_MODE_DOUBLE:
-			CZCudaCalcKernelDouble<<<blocksNum, threadsNum>>>(lData->memDevice1);
-			break;
+#if CUDART_VERSION >= 11020
+	case CZAllocDevicePool:
+		CZ_CUDA_CALL(cudaFreeAsync(buf, aData->stream),
+			return -1);
+		CZ_CUDA_CALL(cudaStreamSynchronize(aData->stream),
+			return -1);
+		break;
+#endif
+	}
 
-		case CZ_CALC_MODE_INTEGER32:
-			CZCudaCalcKernelInteger32<<<blocksNum, threadsNum>>>(lData->memDevice1);
-			break;
+	*releaseUs = (CZGetTimeMs() - timeMs) * 1000.0;
 
-		case CZ_CALC_MODE_INTEGER24:
-			CZCudaCalcKernelInteger24<<<blocksNum, threadsNum>>>(lData->memDevice1);
-			break;
+	return 0;
+}
 
-		case CZ_CALC_MODE_INTEGER64:
-			CZCudaCalcKernelInteger64<<<blocksNum, threadsNum>>>(lData->memDevice1);
-			break;
+/*!	\brief Summarize latencies of one allocation kind and size.
+*/
+static void CZCudaCalcDeviceAllocStat(
+	struct CZDeviceInfoAllocStat *stat,	/*!<[out] Latency distribution. */
+	double *samples,		/*!<[in,out] Allocation latencies. They are sorted. */
+	int num,			/*!<[in] Number of latencies. */
+	double releaseUs		/*!<[in] Sum of release latencies. */
+) {
+	double sum = 0;
+	int i;
 
-		default: // WTF!
-			cudaEventDestroy(start);
-			cudaEventDestroy(stop);
-			return 0;
+	qsort(samples, num, sizeof(samples[0]), CZCudaAllocCompare);
+
+	for(i = 0; i < num; i++)
+		sum += samples[i];
+
+	stat->samples = num;
+	stat->minUs = (float)samples[0];
+	stat->medianUs = (float)samples[num / 2];
+	stat->p99Us = (float)samples[(num * 99) / 100];
+	stat->maxUs = (float)samples[num - 1];
+	stat->meanUs = (float)(sum / num);
+	stat->releaseUs = (float)(releaseUs / num);
+}
+
+/*!	\brief Run memory allocation and registration test.
+	Buffer sizes grow four times from #CZ_ALLOC_SIZE_MIN up to transfer
+	buffer size. About #CZ_ALLOC_BYTES bytes are allocated for each size
+	and kind. Test is stopped by abort flag and time limit like other
+	tests.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZCudaCalcDeviceAllocTest(
+	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
+) {
+	CZDeviceInfoBandLocalData *lData = (CZDeviceInfoBandLocalData*)info->band.localData;
+	struct CZAllocLocalData aData;
+	double samples[CZ_ALLOC_REPS_MAX];
+	double startMs;
+	double testUs;
+	size_t size;
+	int i;
+
+	if(CZCudaCalcDeviceAllocInit(info, &aData) != 0)
+		return -1;
+
+	CZLog(CZLogLevelLow, "Starting allocation test on %s.", info->deviceName);
+
+	startMs = CZGetTimeMs();
+	testUs = CZTraceTimeUs();
+
+	for(i = 0, size = CZ_ALLOC_SIZE_MIN; (i < CZ_ALLOC_POINTS_MAX) && (size <= lData->size); i++, size *= 4) {
+		int reps = (int)(CZ_ALLOC_BYTES / size);
+		int kind;
+
+		if(CZCudaCalcDeviceTestBreak(info, startMs, i)) {
+			info->partialMask |= CZTestAlloc;
+			break;
 		}
 
-		CZ_CUDA_CALL(cudaGetLastError(),
-			cudaEventDestroy(start);
-			cudaEventDestroy(stop);
-			return 0);
+		if(reps < CZ_ALLOC_REPS_MIN)
+			reps = CZ_ALLOC_REPS_MIN;
+		if(reps > CZ_ALLOC_REPS_MAX)
+			reps = CZ_ALLOC_REPS_MAX;
 
-		CZ_CUDA_CALL(cudaEventRecord(stop, 0),
-			cudaEventDestroy(start);
-			cudaEventDestroy(stop);
-			return 0);
+		info->alloc.size[i] = (double)size;
 
-		CZ_CUDA_CALL(cudaEventSynchronize(stop),
-			cudaEventDestroy(start);
-			cudaEventDestroy(stop);
-			return 0);
+		for(kind = 0; kind < CZAllocKindNum; kind++) {
+			struct CZDeviceInfoAllocStat *stat = &info->alloc.stat[i][kind];
+			double releaseSum = 0;
+			double kindUs = CZTraceTimeUs();
+			int r;
 
-		CZ_CUDA_CALL(cudaEventElapsedTime(&loopMs, start, stop),
-			cudaEventDestroy(start);
-			cudaEventDestroy(stop);
-			return 0);
+			if((kind == CZAllocDevicePool) && !aData.poolSupported)
+				continue;
 
-		timeMs += loopMs;
-	}
+			for(r = 0; r < reps; r++) {
+				double releaseUs;
+				if(CZCudaCalcDeviceAllocOnce(&aData, kind, size, &samples[r], &releaseUs) != 0) {
+					CZLog(CZLogLevelError, "Can't allocate %lu bytes (%s) on %s.",
+						(unsigned long)size, CZCudaAllocName(kind), info->deviceName);
+					CZCudaCalcDeviceAllocFree(&aData);
+					return -1;
+				}
+				releaseSum += releaseUs;
+			}
 
-	CZLog(CZLogLevelLow, "Test complete in %f ms.", timeMs);
+			CZTraceHostSpan("alloc", CZCudaAllocName(kind), info->num, kindUs);
 
-	performanceKOPs = (
-		(float)info->core.muliProcCount *
-		(float)CZ_CALC_LOOPS_NUM *
-		(float)threadsNum *
-		(float)CZ_CALC_BLOCK_LOOPS *
-		(float)CZ_CALC_OPS_NUM *
-		(float)CZ_CALC_BLOCK_SIZE *
-		(float)CZ_CALC_BLOCK_NUM
-	) / (float)timeMs;
+			CZCudaCalcDeviceAllocStat(stat, samples, reps, releaseSum);
 
-	cudaEventDestroy(start);
-	cudaEventDestroy(stop);
+			CZLogKV(CZLogLevelLow, "alloc", "dev=%d kind=%s bytes=%lu samples=%d min_us=%f median_us=%f p99_us=%f max_us=%f mean_us=%f release_us=%f",
+				info->num, CZCudaAllocName(kind), (unsigned long)size, stat->samples,
+				stat->minUs, stat->medianUs, stat->p99Us, stat->maxUs, stat->meanUs, stat->releaseUs);
+		}
 
-	return performanceKOPs;
+		info->alloc.num = i + 1;
+	}
+
+	CZTraceHostSpan("alloc", "test", info->num, testUs);
+
+	CZCudaCalcDeviceAllocFree(&aData);
+
+	return 0;
 }
 
-/*!	\brief Calculate performance information about CUDA-device.
+/*!	\brief Measure cost of memory allocation on CUDA-device.
+	Pinned host allocation, registration of pageable host memory, device
+	allocation and stream-ordered allocation from memory pool (CUDA 11.2+)
+	are measured over a size sweep. Test runs only if it is selected in
+	\a info->testMask, otherwise its results are reset to \a 0.
 	\return \a 0 in case of success, \a -1 in case of error.
 */
-int CZCudaCalcDevicePerformance(
+int CZCudaCalcDeviceAlloc(
 	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
 ) {
 
 	if(info == NULL)
 		return -1;
 
-	if(CZCudaCalcDevicePerformanceReset(info) != 0)
+	if(CZCudaCalcDeviceAllocReset(info) != 0)
 		return -1;
 
+	if((info->testMask & CZTestAlloc) == 0)
+		return 0;
+
 	if(!CZCudaIsInit())
 		return -1;
 
-	info->perf.calcFloat = CZCudaCalcDevicePerformanceTest(info, CZ_CALC_MODE_FLOAT);
-	if(((info->major > 1)) ||
-		((info->major == 1) && (info->minor >= 3)))
-		info->perf.calcDouble = CZCudaCalcDevicePerformanceTest(info, CZ_CALC_MODE_DOUBLE);
-	info->perf.calcInteger32 = CZCudaCalcDevicePerformanceTest(info, CZ_CALC_MODE_INTEGER32);
-	info->perf.calcInteger24 = CZCudaCalcDevicePerformanceTest(info, CZ_CALC_MODE_INTEGER24);
-	info->perf.calcInteger64 = CZCudaCalcDevicePerformanceTest(info, CZ_CALC_MODE_INTEGER64);
+	if(CZCudaCalcDeviceBandwidthAlloc(info) != 0)
+		return -1;
 
-	return 0;
+	return CZCudaCalcDeviceAllocTest(info);
 }
@@ -8,6 +8,22 @@
 #ifndef CZ_CUDAINFO_H
 #define CZ_CUDAINFO_H
 
+#define CZ_COPY_BUF_SIZE	(16 * (1 << 20))	/*!< Default transfer buffer size. */
+#define CZ_COPY_LOOPS_NUM	8			/*!< Default number of loops to run transfer test to. */
+#define CZ_CALC_BLOCK_LOOPS	16			/*!< Default maximal number of loops to run calculation loop. */
+#define CZ_CALC_BLOCK_SIZE	256			/*!< Size of instruction block. */
+#define CZ_CALC_BLOCK_NUM	16			/*!< Number of instruction blocks in loop. */
+#define CZ_CALC_OPS_NUM		2			/*!< Number of operations per one loop. */
+#define CZ_CALC_LOOPS_NUM	8			/*!< Default number of loops to run performance test to. */
+#define CZ_TEST_TIME_LIMIT	0			/*!< Default time limit of each performance test (ms), 0 for no limit. */
+#define CZ_STAGE_CHUNK_MIN	(64 * (1 << 10))	/*!< Default smallest chunk of staged transfer study. */
+#define CZ_STAGE_CHUNK_MAX	(8 * (1 << 20))		/*!< Default largest chunk of staged transfer study. */
+#define CZ_STAGE_DEPTH		4			/*!< Default max number of pinned chunks in flight of staged transfer study. */
+#define CZ_COLD_RUNS		10			/*!< Default number of cold starts of each module loading mode. */
+#define CZ_CONTEND_PROCS	4			/*!< Default number of processes of contention test. */
+#define CZ_INGEST_CHUNK		(4 * (1 << 20))		/*!< Default chunk of storage ingest test. */
+#define CZ_INGEST_DEPTH		8			/*!< Default number of chunks in flight of storage ingest test. */
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -21,6 +37,44 @@ enum CZComputeMode {
 	CZComputeModeProhibited,		/*!< Compute-prohibited mode. */
 };
 
+/*!	\brief Device types.
+	Each type is served by its own set of information and test functions.
+*/
+enum CZDeviceType {
+	CZDeviceTypeCuda = 0,			/*!< CUDA-device. See CZCuda*() functions. */
+	CZDeviceTypeCpu,			/*!< Host CPU. See CZCpu*() functions. */
+	CZDeviceTypeOpenCL,			/*!< OpenCL device. See CZCl*() functions. */
+};
+
+/*!	\brief Test identifiers.
+	These bits are used in masks of selected tests and test states.
+*/
+enum CZTest {
+	CZTestCopyHDPage = (1 << 0),		/*!< Host pageable to device copy test. */
+	CZTestCopyHDPin = (1 << 1),		/*!< Host pinned to device copy test. */
+	CZTestCopyDHPage = (1 << 2),		/*!< Device to host pageable copy test. */
+	CZTestCopyDHPin = (1 << 3),		/*!< Device to host pinned copy test. */
+	CZTestCopyDD = (1 << 4),		/*!< Device to device copy test. */
+	CZTestCopySweep = (1 << 5),		/*!< Host pinned copy rate versus transfer size. Not included in #CZTestAll. */
+	CZTestCopyStaged = (1 << 6),		/*!< Pageable copy staged through pinned chunks. Not included in #CZTestAll. */
+	CZTestCopyHostMem = (1 << 7),		/*!< Pageable copy versus host memory policy. Not included in #CZTestAll. */
+	CZTestCalcFloat = (1 << 8),		/*!< Single-precision float point test. */
+	CZTestCalcDouble = (1 << 9),		/*!< Double-precision float point test. */
+	CZTestCalcInteger32 = (1 << 10),	/*!< 32-bit integer test. */
+	CZTestCalcInteger24 = (1 << 11),	/*!< 24-bit integer test. */
+	CZTestCalcInteger64 = (1 << 12),	/*!< 64-bit integer test. */
+	CZTestMemory = (1 << 14),		/*!< Device memory integrity test. Not included in #CZTestAll. */
+	CZTestAlloc = (1 << 15),		/*!< Memory allocation and registration cost. Not included in #CZTestAll. */
+	CZTestUser = (1 << 16),			/*!< User kernels listed in manifest. Not included in #CZTestAll. */
+	CZTestColdStart = (1 << 17),		/*!< CUDA cold-start latency in child processes. Not included in #CZTestAll. */
+	CZTestContend = (1 << 18),		/*!< Selected tests run by several processes at once. Not included in #CZTestAll. */
+	CZTestAggregate = (1 << 19),		/*!< Pinned copies on all devices at once. Not included in #CZTestAll. */
+	CZTestIngest = (1 << 20),		/*!< File streamed into device memory. Not included in #CZTestAll. */
+	CZTestCopyAll = 0x001f,			/*!< All copy tests. */
+	CZTestCalcAll = 0x1f00,			/*!< All calculation tests. */
+	CZTestAll = CZTestCopyAll | CZTestCalcAll,	/*!< All tests. */
+};
+
 /*!	\brief Information about CUDA-device core.
 */
 struct CZDeviceInfoCore {
@@ -41,6 +95,14 @@ struct CZDeviceInfoCore {
 	int		maxThreadsPerMultiProcessor;	/*!< Number of maximum resident threads per multiprocessor. */
 	int		cudaCores;		/*!< Number of CUDA cores. */
 	int		streamPrioritiesSupported;	/*!< Stream priorities supported. */
+	int		doublePrecision;	/*!< 1 if double-precision float point calculations are supported. */
+	int		pciLinkGen;		/*!< Generation of current PCI Express link, 0 if unknown. */
+	int		pciLinkWidth;		/*!< Number of lanes of current PCI Express link, 0 if unknown. */
+	int		pciLinkMaxGen;		/*!< Maximal PCI Express generation supported by the device, 0 if unknown. */
+	int		pciLinkMaxWidth;	/*!< Maximal number of PCI Express lanes supported by the device, 0 if unknown. */
+	int		pciPathGen;		/*!< Generation of the slowest link between the device and root port, 0 if unknown. */
+	int		pciPathWidth;		/*!< Number of lanes of the slowest link between the device and root port, 0 if unknown. */
+	int		pciPathDegraded;	/*!< 1 if any link between the device and root port runs below its capability. */
 };
 
 /*!	\brief Information about CUDA-device memory.
@@ -62,6 +124,119 @@ struct CZDeviceInfoMem {
 	int		memoryClockRate;	/*!< Peak memory clock frequency in kilohertz. */
 	int		memoryBusWidth;		/*!< Memory bus width in bits. */
 	int		l2CacheSize;		/*!< L2 cache size in bytes. */
+	int		l1CacheSize;		/*!< L1 data cache size in bytes, 0 if unknown. */
+	int		l3CacheSize;		/*!< L3 cache size in bytes, 0 if unknown or absent. */
+	int		numaNodes;		/*!< Number of NUMA nodes with CPUs, 0 if unknown. */
+};
+
+/*!	\brief Reasons of device clocks reduction.
+	Values are the same as NVML clock throttle reasons.
+*/
+enum CZThrottle {
+	CZThrottleIdle = (1 << 0),		/*!< Nothing is running on device. */
+	CZThrottleAppClocks = (1 << 1),		/*!< Clocks are limited by application clocks setting. */
+	CZThrottleSwPower = (1 << 2),		/*!< Software power cap. */
+	CZThrottleHwSlowdown = (1 << 3),	/*!< Hardware slowdown. */
+	CZThrottleSyncBoost = (1 << 4),		/*!< Clocks are synchronized with other device. */
+	CZThrottleSwThermal = (1 << 5),		/*!< Software thermal slowdown. */
+	CZThrottleHwThermal = (1 << 6),		/*!< Hardware thermal slowdown. */
+	CZThrottleHwPowerBrake = (1 << 7),	/*!< Hardware power brake slowdown. */
+	CZThrottleDisplayClocks = (1 << 8),	/*!< Clocks are limited by display clock setting. */
+	CZThrottleAll = 0x01ff,			/*!< All known reasons. */
+	CZThrottleSlowdown = CZThrottleSwPower | CZThrottleHwSlowdown |
+		CZThrottleSwThermal | CZThrottleHwThermal | CZThrottleHwPowerBrake,	/*!< Reasons slowing down a busy device. */
+};
+
+/*!	\brief Telemetry of device sampled while test runs.
+	Values are 0 if they are not available.
+*/
+struct CZDeviceInfoTele {
+	int		samples;		/*!< Number of samples taken. */
+	float		smClock;		/*!< Average SM clock in MHz. */
+	float		smClockMin;		/*!< Minimal SM clock in MHz. */
+	float		memClock;		/*!< Average memory clock in MHz. */
+	float		power;			/*!< Average power draw in W. */
+	float		powerMax;		/*!< Maximal power draw in W. */
+	float		temperature;		/*!< Maximal temperature in degrees Celsius. */
+	int		throttle;		/*!< Throttle reasons seen during test. See enum #CZThrottle. */
+};
+
+/*!	\brief Host side timing of CUDA-device test.
+	All times are summed over loops of test.
+*/
+struct CZDeviceInfoTime {
+	float		deviceMs;		/*!< Time measured with CUDA events in ms. */
+	float		wallMs;			/*!< Host monotonic time around the same region in ms. */
+	float		cpuMs;			/*!< CPU time consumed by the testing thread in ms. */
+	double		amount;			/*!< Number of bytes transferred or operations done. */
+	struct CZDeviceInfoTele	tele;	/*!< Device telemetry during test. */
+};
+
+#define CZ_SWEEP_POINTS_MAX	16		/*!< Max number of transfer sizes in copy sweep. */
+
+/*!	\brief Host pinned copy rates versus transfer size.
+*/
+struct CZDeviceInfoSweep {
+	int		num;			/*!< Number of measured sizes. */
+	double		size[CZ_SWEEP_POINTS_MAX];	/*!< Transfer size in bytes. */
+	float		copyHDPin[CZ_SWEEP_POINTS_MAX];	/*!< Copy rate from host pinned to device memory in KB/s. */
+	float		copyDHPin[CZ_SWEEP_POINTS_MAX];	/*!< Copy rate from device to host pinned memory in KB/s. */
+};
+
+#define CZ_STAGE_CHUNKS_MAX	8		/*!< Max number of chunk sizes in staged transfer study. */
+#define CZ_STAGE_DEPTHS_MAX	4		/*!< Max pipeline depth in staged transfer study. */
+
+/*!	\brief Pageable copy rates staged through pinned chunks.
+	Pageable buffer is copied chunk by chunk to/from a ring of pinned
+	chunks with \a cudaMemcpyAsync(), so host memcpy of one chunk
+	overlaps DMA of others. Depth 1 does not overlap them.
+*/
+struct CZDeviceInfoStaged {
+	int		numChunks;		/*!< Number of measured chunk sizes. */
+	int		numDepths;		/*!< Number of measured pipeline depths, they are 1 to \a numDepths. */
+	double		chunk[CZ_STAGE_CHUNKS_MAX];	/*!< Chunk size in bytes. */
+	float		copyHD[CZ_STAGE_CHUNKS_MAX][CZ_STAGE_DEPTHS_MAX];	/*!< Staged copy rate from host pageable to device memory in KB/s. */
+	float		copyDH[CZ_STAGE_CHUNKS_MAX][CZ_STAGE_DEPTHS_MAX];	/*!< Staged copy rate from device to host pageable memory in KB/s. */
+	float		pageHD;			/*!< Direct copy rate from host pageable to device memory in KB/s. */
+	float		pageDH;			/*!< Direct copy rate from device to host pageable memory in KB/s. */
+	float		pinHD;			/*!< Copy rate from host pinned to device memory in KB/s. */
+	float		pinDH;			/*!< Copy rate from device to host pinned memory in KB/s. */
+	int		bestHD[2];		/*!< Chunk index and depth of the best host to device rate. */
+	int		bestDH[2];		/*!< Chunk index and depth of the best device to host rate. */
+};
+
+/*!	\brief Policies of host pageable buffer.
+*/
+enum CZHostMemPolicy {
+	CZHostMemUntouched = 0,			/*!< Fresh buffer, pages are faulted in by the first copy. */
+	CZHostMemPrefault,			/*!< Each page is written before copies. */
+	CZHostMemTransparentHuge,		/*!< Prefaulted buffer advised with \a MADV_HUGEPAGE. */
+	CZHostMemHugeTlb,			/*!< Prefaulted buffer backed by hugetlbfs. */
+	CZHostMemPolicyNum,			/*!< Number of policies. */
+};
+
+/*!	\brief Pageable copy rates and host memory counters of one policy.
+	Counters are summed over copies of both directions, they are \a -1
+	if not available.
+*/
+struct CZDeviceInfoHostMemStat {
+	int		valid;			/*!< Buffer of the policy was allocated. */
+	float		prepareMs;		/*!< Time to allocate and prefault buffers in ms. */
+	float		firstHD;		/*!< The first copy rate from host pageable to device memory in KB/s. */
+	float		copyHD;			/*!< Average copy rate from host pageable to device memory in KB/s. */
+	float		firstDH;		/*!< The first copy rate from device to host pageable memory in KB/s. */
+	float		copyDH;			/*!< Average copy rate from device to host pageable memory in KB/s. */
+	double		minorFaults;		/*!< Minor page faults during copies. */
+	double		majorFaults;		/*!< Major page faults during copies. */
+	double		tlbMisses;		/*!< Data TLB load misses of the testing thread during copies. */
+};
+
+/*!	\brief Pageable copy rates versus host memory policy.
+*/
+struct CZDeviceInfoHostMem {
+	struct CZDeviceInfoHostMemStat	stat[CZHostMemPolicyNum];	/*!< Results of each policy. See enum #CZHostMemPolicy. */
+	int		bestHD;			/*!< Policy of the best average host to device rate, \a -1 if none. */
+	int		bestDH;			/*!< Policy of the best average device to host rate, \a -1 if none. */
 };
 
 /*!	\brief Information about CUDA-device bandwidth.
@@ -72,6 +247,14 @@ struct CZDeviceInfoBand {
 	float		copyDHPage;		/*!< Copy rate from device to host pageable memory in KB/s. */
 	float		copyDHPin;		/*!< Copy rate from device to host pinned memory in KB/s. */
 	float		copyDD;			/*!< Copy rate from device to device memory in KB/s. */
+	struct CZDeviceInfoTime	copyHDPageTime;	/*!< Timing of host pageable to device copy. */
+	struct CZDeviceInfoTime	copyHDPinTime;	/*!< Timing of host pinned to device copy. */
+	struct CZDeviceInfoTime	copyDHPageTime;	/*!< Timing of device to host pageable copy. */
+	struct CZDeviceInfoTime	copyDHPinTime;	/*!< Timing of device to host pinned copy. */
+	struct CZDeviceInfoTime	copyDDTime;	/*!< Timing of device to device copy. */
+	struct CZDeviceInfoSweep	sweep;	/*!< Copy rates versus transfer size. */
+	struct CZDeviceInfoStaged	staged;	/*!< Staged copy rates versus chunk size and pipeline depth. */
+	struct CZDeviceInfoHostMem	hostMem;	/*!< Pageable copy rates versus host memory policy. */
 	/* Service part of structure. */
 	void		*localData;
 };
@@ -84,13 +267,245 @@ struct CZDeviceInfoPerf {
 	float		calcInteger32;		/*!< 32-bit integer calculations performance in KOPS. */
 	float		calcInteger24;		/*!< 24-bit integer calculations performance in KOPS. */
 	float		calcInteger64;		/*!< 64-bit integer calculations performance in KOPS. */
+	struct CZDeviceInfoTime	calcFloatTime;	/*!< Timing of single-precision float point test. */
+	struct CZDeviceInfoTime	calcDoubleTime;	/*!< Timing of double-precision float point test. */
+	struct CZDeviceInfoTime	calcInteger32Time;	/*!< Timing of 32-bit integer test. */
+	struct CZDeviceInfoTime	calcInteger24Time;	/*!< Timing of 24-bit integer test. */
+	struct CZDeviceInfoTime	calcInteger64Time;	/*!< Timing of 64-bit integer test. */
+};
+
+/*!	\brief Theoretical peak performance of CUDA-device.
+	Units are the same as in #CZDeviceInfoBand and #CZDeviceInfoPerf,
+	0 means peak is unknown.
+*/
+struct CZDeviceInfoPeak {
+	float		memBandwidth;		/*!< Memory bandwidth in KB/s. */
+	float		pciBandwidth;		/*!< PCI Express bandwidth in one direction in KB/s. */
+	float		calcFloat;		/*!< Single-precision float point calculations performance in KFOPS. */
+	float		calcDouble;		/*!< Double-precision float point calculations performance in KFOPS. */
+	float		calcInteger32;		/*!< 32-bit integer calculations performance in KOPS. */
+	float		calcInteger24;		/*!< 24-bit integer calculations performance in KOPS. */
+	float		calcInteger64;		/*!< 64-bit integer calculations performance in KOPS. */
+};
+
+#define CZ_USER_KERNELS_MAX	8		/*!< Max number of user kernels. */
+#define CZ_USER_NAME_LEN	64		/*!< Length of user kernel name. */
+
+/*!	\brief Results of one user kernel.
+*/
+struct CZDeviceInfoUserKernel {
+	char		name[CZ_USER_NAME_LEN];	/*!< Name of kernel from manifest. */
+	int		launches;		/*!< Number of timed launches. */
+	float		launchUs;		/*!< Device time of one launch in us. */
+	float		calc;			/*!< Operation rate in kilo-operations per second, 0 if manifest gives no count. */
+	float		band;			/*!< Memory rate in KiB/s, 0 if manifest gives no count. */
+	struct CZDeviceInfoTime	time;		/*!< Timing of kernel. */
+};
+
+/*!	\brief Results of user kernels.
+*/
+struct CZDeviceInfoUser {
+	int		num;			/*!< Number of measured kernels. */
+	struct CZDeviceInfoUserKernel	kernel[CZ_USER_KERNELS_MAX];	/*!< Kernel results. */
+};
+
+#define CZ_MEM_ERRORS_MAX	16		/*!< Max number of recorded memory test mismatches. */
+
+/*!	\brief Data patterns of memory test.
+*/
+enum CZMemPattern {
+	CZMemPatternWalkingOnes = 0,		/*!< One bit set in each word, bit walks with address and pass. */
+	CZMemPatternRandom,			/*!< Pseudo-random words generated from address and seed of pass. */
+	CZMemPatternAddress,			/*!< Each word holds its own address, inverted on odd passes. */
+	CZMemPatternNum,			/*!< Number of patterns. */
+};
+
+/*!	\brief Mismatching word found by memory test.
+*/
+struct CZDeviceInfoMemError {
+	size_t		address;		/*!< Device address of word. */
+	size_t		offset;			/*!< Offset of word in tested region in bytes. */
+	unsigned int	expected;		/*!< Value written. */
+	unsigned int	actual;			/*!< Value read back. */
+	int		pattern;		/*!< Pattern of pass. See enum #CZMemPattern. */
+};
+
+/*!	\brief Results of device memory integrity test.
+*/
+struct CZDeviceInfoMemTest {
+	size_t		size;			/*!< Size of tested region in bytes. */
+	int		passes;			/*!< Number of verified pattern passes. */
+	float		band;			/*!< Rate of pattern write and verify in KiB/s. */
+	double		errors;			/*!< Number of mismatching words. */
+	int		errorNum;		/*!< Number of recorded mismatches. */
+	struct CZDeviceInfoMemError	error[CZ_MEM_ERRORS_MAX];	/*!< First mismatches found. */
+	int		eccValid;		/*!< 1 if ECC error counters were read before and after test. */
+	double		eccCorrected;		/*!< Number of ECC errors corrected during test. */
+	double		eccUncorrected;		/*!< Number of ECC errors not corrected during test. */
+	struct CZDeviceInfoTime	time;		/*!< Timing of test. */
+};
+
+#define CZ_ALLOC_POINTS_MAX	12		/*!< Max number of buffer sizes in allocation test. */
+
+/*!	\brief Kinds of memory allocation measured by allocation test.
+*/
+enum CZAllocKind {
+	CZAllocHostPinned = 0,			/*!< \a cudaMallocHost() and \a cudaFreeHost(). */
+	CZAllocHostRegister,			/*!< \a cudaHostRegister() and \a cudaHostUnregister() of pageable buffer. */
+	CZAllocDevice,				/*!< \a cudaMalloc() and \a cudaFree(). */
+	CZAllocDevicePool,			/*!< \a cudaMallocFromPoolAsync() and \a cudaFreeAsync() with memory pool. */
+	CZAllocKindNum,				/*!< Number of allocation kinds. */
+};
+
+/*!	\brief Latency distribution of one allocation kind and size.
+	Latency of allocation is measured on host around API call.
+*/
+struct CZDeviceInfoAllocStat {
+	int		samples;		/*!< Number of measured allocations, 0 if kind is not supported. */
+	float		minUs;			/*!< Minimal allocation latency in us. */
+	float		medianUs;		/*!< Median allocation latency in us. */
+	float		p99Us;			/*!< 99th percentile of allocation latency in us. */
+	float		maxUs;			/*!< Maximal allocation latency in us. */
+	float		meanUs;			/*!< Average allocation latency in us. */
+	float		releaseUs;		/*!< Average latency of release in us. */
+};
+
+/*!	\brief Results of memory allocation and registration test.
+*/
+struct CZDeviceInfoAlloc {
+	int		num;			/*!< Number of measured sizes. */
+	double		size[CZ_ALLOC_POINTS_MAX];	/*!< Buffer size in bytes. */
+	struct CZDeviceInfoAllocStat	stat[CZ_ALLOC_POINTS_MAX][CZAllocKindNum];	/*!< Latency of each size and kind. See enum #CZAllocKind. */
+};
+
+/*!	\brief Stages of CUDA cold start.
+*/
+enum CZColdStage {
+	CZColdLibrary = 0,			/*!< Loading of CUDA driver library. */
+	CZColdInit,				/*!< \a cuInit(). */
+	CZColdContext,				/*!< Creation of primary context. */
+	CZColdJit,				/*!< JIT compilation of PTX into cubin, cache disabled. */
+	CZColdModule,				/*!< Loading of cubin module with many kernels. */
+	CZColdFunction,				/*!< Getting kernel function of module. */
+	CZColdLaunch,				/*!< The first kernel launch up to its completion. */
+	CZColdProcess,				/*!< Whole child process from start to exit. */
+	CZColdStageNum,				/*!< Number of stages. */
+};
+
+/*!	\brief Module loading modes of cold-start test.
+	Mode is set in \a CUDA_MODULE_LOADING environment variable of child
+	process, it is honoured by CUDA 11.7 and newer.
+*/
+enum CZColdLoading {
+	CZColdLoadingDefault = 0,		/*!< Environment is inherited. */
+	CZColdLoadingEager,			/*!< \a CUDA_MODULE_LOADING=EAGER. */
+	CZColdLoadingLazy,			/*!< \a CUDA_MODULE_LOADING=LAZY. */
+	CZColdLoadingNum,			/*!< Number of modes. */
+};
+
+/*!	\brief Latency distribution of one cold-start stage.
+*/
+struct CZDeviceInfoColdStat {
+	int		samples;		/*!< Number of measured cold starts. */
+	float		minMs;			/*!< Minimal latency in ms. */
+	float		medianMs;		/*!< Median latency in ms. */
+	float		p90Ms;			/*!< 90th percentile of latency in ms. */
+	float		maxMs;			/*!< Maximal latency in ms. */
+	float		meanMs;			/*!< Average latency in ms. */
+};
+
+/*!	\brief Results of cold-start test.
+*/
+struct CZDeviceInfoCold {
+	struct CZDeviceInfoColdStat	stat[CZColdLoadingNum][CZColdStageNum];	/*!< Latency of each mode and stage. See enums #CZColdLoading and #CZColdStage. */
+};
+
+#define CZ_CONTEND_PROCS_MAX	16		/*!< Max number of processes of contention test. */
+#define CZ_CONTEND_TESTS_NUM	13		/*!< Number of bits of tests in #CZTestAll. */
+
+/*!	\brief Results of one test run by several processes at once.
+	Copy rates are in KB/s, calculation rates are in KOPS.
+*/
+struct CZDeviceInfoContendTest {
+	float		solo;			/*!< Result of single process. */
+	float		value[CZ_CONTEND_PROCS_MAX];	/*!< Result of each process running together. */
+	float		aggregate;		/*!< Sum of results of all processes. */
+	float		fairness;		/*!< Jain fairness index, from 1/procs for one winner to 1 for equal shares. */
+	float		slowdown;		/*!< Solo result divided by result of the slowest process. */
+};
+
+/*!	\brief Results of multi-process contention test.
+*/
+struct CZDeviceInfoContend {
+	int		procs;			/*!< Number of processes run together, \a 0 if test was not run. */
+	struct CZDeviceInfoContendTest	test[CZ_CONTEND_TESTS_NUM];	/*!< Results indexed by bit number of test in enum #CZTest. */
+};
+
+#define CZ_INGEST_DEPTH_MAX	64		/*!< Max number of chunks in flight of storage ingest test. */
+
+/*!	\brief Stages of storage ingest pipeline.
+*/
+enum CZIngestStage {
+	CZIngestRead = 0,			/*!< Reading of file into pinned chunks. */
+	CZIngestCopy,				/*!< Copying of pinned chunks to device. */
+	CZIngestStageNum,			/*!< Number of stages. */
+};
+
+/*!	\brief Results of storage ingest test.
+	Rates are in KB/s.
+*/
+struct CZDeviceInfoIngest {
+	int		chunk;			/*!< Size of chunk in bytes, \a 0 if test was not run. */
+	int		depth;			/*!< Number of chunks in flight. */
+	int		direct;			/*!< 1 if file was read bypassing page cache. */
+	int		queued;			/*!< 1 if reads were queued asynchronously. */
+	double		bytes;			/*!< Number of bytes streamed by the pipeline. */
+	float		stageRate[CZIngestStageNum];	/*!< Rate of each stage running alone. See enum #CZIngestStage. */
+	float		stallMs[CZIngestStageNum];	/*!< Time the pipeline waited for each stage only. */
+	float		totalMs;		/*!< Time of the pipeline. */
+	float		rate;			/*!< End-to-end rate of the pipeline. */
+	int		bottleneck;		/*!< The slowest stage. See enum #CZIngestStage. */
+};
+
+/*!	\brief Copy direction of aggregate bandwidth test.
+*/
+enum CZAggregateMode {
+	CZAggregateHD = 0,			/*!< Host pinned to device copy. */
+	CZAggregateDH,				/*!< Device to host pinned copy. */
+	CZAggregateBidir,			/*!< Both directions at once. */
+	CZAggregateModeNum,			/*!< Number of copy directions. */
+};
+
+/*!	\brief Runtime parameters of tests.
+	Parameters are set from profile, config file or command line. See
+	CZConfigProfile().
+*/
+struct CZTestConfig {
+	int		profile;		/*!< Index of profile the parameters are based on. */
+	int		copyBufSize;		/*!< Transfer buffer size in bytes. */
+	int		copyLoops;		/*!< Number of loops to run transfer test to. */
+	int		calcBlockLoops;		/*!< Maximal number of loops to run calculation loop. */
+	int		calcLoops;		/*!< Number of loops to run performance test to. */
+	int		calcThreads;		/*!< Threads per block of calculation test, 0 for device maximum. */
+	int		timeLimit;		/*!< Time limit of each test in ms, 0 if tests are not limited. */
+	int		copyVerify;		/*!< 1 if transferred data are verified with checksums after transfer tests. */
+	int		stageChunkMin;		/*!< Smallest chunk of staged transfer study in bytes. */
+	int		stageChunkMax;		/*!< Largest chunk of staged transfer study in bytes. */
+	int		stageDepth;		/*!< Max pipeline depth of staged transfer study. */
+	int		coldRuns;		/*!< Number of cold starts of each module loading mode. */
+	int		contendProcs;		/*!< Number of processes of contention test. */
+	int		aggregateDevices;	/*!< Bit mask of CUDA devices of aggregate bandwidth test, 0 for all devices. */
+	int		ingestChunk;		/*!< Chunk of storage ingest test in bytes. */
+	int		ingestDepth;		/*!< Number of chunks in flight of storage ingest test. */
 };
 
 /*!	\brief Information about CUDA-device.
 */
 struct CZDeviceInfo {
 	int		num;			/*!< Device index. */
+	int		deviceType;		/*!< Type of device. See enum #CZDeviceType. */
 	int		heavyMode;		/*!< Heavy test mode flag. */
+	int		testMask;		/*!< Mask of tests to be run. See enum #CZTest. */
 	char		deviceName[256];	/*!< ASCII string identifying the device. */
 	int		major;			/*!< Major revision numbers defining the device's compute capability. */
 	int		minor;			/*!< Minor revision numbers defining the device's compute capability. */
@@ -100,12 +515,27 @@ struct CZDeviceInfo {
 	int		rtDllVer;		/*!< Runtime Dll version. */
 	char		*rtDllVerStr;		/*!< Runtime Dll version string. */
 	int		tccDriver;		/*!< 1 if the device is using a TCC driver or 0 if not. */
+	int		timeLimit;		/*!< Time limit of each test in ms, 0 if tests are not limited. */
+	volatile int	*abortFlag;		/*!< Tests are stopped as soon as this flag is set. May be \a NULL. */
+	int		partialMask;		/*!< Mask of tests stopped before all loops were done. See enum #CZTest. */
+	int		corruptMask;		/*!< Mask of transfer tests which delivered corrupted data. See enum #CZTest. */
+	struct CZTestConfig	config;		/*!< Runtime parameters of tests. */
 	struct CZDeviceInfoCore	core;
 	struct CZDeviceInfoMem	mem;
 	struct CZDeviceInfoBand	band;
 	struct CZDeviceInfoPerf	perf;
+	struct CZDeviceInfoPeak	peak;
+	struct CZDeviceInfoUser	user;
+	struct CZDeviceInfoMemTest	memTest;
+	struct CZDeviceInfoAlloc	alloc;
+	struct CZDeviceInfoCold	cold;
+	struct CZDeviceInfoContend	contend;
+	struct CZDeviceInfoIngest	ingest;
 };
 
+const char *CZTestName(int test);
+int CZTestMask(const char *name);
+
 bool CZCudaCheck(void);
 int CZCudaDeviceFound(void);
 int CZCudaReadDeviceInfo(struct CZDeviceInfo *info, int num);
@@ -113,7 +543,18 @@ int CZCudaCalcDeviceSelect(struct CZDeviceInfo *info);
 int CZCudaPrepareDevice(struct CZDeviceInfo *info);
 int CZCudaCalcDeviceBandwidth(struct CZDeviceInfo *info);
 int CZCudaCalcDevicePerformance(struct CZDeviceInfo *info);
+int CZCudaCalcDeviceMemory(struct CZDeviceInfo *info);
+int CZCudaCalcDeviceAlloc(struct CZDeviceInfo *info);
 int CZCudaCleanDevice(struct CZDeviceInfo *info);
+void *CZCudaAggregateAlloc(int num, int size);
+int CZCudaAggregateCopy(void *data, int mode, int loops);
+void CZCudaAggregateFree(void *data);
+void *CZCudaIngestAlloc(int num, int chunk, int depth);
+void *CZCudaIngestBuffer(void *data, int slot);
+int CZCudaIngestCopy(void *data, int slot, int size);
+int CZCudaIngestQuery(void *data, int slot);
+int CZCudaIngestWait(void *data, int slot);
+void CZCudaIngestFree(void *data);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,429 @@
+/*!	\file czconsole.cpp
+	\brief Console mode functions source file.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <QFile>
+#include <QTextStream>
+
+#include <stdio.h>
+
+#include "log.h"
+#include "czconsole.h"
+#include "czdeviceinfo.h"
+#include "cudainfo.h"
+#include "cpuinfo.h"
+#include "clinfo.h"
+#include "peakinfo.h"
+#include "pciinfo.h"
+#include "nvmlinfo.h"
+#include "hostmem.h"
+#include "coldstart.h"
+#include "aggregate.h"
+#include "ingest.h"
+#include "version.h"
+
+/*!	\brief Print one test result line and its host side timing.
+	Tests which were not selected are not printed. Efficiency is printed
+	if theoretical peak of test is known. Device telemetry is printed if
+	it was sampled.
+*/
+static void CZConsolePrintValue(
+	QTextStream &out,		/*!<[in,out] Output stream. */
+	const struct CZDeviceInfo &info,	/*!<[in] Information about CUDA-device. */
+	int test,			/*!<[in] Test identifier. See enum #CZTest. */
+	const char *title,		/*!<[in] Title of value. */
+	double value,			/*!<[in] Value to print. */
+	const char *unit,		/*!<[in] Unit of value. */
+	const struct CZDeviceInfoTime &time	/*!<[in] Host side timing of test. */
+) {
+	if(!(info.testMask & test))
+		return;
+
+	out << "\t" << title << ": ";
+	if(value == 0)
+		out << "--";
+	else
+		out << QString::number(value, 'f', 1) << " " << unit;
+	if(info.partialMask & test)
+		out << " (partial)";
+	if(info.corruptMask & test)
+		out << " (corrupted)";
+	if(CZNvmlIsThrottled(&time.tele))
+		out << " (throttled)";
+	float peak = CZPeakValue(&info, test);
+	if((value != 0) && (peak != 0))
+		out << " (" << QString::number(CZPeakPercent(&info, test), 'f', 1) << "% of peak "
+			<< QString::number(peak / ((test & (CZTestCopyAll | CZTestMemory))? 1024: 1000), 'f', 1) << " " << unit << ")";
+	out << "\n";
+
+	if(time.deviceMs == 0)
+		return;
+
+	out << "\t\tDevice " << QString::number(time.deviceMs, 'f', 2) << " ms"
+		<< ", Wall " << QString::number(time.wallMs, 'f', 2) << " ms"
+		<< ", API overhead " << QString::number(time.wallMs - time.deviceMs, 'f', 2) << " ms"
+		<< ", CPU " << QString::number(time.cpuMs, 'f', 2) << " ms";
+	if((test & (CZTestCopyAll | CZTestMemory)) && (time.amount != 0))
+		out << " (" << QString::number(time.cpuMs * (1024.0 * 1024.0 * 1024.0) / time.amount, 'f', 2) << " ms/GiB)";
+	out << "\n";
+
+	const struct CZDeviceInfoTele &tele = time.tele;
+	if(tele.samples == 0)
+		return;
+
+	out << "\t\tSM " << QString::number(tele.smClock, 'f', 0) << " MHz"
+		<< " (min " << QString::number(tele.smClockMin, 'f', 0) << " MHz)"
+		<< ", Memory " << QString::number(tele.memClock, 'f', 0) << " MHz"
+		<< ", " << QString::number(tele.temperature, 'f', 0) << " C";
+	if(tele.power != 0)
+		out << ", Power " << QString::number(tele.power, 'f', 1) << " W"
+			<< " (max " << QString::number(tele.powerMax, 'f', 1) << " W)"
+			<< ", " << QString::number(CZNvmlPerWatt(value, &tele), 'f', 1) << " " << unit << "/W";
+	out << "\n";
+
+	const char *reasons[CZ_NVML_REASONS_MAX];
+	int reasonsNum = CZNvmlThrottleReasons(&tele, reasons, CZ_NVML_REASONS_MAX);
+	if(reasonsNum != 0) {
+		out << "\t\tClocks limited by:";
+		for(int i = 0; i < reasonsNum; i++)
+			out << " " << reasons[i];
+		out << "\n";
+	}
+}
+
+/*!	\brief Run selected tests on all CUDA-devices and print results.
+	This function does not need GUI. Copy rates are printed in MiB/s,
+	calculation rates in Mflop/s and Miop/s. OpenCL devices are tested
+	after CUDA-devices if \a clDevices is set, host CPU device is tested
+	after them if \a cpuDevice is set. Both work even if there is no CUDA.
+	\return \a 0 in case of success, \a 1 in case of error or if memory
+	test or transfer verification found wrong data.
+*/
+int CZConsoleReport(
+	int testMask,			/*!<[in] Mask of tests to be run. See enum #CZTest. */
+	const QString &fileName,	/*!<[in] Output file name, stdout if empty. */
+	bool cpuDevice,			/*!<[in] Test host CPU device too. */
+	bool clDevices			/*!<[in] Test OpenCL devices too. */
+) {
+	QFile file;
+
+	if(fileName.isEmpty()) {
+		file.open(stdout, QFile::WriteOnly | QFile::Text);
+	} else {
+		file.setFileName(fileName);
+		if(!file.open(QFile::WriteOnly | QFile::Text)) {
+			CZLog(CZLogLevelError, "Cannot write file %s: %s.",
+				fileName.toLocal8Bit().data(), file.errorString().toLocal8Bit().data());
+			return 1;
+		}
+	}
+
+	QTextStream out(&file);
+
+	int num = 0;
+	if(!CZCudaCheck()) {
+		CZLog(CZLogLevelError, "CUDA not found!");
+	} else {
+		num = CZCudaDeviceFound();
+		if(num == 0)
+			CZLog(CZLogLevelError, "No compatible CUDA devices found!");
+	}
+
+	int numCl = 0;
+	if(clDevices) {
+		if(CZClCheck())
+			numCl = CZClDeviceFound();
+		if(numCl == 0)
+			CZLog(CZLogLevelError, "No OpenCL devices found!");
+	}
+
+	int numCpu = cpuDevice? CZCpuDeviceFound(): 0;
+
+	if(num + numCl + numCpu == 0)
+		return 1;
+
+	out << CZ_NAME_SHORT " " CZ_VERSION "\n\n";
+
+	bool dataErrors = false;
+
+	for(int i = 0; i < num + numCl + numCpu; i++) {
+
+		CZCudaDeviceInfo device(
+			(i < num)? i: (i < num + numCl)? (i - num): (i - num - numCl),
+			(i < num)? CZDeviceTypeCuda: (i < num + numCl)? CZDeviceTypeOpenCL: CZDeviceTypeCpu);
+
+		if((device.info().deviceType == CZDeviceTypeCuda) && (device.info().major == 0))
+			continue;
+
+		device.setTestMask(testMask);
+		device.waitPerformance();
+
+		struct CZDeviceInfo info = device.info();
+
+		out << "Device " << i << ": " << info.deviceName << "\n";
+		if(info.deviceType == CZDeviceTypeCpu) {
+			out << "\tSIMD: " << CZCpuSimdName(info.major) << "\n";
+			out << "\tCores: " << info.core.muliProcCount << "\n";
+			out << "\tCaches: L1 " << info.mem.l1CacheSize / 1024 << " KiB"
+				<< ", L2 " << info.mem.l2CacheSize / 1024 << " KiB"
+				<< ", L3 " << info.mem.l3CacheSize / 1024 << " KiB\n";
+			out << "\tNUMA Nodes: " << info.mem.numaNodes << "\n";
+		} else if(info.deviceType == CZDeviceTypeOpenCL) {
+			out << "\tOpenCL Version: " << info.major << "." << info.minor << "\n";
+			out << "\tPlatform: " << info.drvDllVerStr << "\n";
+			out << "\tDriver Version: " << info.drvVersion << "\n";
+		} else {
+			const struct CZArchInfo *arch = CZArchFind(info.major, info.minor);
+			out << "\tCompute Capability: " << info.major << "." << info.minor;
+			if(arch != NULL)
+				out << " (" << arch->name << ")";
+			out << "\n";
+			out << "\tDriver Version: " << info.drvVersion << "\n";
+			if(info.core.pciLinkGen != 0) {
+				out << "\tPCI Express: Gen" << info.core.pciLinkGen << " x" << info.core.pciLinkWidth
+					<< " (max Gen" << info.core.pciLinkMaxGen << " x" << info.core.pciLinkMaxWidth << ")"
+					<< ", path Gen" << info.core.pciPathGen << " x" << info.core.pciPathWidth
+					<< ", " << QString::number(info.peak.pciBandwidth / 1024, 'f', 1) << " MiB/s\n";
+			}
+		}
+		CZConsolePrintValue(out, info, CZTestCopyHDPin, "Host Pinned to Device", info.band.copyHDPin / 1024, "MiB/s", info.band.copyHDPinTime);
+		CZConsolePrintValue(out, info, CZTestCopyHDPage, "Host Pageable to Device", info.band.copyHDPage / 1024, "MiB/s", info.band.copyHDPageTime);
+		CZConsolePrintValue(out, info, CZTestCopyDHPin, "Device to Host Pinned", info.band.copyDHPin / 1024, "MiB/s", info.band.copyDHPinTime);
+		CZConsolePrintValue(out, info, CZTestCopyDHPage, "Device to Host Pageable", info.band.copyDHPage / 1024, "MiB/s", info.band.copyDHPageTime);
+		CZConsolePrintValue(out, info, CZTestCopyDD, "Device to Device", info.band.copyDD / 1024, "MiB/s", info.band.copyDDTime);
+		CZConsolePrintValue(out, info, CZTestCalcFloat, "Single-precision Float", info.perf.calcFloat / 1000, "Mflop/s", info.perf.calcFloatTime);
+		CZConsolePrintValue(out, info, CZTestCalcDouble, "Double-precision Float", info.perf.calcDouble / 1000, "Mflop/s", info.perf.calcDoubleTime);
+		CZConsolePrintValue(out, info, CZTestCalcInteger64, "64-bit Integer", info.perf.calcInteger64 / 1000, "Miop/s", info.perf.calcInteger64Time);
+		CZConsolePrintValue(out, info, CZTestCalcInteger32, "32-bit Integer", info.perf.calcInteger32 / 1000, "Miop/s", info.perf.calcInteger32Time);
+		CZConsolePrintValue(out, info, CZTestCalcInteger24, "24-bit Integer", info.perf.calcInteger24 / 1000, "Miop/s", info.perf.calcInteger24Time);
+		if((info.testMask & CZTestCopyStaged) && (info.band.staged.numChunks != 0)) {
+			const struct CZDeviceInfoStaged &staged = info.band.staged;
+			for(int dir = 0; dir < 2; dir++) {
+				const int *best = (dir == 0)? staged.bestHD: staged.bestDH;
+				float rate = (dir == 0)? staged.copyHD[best[0]][best[1] - 1]: staged.copyDH[best[0]][best[1] - 1];
+				out << "\t" << ((dir == 0)? "Staged Host Pageable to Device": "Staged Device to Host Pageable") << ": "
+					<< QString::number(rate / 1024, 'f', 1) << " MiB/s"
+					<< " with " << QString::number(staged.chunk[best[0]] / 1024, 'f', 0) << " KiB chunks x " << best[1];
+				if(info.partialMask & CZTestCopyStaged)
+					out << " (partial)";
+				out << "\n";
+				out << "\t\tDirect pageable " << QString::number(((dir == 0)? staged.pageHD: staged.pageDH) / 1024, 'f', 1) << " MiB/s"
+					<< ", pinned " << QString::number(((dir == 0)? staged.pinHD: staged.pinDH) / 1024, 'f', 1) << " MiB/s\n";
+				for(int i = 0; i < staged.numChunks; i++) {
+					out << "\t\t" << QString::number(staged.chunk[i] / 1024, 'f', 0) << " KiB:";
+					for(int d = 0; d < staged.numDepths; d++)
+						out << " x" << (d + 1) << " " << QString::number(((dir == 0)? staged.copyHD[i][d]: staged.copyDH[i][d]) / 1024, 'f', 1);
+					out << " MiB/s\n";
+				}
+			}
+		}
+		if((info.testMask & CZTestCopyHostMem) && (info.band.hostMem.bestHD != -1)) {
+			const struct CZDeviceInfoHostMem &hostMem = info.band.hostMem;
+			out << "\tBest Pageable Host Memory: " << CZHostMemPolicyName(hostMem.bestHD) << " to device"
+				<< ", " << CZHostMemPolicyName(hostMem.bestDH) << " from device";
+			if(info.partialMask & CZTestCopyHostMem)
+				out << " (partial)";
+			out << "\n";
+			for(int policy = 0; policy < CZHostMemPolicyNum; policy++) {
+				const struct CZDeviceInfoHostMemStat &stat = hostMem.stat[policy];
+				out << "\t\t" << CZHostMemPolicyName(policy) << ": ";
+				if(!stat.valid) {
+					out << "--\n";
+					continue;
+				}
+				out << "to device " << QString::number(stat.copyHD / 1024, 'f', 1) << " MiB/s"
+					<< " (first " << QString::number(stat.firstHD / 1024, 'f', 1) << ")"
+					<< ", from device " << QString::number(stat.copyDH / 1024, 'f', 1) << " MiB/s"
+					<< " (first " << QString::number(stat.firstDH / 1024, 'f', 1) << ")"
+					<< ", prepare " << QString::number(stat.prepareMs, 'f', 1) << " ms";
+				if(stat.minorFaults >= 0)
+					out << ", faults " << QString::number(stat.minorFaults, 'f', 0)
+						<< "/" << QString::number(stat.majorFaults, 'f', 0);
+				if(stat.tlbMisses >= 0)
+					out << ", TLB misses " << QString::number(stat.tlbMisses, 'f', 0);
+				out << "\n";
+			}
+		}
+		CZConsolePrintValue(out, info, CZTestMemory, "Memory Integrity", info.memTest.band / 1024, "MiB/s", info.memTest.time);
+		if(info.testMask & CZTestMemory) {
+			out << "\t\tRegion " << info.memTest.size / (1024 * 1024) << " MiB"
+				<< ", " << info.memTest.passes << " passes"
+				<< ", " << QString::number(info.memTest.errors, 'f', 0) << " errors"
+				<< ", ECC " << (info.mem.errorCorrection? "on": "off");
+			if(info.memTest.eccValid)
+				out << " (" << QString::number(info.memTest.eccCorrected, 'f', 0) << " corrected"
+					<< ", " << QString::number(info.memTest.eccUncorrected, 'f', 0) << " uncorrected)";
+			out << "\n";
+			for(int k = 0; k < info.memTest.errorNum; k++) {
+				const struct CZDeviceInfoMemError &error = info.memTest.error[k];
+				out << "\t\tMismatch at 0x" << QString::number((qulonglong)error.address, 16)
+					<< " (offset 0x" << QString::number((qulonglong)error.offset, 16) << ")"
+					<< ": expected 0x" << QString("%1").arg(error.expected, 8, 16, QChar('0'))
+					<< ", read 0x" << QString("%1").arg(error.actual, 8, 16, QChar('0'))
+					<< ", " << ((error.pattern == CZMemPatternWalkingOnes)? "walking ones":
+						(error.pattern == CZMemPatternRandom)? "random": "address") << " pattern\n";
+			}
+			if(info.memTest.errors != 0) {
+				dataErrors = true;
+				if(!info.mem.errorCorrection)
+					out << "\tWarning: Device memory returns wrong data and ECC is off!\n";
+				else
+					out << "\tWarning: Device memory returns wrong data not fixed by ECC!\n";
+			} else if(info.memTest.eccCorrected != 0) {
+				out << "\tWarning: ECC corrected memory errors during test!\n";
+			}
+		}
+		if((info.testMask & CZTestAlloc) && (info.alloc.num != 0)) {
+			static const char *kindNames[CZAllocKindNum] = {"pinned", "register", "device", "pool"};
+			out << "\tAllocation Latency:";
+			if(info.partialMask & CZTestAlloc)
+				out << " (partial)";
+			out << "\n";
+			for(int i = 0; i < info.alloc.num; i++) {
+				out << "\t\t" << QString::number(info.alloc.size[i] / 1024, 'f', 0) << " KiB:\n";
+				for(int kind = 0; kind < CZAllocKindNum; kind++) {
+					const struct CZDeviceInfoAllocStat &stat = info.alloc.stat[i][kind];
+					out << "\t\t\t" << kindNames[kind] << ": ";
+					if(stat.samples == 0) {
+						out << "--\n";
+						continue;
+					}
+					out << "median " << QString::number(stat.medianUs, 'f', 1) << " us"
+						<< ", p99 " << QString::number(stat.p99Us, 'f', 1) << " us"
+						<< ", max " << QString::number(stat.maxUs, 'f', 1) << " us"
+						<< ", release " << QString::number(stat.releaseUs, 'f', 1) << " us";
+					if(stat.meanUs != 0)
+						out << ", " << QString::number(info.alloc.size[i] / (1024 * 1024) / (stat.meanUs / 1000000), 'f', 1) << " MiB/s";
+					out << "\n";
+				}
+			}
+		}
+		for(int k = 0; k < info.user.num; k++) {
+			const struct CZDeviceInfoUserKernel &kernel = info.user.kernel[k];
+			QByteArray title = QByteArray("Kernel ") + kernel.name;
+			if(kernel.calc != 0)
+				CZConsolePrintValue(out, info, CZTestUser, title.constData(), kernel.calc / 1000, "Mop/s", kernel.time);
+			else
+				CZConsolePrintValue(out, info, CZTestUser, title.constData(), kernel.band / 1024, "MiB/s", kernel.time);
+			out << "\t\tLaunch " << QString::number(kernel.launchUs, 'f', 2) << " us";
+			if(kernel.band != 0) {
+				out << ", Memory " << QString::number(kernel.band / 1024, 'f', 1) << " MiB/s";
+				if(info.peak.memBandwidth != 0)
+					out << " (" << QString::number(100.0 * kernel.band / info.peak.memBandwidth, 'f', 1) << "% of peak)";
+			}
+			out << "\n";
+		}
+		if((info.testMask & CZTestColdStart) && (info.cold.stat[CZColdLoadingDefault][CZColdProcess].samples != 0)) {
+			out << "\tCold Start: " << QString::number(info.cold.stat[CZColdLoadingDefault][CZColdProcess].medianMs, 'f', 1) << " ms";
+			if(info.partialMask & CZTestColdStart)
+				out << " (partial)";
+			out << "\n";
+			for(int mode = 0; mode < CZColdLoadingNum; mode++) {
+				if(info.cold.stat[mode][CZColdProcess].samples == 0)
+					continue;
+				out << "\t\t" << CZColdLoadingName(mode) << " loading, "
+					<< info.cold.stat[mode][CZColdProcess].samples << " runs, median/p90 ms:";
+				for(int stage = 0; stage < CZColdStageNum; stage++) {
+					const struct CZDeviceInfoColdStat &stat = info.cold.stat[mode][stage];
+					out << " " << CZColdStageName(stage) << " " << QString::number(stat.medianMs, 'f', 1)
+						<< "/" << QString::number(stat.p90Ms, 'f', 1);
+				}
+				out << "\n";
+			}
+		}
+		if((info.testMask & CZTestContend) && (info.contend.procs != 0)) {
+			out << "\tContention: " << info.contend.procs << " processes";
+			if(info.partialMask & CZTestContend)
+				out << " (partial)";
+			out << "\n";
+			for(int bit = 0; bit < CZ_CONTEND_TESTS_NUM; bit++) {
+				const struct CZDeviceInfoContendTest &test = info.contend.test[bit];
+				if(test.aggregate == 0)
+					continue;
+				double scale = ((1 << bit) & CZTestCopyAll)? 1024: 1000;
+				const char *unit = ((1 << bit) & CZTestCopyAll)? "MiB/s": "Mop/s";
+				out << "\t\t" << CZCudaDeviceInfo::testName(1 << bit) << ": solo "
+					<< QString::number(test.solo / scale, 'f', 1) << " " << unit
+					<< ", aggregate " << QString::number(test.aggregate / scale, 'f', 1) << " " << unit
+					<< ", fairness " << QString::number(test.fairness, 'f', 3)
+					<< ", worst slowdown " << QString::number(test.slowdown, 'f', 2) << "x\n";
+				out << "\t\t\tPer process:";
+				for(int i = 0; i < info.contend.procs; i++)
+					out << " " << QString::number(test.value[i] / scale, 'f', 1);
+				out << " " << unit << "\n";
+			}
+		}
+		if((info.testMask & CZTestIngest) && (info.ingest.chunk != 0)) {
+			const struct CZDeviceInfoIngest &ingest = info.ingest;
+			out << "\tStorage Ingest: " << QString::number(ingest.rate / 1024, 'f', 1) << " MiB/s"
+				<< " with " << ingest.chunk / 1024 << " KiB chunks x " << ingest.depth;
+			if(info.partialMask & CZTestIngest)
+				out << " (partial)";
+			out << "\n";
+			out << "\t\t" << (ingest.direct? "Direct": "Cached") << (ingest.queued? " queued": "") << " reads"
+				<< ", " << QString::number(ingest.bytes / (1024 * 1024), 'f', 0) << " MiB"
+				<< " in " << QString::number(ingest.totalMs, 'f', 1) << " ms\n";
+			out << "\t\tRead alone " << QString::number(ingest.stageRate[CZIngestRead] / 1024, 'f', 1) << " MiB/s"
+				<< ", copy alone " << QString::number(ingest.stageRate[CZIngestCopy] / 1024, 'f', 1) << " MiB/s"
+				<< ", bottleneck " << CZIngestStageName(ingest.bottleneck) << "\n";
+			out << "\t\tWaited for read " << QString::number(ingest.stallMs[CZIngestRead], 'f', 1) << " ms"
+				<< ", for copy " << QString::number(ingest.stallMs[CZIngestCopy], 'f', 1) << " ms\n";
+		}
+		if(info.corruptMask) {
+			dataErrors = true;
+			out << "\tWarning: Transferred data are corrupted!\n";
+		}
+		int link = CZPciCheckLink(&info);
+		if(link & CZPciLinkDegraded)
+			out << "\tWarning: PCI Express link runs below its capability!\n";
+		if(link & CZPciLinkBottleneck)
+			out << "\tWarning: Upstream PCI Express link is slower than device link!\n";
+		if(link & CZPciLinkSlow)
+			out << "\tWarning: Pinned copy rate is low for PCI Express link!\n";
+		out << "\n";
+	}
+
+	if((testMask & CZTestAggregate) && (num != 0)) {
+		struct CZAggregateInfo aggregate;
+		static const char *modeTitles[CZAggregateModeNum] = {"Aggregate Host Pinned to Device", "Aggregate Device to Host Pinned", "Aggregate Bidirectional"};
+
+		struct CZTestConfig config = CZCudaDeviceInfo::defaultConfig();
+
+		if(CZAggregateCalc(&aggregate, &config, NULL) == 0) {
+			out << "All Devices: " << aggregate.devices << " CUDA devices at once";
+			if(aggregate.partial)
+				out << " (partial)";
+			out << "\n";
+			for(int mode = 0; mode < CZAggregateModeNum; mode++) {
+				if(aggregate.aggregate[mode] == 0)
+					continue;
+				out << "\t" << modeTitles[mode] << ": " << QString::number(aggregate.aggregate[mode] / 1024, 'f', 1) << " MiB/s";
+				if(aggregate.soloSum[mode] > 0)
+					out << " (" << QString::number(aggregate.aggregate[mode] * 100 / aggregate.soloSum[mode], 'f', 1)
+						<< "% of solo sum " << QString::number(aggregate.soloSum[mode] / 1024, 'f', 1) << " MiB/s)";
+				out << "\n";
+				for(int i = 0; i < aggregate.devices; i++) {
+					const struct CZAggregateDevice &dev = aggregate.dev[i];
+					if(dev.rate[mode] == 0)
+						continue;
+					out << "\t\tAggregate Share of Device " << dev.num << ": " << QString::number(dev.rate[mode] / 1024, 'f', 1) << " MiB/s"
+						<< ", share " << QString::number(dev.share[mode] * 100, 'f', 1) << "%"
+						<< ", solo " << QString::number(dev.solo[mode] / 1024, 'f', 1) << " MiB/s";
+					if(dev.numaNode >= 0)
+						out << ", NUMA node " << dev.numaNode << (dev.pinned? "": " (not pinned)");
+					out << "\n";
+				}
+			}
+			for(int i = 0; i < aggregate.devices; i++) {
+				if(aggregate.dev[i].failed)
+					out << "\tWarning: Copies on device " << aggregate.dev[i].num << " failed!\n";
+			}
+			out << "\n";
+		}
+	}
+
+	return dataErrors? 1: 0;
+}
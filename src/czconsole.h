@@ -0,0 +1,15 @@
+/*!	\file czconsole.h
+	\brief Console mode functions header file.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#ifndef CZ_CONSOLE_H
+#define CZ_CONSOLE_H
+
+#include <QString>
+
+int CZConsoleReport(int testMask, const QString &fileName, bool cpuDevice = false, bool clDevices = false);
+
+#endif//CZ_CONSOLE_H
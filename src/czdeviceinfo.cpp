@@ -5,8 +5,23 @@
 	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
 */
 
+#include <QStringList>
+#if QT_VERSION >= 0x050000
+#include <atomic>
+#endif//QT_VERSION
+
 #include "log.h"
+#include "trace.h"
 #include "czdeviceinfo.h"
+#include "cpuinfo.h"
+#include "clinfo.h"
+#include "pciinfo.h"
+#include "peakinfo.h"
+#include "kernelinfo.h"
+#include "coldstart.h"
+#include "contend.h"
+#include "ingest.h"
+#include "testconfig.h"
 
 /*!	\class CZUpdateThread
 	\brief This class implements performance data update procedure.
@@ -23,16 +38,20 @@ CZUpdateThread::CZUpdateThread(
 	testRunning = false;
 	deviceReady = false;
 	this->info = info;
+	devNum = info->info().num;
 	index = -1;
 
 	CZLog(CZLogLevelLow, "Thread created");
 }
 
 /*!	\brief Terminates the performance data update thread.
-	This function waits util performance test will be over.
+	This function aborts running performance test and waits util it
+	will be over.
 */
 CZUpdateThread::~CZUpdateThread() {
 
+	info->abortPerformance();
+
 	mutex.lock();
 	deviceReady = true;
 	readyForWork.wakeOne();
@@ -50,14 +69,21 @@ CZUpdateThread::~CZUpdateThread() {
 }
 
 /*!	\brief Push performance test.
+	Abort flag is cleared when the test is queued, unless a test is
+	running: the running test keeps its abort and the new request is
+	dropped as the thread does not wait for a new loop.
 */
 void CZUpdateThread::testPerformance(
 	int index			/*!<[in] Index of device in list. */
 ) {
 	CZLog(CZLogLevelModerate, "Rising update action for device %d", index);
 
+	CZTraceBegin("thread", "wait-ready", devNum);
+
 	mutex.lock();
 	this->index = index;
+	if(!testRunning)
+		info->clearAbortPerformance();
 	if(!isRunning()) {
 		start();
 		CZLog(CZLogLevelLow, "Waiting for device is ready...");
@@ -68,6 +94,8 @@ void CZUpdateThread::testPerformance(
 
 	newLoop.wakeOne();
 	mutex.unlock();
+
+	CZTraceEnd("thread", "wait-ready", devNum);
 }
 
 /*!	\brief Wait for performance test results.
@@ -80,11 +108,15 @@ void CZUpdateThread::waitPerformance() {
 
 	mutex.lock();
 	CZLog(CZLogLevelLow, "Waiting for beginnig of test...");
+	CZTraceBegin("thread", "wait-start", devNum);
 	while(!testRunning)
 		testStart.wait(&mutex);
+	CZTraceEnd("thread", "wait-start", devNum);
 	CZLog(CZLogLevelLow, "Waiting for end of test...");
+	CZTraceBegin("thread", "wait-finish", devNum);
 	while(testRunning)
 		testFinish.wait(&mutex);
+	CZTraceEnd("thread", "wait-finish", devNum);
 	mutex.unlock();
 
 	CZLog(CZLogLevelModerate, "Got results!");
@@ -96,7 +128,13 @@ void CZUpdateThread::run() {
 
 	CZLog(CZLogLevelLow, "Thread started");
 
+	if(CZTraceEnabled()) {
+		CZTraceThreadName(QString("Update thread %1").arg(devNum).toLocal8Bit().constData());
+	}
+
+	CZTraceBegin("thread", "prepare", devNum);
 	info->prepareDevice();
+	CZTraceEnd("thread", "prepare", devNum);
 
 	mutex.lock();
 	deviceReady = true;
@@ -105,7 +143,9 @@ void CZUpdateThread::run() {
 	forever {
 
 		CZLog(CZLogLevelLow, "Waiting for new loop...");
+		CZTraceBegin("thread", "wait-loop", devNum);
 		newLoop.wait(&mutex);
+		CZTraceEnd("thread", "wait-loop", devNum);
 		index = this->index;
 		mutex.unlock();
 
@@ -121,7 +161,9 @@ void CZUpdateThread::run() {
 		testStart.wakeAll();
 		mutex.unlock();
 
+		CZTraceBegin("thread", "update", devNum);
 		info->updateInfo();
+		CZTraceEnd("thread", "update", devNum);
 
 		mutex.lock();
 		testRunning = false;
@@ -142,23 +184,77 @@ void CZUpdateThread::run() {
 	deviceReady = false;
 	mutex.unlock();
 
+	CZTraceBegin("thread", "clean", devNum);
 	info->cleanDevice();
+	CZTraceEnd("thread", "clean", devNum);
+}
+
+/*!	\brief Atomic read of integer with acquire semantics.
+*/
+static inline int CZAtomicLoad(
+	QAtomicInt &value		/*!<[in] Atomic value. */
+) {
+#if QT_VERSION < 0x050000
+	return value.fetchAndAddAcquire(0);
+#else
+	return value.loadAcquire();
+#endif//QT_VERSION
+}
+
+/*!	\brief Memory fence with acquire semantics.
+	Plain reads done before the fence can not be moved after atomic reads
+	done after it.
+*/
+static inline void CZAtomicFenceAcquire(void) {
+#if QT_VERSION < 0x050000
+	QAtomicInt fence;
+	fence.fetchAndAddOrdered(0);
+#else
+	std::atomic_thread_fence(std::memory_order_acquire);
+#endif//QT_VERSION
 }
 
 /*!	\class CZCudaDeviceInfo
 	\brief This class implements a container for CUDA-device information.
+
+	Information structure \a _info belongs to the update thread. Every
+	time it is changed a copy of it is published as a snapshot. Readers
+	get snapshots with info() that never blocks the update thread.
+	Snapshots are kept in two buffers under a sequence counter: the
+	counter is odd while a snapshot is written, buffer index of the
+	last complete snapshot is \a (sequence / 2) % 2. The writer always
+	fills the other buffer, so a reader has to retry only if the writer
+	managed to publish twice during one copy.
 */
 
 /*!	\brief Creates CUDA-device information container.
+	Container of host CPU device is created if \a devType is
+	#CZDeviceTypeCpu, container of OpenCL device is created if it is
+	#CZDeviceTypeOpenCL. All functions of the container call functions
+	of the device type.
 */
 CZCudaDeviceInfo::CZCudaDeviceInfo(
 	int devNum,			/*!<[in] Index of device. */
+	int devType,			/*!<[in] Type of device. See enum #CZDeviceType. */
 	QObject *parent			/*!<[in,out] Parent of CUDA device information. */
 ) 	: QObject(parent) {
 	memset(&_info, 0, sizeof(_info));
+	memset(_snapshot, 0, sizeof(_snapshot));
 	_info.num = devNum;
+	_info.deviceType = devType;
 	_info.heavyMode = 0;
+	_info.testMask = CZTestAll;
+	_info.config = _defaultConfig;
+	if(_info.config.copyLoops == 0)
+		CZConfigDefault(&_info.config);
+	_info.timeLimit = _info.config.timeLimit;
+	_config = _info.config;
+	_heavyMode = _info.heavyMode;
+	_testMask = _info.testMask;
+	_abortFlag = 0;
+	_info.abortFlag = &_abortFlag;
 	readInfo();
+	publishInfo(_info);
 	_thread = new CZUpdateThread(this, this);
 	connect(_thread, SIGNAL(testedPerformance(int)), this, SIGNAL(testedPerformance(int)));
 	_thread->start();
@@ -171,16 +267,41 @@ CZCudaDeviceInfo::~CZCudaDeviceInfo() {
 }
 
 /*!	\brief This function reads CUDA-device basic information.
+	Theoretical peaks of device are calculated here too.
 	\return \a 0 in case of success, \a -1 in case of error.
 */
 int CZCudaDeviceInfo::readInfo() {
-	return CZCudaReadDeviceInfo(&_info, _info.num);
+	int r;
+
+	if(_info.deviceType == CZDeviceTypeCpu)
+		r = CZCpuReadDeviceInfo(&_info, _info.num);
+	else if(_info.deviceType == CZDeviceTypeOpenCL)
+		r = CZClReadDeviceInfo(&_info, _info.num);
+	else {
+		r = CZCudaReadDeviceInfo(&_info, _info.num);
+		if(r == 0)
+			CZPciReadLink(&_info);
+	}
+
+	if(r == 0)
+		CZPeakCalc(&_info);
+	return r;
 }
 
 /*!	\brief This function prepare some buffers for budwidth tests.
 	\return \a 0 in case of success, \a -1 in case of error.
 */
 int CZCudaDeviceInfo::prepareDevice() {
+	if(_info.deviceType == CZDeviceTypeCpu) {
+		if(CZCpuCalcDeviceSelect(&_info) != 0)
+			return 1;
+		return CZCpuPrepareDevice(&_info);
+	}
+	if(_info.deviceType == CZDeviceTypeOpenCL) {
+		if(CZClCalcDeviceSelect(&_info) != 0)
+			return 1;
+		return CZClPrepareDevice(&_info);
+	}
 	if(CZCudaCalcDeviceSelect(&_info) != 0)
 		return 1;
 	return CZCudaPrepareDevice(&_info);
@@ -193,11 +314,48 @@ int CZCudaDeviceInfo::updateInfo() {
 	int r;
 	struct CZDeviceInfo info = _info;
 
-	r = CZCudaCalcDeviceBandwidth(&info);
-	if(r != -1)
-		r = CZCudaCalcDevicePerformance(&info);
+	info.heavyMode = CZAtomicLoad(_heavyMode);
+	info.testMask = CZAtomicLoad(_testMask);
+	_configMutex.lock();
+	info.config = _config;
+	_configMutex.unlock();
+	info.timeLimit = info.config.timeLimit;
+
+	if(info.deviceType == CZDeviceTypeCpu) {
+		r = CZCpuCalcDeviceBandwidth(&info);
+		if(r != -1)
+			r = CZCpuCalcDevicePerformance(&info);
+		if(r != -1)
+			r = CZIngestCalcDevice(&info);
+	} else if(info.deviceType == CZDeviceTypeOpenCL) {
+		r = CZClCalcDeviceBandwidth(&info);
+		if(r != -1)
+			r = CZClCalcDevicePerformance(&info);
+	} else {
+		r = CZCudaCalcDeviceBandwidth(&info);
+		if((r != -1) && (info.testMask & CZTestCopyAll)) {
+			/* Idle device may slow its link down to save power. */
+			CZPciReadLink(&info);
+			CZPeakCalc(&info);
+		}
+		if(r != -1)
+			r = CZCudaCalcDevicePerformance(&info);
+		if(r != -1)
+			r = CZCudaCalcDeviceMemory(&info);
+		if(r != -1)
+			r = CZCudaCalcDeviceAlloc(&info);
+		if(r != -1)
+			r = CZKernelCalcDevice(&info);
+		if(r != -1)
+			r = CZColdCalcDevice(&info);
+		if(r != -1)
+			r = CZContendCalcDevice(&info);
+		if(r != -1)
+			r = CZIngestCalcDevice(&info);
+	}
 
 	_info = info;
+	publishInfo(_info);
 	return r;
 }
 
@@ -205,13 +363,157 @@ int CZCudaDeviceInfo::updateInfo() {
 	\return \a 0 in case of success, \a -1 in case of error.
 */
 int CZCudaDeviceInfo::cleanDevice() {
+	if(_info.deviceType == CZDeviceTypeCpu)
+		return CZCpuCleanDevice(&_info);
+	if(_info.deviceType == CZDeviceTypeOpenCL)
+		return CZClCleanDevice(&_info);
 	return CZCudaCleanDevice(&_info);
 }
 
-/*!	\brief Returns pointer to inforation structure.
+/*!	\brief Publishes a new snapshot of information structure.
+	This function is called by the owner of \a _info only: constructor
+	before the update thread is started and the update thread later.
+*/
+void CZCudaDeviceInfo::publishInfo(
+	const struct CZDeviceInfo &info	/*!<[in] Information to be published. */
+) {
+	int sequence = _sequence.fetchAndAddOrdered(1);
+
+	_snapshot[((sequence >> 1) + 1) & 1] = info;
+
+	_sequence.fetchAndAddOrdered(1);
+}
+
+/*!	\brief Returns a consistent snapshot of information structure.
+	This function never blocks the update thread. Fence keeps the copy of
+	snapshot ahead of the second read of sequence, so a copy torn by
+	publishInfo() is always seen and retried.
+*/
+struct CZDeviceInfo CZCudaDeviceInfo::info() {
+	struct CZDeviceInfo info;
+	int first;
+	int last;
+
+	do {
+		first = CZAtomicLoad(_sequence);
+		info = _snapshot[(first >> 1) & 1];
+		CZAtomicFenceAcquire();
+		last = CZAtomicLoad(_sequence);
+	} while((last - (first | 1)) >= 2);
+
+	return info;
+}
+
+/*!	\brief Returns version of information snapshot.
+	Version is incremented each time new results are published.
+*/
+int CZCudaDeviceInfo::version() {
+	return CZAtomicLoad(_sequence) >> 1;
+}
+
+/*!	\brief Selects heavy mode of performance update.
+*/
+void CZCudaDeviceInfo::setHeavyMode(
+	int heavyMode			/*!<[in] Heavy test mode flag. */
+) {
+	_heavyMode.fetchAndStoreOrdered(heavyMode);
+}
+
+/*!	\brief Returns heavy mode of performance update.
+*/
+int CZCudaDeviceInfo::heavyMode() {
+	return CZAtomicLoad(_heavyMode);
+}
+
+/*!	\brief Selects tests to be run by performance update.
+*/
+void CZCudaDeviceInfo::setTestMask(
+	int testMask			/*!<[in] Mask of tests. See enum #CZTest. */
+) {
+	_testMask.fetchAndStoreOrdered(testMask);
+}
+
+/*!	\brief Returns mask of tests run by performance update.
+*/
+int CZCudaDeviceInfo::testMask() {
+	return CZAtomicLoad(_testMask);
+}
+
+/*!	\brief Sets parameters of tests run by performance update.
+	Parameters are used from the next update.
+*/
+void CZCudaDeviceInfo::setConfig(
+	const struct CZTestConfig &config	/*!<[in] Test parameters. */
+) {
+	_configMutex.lock();
+	_config = config;
+	_configMutex.unlock();
+}
+
+/*!	\brief Returns parameters of tests run by performance update.
+*/
+struct CZTestConfig CZCudaDeviceInfo::config() {
+	_configMutex.lock();
+	struct CZTestConfig config = _config;
+	_configMutex.unlock();
+	return config;
+}
+
+/*!	\brief Parameters of tests of devices created later.
+	Parameters of \a standard profile are used if they are not set.
+*/
+struct CZTestConfig CZCudaDeviceInfo::_defaultConfig;
+
+/*!	\brief Sets parameters of tests of devices created later.
+*/
+void CZCudaDeviceInfo::setDefaultConfig(
+	const struct CZTestConfig &config	/*!<[in] Test parameters. */
+) {
+	_defaultConfig = config;
+}
+
+/*!	\brief Returns parameters of tests of devices created later.
 */
-struct CZDeviceInfo &CZCudaDeviceInfo::info() {
-	return _info;
+struct CZTestConfig CZCudaDeviceInfo::defaultConfig() {
+	return _defaultConfig;
+}
+
+/*!	\brief Converts comma separated list of test names into mask of tests.
+	Known names are \a hd-page, \a hd-pin, \a dh-page, \a dh-pin, \a dd,
+	\a sweep, \a staged, \a hostmem, \a float, \a double, \a int32,
+	\a int24, \a int64, \a memory, \a alloc, \a user, \a coldstart,
+	\a contend, \a aggregate, \a ingest and groups \a copy, \a calc and
+	\a all.
+	\return mask of tests, \a -1 in case of unknown test name.
+*/
+int CZCudaDeviceInfo::parseTestMask(
+	const QString &list		/*!<[in] List of test names. */
+) {
+	QStringList names = list.split(',', QString::SkipEmptyParts);
+	int mask = 0;
+
+	for(int i = 0; i < names.size(); i++) {
+		QString name = names[i].trimmed().toLower();
+		int test = CZTestMask(name.toLocal8Bit().data());
+
+		if(test == -1) {
+			CZLog(CZLogLevelWarning, "Unknown test %s!", name.toLocal8Bit().data());
+			return -1;
+		}
+
+		mask |= test;
+	}
+
+	return mask;
+}
+
+/*!	\brief Get name of test used in test lists.
+	\return name of test, \a "unknown" if \a test is not a single known test.
+*/
+const char *CZCudaDeviceInfo::testName(
+	int test			/*!<[in] Test identifier. See enum #CZTest. */
+) {
+	return CZTestName(test);
 }
 
 /*!	\brief Push performance test in thread.
@@ -227,3 +529,21 @@ void CZCudaDeviceInfo::testPerformance(
 void CZCudaDeviceInfo::waitPerformance() {
 	_thread->waitPerformance();
 }
+
+/*!	\brief Stop running performance test.
+	Test loops check the abort flag between iterations, so the thread
+	becomes free after the current iteration. Results of stopped tests
+	are marked as partial.
+*/
+void CZCudaDeviceInfo::abortPerformance() {
+	_abortFlag = 1;
+}
+
+/*!	\brief Clear the abort flag before the next performance test.
+	This function is called by CZUpdateThread::testPerformance() under
+	its mutex when no test is running, so an abort of a running test or
+	an abort made after the request is queued is never lost.
+*/
+void CZCudaDeviceInfo::clearAbortPerformance() {
+	_abortFlag = 0;
+}
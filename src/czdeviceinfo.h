@@ -11,6 +11,8 @@
 #include <QThread>
 #include <QMutex>
 #include <QWaitCondition>
+#include <QAtomicInt>
+#include <QString>
 
 #include "cudainfo.h"
 
@@ -40,6 +42,7 @@ private:
 	QWaitCondition testFinish;
 	CZCudaDeviceInfo *info;
 
+	int devNum;
 	int index;
 	bool abort;
 	bool deviceReady;
@@ -50,7 +53,7 @@ class CZCudaDeviceInfo: public QObject {
 	Q_OBJECT
 
 public:
-	CZCudaDeviceInfo(int devNum, QObject *parent = 0);
+	CZCudaDeviceInfo(int devNum, int devType = CZDeviceTypeCuda, QObject *parent = 0);
 	~CZCudaDeviceInfo();
 
 	int readInfo();
@@ -58,17 +61,44 @@ public:
 	int updateInfo();
 	int cleanDevice();
 
-	struct CZDeviceInfo &info();
+	struct CZDeviceInfo info();
+	int version();
+
+	void setHeavyMode(int heavyMode);
+	int heavyMode();
+	void setTestMask(int testMask);
+	int testMask();
+	void setConfig(const struct CZTestConfig &config);
+	struct CZTestConfig config();
+
+	static void setDefaultConfig(const struct CZTestConfig &config);
+	static struct CZTestConfig defaultConfig();
+
+	static int parseTestMask(const QString &list);
+	static const char *testName(int test);
 
 	void testPerformance(int index);
 	void waitPerformance();
+	void abortPerformance();
+	void clearAbortPerformance();
 
 signals:
 	void testedPerformance(int index);
 
 private:
 	struct CZDeviceInfo _info;
+	struct CZDeviceInfo _snapshot[2];
+	QAtomicInt _sequence;
+	QAtomicInt _heavyMode;
+	QAtomicInt _testMask;
+	QMutex _configMutex;
+	struct CZTestConfig _config;
+	volatile int _abortFlag;
 	CZUpdateThread *_thread;
+
+	static struct CZTestConfig _defaultConfig;
+
+	void publishInfo(const struct CZDeviceInfo &info);
 };
 
 #endif//CZ_DEVICEINFO_H
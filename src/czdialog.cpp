@@ -22,6 +22,12 @@
 
 #include "log.h"
 #include "czdialog.h"
+#include "cpuinfo.h"
+#include "clinfo.h"
+#include "peakinfo.h"
+#include "pciinfo.h"
+#include "nvmlinfo.h"
+#include "testconfig.h"
 #include "version.h"
 
 /*!	\def CZ_USE_QHTTP
@@ -179,6 +185,7 @@ CZSplashScreen *splash;
 	- Starts Performance data update timer.
 */
 CZDialog::CZDialog(
+	int testMask,		/*!<[in] Mask of tests to be run. See enum #CZTest. */
 	QWidget *parent,	/*!<[in,out] Parent of widget. */
 	Qt::WindowFlags f	/*!<[in] Window flags. */
 )	: QDialog(parent, f /*| Qt::MSWindowsFixedSizeDialogHint*/ | Qt::WindowTitleHint | Qt::WindowSystemMenuHint | Qt::WindowMinimizeButtonHint) {
@@ -203,8 +210,14 @@ CZDialog::CZDialog(
 	exportMenu->addAction(tr("to &Clipboard"), this, SLOT(slotExportToClipboard()));
 	pushExport->setMenu(exportMenu);
 	
-	readCudaDevices();
+	readCudaDevices(testMask);
 	setupDeviceList();
+
+	for(int i = 0; CZConfigProfileName(i) != NULL; i++)
+		comboProfile->addItem(CZConfigProfileName(i));
+	if(!m_deviceList.isEmpty())
+		comboProfile->setCurrentIndex(m_deviceList[0]->config().profile);
+	connect(comboProfile, SIGNAL(activated(int)), SLOT(slotChangeProfile(int)));
 	setupDeviceInfo(comboDevice->currentIndex());
 	setupAboutTab();
 
@@ -229,19 +242,30 @@ CZDialog::~CZDialog() {
 	For each of detected CUDA-devices does following:
 	- Initialize CUDA-data structure.
 	- Reads CUDA-information about device.
+	- Selects tests to be run.
 	- Shows progress message in splash screen.
 	- Starts Performance calculation procedure.
 	- Appends entry in to device-list.
+	OpenCL devices are appended after CUDA-devices, host CPU device
+	is the last one.
 */
-void CZDialog::readCudaDevices() {
+void CZDialog::readCudaDevices(
+	int testMask			/*!<[in] Mask of tests to be run. See enum #CZTest. */
+) {
 
 	int num = getCudaDeviceNumber();
+	int numCl = CZClCheck()? CZClDeviceFound(): 0;
 
-	for(int i = 0; i < num; i++) {
+	for(int i = 0; i < num + numCl + CZCpuDeviceFound(); i++) {
 
-		CZCudaDeviceInfo *info = new CZCudaDeviceInfo(i);
+		CZCudaDeviceInfo *info = (i < num)?
+			new CZCudaDeviceInfo(i):
+			(i < num + numCl)?
+			new CZCudaDeviceInfo(i - num, CZDeviceTypeOpenCL):
+			new CZCudaDeviceInfo(i - num - numCl, CZDeviceTypeCpu);
 
-		if(info->info().major != 0) {
+		if((info->info().deviceType != CZDeviceTypeCuda) || (info->info().major != 0)) {
+			info->setTestMask(testMask);
 			splash->showMessage(tr("Getting information about %1 ...").arg(info->info().deviceName),
 				Qt::AlignLeft | Qt::AlignBottom);
 			qApp->processEvents();
@@ -271,6 +295,8 @@ void CZDialog::freeCudaDevices() {
 	\return number of CUDA-devices in case of success, \a 0 if no CUDA-devies were found.
 */
 int CZDialog::getCudaDeviceNumber() {
+	if(!CZCudaCheck())
+		return 0;
 	return CZCudaDeviceFound();
 }
 
@@ -289,6 +315,11 @@ void CZDialog::setupDeviceList() {
 void CZDialog::slotShowDevice(
 	int index			/*!<[in] Index of device in list. */
 ) {
+	for(int i = 0; i < m_deviceList.size(); i++) {
+		if(i != index)
+			m_deviceList[i]->abortPerformance();
+	}
+
 	setupDeviceInfo(index);
 	if(checkUpdateResults->checkState() == Qt::Checked) {
 		CZLog(CZLogLevelModerate, "Switch device -> update performance for device %d", index);
@@ -303,7 +334,21 @@ void CZDialog::slotUpdatePerformance(
 	int index			/*!<[in] Index of device in list. */
 ) {
 	if(index == comboDevice->currentIndex())
-	setupPerformanceTab(m_deviceList[index]->info());
+		setupPerformanceTab(m_deviceList[index]->info());
+}
+
+/*!	\brief This slot sets test parameters of profile selected by
+	\a index to all devices.
+*/
+void CZDialog::slotChangeProfile(
+	int index			/*!<[in] Index of profile. */
+) {
+	for(int i = 0; i < m_deviceList.size(); i++) {
+		struct CZTestConfig config = m_deviceList[i]->config();
+		if(CZConfigProfile(&config, CZConfigProfileName(index)) == 0)
+			m_deviceList[i]->setConfig(config);
+	}
+	CZLog(CZLogLevelModerate, "Test profile %s is selected", CZConfigProfileName(index));
 }
 
 /*!	\brief This slot updates performance information of current device
@@ -314,11 +359,11 @@ void CZDialog::slotUpdateTimer() {
 	int index = comboDevice->currentIndex();
 	if(checkUpdateResults->checkState() == Qt::Checked) {
 		if(checkHeavyMode->checkState() == Qt::Checked) {
-			m_deviceList[index]->info().heavyMode = 1;
+			m_deviceList[index]->setHeavyMode(1);
 		} else {
-			m_deviceList[index]->info().heavyMode = 0;
+			m_deviceList[index]->setHeavyMode(0);
 		}
-		CZLog(CZLogLevelModerate, "Timer shot -> update performance for device %d in mode %d", index, m_deviceList[index]->info().heavyMode);
+		CZLog(CZLogLevelModerate, "Timer shot -> update performance for device %d in mode %d", index, m_deviceList[index]->heavyMode());
 		m_deviceList[index]->testPerformance(index);
 	} else {
 		CZLog(CZLogLevelModerate, "Timer shot -> update ignored");
@@ -330,20 +375,30 @@ void CZDialog::slotUpdateTimer() {
 void CZDialog::setupDeviceInfo(
 	int dev				/*!<[in] Number/index of CUDA-device. */
 ) {
-	setupCoreTab(m_deviceList[dev]->info());
-	setupMemoryTab(m_deviceList[dev]->info());
-	setupPerformanceTab(m_deviceList[dev]->info());
+	struct CZDeviceInfo info = m_deviceList[dev]->info();
+
+	setupCoreTab(info);
+	setupMemoryTab(info);
+	setupPerformanceTab(info);
 }
 
 /*!	\brief Fill tab "Core" with CUDA devices information.
 */
 void CZDialog::setupCoreTab(
-	struct CZDeviceInfo &info	/*!<[in] Information about CUDA-device. */
+	const struct CZDeviceInfo &info	/*!<[in] Information about CUDA-device. */
 ) {
 	QString deviceName(info.deviceName);
 
 	labelNameText->setText(deviceName);
-	labelCapabilityText->setText(QString("%1.%2").arg(info.major).arg(info.minor));
+	if(info.deviceType == CZDeviceTypeCpu)
+		labelCapabilityText->setText(CZCpuSimdName(info.major));
+	else if(info.deviceType == CZDeviceTypeOpenCL)
+		labelCapabilityText->setText(QString("OpenCL %1.%2").arg(info.major).arg(info.minor));
+	else {
+		labelCapabilityText->setText(QString("%1.%2").arg(info.major).arg(info.minor));
+		const struct CZArchInfo *arch = CZArchFind(info.major, info.minor);
+		labelCapabilityText->setToolTip((arch == NULL)? QString(): tr("Architecture: %1").arg(arch->name));
+	}
 	labelClockText->setText(getValue1000(info.core.clockRate, prefixKilo, tr("Hz")));
 	if(info.core.muliProcCount == 0)
 		labelMultiProcText->setText(tr("Unknown"));
@@ -400,6 +455,17 @@ void CZDialog::setupCoreTab(
 		.arg(info.core.pciDomainID)
 		.arg(info.core.pciBusID)
 		.arg(info.core.pciDeviceID));
+	if(info.core.pciLinkGen != 0) {
+		if(info.core.pciPathDegraded)
+			labelPCIInfoText->setText(labelPCIInfoText->text() + " " + tr("(degraded link)"));
+		labelPCIInfoText->setToolTip(
+			tr("PCI Express Gen%1 x%2").arg(info.core.pciLinkGen).arg(info.core.pciLinkWidth) + "\n" +
+			tr("Device maximum: Gen%1 x%2").arg(info.core.pciLinkMaxGen).arg(info.core.pciLinkMaxWidth) + "\n" +
+			tr("Slowest link to root port: Gen%1 x%2").arg(info.core.pciPathGen).arg(info.core.pciPathWidth) + "\n" +
+			tr("Theoretical bandwidth: %1").arg(getValue1024(info.peak.pciBandwidth, prefixKibi, tr("B/s"))));
+	} else {
+		labelPCIInfoText->setToolTip(QString());
+	}
 
 	QString version;
 	if(strlen(info.drvVersion) != 0) {
@@ -438,13 +504,27 @@ void CZDialog::setupCoreTab(
 /*!	\brief Fill tab "Memory" with CUDA devices information.
 */
 void CZDialog::setupMemoryTab(
-	struct CZDeviceInfo &info	/*!<[in] Information about CUDA-device. */
+	const struct CZDeviceInfo &info	/*!<[in] Information about CUDA-device. */
 ) {
 	labelTotalGlobalText->setText(getValue1024(info.mem.totalGlobal, prefixNothing, tr("B")));
 	labelBusWidthText->setText(tr("%1 bits").arg(info.mem.memoryBusWidth));
 	labelMemClockText->setText(getValue1000(info.mem.memoryClockRate, prefixKilo, tr("Hz")));
+	QString memTip;
+	if(info.peak.memBandwidth != 0)
+		memTip = tr("Theoretical bandwidth: %1").arg(getValue1024(info.peak.memBandwidth, prefixKibi, tr("B/s")));
+	labelBusWidthText->setToolTip(memTip);
+	labelMemClockText->setToolTip(memTip);
 	labelErrorCorrectionText->setText(info.mem.errorCorrection? tr("Yes"): tr("No"));
 	labelL2CasheSizeText->setText(info.mem.l2CacheSize?getValue1024(info.mem.l2CacheSize, prefixNothing, tr("B")): tr("No"));
+	if(info.deviceType == CZDeviceTypeCpu) {
+		labelL2CasheSizeText->setToolTip(
+			tr("L1 Data Cache: %1").arg(getValue1024(info.mem.l1CacheSize, prefixNothing, tr("B"))) + "\n" +
+			tr("L2 Cache: %1").arg(getValue1024(info.mem.l2CacheSize, prefixNothing, tr("B"))) + "\n" +
+			tr("L3 Cache: %1").arg(getValue1024(info.mem.l3CacheSize, prefixNothing, tr("B"))) + "\n" +
+			tr("NUMA Nodes: %1").arg(info.mem.numaNodes));
+	} else {
+		labelL2CasheSizeText->setToolTip(QString());
+	}
 	labelSharedText->setText(getValue1024(info.mem.sharedPerBlock, prefixNothing, tr("B")));
 	labelPitchText->setText(getValue1024(info.mem.maxPitch, prefixNothing, tr("B")));
 	labelTotalConstText->setText(getValue1024(info.mem.totalConst, prefixNothing, tr("B")));
@@ -470,63 +550,217 @@ void CZDialog::setupMemoryTab(
 /*!	\brief Fill tab "Performance" with CUDA devices information.
 */
 void CZDialog::setupPerformanceTab(
-	struct CZDeviceInfo &info	/*!<[in] Information about CUDA-device. */
+	const struct CZDeviceInfo &info	/*!<[in] Information about CUDA-device. */
 ) {
 
-	if(info.band.copyHDPin == 0)
+	if(!(info.testMask & CZTestCopyHDPin))
+		labelHDRatePinText->setText(tr("Not Selected"));
+	else if(info.band.copyHDPin == 0)
 		labelHDRatePinText->setText("--");
 	else
-		labelHDRatePinText->setText(getValue1024(info.band.copyHDPin, prefixKibi, tr("B/s")));
+		labelHDRatePinText->setText(getValue1024(info.band.copyHDPin, prefixKibi, tr("B/s")) + getPartialMark(info, CZTestCopyHDPin) + getPeakMark(info, CZTestCopyHDPin) + getThrottleMark(info.band.copyHDPinTime));
 
-	if(info.band.copyHDPage == 0)
+	if(!(info.testMask & CZTestCopyHDPage))
+		labelHDRatePageText->setText(tr("Not Selected"));
+	else if(info.band.copyHDPage == 0)
 		labelHDRatePageText->setText("--");
 	else
-		labelHDRatePageText->setText(getValue1024(info.band.copyHDPage, prefixKibi, tr("B/s")));
+		labelHDRatePageText->setText(getValue1024(info.band.copyHDPage, prefixKibi, tr("B/s")) + getPartialMark(info, CZTestCopyHDPage) + getPeakMark(info, CZTestCopyHDPage) + getThrottleMark(info.band.copyHDPageTime));
 
-	if(info.band.copyDHPin == 0)
+	if(!(info.testMask & CZTestCopyDHPin))
+		labelDHRatePinText->setText(tr("Not Selected"));
+	else if(info.band.copyDHPin == 0)
 		labelDHRatePinText->setText("--");
 	else
-		labelDHRatePinText->setText(getValue1024(info.band.copyDHPin, prefixKibi, tr("B/s")));
+		labelDHRatePinText->setText(getValue1024(info.band.copyDHPin, prefixKibi, tr("B/s")) + getPartialMark(info, CZTestCopyDHPin) + getPeakMark(info, CZTestCopyDHPin) + getThrottleMark(info.band.copyDHPinTime));
 
-	if(info.band.copyDHPage == 0)
+	if(!(info.testMask & CZTestCopyDHPage))
+		labelDHRatePageText->setText(tr("Not Selected"));
+	else if(info.band.copyDHPage == 0)
 		labelDHRatePageText->setText("--");
 	else
-		labelDHRatePageText->setText(getValue1024(info.band.copyDHPage, prefixKibi, tr("B/s")));
+		labelDHRatePageText->setText(getValue1024(info.band.copyDHPage, prefixKibi, tr("B/s")) + getPartialMark(info, CZTestCopyDHPage) + getPeakMark(info, CZTestCopyDHPage) + getThrottleMark(info.band.copyDHPageTime));
 
-	if(info.band.copyDD == 0)
+	if(!(info.testMask & CZTestCopyDD))
+		labelDDRateText->setText(tr("Not Selected"));
+	else if(info.band.copyDD == 0)
 		labelDDRateText->setText("--");
 	else
-		labelDDRateText->setText(getValue1024(info.band.copyDD, prefixKibi, tr("B/s")));
+		labelDDRateText->setText(getValue1024(info.band.copyDD, prefixKibi, tr("B/s")) + getPartialMark(info, CZTestCopyDD) + getPeakMark(info, CZTestCopyDD) + getThrottleMark(info.band.copyDDTime));
 
-	if(info.perf.calcFloat == 0)
+	if(!(info.testMask & CZTestCalcFloat))
+		labelFloatRateText->setText(tr("Not Selected"));
+	else if(info.perf.calcFloat == 0)
 		labelFloatRateText->setText("--");
 	else
-		labelFloatRateText->setText(getValue1000(info.perf.calcFloat, prefixKilo, tr("flop/s")));
+		labelFloatRateText->setText(getValue1000(info.perf.calcFloat, prefixKilo, tr("flop/s")) + getPartialMark(info, CZTestCalcFloat) + getPeakMark(info, CZTestCalcFloat) + getThrottleMark(info.perf.calcFloatTime));
 
-	if(((info.major > 1)) ||
-		((info.major == 1) && (info.minor >= 3))) {
-		if(info.perf.calcDouble == 0)
+	if(info.core.doublePrecision) {
+		if(!(info.testMask & CZTestCalcDouble))
+			labelDoubleRateText->setText(tr("Not Selected"));
+		else if(info.perf.calcDouble == 0)
 			labelDoubleRateText->setText("--");
 		else
-			labelDoubleRateText->setText(getValue1000(info.perf.calcDouble, prefixKilo, tr("flop/s")));
+			labelDoubleRateText->setText(getValue1000(info.perf.calcDouble, prefixKilo, tr("flop/s")) + getPartialMark(info, CZTestCalcDouble) + getPeakMark(info, CZTestCalcDouble) + getThrottleMark(info.perf.calcDoubleTime));
 	} else {
 		labelDoubleRateText->setText(tr("Not Supported"));
 	}
 
-	if(info.perf.calcInteger64 == 0)
+	if(!(info.testMask & CZTestCalcInteger64))
+		labelInt64RateText->setText(tr("Not Selected"));
+	else if(info.perf.calcInteger64 == 0)
 		labelInt64RateText->setText("--");
 	else
-		labelInt64RateText->setText(getValue1000(info.perf.calcInteger64, prefixKilo, tr("iop/s")));
+		labelInt64RateText->setText(getValue1000(info.perf.calcInteger64, prefixKilo, tr("iop/s")) + getPartialMark(info, CZTestCalcInteger64) + getPeakMark(info, CZTestCalcInteger64) + getThrottleMark(info.perf.calcInteger64Time));
 
-	if(info.perf.calcInteger32 == 0)
+	if(!(info.testMask & CZTestCalcInteger32))
+		labelInt32RateText->setText(tr("Not Selected"));
+	else if(info.perf.calcInteger32 == 0)
 		labelInt32RateText->setText("--");
 	else
-		labelInt32RateText->setText(getValue1000(info.perf.calcInteger32, prefixKilo, tr("iop/s")));
+		labelInt32RateText->setText(getValue1000(info.perf.calcInteger32, prefixKilo, tr("iop/s")) + getPartialMark(info, CZTestCalcInteger32) + getPeakMark(info, CZTestCalcInteger32) + getThrottleMark(info.perf.calcInteger32Time));
 
-	if(info.perf.calcInteger24 == 0)
+	if(!(info.testMask & CZTestCalcInteger24))
+		labelInt24RateText->setText(tr("Not Selected"));
+	else if(info.perf.calcInteger24 == 0)
 		labelInt24RateText->setText("--");
 	else
-		labelInt24RateText->setText(getValue1000(info.perf.calcInteger24, prefixKilo, tr("iop/s")));
+		labelInt24RateText->setText(getValue1000(info.perf.calcInteger24, prefixKilo, tr("iop/s")) + getPartialMark(info, CZTestCalcInteger24) + getPeakMark(info, CZTestCalcInteger24) + getThrottleMark(info.perf.calcInteger24Time));
+
+	labelHDRatePinText->setToolTip(getTestTip(info, CZTestCopyHDPin, info.band.copyHDPinTime));
+	labelHDRatePageText->setToolTip(getTestTip(info, CZTestCopyHDPage, info.band.copyHDPageTime));
+	labelDHRatePinText->setToolTip(getTestTip(info, CZTestCopyDHPin, info.band.copyDHPinTime));
+	labelDHRatePageText->setToolTip(getTestTip(info, CZTestCopyDHPage, info.band.copyDHPageTime));
+	labelDDRateText->setToolTip(getTestTip(info, CZTestCopyDD, info.band.copyDDTime));
+	labelFloatRateText->setToolTip(getTestTip(info, CZTestCalcFloat, info.perf.calcFloatTime));
+	labelDoubleRateText->setToolTip(getTestTip(info, CZTestCalcDouble, info.perf.calcDoubleTime));
+	labelInt64RateText->setToolTip(getTestTip(info, CZTestCalcInteger64, info.perf.calcInteger64Time));
+	labelInt32RateText->setToolTip(getTestTip(info, CZTestCalcInteger32, info.perf.calcInteger32Time));
+	labelInt24RateText->setToolTip(getTestTip(info, CZTestCalcInteger24, info.perf.calcInteger24Time));
+}
+
+/*!	\brief Get host side timing breakdown of test.
+	API overhead is the part of host wall time not covered by device
+	time. For copy tests CPU time is also given per GiB transferred.
+	\return timing string, empty string if test was not run.
+*/
+QString CZDialog::getTimingTip(
+	const struct CZDeviceInfoTime &time,	/*!<[in] Host side timing of test. */
+	bool copy			/*!<[in] Timing of copy test. */
+) {
+	if(time.deviceMs == 0)
+		return QString();
+
+	QString tip = tr("Device time: %1 ms").arg(time.deviceMs, 0, 'f', 2) + "\n" +
+		tr("Wall time: %1 ms").arg(time.wallMs, 0, 'f', 2) + "\n" +
+		tr("API overhead: %1 ms").arg(time.wallMs - time.deviceMs, 0, 'f', 2) + "\n" +
+		tr("CPU time: %1 ms").arg(time.cpuMs, 0, 'f', 2);
+
+	if(copy && (time.amount != 0)) {
+		tip += "\n" + tr("CPU time per GiB: %1 ms").arg(time.cpuMs * (1024.0 * 1024.0 * 1024.0) / time.amount, 0, 'f', 2);
+	}
+
+	return tip;
+}
+
+/*!	\brief Get tool tip of test result.
+	Tip includes host side timing and theoretical peak of test.
+	\return tip string, empty string if there is nothing to show.
+*/
+QString CZDialog::getTestTip(
+	const struct CZDeviceInfo &info,	/*!<[in] Information about CUDA-device. */
+	int test,			/*!<[in] Test identifier. See enum #CZTest. */
+	const struct CZDeviceInfoTime &time	/*!<[in] Host side timing of test. */
+) {
+	bool copy = (test & CZTestCopyAll) != 0;
+	QString tip = getTimingTip(time, copy);
+	float peak = CZPeakValue(&info, test);
+
+	if(peak != 0) {
+		if(!tip.isEmpty())
+			tip += "\n";
+		if(copy)
+			tip += tr("Theoretical peak: %1").arg(getValue1024(peak, prefixKibi, tr("B/s")));
+		else
+			tip += tr("Theoretical peak: %1").arg(getValue1000(peak, prefixKilo, (test & (CZTestCalcFloat | CZTestCalcDouble))? tr("flop/s"): tr("iop/s")));
+	}
+
+	if(test & (CZTestCopyHDPage | CZTestCopyHDPin | CZTestCopyDHPage | CZTestCopyDHPin)) {
+		int link = CZPciCheckLink(&info);
+		if(link & CZPciLinkDegraded)
+			tip += "\n" + tr("PCI Express link runs below its capability!");
+		if(link & CZPciLinkBottleneck)
+			tip += "\n" + tr("Upstream PCI Express link is slower than device link!");
+		if((link & CZPciLinkSlow) && (test & (CZTestCopyHDPin | CZTestCopyDHPin)))
+			tip += "\n" + tr("Pinned copy rate is low for PCI Express link!");
+	}
+
+	const struct CZDeviceInfoTele &tele = time.tele;
+	if(tele.samples != 0) {
+		if(!tip.isEmpty())
+			tip += "\n";
+		tip += tr("SM clock: %1 MHz (min %2 MHz)").arg(tele.smClock, 0, 'f', 0).arg(tele.smClockMin, 0, 'f', 0) + "\n" +
+			tr("Memory clock: %1 MHz").arg(tele.memClock, 0, 'f', 0) + "\n" +
+			tr("Temperature: %1 C").arg(tele.temperature, 0, 'f', 0);
+		if(tele.power != 0) {
+			float perWatt = CZNvmlPerWatt(CZTestValue(&info, test), &tele);
+			tip += "\n" + tr("Power: %1 W (max %2 W)").arg(tele.power, 0, 'f', 1).arg(tele.powerMax, 0, 'f', 1);
+			if(copy)
+				tip += "\n" + tr("Efficiency: %1/W").arg(getValue1024(perWatt, prefixKibi, tr("B/s")));
+			else
+				tip += "\n" + tr("Efficiency: %1/W").arg(getValue1000(perWatt, prefixKilo, (test & (CZTestCalcFloat | CZTestCalcDouble))? tr("flop/s"): tr("iop/s")));
+		}
+		const char *names[CZ_NVML_REASONS_MAX];
+		int namesNum = CZNvmlThrottleReasons(&tele, names, CZ_NVML_REASONS_MAX);
+		if(namesNum != 0) {
+			QStringList reasons;
+			for(int i = 0; i < namesNum; i++)
+				reasons << names[i];
+			tip += "\n" + tr("Clocks limited by: %1").arg(reasons.join(", "));
+		}
+	}
+
+	return tip;
+}
+
+/*!	\brief Get mark of throttled test result.
+	\return mark string if device clocks were slowed down while test
+	was running, empty string otherwise.
+*/
+QString CZDialog::getThrottleMark(
+	const struct CZDeviceInfoTime &time	/*!<[in] Host side timing of test. */
+) {
+	if(CZNvmlIsThrottled(&time.tele))
+		return " " + tr("(throttled)");
+	return QString();
+}
+
+/*!	\brief Get mark of test result efficiency.
+	\return percentage of theoretical peak reached by test \a test,
+	empty string if peak is unknown.
+*/
+QString CZDialog::getPeakMark(
+	const struct CZDeviceInfo &info,	/*!<[in] Information about CUDA-device. */
+	int test			/*!<[in] Test identifier. See enum #CZTest. */
+) {
+	float percent = CZPeakPercent(&info, test);
+
+	if(percent == 0)
+		return QString();
+	return " " + tr("(%1%)").arg(percent, 0, 'f', 0);
+}
+
+/*!	\brief Get mark of partial test result.
+	\return mark string if test \a test was stopped before all its
+	loops were done, empty string otherwise.
+*/
+QString CZDialog::getPartialMark(
+	const struct CZDeviceInfo &info,	/*!<[in] Information about CUDA-device. */
+	int test			/*!<[in] Test identifier. See enum #CZTest. */
+) {
+	if(info.partialMask & test)
+		return " " + tr("(partial)");
+	return QString();
 }
 
 /*!	\brief Get C/C++ compiler name string
@@ -721,6 +955,7 @@ QString CZDialog::generateTextReport() {
 	QString out;
 	QString title = tr(CZ_NAME_SHORT " Report");
 	QString subtitle;
+	int testMask = m_deviceList[comboDevice->currentIndex()]->testMask();
 
 	out += title;
 	out += "\n";
@@ -790,18 +1025,30 @@ QString CZDialog::generateTextReport() {
 	for(int i = 0; i < subtitle.size(); i++)
 		out += "-";
 	out += "\n";
-	out += tr("Memory Copy") + "\n";
-	CZ_TXT_EXPORT_TAB_TITLE("Host Pinned to Device", labelHDRatePin);
-	CZ_TXT_EXPORT_TAB_TITLE("Host Pageable to Device", labelHDRatePage);
-	CZ_TXT_EXPORT_TAB_TITLE("Device to Host Pinned", labelDHRatePin);
-	CZ_TXT_EXPORT_TAB_TITLE("Device to Host Pageable", labelDHRatePage);
-	CZ_TXT_EXPORT_TAB(labelDDRate);
-	out += tr("GPU Core Performance") + "\n";
-	CZ_TXT_EXPORT_TAB(labelFloatRate);
-	CZ_TXT_EXPORT_TAB(labelDoubleRate);
-	CZ_TXT_EXPORT_TAB(labelInt64Rate);
-	CZ_TXT_EXPORT_TAB(labelInt32Rate);
-	CZ_TXT_EXPORT_TAB(labelInt24Rate);
+	if(testMask & CZTestCopyAll)
+		out += tr("Memory Copy") + "\n";
+	if(testMask & CZTestCopyHDPin)
+		CZ_TXT_EXPORT_TAB_TITLE("Host Pinned to Device", labelHDRatePin);
+	if(testMask & CZTestCopyHDPage)
+		CZ_TXT_EXPORT_TAB_TITLE("Host Pageable to Device", labelHDRatePage);
+	if(testMask & CZTestCopyDHPin)
+		CZ_TXT_EXPORT_TAB_TITLE("Device to Host Pinned", labelDHRatePin);
+	if(testMask & CZTestCopyDHPage)
+		CZ_TXT_EXPORT_TAB_TITLE("Device to Host Pageable", labelDHRatePage);
+	if(testMask & CZTestCopyDD)
+		CZ_TXT_EXPORT_TAB(labelDDRate);
+	if(testMask & CZTestCalcAll)
+		out += tr("GPU Core Performance") + "\n";
+	if(testMask & CZTestCalcFloat)
+		CZ_TXT_EXPORT_TAB(labelFloatRate);
+	if(testMask & CZTestCalcDouble)
+		CZ_TXT_EXPORT_TAB(labelDoubleRate);
+	if(testMask & CZTestCalcInteger64)
+		CZ_TXT_EXPORT_TAB(labelInt64Rate);
+	if(testMask & CZTestCalcInteger32)
+		CZ_TXT_EXPORT_TAB(labelInt32Rate);
+	if(testMask & CZTestCalcInteger24)
+		CZ_TXT_EXPORT_TAB(labelInt24Rate);
 	out += "\n";
 
 	time_t t;
@@ -846,6 +1093,7 @@ QString CZDialog::generateHTMLReport() {
 
 	QString out;
 	QString title = tr(CZ_NAME_SHORT " Report");
+	int testMask = m_deviceList[comboDevice->currentIndex()]->testMask();
 
 	out += "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
 		"<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.0 Strict//EN\" \"http://www.w3.org/TR/xhtml1/DTD/xhtml1-strict.dtd\">\n"
@@ -927,18 +1175,30 @@ QString CZDialog::generateHTMLReport() {
 
 	out += "<h2>" + tr("Performance Information") + "</h2>\n";
 	out += "<table border=\"1\">\n";
-	out += "<tr><th colspan=\"2\">" + tr("Memory Copy") + "</th></tr>\n";
-	CZ_HTML_EXPORT_TAB_TITLE("Host Pinned to Device", labelHDRatePin);
-	CZ_HTML_EXPORT_TAB_TITLE("Host Pageable to Device", labelHDRatePage);
-	CZ_HTML_EXPORT_TAB_TITLE("Device to Host Pinned", labelDHRatePin);
-	CZ_HTML_EXPORT_TAB_TITLE("Device to Host Pageable", labelDHRatePage);
-	CZ_HTML_EXPORT_TAB(labelDDRate);
-	out += "<tr><th colspan=\"2\">" + tr("GPU Core Performance") + "</th></tr>\n";
-	CZ_HTML_EXPORT_TAB(labelFloatRate);
-	CZ_HTML_EXPORT_TAB(labelDoubleRate);
-	CZ_HTML_EXPORT_TAB(labelInt64Rate);
-	CZ_HTML_EXPORT_TAB(labelInt32Rate);
-	CZ_HTML_EXPORT_TAB(labelInt24Rate);
+	if(testMask & CZTestCopyAll)
+		out += "<tr><th colspan=\"2\">" + tr("Memory Copy") + "</th></tr>\n";
+	if(testMask & CZTestCopyHDPin)
+		CZ_HTML_EXPORT_TAB_TITLE("Host Pinned to Device", labelHDRatePin);
+	if(testMask & CZTestCopyHDPage)
+		CZ_HTML_EXPORT_TAB_TITLE("Host Pageable to Device", labelHDRatePage);
+	if(testMask & CZTestCopyDHPin)
+		CZ_HTML_EXPORT_TAB_TITLE("Device to Host Pinned", labelDHRatePin);
+	if(testMask & CZTestCopyDHPage)
+		CZ_HTML_EXPORT_TAB_TITLE("Device to Host Pageable", labelDHRatePage);
+	if(testMask & CZTestCopyDD)
+		CZ_HTML_EXPORT_TAB(labelDDRate);
+	if(testMask & CZTestCalcAll)
+		out += "<tr><th colspan=\"2\">" + tr("GPU Core Performance") + "</th></tr>\n";
+	if(testMask & CZTestCalcFloat)
+		CZ_HTML_EXPORT_TAB(labelFloatRate);
+	if(testMask & CZTestCalcDouble)
+		CZ_HTML_EXPORT_TAB(labelDoubleRate);
+	if(testMask & CZTestCalcInteger64)
+		CZ_HTML_EXPORT_TAB(labelInt64Rate);
+	if(testMask & CZTestCalcInteger32)
+		CZ_HTML_EXPORT_TAB(labelInt32Rate);
+	if(testMask & CZTestCalcInteger24)
+		CZ_HTML_EXPORT_TAB(labelInt24Rate);
 	out += "</table>\n";
 
 	time_t t;
@@ -59,7 +59,7 @@ class CZDialog: public QDialog, public Ui::CZDialog {
 	Q_OBJECT
 
 public:
-	CZDialog(QWidget *parent = 0, Qt::WindowFlags f = 0);
+	CZDialog(int testMask = CZTestAll, QWidget *parent = 0, Qt::WindowFlags f = 0);
 	~CZDialog();
 
 private:
@@ -75,16 +75,21 @@ private:
 	QUrl m_url;
 	QString m_history;
 
-	void readCudaDevices();
+	void readCudaDevices(int testMask);
 	void freeCudaDevices();
 	int getCudaDeviceNumber();
 
 	void setupDeviceList();
 	void setupDeviceInfo(int dev);
 
-	void setupCoreTab(struct CZDeviceInfo &info);
-	void setupMemoryTab(struct CZDeviceInfo &info);
-	void setupPerformanceTab(struct CZDeviceInfo &info);
+	void setupCoreTab(const struct CZDeviceInfo &info);
+	void setupMemoryTab(const struct CZDeviceInfo &info);
+	void setupPerformanceTab(const struct CZDeviceInfo &info);
+	QString getPartialMark(const struct CZDeviceInfo &info, int test);
+	QString getTimingTip(const struct CZDeviceInfoTime &time, bool copy);
+	QString getPeakMark(const struct CZDeviceInfo &info, int test);
+	QString getThrottleMark(const struct CZDeviceInfoTime &time);
+	QString getTestTip(const struct CZDeviceInfo &info, int test, const struct CZDeviceInfoTime &time);
 
 	void setupAboutTab();
 
@@ -132,6 +137,7 @@ private slots:
 	void slotShowDevice(int index);
 	void slotUpdatePerformance(int index);
 	void slotUpdateTimer();
+	void slotChangeProfile(int index);
 	void slotExportToText();
 	void slotExportToHTML();
 	void slotExportToClipboard();
@@ -0,0 +1,467 @@
+/*!	\file czfleet.cpp
+	\brief Fleet report functions source file.
+	Fleet report reads many reports made by text, HTML or console
+	exporters, groups devices by model and driver and finds devices
+	which results differ from results of their peers.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDirIterator>
+#include <QTextStream>
+#include <QHash>
+#include <QVector>
+
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "log.h"
+#include "czfleet.h"
+#include "czstat.h"
+#include "cudainfo.h"
+#include "version.h"
+
+#define CZ_FLEET_BINS		256			/*!< Number of histogram bins of metric distribution. */
+#define CZ_FLEET_SIGMA		3.0			/*!< Distance from peers in standard deviations to be an outlier. */
+#define CZ_FLEET_MIN_PEERS	5			/*!< Minimal number of peers to find outliers. */
+#define CZ_FLEET_NOISE		0.005			/*!< Minimal standard deviation as a part of mean. */
+
+/*!	\brief Metrics found in reports.
+	Titles are the same in all exporters. Values are converted to
+	\a unit.
+*/
+static const struct {
+	const char	*title;			/*!< Title of metric in report. */
+	int		test;			/*!< Test identifier. See enum #CZTest. */
+	const char	*unit;			/*!< Unit of metric. */
+} CZFleetMetrics[] = {
+	{"Host Pinned to Device",	CZTestCopyHDPin,	"MiB/s"},
+	{"Host Pageable to Device",	CZTestCopyHDPage,	"MiB/s"},
+	{"Device to Host Pinned",	CZTestCopyDHPin,	"MiB/s"},
+	{"Device to Host Pageable",	CZTestCopyDHPage,	"MiB/s"},
+	{"Device to Device",		CZTestCopyDD,		"MiB/s"},
+	{"Single-precision Float",	CZTestCalcFloat,	"Mflop/s"},
+	{"Double-precision Float",	CZTestCalcDouble,	"Mflop/s"},
+	{"64-bit Integer",		CZTestCalcInteger64,	"Miop/s"},
+	{"32-bit Integer",		CZTestCalcInteger32,	"Miop/s"},
+	{"24-bit Integer",		CZTestCalcInteger24,	"Miop/s"},
+	{"Memory Integrity",		CZTestMemory,		"MiB/s"},
+};
+
+#define CZ_FLEET_METRICS_NUM	((int)(sizeof(CZFleetMetrics) / sizeof(CZFleetMetrics[0])))	/*!< Number of metrics. */
+
+/*!	\brief Results of one device found in report.
+*/
+struct CZFleetRecord {
+	QString		source;			/*!< Report file name and device index. */
+	QString		model;			/*!< Device name. */
+	QString		driver;			/*!< Driver version. */
+	double		value[CZ_FLEET_METRICS_NUM];	/*!< Metric values, negative if missing. */
+};
+
+/*!	\brief Group of devices of the same model and driver.
+	Distributions of metrics are collected in the first pass over
+	reports, histograms are filled in the second one.
+*/
+struct CZFleetGroup {
+	QString		model;			/*!< Device name. */
+	QString		driver;			/*!< Driver version. */
+	int		devices;		/*!< Number of devices. */
+	int		outliers;		/*!< Number of outlier values. */
+	struct CZStat	stat[CZ_FLEET_METRICS_NUM];	/*!< Distributions of metrics. */
+	int		bins[CZ_FLEET_METRICS_NUM][CZ_FLEET_BINS];	/*!< Histograms of metrics between \a min and \a max. */
+};
+
+/*!	\brief State of fleet report.
+*/
+struct CZFleetContext {
+	int		pass;			/*!< Pass over reports, \a 0 or \a 1. */
+	int		files;			/*!< Number of files read. */
+	int		records;		/*!< Number of devices found. */
+	int		outliers;		/*!< Number of outliers found. */
+	QHash<QString, int>	groupIndex;	/*!< Index of group by its key. */
+	QVector<CZFleetGroup>	groups;		/*!< Groups of devices. */
+	QTextStream	*out;			/*!< Output stream. */
+};
+
+/*!	\brief Convert value with unit of report to unit of metric.
+	Values are written as number, space and unit with SI or IEC prefix,
+	e.g. "6.21 GiB/s" or "1234.5 Mflop/s".
+	\return converted value, \a -1 if there is no value.
+*/
+static double CZFleetParseValue(
+	const QString &text,		/*!<[in] Value text. */
+	int metric			/*!<[in] Index of metric. */
+) {
+	QString number = text.section(' ', 0, 0);
+	QString unit = text.section(' ', 1, 1);
+	bool ok;
+	double value = number.toDouble(&ok);
+
+	if(!ok)
+		return -1;
+
+	static const char prefixes[] = "kMGTPE";
+	double base = (CZFleetMetrics[metric].test & (CZTestCopyAll | CZTestMemory))? 1024.0: 1000.0;
+	int power = 0;
+
+	if(!unit.isEmpty()) {
+		const char *p = strchr(prefixes, unit.at(0).toLatin1());
+		if(unit.at(0) == 'K')
+			p = prefixes;
+		if((p != NULL) && (*p != 0))
+			power = (int)(p - prefixes) + 1;
+	}
+
+	/* Units of metrics are Mi or M prefixed. */
+	return value * pow(base, power - 2);
+}
+
+/*!	\brief Convert line of report to "key: value" form.
+	HTML tags are removed, table cells are joined with ": ".
+	\return converted line.
+*/
+static QString CZFleetStripLine(
+	const QString &line		/*!<[in] Line of report. */
+) {
+	if(!line.contains('<'))
+		return line.trimmed();
+
+	QString res = line;
+	res.replace("</th><td>", ": ");
+
+	QString text;
+	bool tag = false;
+	for(int i = 0; i < res.size(); i++) {
+		QChar c = res.at(i);
+		if(c == '<')
+			tag = true;
+		else if(c == '>')
+			tag = false;
+		else if(!tag)
+			text += c;
+	}
+
+	text.replace("&lt;", "<");
+	text.replace("&gt;", ">");
+	text.replace("&amp;", "&");
+	return text.trimmed();
+}
+
+/*!	\brief Find group of record, create a new one in the first pass.
+	\return index of group, \a -1 if there is no such group.
+*/
+static int CZFleetGroupFind(
+	struct CZFleetContext &ctx,	/*!<[in,out] State of fleet report. */
+	const struct CZFleetRecord &rec	/*!<[in] Device record. */
+) {
+	QString key = rec.model + "\n" + rec.driver;
+	QHash<QString, int>::const_iterator it = ctx.groupIndex.constFind(key);
+
+	if(it != ctx.groupIndex.constEnd())
+		return it.value();
+
+	if(ctx.pass != 0)
+		return -1;
+
+	struct CZFleetGroup group;
+	group.model = rec.model;
+	group.driver = rec.driver;
+	group.devices = 0;
+	group.outliers = 0;
+	for(int m = 0; m < CZ_FLEET_METRICS_NUM; m++)
+		CZStatClear(&group.stat[m]);
+	memset(group.bins, 0, sizeof(group.bins));
+
+	ctx.groups.append(group);
+	ctx.groupIndex.insert(key, ctx.groups.size() - 1);
+	return ctx.groups.size() - 1;
+}
+
+/*!	\brief Process device record.
+	First pass collects mean, variance and range of each metric with
+	Welford's method. Second pass fills histograms and compares each
+	value with mean and variance of its peers, i.e. group without the
+	value itself.
+*/
+static void CZFleetRecordDone(
+	struct CZFleetContext &ctx,	/*!<[in,out] State of fleet report. */
+	const struct CZFleetRecord &rec	/*!<[in] Device record. */
+) {
+	int found = 0;
+
+	for(int m = 0; m < CZ_FLEET_METRICS_NUM; m++) {
+		if(rec.value[m] >= 0)
+			found++;
+	}
+	if(rec.model.isEmpty() || (found == 0))
+		return;
+
+	int g = CZFleetGroupFind(ctx, rec);
+	if(g < 0)
+		return;
+	struct CZFleetGroup &group = ctx.groups[g];
+
+	if(ctx.pass == 0) {
+		ctx.records++;
+		group.devices++;
+	}
+
+	for(int m = 0; m < CZ_FLEET_METRICS_NUM; m++) {
+		double x = rec.value[m];
+		struct CZStat &stat = group.stat[m];
+
+		if(x < 0)
+			continue;
+
+		if(ctx.pass == 0) {
+			CZStatAdd(&stat, x);
+			continue;
+		}
+
+		int bin = (stat.max > stat.min)? (int)((x - stat.min) / (stat.max - stat.min) * CZ_FLEET_BINS): 0;
+		if(bin >= CZ_FLEET_BINS)
+			bin = CZ_FLEET_BINS - 1;
+		if(bin < 0)
+			bin = 0;
+		group.bins[m][bin]++;
+
+		int peers = stat.num - 1;
+		if(peers < CZ_FLEET_MIN_PEERS)
+			continue;
+
+		double peerMean = (stat.num * stat.mean - x) / peers;
+		double peerM2 = stat.m2 - (x - stat.mean) * (x - peerMean);
+		double peerSigma = sqrt((peerM2 > 0)? peerM2 / (peers - 1): 0);
+		if(peerSigma < peerMean * CZ_FLEET_NOISE)
+			peerSigma = peerMean * CZ_FLEET_NOISE;
+		if(peerSigma == 0)
+			continue;
+
+		double z = (x - peerMean) / peerSigma;
+		if(fabs(z) < CZ_FLEET_SIGMA)
+			continue;
+
+		ctx.outliers++;
+		group.outliers++;
+		*ctx.out << "\t" << rec.source << ": " << rec.model << ", driver " << rec.driver << "\n"
+			<< "\t\t" << CZFleetMetrics[m].title << " " << QString::number(x, 'f', 1) << " " << CZFleetMetrics[m].unit
+			<< ", peers " << QString::number(peerMean, 'f', 1) << " +- " << QString::number(peerSigma, 'f', 1)
+			<< ", z " << QString::number(z, 'f', 1) << ((z < 0)? " (low)": " (high)") << "\n";
+	}
+}
+
+/*!	\brief Clear device record.
+*/
+static void CZFleetRecordClear(
+	struct CZFleetRecord &rec,	/*!<[out] Device record. */
+	const QString &source,		/*!<[in] Source of record. */
+	const QString &driver		/*!<[in] Default driver version. */
+) {
+	rec.source = source;
+	rec.model.clear();
+	rec.driver = driver;
+	for(int m = 0; m < CZ_FLEET_METRICS_NUM; m++)
+		rec.value[m] = -1;
+}
+
+/*!	\brief Read one report file.
+	File is read line by line. Console reports may have many devices,
+	each starts with "Device N: name" line. Text and HTML exports have
+	one device named in "Name" line and driver version given before it.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZFleetReadFile(
+	struct CZFleetContext &ctx,	/*!<[in,out] State of fleet report. */
+	const QString &fileName		/*!<[in] Report file name. */
+) {
+	QFile file(fileName);
+	QString fileDriver;
+	struct CZFleetRecord rec;
+
+	if(!file.open(QFile::ReadOnly | QFile::Text)) {
+		if(ctx.pass == 0)
+			CZLog(CZLogLevelWarning, "Cannot read file %s: %s.",
+				fileName.toLocal8Bit().data(), file.errorString().toLocal8Bit().data());
+		return -1;
+	}
+
+	if(ctx.pass == 0)
+		ctx.files++;
+
+	QTextStream in(&file);
+	CZFleetRecordClear(rec, fileName, fileDriver);
+
+	while(!in.atEnd()) {
+		QString line = CZFleetStripLine(in.readLine());
+		int sep = line.indexOf(": ");
+		if(sep <= 0)
+			continue;
+
+		QString key = line.left(sep);
+		QString value = line.mid(sep + 2).trimmed();
+
+		/* Aggregate results of all devices are not results of one device. */
+		if(key == "All Devices")
+			break;
+
+		bool isNum = false;
+		int dev = key.startsWith("Device ")? key.mid(7).toInt(&isNum): 0;
+		if(isNum) {
+			CZFleetRecordDone(ctx, rec);
+			CZFleetRecordClear(rec, fileName + "#" + QString::number(dev), fileDriver);
+			rec.model = value;
+			continue;
+		}
+
+		if(key == "Name") {
+			rec.model = value;
+			continue;
+		}
+
+		if(key == "Driver Version") {
+			if(rec.model.isEmpty())
+				fileDriver = value;
+			rec.driver = value;
+			continue;
+		}
+
+		for(int m = 0; m < CZ_FLEET_METRICS_NUM; m++) {
+			if(key == CZFleetMetrics[m].title) {
+				rec.value[m] = CZFleetParseValue(value, m);
+				break;
+			}
+		}
+	}
+
+	CZFleetRecordDone(ctx, rec);
+	return 0;
+}
+
+/*!	\brief Make list of report files.
+	Directories are searched recursively.
+	\return list of files.
+*/
+static QStringList CZFleetListFiles(
+	const QStringList &inputs	/*!<[in] Report files and directories. */
+) {
+	QStringList files;
+
+	for(int i = 0; i < inputs.size(); i++) {
+		QFileInfo info(inputs[i]);
+		if(info.isDir()) {
+			QDirIterator it(inputs[i], QDir::Files, QDirIterator::Subdirectories);
+			while(it.hasNext())
+				files << it.next();
+		} else {
+			files << inputs[i];
+		}
+	}
+
+	files.sort();
+	return files;
+}
+
+/*!	\brief Get value of histogram percentile.
+	Value is interpolated linearly inside of histogram bin.
+	\return value of percentile.
+*/
+static double CZFleetPercentile(
+	const struct CZStat &stat,	/*!<[in] Distribution of metric. */
+	const int *bins,		/*!<[in] Histogram of metric of #CZ_FLEET_BINS bins. */
+	double part			/*!<[in] Percentile as part of 1. */
+) {
+	double target = part * stat.num;
+	double width = (stat.max - stat.min) / CZ_FLEET_BINS;
+	int count = 0;
+
+	for(int i = 0; i < CZ_FLEET_BINS; i++) {
+		if((bins[i] != 0) && (count + bins[i] >= target))
+			return stat.min + width * (i + (target - count) / bins[i]);
+		count += bins[i];
+	}
+	return stat.max;
+}
+
+/*!	\brief Read many reports and print fleet summary.
+	Reports are read twice, so memory used does not depend on number
+	of reports: the first pass collects mean and variance of each metric
+	per group of model and driver, the second pass fills histograms and
+	prints devices which results are #CZ_FLEET_SIGMA standard deviations
+	away from their peers. Percentiles are approximated with histograms
+	of #CZ_FLEET_BINS bins.
+	\return \a 0 in case of success, \a 1 in case of error.
+*/
+int CZFleetReport(
+	const QStringList &inputs,	/*!<[in] Report files and directories. */
+	const QString &fileName		/*!<[in] Output file name, stdout if empty. */
+) {
+	QFile file;
+
+	if(fileName.isEmpty()) {
+		file.open(stdout, QFile::WriteOnly | QFile::Text);
+	} else {
+		file.setFileName(fileName);
+		if(!file.open(QFile::WriteOnly | QFile::Text)) {
+			CZLog(CZLogLevelError, "Cannot write file %s: %s.",
+				fileName.toLocal8Bit().data(), file.errorString().toLocal8Bit().data());
+			return 1;
+		}
+	}
+
+	QTextStream out(&file);
+	QStringList files = CZFleetListFiles(inputs);
+	struct CZFleetContext ctx;
+
+	ctx.files = 0;
+	ctx.records = 0;
+	ctx.outliers = 0;
+	ctx.out = &out;
+
+	out << CZ_NAME_SHORT " " CZ_VERSION " Fleet Report\n\n";
+
+	for(ctx.pass = 0; ctx.pass < 2; ctx.pass++) {
+		if(ctx.pass == 1)
+			out << "Outliers:\n";
+		for(int i = 0; i < files.size(); i++)
+			CZFleetReadFile(ctx, files[i]);
+		CZLog(CZLogLevelLow, "Fleet pass %d done: %d file(s), %d device(s).", ctx.pass, ctx.files, ctx.records);
+	}
+
+	if(ctx.outliers == 0)
+		out << "\tNone\n";
+	out << "\n";
+
+	out << "Reports: " << ctx.files << ", Devices: " << ctx.records
+		<< ", Groups: " << ctx.groups.size() << ", Outliers: " << ctx.outliers << "\n\n";
+
+	for(int g = 0; g < ctx.groups.size(); g++) {
+		const struct CZFleetGroup &group = ctx.groups[g];
+
+		out << "Group: " << group.model << ", driver " << group.driver
+			<< " (" << group.devices << " devices, " << group.outliers << " outliers)\n";
+
+		for(int m = 0; m < CZ_FLEET_METRICS_NUM; m++) {
+			const struct CZStat &stat = group.stat[m];
+			if(stat.num == 0)
+				continue;
+
+			double sigma = CZStatSigma(&stat);
+			out << "\t" << CZFleetMetrics[m].title << " (" << CZFleetMetrics[m].unit << "): n " << stat.num
+				<< ", mean " << QString::number(stat.mean, 'f', 1)
+				<< ", stddev " << QString::number(sigma, 'f', 1)
+				<< ", min " << QString::number(stat.min, 'f', 1)
+				<< ", p5 " << QString::number(CZFleetPercentile(stat, group.bins[m], 0.05), 'f', 1)
+				<< ", median " << QString::number(CZFleetPercentile(stat, group.bins[m], 0.5), 'f', 1)
+				<< ", p95 " << QString::number(CZFleetPercentile(stat, group.bins[m], 0.95), 'f', 1)
+				<< ", max " << QString::number(stat.max, 'f', 1) << "\n";
+		}
+		out << "\n";
+	}
+
+	return (ctx.records == 0)? 1: 0;
+}
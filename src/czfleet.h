@@ -0,0 +1,16 @@
+/*!	\file czfleet.h
+	\brief Fleet report functions header file.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#ifndef CZ_FLEET_H
+#define CZ_FLEET_H
+
+#include <QString>
+#include <QStringList>
+
+int CZFleetReport(const QStringList &inputs, const QString &fileName);
+
+#endif//CZ_FLEET_H
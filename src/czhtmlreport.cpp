@@ -0,0 +1,572 @@
+/*!	\file czhtmlreport.cpp
+	\brief HTML report functions source file.
+	HTML report runs tests on all devices several times and writes one
+	self-contained page with inline SVG charts. The page has no scripts
+	and no external resources, so it opens in any browser and can be
+	attached to a bug report as is.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <QFile>
+#include <QTextStream>
+#include <QVector>
+#include <QStringList>
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "log.h"
+#include "czhtmlreport.h"
+#include "czstat.h"
+#include "czdeviceinfo.h"
+#include "cudainfo.h"
+#include "cpuinfo.h"
+#include "clinfo.h"
+#include "peakinfo.h"
+#include "version.h"
+
+#define CZ_HTML_CHART_WIDTH	640			/*!< Width of chart in pixels. */
+#define CZ_HTML_CHART_HEIGHT	300			/*!< Height of line chart in pixels. */
+#define CZ_HTML_MARGIN_LEFT	70			/*!< Left margin of line chart for axis labels. */
+#define CZ_HTML_MARGIN_RIGHT	20			/*!< Right margin of chart. */
+#define CZ_HTML_MARGIN_TOP	20			/*!< Top margin of chart. */
+#define CZ_HTML_MARGIN_BOTTOM	40			/*!< Bottom margin of chart for axis labels. */
+#define CZ_HTML_LABEL_WIDTH	260			/*!< Width of row labels of bar and range charts. */
+#define CZ_HTML_ROW_HEIGHT	20			/*!< Height of one row of bar and range charts. */
+#define CZ_HTML_Y_TICKS		5			/*!< Number of value axis ticks. */
+
+#define CZ_HTML_COLOR_HD	"#1f77b4"		/*!< Color of host to device data. */
+#define CZ_HTML_COLOR_DH	"#d62728"		/*!< Color of device to host data. */
+#define CZ_HTML_COLOR_BAR	"#4c72b0"		/*!< Color of bars and dots. */
+
+/*!	\brief Metrics shown in report.
+	Values are converted from KiB/s and kilo-operations per second
+	to \a unit by division by \a scale.
+*/
+static const struct {
+	const char	*title;			/*!< Title of metric. */
+	int		test;			/*!< Test identifier. See enum #CZTest. */
+	const char	*unit;			/*!< Unit of metric. */
+	double		scale;			/*!< Divisor of raw value. */
+} CZHtmlMetrics[] = {
+	{"Host Pinned to Device",	CZTestCopyHDPin,	"MiB/s",	1024},
+	{"Host Pageable to Device",	CZTestCopyHDPage,	"MiB/s",	1024},
+	{"Device to Host Pinned",	CZTestCopyDHPin,	"MiB/s",	1024},
+	{"Device to Host Pageable",	CZTestCopyDHPage,	"MiB/s",	1024},
+	{"Device to Device",		CZTestCopyDD,		"MiB/s",	1024},
+	{"Single-precision Float",	CZTestCalcFloat,	"Mflop/s",	1000},
+	{"Double-precision Float",	CZTestCalcDouble,	"Mflop/s",	1000},
+	{"64-bit Integer",		CZTestCalcInteger64,	"Miop/s",	1000},
+	{"32-bit Integer",		CZTestCalcInteger32,	"Miop/s",	1000},
+	{"24-bit Integer",		CZTestCalcInteger24,	"Miop/s",	1000},
+};
+
+#define CZ_HTML_METRICS_NUM	((int)(sizeof(CZHtmlMetrics) / sizeof(CZHtmlMetrics[0])))	/*!< Number of metrics. */
+
+/*!	\brief Results of all runs on one device.
+*/
+struct CZHtmlDevice {
+	QString		name;			/*!< Title of device. */
+	QVector<struct CZDeviceInfo>	runs;	/*!< Device information after each run. */
+	struct CZStat	stat[CZ_HTML_METRICS_NUM];	/*!< Distribution of each metric. */
+	QStringList	userName;		/*!< Names of user kernels. */
+	struct CZStat	user[CZ_USER_KERNELS_MAX];	/*!< Distribution of user kernel rates. */
+	bool		userCalc[CZ_USER_KERNELS_MAX];	/*!< User kernel rate is operation rate, not memory rate. */
+};
+
+/*!	\brief Add value of run to distribution.
+	Zero values mean the test was not done and are skipped.
+*/
+static void CZHtmlStatAdd(
+	struct CZStat &stat,		/*!<[in,out] Distribution. */
+	double value			/*!<[in] Value. */
+) {
+	if(value > 0)
+		CZStatAdd(&stat, value);
+}
+
+/*!	\brief Round axis limit up to 1, 2 or 5 times power of 10.
+	\return rounded limit.
+*/
+static double CZHtmlNiceMax(
+	double value			/*!<[in] Maximal value on axis. */
+) {
+	if(value <= 0)
+		return 1;
+
+	double base = pow(10.0, floor(log10(value)));
+	if(value <= base)
+		return base;
+	if(value <= 2 * base)
+		return 2 * base;
+	if(value <= 5 * base)
+		return 5 * base;
+	return 10 * base;
+}
+
+/*!	\brief Escape text for HTML.
+	\return escaped text.
+*/
+static QString CZHtmlEscape(
+	const QString &text		/*!<[in] Text. */
+) {
+	QString res;
+	res.reserve(text.size());
+
+	for(int i = 0; i < text.size(); i++) {
+		QChar c = text[i];
+		if(c == '&')
+			res += "&amp;";
+		else if(c == '<')
+			res += "&lt;";
+		else if(c == '>')
+			res += "&gt;";
+		else if(c == '"')
+			res += "&quot;";
+		else
+			res += c;
+	}
+
+	return res;
+}
+
+/*!	\brief Get short title of transfer size.
+	\return size with K or M suffix.
+*/
+static QString CZHtmlSizeName(
+	double size			/*!<[in] Size in bytes. */
+) {
+	if(size >= 1024 * 1024)
+		return QString::number(size / (1024 * 1024), 'f', 0) + "M";
+	if(size >= 1024)
+		return QString::number(size / 1024, 'f', 0) + "K";
+	return QString::number(size, 'f', 0);
+}
+
+/*!	\brief Write value axis grid of line chart.
+*/
+static void CZHtmlWriteGrid(
+	QTextStream &out,		/*!<[in,out] Output stream. */
+	double yMax,			/*!<[in] Value at top of chart. */
+	const char *unit		/*!<[in] Unit of values. */
+) {
+	const int h = CZ_HTML_CHART_HEIGHT - CZ_HTML_MARGIN_TOP - CZ_HTML_MARGIN_BOTTOM;
+
+	for(int t = 0; t <= CZ_HTML_Y_TICKS; t++) {
+		double y = CZ_HTML_MARGIN_TOP + h - (double)h * t / CZ_HTML_Y_TICKS;
+		out << "<line class=\"grid\" x1=\"" << CZ_HTML_MARGIN_LEFT << "\" y1=\"" << y
+			<< "\" x2=\"" << (CZ_HTML_CHART_WIDTH - CZ_HTML_MARGIN_RIGHT) << "\" y2=\"" << y << "\"/>"
+			<< "<text x=\"" << (CZ_HTML_MARGIN_LEFT - 6) << "\" y=\"" << (y + 4) << "\" text-anchor=\"end\">"
+			<< QString::number(yMax * t / CZ_HTML_Y_TICKS, 'f', 0) << "</text>\n";
+	}
+	out << "<text x=\"12\" y=\"" << (CZ_HTML_MARGIN_TOP + h / 2) << "\" text-anchor=\"middle\""
+		<< " transform=\"rotate(-90 12 " << (CZ_HTML_MARGIN_TOP + h / 2) << ")\">" << unit << "</text>\n";
+}
+
+/*!	\brief Write chart of copy rate versus transfer size.
+	Lines connect mean rates of all runs, whiskers show range of rates
+	between runs. Transfer size axis is logarithmic.
+*/
+static void CZHtmlWriteSweep(
+	QTextStream &out,		/*!<[in,out] Output stream. */
+	const struct CZHtmlDevice &dev	/*!<[in] Device results. */
+) {
+	const struct CZDeviceInfoSweep *sizes = NULL;
+	struct CZStat hd[CZ_SWEEP_POINTS_MAX];
+	struct CZStat dh[CZ_SWEEP_POINTS_MAX];
+	double yMax = 0;
+	int num = 0;
+
+	memset(hd, 0, sizeof(hd));
+	memset(dh, 0, sizeof(dh));
+
+	for(int r = 0; r < dev.runs.size(); r++) {
+		const struct CZDeviceInfoSweep &sweep = dev.runs[r].band.sweep;
+		if(sweep.num == 0)
+			continue;
+		if((sizes == NULL) || (sweep.num > num)) {
+			sizes = &sweep;
+			num = sweep.num;
+		}
+		for(int i = 0; i < sweep.num; i++) {
+			CZHtmlStatAdd(hd[i], sweep.copyHDPin[i] / 1024);
+			CZHtmlStatAdd(dh[i], sweep.copyDHPin[i] / 1024);
+			if(hd[i].max > yMax)
+				yMax = hd[i].max;
+			if(dh[i].max > yMax)
+				yMax = dh[i].max;
+		}
+	}
+
+	if(num < 2)
+		return;
+
+	yMax = CZHtmlNiceMax(yMax);
+
+	const int w = CZ_HTML_CHART_WIDTH - CZ_HTML_MARGIN_LEFT - CZ_HTML_MARGIN_RIGHT;
+	const int h = CZ_HTML_CHART_HEIGHT - CZ_HTML_MARGIN_TOP - CZ_HTML_MARGIN_BOTTOM;
+	double xMin = log(sizes->size[0]);
+	double xSpan = log(sizes->size[num - 1]) - xMin;
+	double x[CZ_SWEEP_POINTS_MAX];
+
+	for(int i = 0; i < num; i++)
+		x[i] = CZ_HTML_MARGIN_LEFT + w * (log(sizes->size[i]) - xMin) / xSpan;
+
+	out << "<h3>Copy Rate versus Transfer Size</h3>\n"
+		<< "<svg width=\"" << CZ_HTML_CHART_WIDTH << "\" height=\"" << CZ_HTML_CHART_HEIGHT << "\">\n";
+	CZHtmlWriteGrid(out, yMax, "MiB/s");
+
+	for(int i = 0; i < num; i++) {
+		out << "<text x=\"" << x[i] << "\" y=\"" << (CZ_HTML_MARGIN_TOP + h + 16)
+			<< "\" text-anchor=\"middle\">" << CZHtmlSizeName(sizes->size[i]) << "</text>";
+	}
+	out << "\n";
+
+	for(int s = 0; s < 2; s++) {
+		const struct CZStat *stat = (s == 0)? hd: dh;
+		const char *color = (s == 0)? CZ_HTML_COLOR_HD: CZ_HTML_COLOR_DH;
+
+		out << "<polyline fill=\"none\" stroke=\"" << color << "\" stroke-width=\"2\" points=\"";
+		for(int i = 0; i < num; i++) {
+			if(stat[i].num != 0)
+				out << x[i] << "," << (CZ_HTML_MARGIN_TOP + h - h * stat[i].mean / yMax) << " ";
+		}
+		out << "\"/>\n";
+
+		for(int i = 0; i < num; i++) {
+			if(stat[i].num < 2)
+				continue;
+			out << "<line stroke=\"" << color << "\" x1=\"" << x[i]
+				<< "\" y1=\"" << (CZ_HTML_MARGIN_TOP + h - h * stat[i].min / yMax)
+				<< "\" x2=\"" << x[i]
+				<< "\" y2=\"" << (CZ_HTML_MARGIN_TOP + h - h * stat[i].max / yMax) << "\"/>";
+		}
+		out << "\n";
+
+		out << "<rect x=\"" << (CZ_HTML_MARGIN_LEFT + 10) << "\" y=\"" << (CZ_HTML_MARGIN_TOP + 6 + s * 16)
+			<< "\" width=\"12\" height=\"3\" fill=\"" << color << "\"/>"
+			<< "<text x=\"" << (CZ_HTML_MARGIN_LEFT + 28) << "\" y=\"" << (CZ_HTML_MARGIN_TOP + 11 + s * 16) << "\">"
+			<< ((s == 0)? "Host Pinned to Device": "Device to Host Pinned") << "</text>\n";
+	}
+
+	out << "</svg>\n";
+}
+
+/*!	\brief Write run-to-run variance table and chart of device.
+	Chart shows deviation of each run from mean of the metric in
+	percent.
+*/
+static void CZHtmlWriteVariance(
+	QTextStream &out,		/*!<[in,out] Output stream. */
+	const struct CZHtmlDevice &dev	/*!<[in] Device results. */
+) {
+	double span = 0;
+	int rows = 0;
+
+	out << "<table>\n<tr><th>Test</th><th>Runs</th><th>Mean</th><th>Stddev</th><th>CV</th>"
+		"<th>Min</th><th>Max</th><th>Peak</th></tr>\n";
+
+	for(int m = 0; m < CZ_HTML_METRICS_NUM; m++) {
+		const struct CZStat &stat = dev.stat[m];
+		if(stat.num == 0)
+			continue;
+
+		double sigma = CZStatSigma(&stat);
+		double peak = CZPeakValue(&dev.runs[0], CZHtmlMetrics[m].test) / CZHtmlMetrics[m].scale;
+
+		out << "<tr><td>" << CZHtmlMetrics[m].title << "</td><td>" << stat.num << "</td>"
+			<< "<td>" << QString::number(stat.mean, 'f', 1) << " " << CZHtmlMetrics[m].unit << "</td>"
+			<< "<td>" << QString::number(sigma, 'f', 1) << "</td>"
+			<< "<td>" << QString::number(100 * sigma / stat.mean, 'f', 2) << "%</td>"
+			<< "<td>" << QString::number(stat.min, 'f', 1) << "</td>"
+			<< "<td>" << QString::number(stat.max, 'f', 1) << "</td><td>";
+		if(peak != 0)
+			out << QString::number(100 * stat.mean / peak, 'f', 1) << "%";
+		else
+			out << "--";
+		out << "</td></tr>\n";
+
+		if(stat.num > 1) {
+			rows++;
+			double dev1 = 100 * (stat.max - stat.mean) / stat.mean;
+			double dev2 = 100 * (stat.mean - stat.min) / stat.mean;
+			if(dev1 > span)
+				span = dev1;
+			if(dev2 > span)
+				span = dev2;
+		}
+	}
+
+	for(int k = 0; k < dev.userName.size(); k++) {
+		const struct CZStat &stat = dev.user[k];
+		if(stat.num == 0)
+			continue;
+
+		double sigma = CZStatSigma(&stat);
+		double peak = dev.userCalc[k]? 0: dev.runs[0].peak.memBandwidth / 1024;
+
+		out << "<tr><td>Kernel " << CZHtmlEscape(dev.userName[k]) << "</td><td>" << stat.num << "</td>"
+			<< "<td>" << QString::number(stat.mean, 'f', 1) << " " << (dev.userCalc[k]? "Mop/s": "MiB/s") << "</td>"
+			<< "<td>" << QString::number(sigma, 'f', 1) << "</td>"
+			<< "<td>" << QString::number(100 * sigma / stat.mean, 'f', 2) << "%</td>"
+			<< "<td>" << QString::number(stat.min, 'f', 1) << "</td>"
+			<< "<td>" << QString::number(stat.max, 'f', 1) << "</td><td>";
+		if(peak != 0)
+			out << QString::number(100 * stat.mean / peak, 'f', 1) << "%";
+		else
+			out << "--";
+		out << "</td></tr>\n";
+	}
+
+	out << "</table>\n";
+
+	if(rows == 0)
+		return;
+
+	span = CZHtmlNiceMax((span < 0.1)? 0.1: span);
+
+	const int w = CZ_HTML_CHART_WIDTH - CZ_HTML_LABEL_WIDTH - CZ_HTML_MARGIN_RIGHT;
+	const int height = CZ_HTML_MARGIN_TOP + rows * CZ_HTML_ROW_HEIGHT + 20;
+	const double xMid = CZ_HTML_LABEL_WIDTH + w / 2.0;
+
+	out << "<h3>Deviation of Runs from Mean</h3>\n"
+		<< "<svg width=\"" << CZ_HTML_CHART_WIDTH << "\" height=\"" << height << "\">\n";
+
+	for(int t = -2; t <= 2; t++) {
+		double x = xMid + w / 2.0 * t / 2;
+		out << "<line class=\"grid\" x1=\"" << x << "\" y1=\"" << CZ_HTML_MARGIN_TOP
+			<< "\" x2=\"" << x << "\" y2=\"" << (height - 20) << "\"/>"
+			<< "<text x=\"" << x << "\" y=\"" << (height - 6) << "\" text-anchor=\"middle\">"
+			<< ((t > 0)? "+": "") << QString::number(span * t / 2, 'g', 3) << "%</text>\n";
+	}
+
+	int row = 0;
+	for(int m = 0; m < CZ_HTML_METRICS_NUM; m++) {
+		const struct CZStat &stat = dev.stat[m];
+		if(stat.num < 2)
+			continue;
+
+		double y = CZ_HTML_MARGIN_TOP + (row + 0.5) * CZ_HTML_ROW_HEIGHT;
+		out << "<text x=\"" << (CZ_HTML_LABEL_WIDTH - 8) << "\" y=\"" << (y + 4) << "\" text-anchor=\"end\">"
+			<< CZHtmlMetrics[m].title << "</text>";
+
+		for(int r = 0; r < dev.runs.size(); r++) {
+			double value = CZTestValue(&dev.runs[r], CZHtmlMetrics[m].test) / CZHtmlMetrics[m].scale;
+			if(value <= 0)
+				continue;
+			double x = xMid + w / 2.0 * (100 * (value - stat.mean) / stat.mean) / span;
+			out << "<circle cx=\"" << x << "\" cy=\"" << y << "\" r=\"3\" fill=\"" CZ_HTML_COLOR_BAR "\"/>";
+		}
+		out << "\n";
+		row++;
+	}
+
+	out << "</svg>\n";
+}
+
+/*!	\brief Write comparison of devices.
+	Each metric gets a bar chart with mean value of every device which
+	ran the test. Whiskers show range between runs.
+*/
+static void CZHtmlWriteCompare(
+	QTextStream &out,		/*!<[in,out] Output stream. */
+	const QVector<struct CZHtmlDevice> &devices	/*!<[in] Results of all devices. */
+) {
+	const int w = CZ_HTML_CHART_WIDTH - CZ_HTML_LABEL_WIDTH - CZ_HTML_MARGIN_RIGHT - 60;
+
+	out << "<h2>Device Comparison</h2>\n";
+
+	for(int m = 0; m < CZ_HTML_METRICS_NUM; m++) {
+		double xMax = 0;
+		int rows = 0;
+
+		for(int d = 0; d < devices.size(); d++) {
+			if(devices[d].stat[m].num == 0)
+				continue;
+			rows++;
+			if(devices[d].stat[m].max > xMax)
+				xMax = devices[d].stat[m].max;
+		}
+
+		if(rows == 0)
+			continue;
+
+		xMax = CZHtmlNiceMax(xMax);
+
+		out << "<h3>" << CZHtmlMetrics[m].title << ", " << CZHtmlMetrics[m].unit << "</h3>\n"
+			<< "<svg width=\"" << CZ_HTML_CHART_WIDTH << "\" height=\"" << (rows * CZ_HTML_ROW_HEIGHT + 4) << "\">\n";
+
+		int row = 0;
+		for(int d = 0; d < devices.size(); d++) {
+			const struct CZStat &stat = devices[d].stat[m];
+			if(stat.num == 0)
+				continue;
+
+			double y = row * CZ_HTML_ROW_HEIGHT + 2;
+			double len = w * stat.mean / xMax;
+			out << "<text x=\"" << (CZ_HTML_LABEL_WIDTH - 8) << "\" y=\"" << (y + 13) << "\" text-anchor=\"end\">"
+				<< CZHtmlEscape(devices[d].name) << "</text>"
+				<< "<rect x=\"" << CZ_HTML_LABEL_WIDTH << "\" y=\"" << (y + 2) << "\" width=\"" << len
+				<< "\" height=\"" << (CZ_HTML_ROW_HEIGHT - 6) << "\" fill=\"" CZ_HTML_COLOR_BAR "\"/>";
+			if(stat.num > 1) {
+				out << "<line stroke=\"black\" x1=\"" << (CZ_HTML_LABEL_WIDTH + w * stat.min / xMax)
+					<< "\" y1=\"" << (y + CZ_HTML_ROW_HEIGHT / 2 - 1)
+					<< "\" x2=\"" << (CZ_HTML_LABEL_WIDTH + w * stat.max / xMax)
+					<< "\" y2=\"" << (y + CZ_HTML_ROW_HEIGHT / 2 - 1) << "\"/>";
+			}
+			out << "<text x=\"" << (CZ_HTML_LABEL_WIDTH + w * stat.max / xMax + 6) << "\" y=\"" << (y + 13) << "\">"
+				<< QString::number(stat.mean, 'f', 0) << "</text>\n";
+			row++;
+		}
+
+		out << "</svg>\n";
+	}
+}
+
+/*!	\brief Run selected tests on all devices and write HTML report.
+	Each device is tested \a runs times. Report has results of every
+	device, their run-to-run variance, copy rate versus transfer size
+	curves if copy sweep was run and comparison of all devices. OpenCL
+	and host CPU devices are tested like in CZConsoleReport().
+	\return \a 0 in case of success, \a 1 in case of error.
+*/
+int CZHtmlReport(
+	int testMask,			/*!<[in] Mask of tests to be run. See enum #CZTest. */
+	const QString &fileName,	/*!<[in] Output file name, stdout if empty. */
+	int runs,			/*!<[in] Number of runs on each device. */
+	bool cpuDevice,			/*!<[in] Test host CPU device too. */
+	bool clDevices			/*!<[in] Test OpenCL devices too. */
+) {
+	QFile file;
+
+	if(fileName.isEmpty()) {
+		file.open(stdout, QFile::WriteOnly | QFile::Text);
+	} else {
+		file.setFileName(fileName);
+		if(!file.open(QFile::WriteOnly | QFile::Text)) {
+			CZLog(CZLogLevelError, "Cannot write file %s: %s.",
+				fileName.toLocal8Bit().data(), file.errorString().toLocal8Bit().data());
+			return 1;
+		}
+	}
+
+	if(runs < 1)
+		runs = 1;
+
+	int num = 0;
+	if(!CZCudaCheck()) {
+		CZLog(CZLogLevelError, "CUDA not found!");
+	} else {
+		num = CZCudaDeviceFound();
+		if(num == 0)
+			CZLog(CZLogLevelError, "No compatible CUDA devices found!");
+	}
+
+	int numCl = 0;
+	if(clDevices) {
+		if(CZClCheck())
+			numCl = CZClDeviceFound();
+		if(numCl == 0)
+			CZLog(CZLogLevelError, "No OpenCL devices found!");
+	}
+
+	int numCpu = cpuDevice? CZCpuDeviceFound(): 0;
+
+	if(num + numCl + numCpu == 0)
+		return 1;
+
+	QVector<struct CZHtmlDevice> devices;
+	devices.reserve(num + numCl + numCpu);
+
+	for(int i = 0; i < num + numCl + numCpu; i++) {
+
+		CZCudaDeviceInfo device(
+			(i < num)? i: (i < num + numCl)? (i - num): (i - num - numCl),
+			(i < num)? CZDeviceTypeCuda: (i < num + numCl)? CZDeviceTypeOpenCL: CZDeviceTypeCpu);
+
+		if((device.info().deviceType == CZDeviceTypeCuda) && (device.info().major == 0))
+			continue;
+
+		device.setTestMask(testMask);
+
+		struct CZHtmlDevice dev;
+		memset(dev.stat, 0, sizeof(dev.stat));
+		memset(dev.user, 0, sizeof(dev.user));
+		dev.name = QString("Device %1: %2").arg(i).arg(device.info().deviceName);
+		dev.runs.reserve(runs);
+
+		for(int r = 0; r < runs; r++) {
+			CZLog(CZLogLevelLow, "Run %d of %d on %s.", r + 1, runs, device.info().deviceName);
+			device.waitPerformance();
+			dev.runs.append(device.info());
+			for(int m = 0; m < CZ_HTML_METRICS_NUM; m++)
+				CZHtmlStatAdd(dev.stat[m], CZTestValue(&dev.runs[r], CZHtmlMetrics[m].test) / CZHtmlMetrics[m].scale);
+			for(int k = 0; k < dev.runs[r].user.num; k++) {
+				const struct CZDeviceInfoUserKernel &kernel = dev.runs[r].user.kernel[k];
+				int j = dev.userName.indexOf(kernel.name);
+				if(j == -1) {
+					if(dev.userName.size() >= CZ_USER_KERNELS_MAX)
+						continue;
+					j = dev.userName.size();
+					dev.userName.append(kernel.name);
+					dev.userCalc[j] = kernel.calc != 0;
+				}
+				CZHtmlStatAdd(dev.user[j], dev.userCalc[j]? kernel.calc / 1000: kernel.band / 1024);
+			}
+		}
+
+		devices.append(dev);
+	}
+
+	QTextStream out(&file);
+
+	out << "<!DOCTYPE html>\n<html>\n<head>\n<meta charset=\"utf-8\">\n"
+		<< "<title>" CZ_NAME_SHORT " Report</title>\n"
+		<< "<style>\n"
+		"body{font-family:sans-serif;font-size:13px;margin:16px;}\n"
+		"table{border-collapse:collapse;margin:8px 0;}\n"
+		"th,td{border:1px solid #ccc;padding:2px 8px;text-align:right;}\n"
+		"th:first-child,td:first-child{text-align:left;}\n"
+		"svg{display:block;margin:4px 0 12px 0;}\n"
+		"svg text{font-size:11px;fill:#333;}\n"
+		"svg .grid{stroke:#ddd;}\n"
+		"</style>\n</head>\n<body>\n"
+		<< "<h1>" CZ_NAME_SHORT " " CZ_VERSION " Report</h1>\n"
+		<< "<p>" << devices.size() << " device(s), " << runs << " run(s) each.</p>\n";
+
+	for(int d = 0; d < devices.size(); d++) {
+		const struct CZHtmlDevice &dev = devices[d];
+		const struct CZDeviceInfo &info = dev.runs[0];
+
+		out << "<h2>" << CZHtmlEscape(dev.name) << "</h2>\n<p>";
+		if(info.deviceType == CZDeviceTypeCpu) {
+			out << "SIMD: " << CZCpuSimdName(info.major) << ", Cores: " << info.core.muliProcCount;
+		} else if(info.deviceType == CZDeviceTypeOpenCL) {
+			out << "OpenCL Version: " << info.major << "." << info.minor
+				<< ", Platform: " << CZHtmlEscape(info.drvDllVerStr)
+				<< ", Driver Version: " << CZHtmlEscape(info.drvVersion);
+		} else {
+			const struct CZArchInfo *arch = CZArchFind(info.major, info.minor);
+			out << "Compute Capability: " << info.major << "." << info.minor;
+			if(arch != NULL)
+				out << " (" << arch->name << ")";
+			out << ", Driver Version: " << CZHtmlEscape(info.drvVersion);
+			if(info.core.pciLinkGen != 0)
+				out << ", PCI Express: Gen" << info.core.pciLinkGen << " x" << info.core.pciLinkWidth;
+		}
+		out << "</p>\n";
+
+		CZHtmlWriteVariance(out, dev);
+		CZHtmlWriteSweep(out, dev);
+	}
+
+	if(devices.size() > 1)
+		CZHtmlWriteCompare(out, devices);
+
+	out << "</body>\n</html>\n";
+
+	return 0;
+}
@@ -0,0 +1,15 @@
+/*!	\file czhtmlreport.h
+	\brief HTML report functions header file.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#ifndef CZ_HTMLREPORT_H
+#define CZ_HTMLREPORT_H
+
+#include <QString>
+
+int CZHtmlReport(int testMask, const QString &fileName, int runs = 1, bool cpuDevice = false, bool clDevices = false);
+
+#endif//CZ_HTMLREPORT_H
@@ -0,0 +1,44 @@
+/*!	\file czstat.cpp
+	\brief Running statistics of test results source file.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <math.h>
+#include <string.h>
+
+#include "czstat.h"
+
+/*!	\brief Make distribution empty.
+*/
+void CZStatClear(
+	struct CZStat *stat		/*!<[out] Distribution. */
+) {
+	memset(stat, 0, sizeof(*stat));
+}
+
+/*!	\brief Add value to distribution.
+*/
+void CZStatAdd(
+	struct CZStat *stat,		/*!<[in,out] Distribution. */
+	double value			/*!<[in] Value. */
+) {
+	stat->num++;
+	double delta = value - stat->mean;
+	stat->mean += delta / stat->num;
+	stat->m2 += delta * (value - stat->mean);
+	if((stat->num == 1) || (value < stat->min))
+		stat->min = value;
+	if((stat->num == 1) || (value > stat->max))
+		stat->max = value;
+}
+
+/*!	\brief Get standard deviation of distribution.
+	\return sample standard deviation, \a 0 for less than two values.
+*/
+double CZStatSigma(
+	const struct CZStat *stat	/*!<[in] Distribution. */
+) {
+	return (stat->num < 2)? 0: sqrt(stat->m2 / (stat->num - 1));
+}
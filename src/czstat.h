@@ -0,0 +1,34 @@
+/*!	\file czstat.h
+	\brief Running statistics of test results definition.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#ifndef CZ_STAT_H
+#define CZ_STAT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!	\brief Distribution of one value.
+	Mean and variance are collected with Welford's method.
+*/
+struct CZStat {
+	int		num;			/*!< Number of values. */
+	double		mean;			/*!< Mean value. */
+	double		m2;			/*!< Sum of squared differences from mean. */
+	double		min;			/*!< Minimal value. */
+	double		max;			/*!< Maximal value. */
+};
+
+void CZStatClear(struct CZStat *stat);
+void CZStatAdd(struct CZStat *stat, double value);
+double CZStatSigma(const struct CZStat *stat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//CZ_STAT_H
@@ -0,0 +1,344 @@
+/*!	\file hostmem.cpp
+	\brief Host memory policies and page fault counters source file.
+	Pageable transfer rate depends on how host buffer is backed: the
+	first copy of an untouched buffer pays for page faults, huge pages
+	reduce TLB misses of the driver staging memcpy. Buffers of each
+	policy are allocated here, page faults and TLB misses of the
+	testing thread are counted with \a getrusage() and
+	\a perf_event_open().
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <QtGlobal>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(Q_OS_LINUX)
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+#elif defined(Q_OS_MAC)
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+
+#include "log.h"
+#include "hostmem.h"
+
+#define CZ_HOSTMEM_PAGE_SIZE	4096			/*!< Page size used if system does not report it. */
+#define CZ_HOSTMEM_HUGE_SIZE	(2 * (1 << 20))		/*!< Huge page size used if system does not report it. */
+#define CZ_HOSTMEM_LINE_LEN	256			/*!< Length of line read from system files. */
+
+/*!	\brief Get size of base page.
+	\return page size in bytes.
+*/
+static size_t CZHostMemPageSize(void) {
+#if defined(Q_OS_LINUX) || defined(Q_OS_MAC)
+	long size = sysconf(_SC_PAGESIZE);
+	if(size > 0)
+		return (size_t)size;
+#endif
+	return CZ_HOSTMEM_PAGE_SIZE;
+}
+
+#if defined(Q_OS_LINUX)
+/*!	\brief Get default size of huge page.
+	Size is read from \a Hugepagesize line of \a /proc/meminfo.
+	\return huge page size in bytes.
+*/
+static size_t CZHostMemHugeSize(void) {
+	char line[CZ_HOSTMEM_LINE_LEN];
+	size_t size = CZ_HOSTMEM_HUGE_SIZE;
+	unsigned long kib;
+
+	FILE *file = fopen("/proc/meminfo", "r");
+	if(file == NULL)
+		return size;
+
+	while(fgets(line, sizeof(line), file) != NULL) {
+		if(sscanf(line, "Hugepagesize: %lu kB", &kib) == 1) {
+			size = (size_t)kib * 1024;
+			break;
+		}
+	}
+
+	fclose(file);
+
+	return size;
+}
+#endif//Q_OS_LINUX
+
+/*!	\brief Touch each page of buffer.
+	Pages are written, so they are backed by memory after return.
+*/
+static void CZHostMemTouch(
+	void *ptr,			/*!<[in,out] Buffer. */
+	size_t size,			/*!<[in] Size of buffer. */
+	size_t page			/*!<[in] Page size. */
+) {
+	volatile char *p = (volatile char*)ptr;
+
+	for(size_t i = 0; i < size; i += page)
+		p[i] = 0;
+	if(size != 0)
+		p[size - 1] = 0;
+}
+
+/*!	\brief Allocate host buffer with memory policy.
+	Buffers are mapped directly on Linux. Policies without huge pages
+	disable transparent huge pages of their mapping, so the result does
+	not depend on system THP setting. \a CZHostMemHugeTlb needs huge
+	pages reserved in \a vm.nr_hugepages. Huge page policies are not
+	supported on other platforms.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZHostMemAlloc(
+	struct CZHostMem *mem,		/*!<[out] Buffer description. */
+	size_t size,			/*!<[in] Size of buffer. */
+	int policy			/*!<[in] Memory policy. See enum #CZHostMemPolicy. */
+) {
+	size_t page = CZHostMemPageSize();
+
+	memset(mem, 0, sizeof(*mem));
+	mem->size = size;
+	mem->policy = policy;
+
+#if defined(Q_OS_LINUX)
+	size_t huge = CZHostMemHugeSize();
+	int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+	switch(policy) {
+	case CZHostMemUntouched:
+	case CZHostMemPrefault:
+		mem->mapSize = (size + page - 1) & ~(page - 1);
+		break;
+
+	case CZHostMemTransparentHuge:
+		mem->mapSize = ((size + huge - 1) & ~(huge - 1)) + huge;
+		break;
+
+	case CZHostMemHugeTlb:
+		mem->mapSize = (size + huge - 1) & ~(huge - 1);
+		flags |= MAP_HUGETLB;
+		break;
+
+	default: // WTF!
+		return -1;
+	}
+
+	mem->base = mmap(NULL, mem->mapSize, PROT_READ | PROT_WRITE, flags, -1, 0);
+	if(mem->base == MAP_FAILED) {
+		CZLog(CZLogLevelModerate, "Can't map %lu bytes of %s host memory (errno %d).",
+			(unsigned long)mem->mapSize, CZHostMemPolicyName(policy), errno);
+		if(policy == CZHostMemHugeTlb)
+			CZLog(CZLogLevelModerate, "Huge pages are probably not reserved, see vm.nr_hugepages.");
+		memset(mem, 0, sizeof(*mem));
+		return -1;
+	}
+	mem->ptr = mem->base;
+
+	switch(policy) {
+	case CZHostMemUntouched:
+	case CZHostMemPrefault:
+#ifdef MADV_NOHUGEPAGE
+		madvise(mem->base, mem->mapSize, MADV_NOHUGEPAGE);
+#endif
+		break;
+
+	case CZHostMemTransparentHuge:
+		mem->ptr = (void*)(((size_t)mem->base + huge - 1) & ~(huge - 1));
+#ifdef MADV_HUGEPAGE
+		if(madvise(mem->ptr, mem->mapSize - huge, MADV_HUGEPAGE) != 0) {
+			CZLog(CZLogLevelModerate, "Transparent huge pages are not available (errno %d).", errno);
+			munmap(mem->base, mem->mapSize);
+			memset(mem, 0, sizeof(*mem));
+			return -1;
+		}
+#else
+		munmap(mem->base, mem->mapSize);
+		memset(mem, 0, sizeof(*mem));
+		return -1;
+#endif
+		break;
+	}
+
+	if(policy != CZHostMemUntouched)
+		CZHostMemTouch(mem->ptr, size, page);
+
+	return 0;
+#else//!Q_OS_LINUX
+	if((policy != CZHostMemUntouched) && (policy != CZHostMemPrefault)) {
+		CZLog(CZLogLevelLow, "Host memory policy %s is not supported.", CZHostMemPolicyName(policy));
+		return -1;
+	}
+
+	mem->base = malloc(size);
+	if(mem->base == NULL) {
+		memset(mem, 0, sizeof(*mem));
+		return -1;
+	}
+	mem->ptr = mem->base;
+	mem->mapSize = size;
+
+	if(policy == CZHostMemPrefault)
+		CZHostMemTouch(mem->ptr, size, page);
+
+	return 0;
+#endif//Q_OS_LINUX
+}
+
+/*!	\brief Free host buffer allocated by CZHostMemAlloc().
+*/
+void CZHostMemFree(
+	struct CZHostMem *mem		/*!<[in,out] Buffer description. */
+) {
+
+	if(mem->base != NULL) {
+#if defined(Q_OS_LINUX)
+		munmap(mem->base, mem->mapSize);
+#else
+		free(mem->base);
+#endif
+	}
+	memset(mem, 0, sizeof(*mem));
+}
+
+/*!	\brief Get name of memory policy.
+	\return name of policy.
+*/
+const char *CZHostMemPolicyName(
+	int policy			/*!<[in] Memory policy. See enum #CZHostMemPolicy. */
+) {
+	switch(policy) {
+	case CZHostMemUntouched:	return "untouched";
+	case CZHostMemPrefault:		return "prefault";
+	case CZHostMemTransparentHuge:	return "thp";
+	case CZHostMemHugeTlb:		return "hugetlb";
+	default:			return "unknown";
+	}
+}
+
+/*!	\brief State of host memory counters.
+*/
+struct CZHostMemCounter {
+	int		faultsValid;		/*!< Page fault counters are read. */
+	double		minorFaults;		/*!< Minor page faults at start. */
+	double		majorFaults;		/*!< Major page faults at start. */
+	int		tlbFd;			/*!< File descriptor of TLB miss counter, \a -1 if not opened. */
+};
+
+/*!	\brief Read page fault counters of the calling thread.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZHostMemReadFaults(
+	double *minorFaults,		/*!<[out] Minor page faults. */
+	double *majorFaults		/*!<[out] Major page faults. */
+) {
+#if defined(Q_OS_LINUX) || defined(Q_OS_MAC)
+	struct rusage usage;
+
+#if defined(Q_OS_LINUX)
+	if(getrusage(RUSAGE_THREAD, &usage) != 0)
+		return -1;
+#else
+	if(getrusage(RUSAGE_SELF, &usage) != 0)
+		return -1;
+#endif
+
+	*minorFaults = (double)usage.ru_minflt;
+	*majorFaults = (double)usage.ru_majflt;
+
+	return 0;
+#else
+	(void)minorFaults;
+	(void)majorFaults;
+	return -1;
+#endif
+}
+
+/*!	\brief Start counting page faults and TLB misses of the calling thread.
+	TLB misses are counted in user space only, so the counter works
+	with default \a perf_event_paranoid setting. Faults are counted for
+	whole process on MacOS.
+	\return counter to be passed to CZHostMemCountStop(), \a NULL in
+	case of error.
+*/
+void *CZHostMemCountStart(void) {
+	struct CZHostMemCounter *counter = (struct CZHostMemCounter*)malloc(sizeof(*counter));
+
+	if(counter == NULL)
+		return NULL;
+
+	memset(counter, 0, sizeof(*counter));
+	counter->tlbFd = -1;
+
+#if defined(Q_OS_LINUX)
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HW_CACHE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_CACHE_DTLB |
+		(PERF_COUNT_HW_CACHE_OP_READ << 8) |
+		(PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+
+	counter->tlbFd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+	if(counter->tlbFd == -1) {
+		CZLog(CZLogLevelLow, "Can't open TLB miss counter (errno %d).", errno);
+	} else {
+		ioctl(counter->tlbFd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(counter->tlbFd, PERF_EVENT_IOC_ENABLE, 0);
+	}
+#endif
+
+	counter->faultsValid = (CZHostMemReadFaults(&counter->minorFaults, &counter->majorFaults) == 0);
+
+	return counter;
+}
+
+/*!	\brief Stop counting and get counted values.
+	Values are \a -1 if \a counter is \a NULL or counter is not available.
+*/
+void CZHostMemCountStop(
+	void *counter,			/*!<[in] Counter returned by CZHostMemCountStart(). */
+	struct CZHostMemCount *count	/*!<[out] Counted values. */
+) {
+	struct CZHostMemCounter *c = (struct CZHostMemCounter*)counter;
+	double minorFaults;
+	double majorFaults;
+
+	count->minorFaults = -1;
+	count->majorFaults = -1;
+	count->tlbMisses = -1;
+
+	if(c == NULL)
+		return;
+
+	if(c->faultsValid && (CZHostMemReadFaults(&minorFaults, &majorFaults) == 0)) {
+		count->minorFaults = minorFaults - c->minorFaults;
+		count->majorFaults = majorFaults - c->majorFaults;
+	}
+
+#if defined(Q_OS_LINUX)
+	if(c->tlbFd != -1) {
+		unsigned long long value;
+		ioctl(c->tlbFd, PERF_EVENT_IOC_DISABLE, 0);
+		if(read(c->tlbFd, &value, sizeof(value)) == (ssize_t)sizeof(value))
+			count->tlbMisses = (double)value;
+		close(c->tlbFd);
+	}
+#endif
+
+	free(c);
+}
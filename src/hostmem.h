@@ -0,0 +1,49 @@
+/*!	\file hostmem.h
+	\brief Host memory policies and page fault counters definition.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#ifndef CZ_HOSTMEM_H
+#define CZ_HOSTMEM_H
+
+#include <stddef.h>
+
+#include "cudainfo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!	\brief Host buffer allocated with one of memory policies.
+*/
+struct CZHostMem {
+	void		*ptr;			/*!< Buffer. */
+	size_t		size;			/*!< Size of buffer. */
+	int		policy;			/*!< Memory policy. See enum #CZHostMemPolicy. */
+	/* Service part of structure. */
+	void		*base;			/*!< Start of mapping. */
+	size_t		mapSize;		/*!< Size of mapping. */
+};
+
+/*!	\brief Host memory counters of the calling thread.
+	Counter is \a -1 if it is not available.
+*/
+struct CZHostMemCount {
+	double		minorFaults;		/*!< Page faults served without I/O. */
+	double		majorFaults;		/*!< Page faults requiring I/O. */
+	double		tlbMisses;		/*!< Data TLB load misses in user space. */
+};
+
+int CZHostMemAlloc(struct CZHostMem *mem, size_t size, int policy);
+void CZHostMemFree(struct CZHostMem *mem);
+const char *CZHostMemPolicyName(int policy);
+void *CZHostMemCountStart(void);
+void CZHostMemCountStop(void *counter, struct CZHostMemCount *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//CZ_HOSTMEM_H
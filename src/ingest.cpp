@@ -0,0 +1,715 @@
+/*!	\file ingest.cpp
+	\brief Storage ingest pipeline test source file.
+	A local file is streamed into device memory through a ring of pinned
+	chunks. Every chunk is read from file and then copied to device, up to
+	\a depth chunks are in flight at once. On Linux file is opened with
+	\a O_DIRECT to bypass page cache and reads are queued with kernel AIO.
+	Read and copy stages are measured alone and together, the slower
+	stage alone is the bottleneck of the pipeline. Copy stage of host CPU
+	device is a plain memory copy, so file reading and pipelining can be
+	checked on a machine without GPU.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <QtGlobal>
+#include <QFile>
+#include <QElapsedTimer>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(Q_OS_LINUX)
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/aio_abi.h>
+#endif
+
+#include "log.h"
+#include "trace.h"
+#include "ingest.h"
+#include "hostmem.h"
+
+#define CZ_INGEST_PATH_LEN	1024		/*!< Max length of file name. */
+#define CZ_INGEST_ALIGN		4096		/*!< Alignment of chunks and file offsets for direct reads. */
+#define CZ_INGEST_POLL_US	100		/*!< Period of checking copies while reads are running in us. */
+
+/*!	\brief Name of file streamed by ingest test, empty if it is not set.
+*/
+static char CZIngestFileName[CZ_INGEST_PATH_LEN] = "";
+
+/*!	\brief Set file streamed by ingest test.
+*/
+void CZIngestSetFile(
+	const char *fileName		/*!<[in] File name, \a NULL to disable test. */
+) {
+	if(fileName == NULL)
+		CZIngestFileName[0] = 0;
+	else
+		snprintf(CZIngestFileName, sizeof(CZIngestFileName), "%s", fileName);
+}
+
+/*!	\brief Get name of stage of ingest pipeline.
+	\return name of stage.
+*/
+const char *CZIngestStageName(
+	int stage			/*!<[in] Stage. See enum #CZIngestStage. */
+) {
+	switch(stage) {
+	case CZIngestRead:
+		return "read";
+	case CZIngestCopy:
+		return "copy";
+	default:
+		return "unknown";
+	}
+}
+
+/*!	\brief Copy stage of ingest pipeline.
+	Functions have the same meaning as CZCudaIngestAlloc() and others.
+*/
+struct CZIngestCopier {
+	void		*(*alloc)(int num, int chunk, int depth);	/*!< Allocate chunks. */
+	void		*(*buffer)(void *data, int slot);	/*!< Get pinned chunk. */
+	int		(*copy)(void *data, int slot, int size);	/*!< Queue copy of chunk. */
+	int		(*query)(void *data, int slot);	/*!< Check if copy of chunk is done. */
+	int		(*wait)(void *data, int slot);	/*!< Wait for copy of chunk. */
+	void		(*release)(void *data);		/*!< Free chunks. */
+};
+
+/*!	\brief Copy stage of CUDA-device.
+*/
+static const struct CZIngestCopier CZIngestCudaCopier = {
+	CZCudaIngestAlloc,
+	CZCudaIngestBuffer,
+	CZCudaIngestCopy,
+	CZCudaIngestQuery,
+	CZCudaIngestWait,
+	CZCudaIngestFree,
+};
+
+/*!	\brief Chunks of host copy stage.
+*/
+struct CZIngestHostData {
+	struct CZHostMem	ring;		/*!< Chunks file is read to. */
+	struct CZHostMem	target;		/*!< Chunks data are copied to. */
+	size_t		chunk;			/*!< Size of chunk. */
+};
+
+/*!	\brief Free chunks of host copy stage.
+*/
+static void CZIngestHostFree(
+	void *data			/*!<[in,out] Chunks returned by CZIngestHostAlloc(). */
+) {
+	struct CZIngestHostData *hData = (struct CZIngestHostData*)data;
+
+	if(hData == NULL)
+		return;
+
+	CZHostMemFree(&hData->ring);
+	CZHostMemFree(&hData->target);
+	free(hData);
+}
+
+/*!	\brief Allocate chunks of host copy stage.
+	\return chunks, \a NULL in case of error.
+*/
+static void *CZIngestHostAlloc(
+	int num,			/*!<[in] Device index, not used. */
+	int chunk,			/*!<[in] Size of chunk. */
+	int depth			/*!<[in] Number of chunks. */
+) {
+	struct CZIngestHostData *hData;
+
+	(void)num;
+
+	hData = (struct CZIngestHostData*)calloc(1, sizeof(*hData));
+	if(hData == NULL)
+		return NULL;
+	hData->chunk = chunk;
+
+	if((CZHostMemAlloc(&hData->ring, (size_t)chunk * depth, CZHostMemPrefault) != 0) ||
+		(CZHostMemAlloc(&hData->target, (size_t)chunk * depth, CZHostMemPrefault) != 0)) {
+		CZIngestHostFree(hData);
+		return NULL;
+	}
+
+	return hData;
+}
+
+/*!	\brief Get chunk of host copy stage.
+	\return pointer to chunk.
+*/
+static void *CZIngestHostBuffer(
+	void *data,			/*!<[in] Chunks returned by CZIngestHostAlloc(). */
+	int slot			/*!<[in] Index of chunk. */
+) {
+	struct CZIngestHostData *hData = (struct CZIngestHostData*)data;
+
+	return (char*)hData->ring.ptr + hData->chunk * slot;
+}
+
+/*!	\brief Copy chunk of host copy stage.
+	Copy is done before return.
+	\return \a 0.
+*/
+static int CZIngestHostCopy(
+	void *data,			/*!<[in,out] Chunks returned by CZIngestHostAlloc(). */
+	int slot,			/*!<[in] Index of chunk. */
+	int size			/*!<[in] Number of bytes to copy. */
+) {
+	struct CZIngestHostData *hData = (struct CZIngestHostData*)data;
+
+	memcpy((char*)hData->target.ptr + hData->chunk * slot, (char*)hData->ring.ptr + hData->chunk * slot, size);
+
+	return 0;
+}
+
+/*!	\brief Check copy of host copy stage.
+	\return \a 1, copy is always done.
+*/
+static int CZIngestHostQuery(
+	void *data,			/*!<[in] Chunks returned by CZIngestHostAlloc(). */
+	int slot			/*!<[in] Index of chunk. */
+) {
+	(void)data;
+	(void)slot;
+
+	return 1;
+}
+
+/*!	\brief Wait for copy of host copy stage.
+	\return \a 0, copy is always done.
+*/
+static int CZIngestHostWait(
+	void *data,			/*!<[in] Chunks returned by CZIngestHostAlloc(). */
+	int slot			/*!<[in] Index of chunk. */
+) {
+	(void)data;
+	(void)slot;
+
+	return 0;
+}
+
+/*!	\brief Copy stage of host CPU device.
+*/
+static const struct CZIngestCopier CZIngestHostCopier = {
+	CZIngestHostAlloc,
+	CZIngestHostBuffer,
+	CZIngestHostCopy,
+	CZIngestHostQuery,
+	CZIngestHostWait,
+	CZIngestHostFree,
+};
+
+/*!	\brief File read by ingest pipeline.
+	Finished reads are kept in a list until they are collected by
+	CZIngestFileComplete().
+*/
+struct CZIngestFile {
+	int		direct;			/*!< 1 if page cache is bypassed. */
+	int		queued;			/*!< 1 if reads are queued asynchronously. */
+	double		size;			/*!< Size of file. */
+	int		doneNum;		/*!< Number of finished reads in list. */
+	int		doneSlot[CZ_INGEST_DEPTH_MAX];	/*!< Chunks of finished reads. */
+	int		doneSize[CZ_INGEST_DEPTH_MAX];	/*!< Bytes read by finished reads, \a -1 in case of error. */
+#if defined(Q_OS_LINUX)
+	int		fd;			/*!< File descriptor. */
+	aio_context_t	ctx;			/*!< AIO context. */
+	struct iocb	cb[CZ_INGEST_DEPTH_MAX];	/*!< Read requests of chunks. */
+#else
+	QFile		*file;			/*!< File. */
+#endif
+};
+
+/*!	\brief Close file of ingest pipeline.
+*/
+static void CZIngestFileClose(
+	struct CZIngestFile *file	/*!<[in,out] File. */
+) {
+#if defined(Q_OS_LINUX)
+	if(file->queued)
+		syscall(__NR_io_destroy, file->ctx);
+	if(file->fd >= 0)
+		close(file->fd);
+	file->fd = -1;
+#else
+	delete file->file;
+	file->file = NULL;
+#endif
+	file->queued = 0;
+}
+
+/*!	\brief Open file of ingest pipeline.
+	Linux file is read directly if file system supports it. One block
+	is read to \a probe to check it.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZIngestFileOpen(
+	struct CZIngestFile *file,	/*!<[out] File. */
+	const char *name,		/*!<[in] File name. */
+	int depth,			/*!<[in] Max number of reads in flight. */
+	void *probe			/*!<[in,out] Aligned buffer of #CZ_INGEST_ALIGN bytes at least. */
+) {
+	memset(file, 0, sizeof(*file));
+
+#if defined(Q_OS_LINUX)
+	struct stat st;
+
+	file->fd = open(name, O_RDONLY | O_DIRECT);
+	if(file->fd >= 0) {
+		file->direct = 1;
+		if((pread(file->fd, probe, CZ_INGEST_ALIGN, 0) < 0) && (errno == EINVAL)) {
+			close(file->fd);
+			file->fd = -1;
+		}
+	}
+	if(file->fd < 0) {
+		file->direct = 0;
+		file->fd = open(name, O_RDONLY);
+	}
+	if(file->fd < 0) {
+		CZLog(CZLogLevelError, "Can't open %s (errno %d).", name, errno);
+		return -1;
+	}
+	if(!file->direct)
+		CZLog(CZLogLevelWarning, "File system of %s does not support direct reads, page cache is used.", name);
+
+	if(fstat(file->fd, &st) != 0) {
+		CZIngestFileClose(file);
+		return -1;
+	}
+	file->size = (double)st.st_size;
+
+	if(syscall(__NR_io_setup, depth, &file->ctx) == 0)
+		file->queued = 1;
+	else
+		CZLog(CZLogLevelLow, "Kernel AIO is not available (errno %d), reads are not queued.", errno);
+#else
+	(void)depth;
+	(void)probe;
+
+	file->file = new QFile(QString::fromLocal8Bit(name));
+	if(!file->file->open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+		CZLog(CZLogLevelError, "Can't open %s: %s.", name, file->file->errorString().toLocal8Bit().constData());
+		CZIngestFileClose(file);
+		return -1;
+	}
+	file->size = (double)file->file->size();
+#endif
+
+	return 0;
+}
+
+/*!	\brief Drop cached pages of file, so every pass reads the storage.
+	Only clean pages of Linux page cache are dropped.
+*/
+static void CZIngestFileDrop(
+	struct CZIngestFile *file	/*!<[in] File. */
+) {
+#if defined(Q_OS_LINUX)
+	posix_fadvise(file->fd, 0, 0, POSIX_FADV_DONTNEED);
+#else
+	(void)file;
+#endif
+}
+
+/*!	\brief Start reading one chunk of file.
+	Read is done before return if reads are not queued.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZIngestFileSubmit(
+	struct CZIngestFile *file,	/*!<[in,out] File. */
+	int slot,			/*!<[in] Index of chunk. */
+	void *buf,			/*!<[out] Chunk. */
+	double offset,			/*!<[in] Offset in file. */
+	int size			/*!<[in] Size of chunk. */
+) {
+#if defined(Q_OS_LINUX)
+	if(file->queued) {
+		struct iocb *cb = &file->cb[slot];
+
+		memset(cb, 0, sizeof(*cb));
+		cb->aio_data = slot;
+		cb->aio_lio_opcode = IOCB_CMD_PREAD;
+		cb->aio_fildes = file->fd;
+		cb->aio_buf = (unsigned long long)(size_t)buf;
+		cb->aio_nbytes = size;
+		cb->aio_offset = (long long)offset;
+
+		if(syscall(__NR_io_submit, file->ctx, 1, &cb) != 1) {
+			CZLog(CZLogLevelError, "Can't queue file read (errno %d).", errno);
+			return -1;
+		}
+		return 0;
+	}
+
+	ssize_t res = pread(file->fd, buf, size, (off_t)offset);
+#else
+	qint64 res = -1;
+	if(file->file->seek((qint64)offset))
+		res = file->file->read((char*)buf, size);
+#endif
+
+	file->doneSlot[file->doneNum] = slot;
+	file->doneSize[file->doneNum] = (int)res;
+	file->doneNum++;
+
+	return 0;
+}
+
+/*!	\brief Move finished queued reads to the list of finished reads.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZIngestFileWait(
+	struct CZIngestFile *file,	/*!<[in,out] File. */
+	int timeoutUs			/*!<[in] Time to wait for the first read in us, \a -1 to wait forever. */
+) {
+#if defined(Q_OS_LINUX)
+	struct io_event event[CZ_INGEST_DEPTH_MAX];
+	struct timespec timeout;
+	long num;
+
+	if(!file->queued)
+		return 0;
+
+	timeout.tv_sec = (timeoutUs < 0)? 0: timeoutUs / 1000000;
+	timeout.tv_nsec = (timeoutUs < 0)? 0: (timeoutUs % 1000000) * 1000;
+
+	num = syscall(__NR_io_getevents, file->ctx, (timeoutUs == 0)? 0: 1,
+		CZ_INGEST_DEPTH_MAX - file->doneNum, event, (timeoutUs < 0)? NULL: &timeout);
+	if(num < 0) {
+		if(errno == EINTR)
+			return 0;
+		CZLog(CZLogLevelError, "Can't get finished file reads (errno %d).", errno);
+		return -1;
+	}
+
+	for(long i = 0; i < num; i++) {
+		file->doneSlot[file->doneNum] = (int)event[i].data;
+		file->doneSize[file->doneNum] = (event[i].res < 0)? -1: (int)event[i].res;
+		file->doneNum++;
+	}
+#else
+	(void)file;
+	(void)timeoutUs;
+#endif
+
+	return 0;
+}
+
+/*!	\brief Collect one finished read without waiting.
+	\return \a 1 if read was collected, \a 0 if no read is finished, \a -1
+	in case of error.
+*/
+static int CZIngestFileComplete(
+	struct CZIngestFile *file,	/*!<[in,out] File. */
+	int *slot,			/*!<[out] Index of chunk. */
+	int *size			/*!<[out] Bytes read. */
+) {
+	if((file->doneNum == 0) && (CZIngestFileWait(file, 0) != 0))
+		return -1;
+
+	if(file->doneNum == 0)
+		return 0;
+
+	file->doneNum--;
+	*slot = file->doneSlot[file->doneNum];
+	*size = file->doneSize[file->doneNum];
+
+	if(*size < 0) {
+		CZLog(CZLogLevelError, "Can't read file.");
+		return -1;
+	}
+
+	return 1;
+}
+
+/*!	\brief State of chunk in ingest pipeline.
+*/
+enum CZIngestSlot {
+	CZIngestSlotFree = 0,			/*!< Chunk is not used. */
+	CZIngestSlotReading,			/*!< File is being read to chunk. */
+	CZIngestSlotCopying,			/*!< Chunk is being copied to device. */
+};
+
+/*!	\brief Results of one pass of ingest pipeline.
+*/
+struct CZIngestPass {
+	double		bytes;			/*!< Number of bytes passed through pipeline. */
+	double		ms;			/*!< Time of pass in ms. */
+	double		stallMs[CZIngestStageNum];	/*!< Time pipeline waited for each stage only in ms. */
+};
+
+/*!	\brief Check if running pass has to be stopped.
+	Rules are the same as for CUDA-device tests.
+	\return \a true if pass has to be stopped, \a false otherwise.
+*/
+static bool CZIngestBreak(
+	struct CZDeviceInfo *info,	/*!<[in] Device information. */
+	const QElapsedTimer &timer	/*!<[in] Timer started with pass. */
+) {
+
+	if((info->abortFlag != NULL) && (*info->abortFlag != 0)) {
+		CZLog(CZLogLevelLow, "Test is aborted on %s.", info->deviceName);
+		return true;
+	}
+
+	if((info->timeLimit > 0) && (timer.elapsed() >= info->timeLimit)) {
+		CZLog(CZLogLevelLow, "Time limit of test is reached on %s.", info->deviceName);
+		return true;
+	}
+
+	return false;
+}
+
+/*!	\brief Run one pass of ingest pipeline.
+	File chunks are read and copied if \a file is set and \a copy is
+	\a true. File chunks are only read if \a copy is \a false. Chunks
+	are only copied if \a file is \a NULL.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZIngestRun(
+	struct CZDeviceInfo *info,	/*!<[in,out] Device information. */
+	struct CZIngestFile *file,	/*!<[in,out] File, \a NULL to skip reading. */
+	const struct CZIngestCopier *copier,	/*!<[in] Copy stage. */
+	void *data,			/*!<[in,out] Chunks of copy stage. */
+	bool copy,			/*!<[in] Copy chunks to device. */
+	int chunk,			/*!<[in] Size of chunk. */
+	int depth,			/*!<[in] Number of chunks. */
+	double limit,			/*!<[in] Number of bytes to pass. */
+	struct CZIngestPass *pass	/*!<[out] Results of pass. */
+) {
+	int state[CZ_INGEST_DEPTH_MAX];
+	int size[CZ_INGEST_DEPTH_MAX];
+	unsigned int order[CZ_INGEST_DEPTH_MAX];
+	unsigned int orderNext = 0;
+	int reading = 0;
+	int copying = 0;
+	double next = 0;
+	bool stop = false;
+	int slot;
+	int n;
+	int r;
+
+	memset(pass, 0, sizeof(*pass));
+	memset(state, 0, sizeof(state));
+
+	if(file != NULL)
+		CZIngestFileDrop(file);
+
+	QElapsedTimer timer;
+	timer.start();
+
+	for(;;) {
+		bool progress = false;
+
+		if(!stop && (next < limit) && CZIngestBreak(info, timer)) {
+			info->partialMask |= CZTestIngest;
+			stop = true;
+		}
+
+		/* Start new chunks in free slots. */
+		for(slot = 0; !stop && (slot < depth) && (next < limit); slot++) {
+			if(state[slot] != CZIngestSlotFree)
+				continue;
+			if(file != NULL) {
+				if(CZIngestFileSubmit(file, slot, copier->buffer(data, slot), next, chunk) != 0)
+					return -1;
+				state[slot] = CZIngestSlotReading;
+				reading++;
+			} else {
+				size[slot] = (limit - next < chunk)? (int)(limit - next): chunk;
+				if(copier->copy(data, slot, size[slot]) != 0)
+					return -1;
+				state[slot] = CZIngestSlotCopying;
+				order[slot] = orderNext++;
+				copying++;
+			}
+			next += chunk;
+			progress = true;
+		}
+
+		/* Pass finished reads to copy stage. */
+		while(reading > 0) {
+			r = CZIngestFileComplete(file, &slot, &n);
+			if(r < 0)
+				return -1;
+			if(r == 0)
+				break;
+			reading--;
+			progress = true;
+			if(copy && (n > 0)) {
+				size[slot] = n;
+				if(copier->copy(data, slot, n) != 0)
+					return -1;
+				state[slot] = CZIngestSlotCopying;
+				order[slot] = orderNext++;
+				copying++;
+			} else {
+				pass->bytes += n;
+				state[slot] = CZIngestSlotFree;
+			}
+		}
+
+		/* Free chunks copied to device. */
+		for(slot = 0; (copying > 0) && (slot < depth); slot++) {
+			if(state[slot] != CZIngestSlotCopying)
+				continue;
+			r = copier->query(data, slot);
+			if(r < 0)
+				return -1;
+			if(r == 0)
+				continue;
+			pass->bytes += size[slot];
+			state[slot] = CZIngestSlotFree;
+			copying--;
+			progress = true;
+		}
+
+		if((reading == 0) && (copying == 0) && (stop || (next >= limit)))
+			break;
+
+		if(progress)
+			continue;
+
+		/* Nothing moved, wait for the stage holding the pipeline. */
+		qint64 waitNs = timer.nsecsElapsed();
+		if(copying == 0) {
+			if(CZIngestFileWait(file, -1) != 0)
+				return -1;
+			pass->stallMs[CZIngestRead] += (double)(timer.nsecsElapsed() - waitNs) / 1000000.0;
+		} else if(reading == 0) {
+			int oldest = -1;
+			for(slot = 0; slot < depth; slot++) {
+				if((state[slot] == CZIngestSlotCopying) && ((oldest == -1) || ((int)(order[slot] - order[oldest]) < 0)))
+					oldest = slot;
+			}
+			if(copier->wait(data, oldest) != 0)
+				return -1;
+			pass->stallMs[CZIngestCopy] += (double)(timer.nsecsElapsed() - waitNs) / 1000000.0;
+		} else {
+			if(CZIngestFileWait(file, CZ_INGEST_POLL_US) != 0)
+				return -1;
+		}
+	}
+
+	pass->ms = (double)timer.nsecsElapsed() / 1000000.0;
+
+	return 0;
+}
+
+/*!	\brief Stream file set by CZIngestSetFile() into device memory.
+	Read stage, copy stage and the whole pipeline are run one by one,
+	each of them for time limit of test at most. Copy stage of CUDA-device
+	copies pinned chunks to device, copy stage of host CPU device copies
+	them to other host memory.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZIngestCalcDevice(
+	struct CZDeviceInfo *info	/*!<[in,out] Device information. */
+) {
+	const struct CZIngestCopier *copier;
+	struct CZIngestFile file;
+	struct CZIngestPass pass;
+	int chunk = info->config.ingestChunk & ~(CZ_INGEST_ALIGN - 1);
+	int depth = info->config.ingestDepth;
+	void *data;
+	int res = -1;
+
+	memset(&info->ingest, 0, sizeof(info->ingest));
+	info->partialMask &= ~CZTestIngest;
+
+	if((info->testMask & CZTestIngest) == 0)
+		return 0;
+
+	if(info->deviceType == CZDeviceTypeCuda)
+		copier = &CZIngestCudaCopier;
+	else if(info->deviceType == CZDeviceTypeCpu)
+		copier = &CZIngestHostCopier;
+	else
+		return 0;
+
+	if(CZIngestFileName[0] == 0) {
+		CZLog(CZLogLevelWarning, "File of storage ingest test is not set.");
+		return 0;
+	}
+
+	if(chunk < CZ_INGEST_ALIGN)
+		chunk = CZ_INGEST_ALIGN;
+	if(depth < 1)
+		depth = 1;
+	if(depth > CZ_INGEST_DEPTH_MAX)
+		depth = CZ_INGEST_DEPTH_MAX;
+
+	CZLog(CZLogLevelLow, "Starting storage ingest test of %s on %s.", CZIngestFileName, info->deviceName);
+
+	double testUs = CZTraceTimeUs();
+
+	data = copier->alloc(info->num, chunk, depth);
+	if(data == NULL)
+		return -1;
+
+	if(CZIngestFileOpen(&file, CZIngestFileName, depth, copier->buffer(data, 0)) != 0) {
+		copier->release(data);
+		return -1;
+	}
+
+	info->ingest.chunk = chunk;
+	info->ingest.depth = depth;
+	info->ingest.direct = file.direct;
+	info->ingest.queued = file.queued;
+
+	double passUs = CZTraceTimeUs();
+
+	if(CZIngestRun(info, &file, copier, data, false, chunk, depth, file.size, &pass) != 0)
+		goto cleanup;
+	if(pass.ms > 0)
+		info->ingest.stageRate[CZIngestRead] = (float)(pass.bytes / 1024.0 / (pass.ms / 1000.0));
+
+	CZTraceHostSpan("ingest", "read", info->num, passUs);
+	passUs = CZTraceTimeUs();
+
+	if(CZIngestRun(info, NULL, copier, data, true, chunk, depth, (pass.bytes > 0)? pass.bytes: file.size, &pass) != 0)
+		goto cleanup;
+	if(pass.ms > 0)
+		info->ingest.stageRate[CZIngestCopy] = (float)(pass.bytes / 1024.0 / (pass.ms / 1000.0));
+
+	CZTraceHostSpan("ingest", "copy", info->num, passUs);
+	passUs = CZTraceTimeUs();
+
+	if(CZIngestRun(info, &file, copier, data, true, chunk, depth, file.size, &pass) != 0)
+		goto cleanup;
+	info->ingest.bytes = pass.bytes;
+	info->ingest.totalMs = (float)pass.ms;
+	info->ingest.stallMs[CZIngestRead] = (float)pass.stallMs[CZIngestRead];
+	info->ingest.stallMs[CZIngestCopy] = (float)pass.stallMs[CZIngestCopy];
+	if(pass.ms > 0)
+		info->ingest.rate = (float)(pass.bytes / 1024.0 / (pass.ms / 1000.0));
+	info->ingest.bottleneck = (info->ingest.stageRate[CZIngestRead] < info->ingest.stageRate[CZIngestCopy])?
+		CZIngestRead: CZIngestCopy;
+
+	CZTraceHostSpan("ingest", "pipeline", info->num, passUs);
+
+	CZLogKV(CZLogLevelModerate, "ingest", "dev=%d chunk=%d depth=%d direct=%d queued=%d bytes=%.0f read=%f copy=%f rate=%f read_stall_ms=%f copy_stall_ms=%f bottleneck=%s",
+		info->num, chunk, depth, file.direct, file.queued, pass.bytes,
+		info->ingest.stageRate[CZIngestRead], info->ingest.stageRate[CZIngestCopy], info->ingest.rate,
+		info->ingest.stallMs[CZIngestRead], info->ingest.stallMs[CZIngestCopy],
+		CZIngestStageName(info->ingest.bottleneck));
+
+	res = 0;
+
+cleanup:
+	CZIngestFileClose(&file);
+	copier->release(data);
+
+	CZTraceHostSpan("ingest", "test", info->num, testUs);
+
+	return res;
+}
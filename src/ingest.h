@@ -0,0 +1,25 @@
+/*!	\file ingest.h
+	\brief Storage ingest pipeline test definition.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#ifndef CZ_INGEST_H
+#define CZ_INGEST_H
+
+#include "cudainfo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void CZIngestSetFile(const char *fileName);
+int CZIngestCalcDevice(struct CZDeviceInfo *info);
+const char *CZIngestStageName(int stage);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//CZ_INGEST_H
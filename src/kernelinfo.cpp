@@ -0,0 +1,670 @@
+/*!	\file kernelinfo.cpp
+	\brief User kernel test source file.
+	User kernels are loaded from PTX or cubin modules with CUDA driver
+	API and timed like built-in tests. Kernels are described in a
+	manifest file of the following form:
+	\code
+	# Comment.
+	[saxpy]
+	module = saxpy.ptx
+	function = saxpy
+	grid = 4096
+	block = 256
+	shared = 0
+	arg = buffer 16777216
+	arg = buffer 16777216
+	arg = float 2.0
+	arg = int 4194304
+	ops = 8388608
+	bytes = 50331648
+	launches = 100
+	\endcode
+	Section name is the name of kernel in reports. Module path is
+	relative to the manifest. Grid and block are \a x[,y[,z]]. Kernel
+	arguments are passed in order they are listed: \a buffer gives size
+	of device memory buffer passed as pointer, \a int, \a long, \a float
+	and \a double give scalar values. Optional \a ops and \a bytes are
+	numbers of operations and bytes of memory traffic of one launch.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <QtGlobal>
+#include <QElapsedTimer>
+#include <QMutex>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#include "log.h"
+#include "trace.h"
+#include "kernelinfo.h"
+#include "nvmlinfo.h"
+
+#if defined(Q_OS_WIN)
+#define CZ_KERNEL_DLL_FNAME	"nvcuda.dll"		/*!< CUDA driver dll file name. */
+#elif defined(Q_OS_MAC)
+#define CZ_KERNEL_DLL_FNAME	"/usr/local/cuda/lib/libcuda.dylib"	/*!< CUDA driver library file name. */
+#else
+#define CZ_KERNEL_DLL_FNAME	"libcuda.so.1"		/*!< CUDA driver library file name. */
+#endif
+
+#define CZ_KERNEL_ARGS_MAX	16			/*!< Max number of kernel arguments. */
+#define CZ_KERNEL_LINE_LEN	1024			/*!< Length of manifest line. */
+#define CZ_KERNEL_LAUNCHES	100			/*!< Default number of timed launches. */
+#define CZ_KERNEL_LOG_LEN	4096			/*!< Length of JIT error log. */
+
+/*	CUDA driver API types and constants used here. They are copied from
+	cuda.h so the file is built without CUDA SDK.
+*/
+typedef int CUresult;
+typedef int CUdevice;
+typedef unsigned long long CUdeviceptr;
+typedef struct CUctx_st *CUcontext;
+typedef struct CUmod_st *CUmodule;
+typedef struct CUfunc_st *CUfunction;
+typedef struct CUevent_st *CUevent;
+typedef struct CUstream_st *CUstream;
+
+#define CUDA_SUCCESS				0
+#define CU_JIT_ERROR_LOG_BUFFER			5
+#define CU_JIT_ERROR_LOG_BUFFER_SIZE_BYTES	6
+
+#if defined(Q_OS_WIN)
+#define CZ_CU_API	__stdcall
+#else
+#define CZ_CU_API
+#endif
+
+/*!	\brief List of CUDA driver functions used here.
+	Each item gives return type, name and arguments of function.
+*/
+#define CZ_CU_FUNC_LIST \
+	CZ_CU_FUNC(CUresult, cuInit, (unsigned int flags)) \
+	CZ_CU_FUNC(CUresult, cuDeviceGet, (CUdevice *device, int ordinal)) \
+	CZ_CU_FUNC(CUresult, cuDevicePrimaryCtxRetain, (CUcontext *ctx, CUdevice dev)) \
+	CZ_CU_FUNC(CUresult, cuDevicePrimaryCtxRelease, (CUdevice dev)) \
+	CZ_CU_FUNC(CUresult, cuCtxPushCurrent_v2, (CUcontext ctx)) \
+	CZ_CU_FUNC(CUresult, cuCtxPopCurrent_v2, (CUcontext *ctx)) \
+	CZ_CU_FUNC(CUresult, cuModuleLoadDataEx, (CUmodule *module, const void *image, unsigned int numOptions, int *options, void **optionValues)) \
+	CZ_CU_FUNC(CUresult, cuModuleUnload, (CUmodule module)) \
+	CZ_CU_FUNC(CUresult, cuModuleGetFunction, (CUfunction *func, CUmodule module, const char *name)) \
+	CZ_CU_FUNC(CUresult, cuMemAlloc_v2, (CUdeviceptr *ptr, size_t size)) \
+	CZ_CU_FUNC(CUresult, cuMemFree_v2, (CUdeviceptr ptr)) \
+	CZ_CU_FUNC(CUresult, cuMemsetD8_v2, (CUdeviceptr ptr, unsigned char value, size_t num)) \
+	CZ_CU_FUNC(CUresult, cuLaunchKernel, (CUfunction func, unsigned int gridX, unsigned int gridY, unsigned int gridZ, \
+		unsigned int blockX, unsigned int blockY, unsigned int blockZ, unsigned int shared, CUstream stream, \
+		void **params, void **extra)) \
+	CZ_CU_FUNC(CUresult, cuEventCreate, (CUevent *event, unsigned int flags)) \
+	CZ_CU_FUNC(CUresult, cuEventDestroy_v2, (CUevent event)) \
+	CZ_CU_FUNC(CUresult, cuEventRecord, (CUevent event, CUstream stream)) \
+	CZ_CU_FUNC(CUresult, cuEventSynchronize, (CUevent event)) \
+	CZ_CU_FUNC(CUresult, cuEventElapsedTime, (float *ms, CUevent start, CUevent end))
+
+/*	Prototypes of CUDA driver functions \a <name>_t and pointers to
+	them \a p_<name>. Pointers are initializaed by CZKernelIsInit().
+*/
+#define CZ_CU_FUNC(ret, name, args) \
+	typedef ret (CZ_CU_API *name##_t) args; \
+	static name##_t p_##name = NULL;
+CZ_CU_FUNC_LIST
+#undef CZ_CU_FUNC
+
+static QMutex CZKernelMutex;		/*!< Lock of CUDA driver loading. */
+
+/*!	\brief Error handling of CUDA driver calls.
+*/
+#define CZ_CU_CALL(funcCall, errProc) \
+	{ \
+		CUresult errCode; \
+		if((errCode = (funcCall)) != CUDA_SUCCESS) { \
+			CZLog(CZLogLevelError, "CUDA Driver Error: %d in %s", errCode, #funcCall); \
+			errProc; \
+		} \
+	}
+
+/*!	\brief Type of kernel argument.
+*/
+enum CZKernelArgType {
+	CZKernelArgBuffer,		/*!< Device memory buffer. */
+	CZKernelArgInt,			/*!< 32-bit integer. */
+	CZKernelArgLong,		/*!< 64-bit integer. */
+	CZKernelArgFloat,		/*!< Single-precision float. */
+	CZKernelArgDouble,		/*!< Double-precision float. */
+};
+
+/*!	\brief Names of kernel argument types in manifest.
+*/
+static const struct {
+	const char	*name;			/*!< Name of type. */
+	int		type;			/*!< Type. See enum #CZKernelArgType. */
+} CZKernelArgTypes[] = {
+	{"buffer",	CZKernelArgBuffer},
+	{"int",		CZKernelArgInt},
+	{"long",	CZKernelArgLong},
+	{"float",	CZKernelArgFloat},
+	{"double",	CZKernelArgDouble},
+};
+
+/*!	\brief User kernel read from manifest.
+*/
+struct CZKernelDesc {
+	char		name[CZ_USER_NAME_LEN];	/*!< Name of kernel. */
+	char		module[CZ_KERNEL_LINE_LEN];	/*!< Module file name. */
+	char		function[CZ_KERNEL_LINE_LEN];	/*!< Kernel function name. */
+	void		*image;			/*!< Module image. */
+	unsigned int	grid[3];		/*!< Grid size. */
+	unsigned int	block[3];		/*!< Block size. */
+	unsigned int	shared;			/*!< Dynamic shared memory size in bytes. */
+	int		argNum;			/*!< Number of arguments. */
+	int		argType[CZ_KERNEL_ARGS_MAX];	/*!< Type of argument. See enum #CZKernelArgType. */
+	double		argValue[CZ_KERNEL_ARGS_MAX];	/*!< Value of argument or buffer size. */
+	double		ops;			/*!< Number of operations of one launch. */
+	double		bytes;			/*!< Number of bytes of one launch. */
+	int		launches;		/*!< Number of timed launches. */
+};
+
+/*!	\brief Kernels read from manifest.
+*/
+static struct CZKernelDesc CZKernels[CZ_USER_KERNELS_MAX];
+
+/*!	\brief Number of kernels read from manifest.
+*/
+static int CZKernelNum = 0;
+
+/*!	\brief Check if CUDA driver library is loaded.
+	This function loads CUDA driver library and finds all functions of
+	\a CZ_CU_FUNC_LIST. User kernels of several devices are run from
+	their own threads, so the driver is loaded under lock.
+	\return \a true in case of success, \a false in case of error.
+*/
+static bool CZKernelIsInit(void) {
+	static int state = 0;
+	QMutexLocker locker(&CZKernelMutex);
+
+	if(state != 0)
+		return state > 0;
+
+	state = -1;
+
+#if defined(Q_OS_WIN)
+	HMODULE hDll = LoadLibraryA(CZ_KERNEL_DLL_FNAME);
+#define CZ_CU_SYMBOL(name) GetProcAddress(hDll, name)
+#else
+	void *hDll = dlopen(CZ_KERNEL_DLL_FNAME, RTLD_LAZY);
+#define CZ_CU_SYMBOL(name) dlsym(hDll, name)
+#endif
+
+	if(hDll == NULL) {
+		CZLog(CZLogLevelError, "Can't load CUDA driver.");
+		return false;
+	}
+
+#define CZ_CU_FUNC(ret, name, args) \
+	p_##name = (name##_t)CZ_CU_SYMBOL(#name); \
+	if(p_##name == NULL) { \
+		CZLog(CZLogLevelError, "Can't find function %s in CUDA driver.", #name); \
+		return false; \
+	}
+CZ_CU_FUNC_LIST
+#undef CZ_CU_FUNC
+#undef CZ_CU_SYMBOL
+
+	CZ_CU_CALL(p_cuInit(0),
+		return false);
+
+	state = 1;
+	return true;
+}
+
+/*!	\brief Remove spaces from both ends of string.
+	\return pointer to the first non-space character.
+*/
+static char *CZKernelTrim(
+	char *str			/*!<[in,out] String. */
+) {
+	while((*str == ' ') || (*str == '\t'))
+		str++;
+
+	char *end = str + strlen(str);
+	while((end > str) && ((end[-1] == ' ') || (end[-1] == '\t') || (end[-1] == '\n') || (end[-1] == '\r')))
+		end--;
+	*end = 0;
+
+	return str;
+}
+
+/*!	\brief Read dimensions of grid or block.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZKernelReadDim(
+	const char *value,		/*!<[in] Text of dimensions. */
+	unsigned int dim[3]		/*!<[out] Dimensions. */
+) {
+	dim[0] = dim[1] = dim[2] = 1;
+
+	int num = sscanf(value, "%u,%u,%u", &dim[0], &dim[1], &dim[2]);
+	if((num < 1) || (dim[0] == 0) || (dim[1] == 0) || (dim[2] == 0))
+		return -1;
+
+	return 0;
+}
+
+/*!	\brief Read kernel argument.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZKernelReadArg(
+	const char *value,		/*!<[in] Text of argument. */
+	struct CZKernelDesc *desc	/*!<[in,out] Kernel description. */
+) {
+	char type[32];
+	double arg;
+
+	if(desc->argNum >= CZ_KERNEL_ARGS_MAX)
+		return -1;
+
+	if(sscanf(value, "%31s %lf", type, &arg) != 2)
+		return -1;
+
+	for(unsigned int i = 0; i < sizeof(CZKernelArgTypes) / sizeof(CZKernelArgTypes[0]); i++) {
+		if(strcmp(type, CZKernelArgTypes[i].name) == 0) {
+			if((CZKernelArgTypes[i].type == CZKernelArgBuffer) && (arg < 1))
+				return -1;
+			desc->argType[desc->argNum] = CZKernelArgTypes[i].type;
+			desc->argValue[desc->argNum] = arg;
+			desc->argNum++;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+/*!	\brief Load module image of kernel.
+	Module file name is relative to directory of manifest. PTX image is
+	terminated with zero as driver needs.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZKernelLoadImage(
+	const char *manifest,		/*!<[in] Manifest file name. */
+	struct CZKernelDesc *desc	/*!<[in,out] Kernel description. */
+) {
+	char path[2 * CZ_KERNEL_LINE_LEN];
+	const char *sep = strrchr(manifest, '/');
+#if defined(Q_OS_WIN)
+	const char *sep2 = strrchr(manifest, '\\');
+	if((sep == NULL) || ((sep2 != NULL) && (sep2 > sep)))
+		sep = sep2;
+	bool absolute = (desc->module[0] == '/') || (desc->module[0] == '\\') || (desc->module[1] == ':');
+#else
+	bool absolute = (desc->module[0] == '/');
+#endif
+
+	if(absolute || (sep == NULL))
+		snprintf(path, sizeof(path), "%s", desc->module);
+	else
+		snprintf(path, sizeof(path), "%.*s/%s", (int)(sep - manifest), manifest, desc->module);
+
+	FILE *file = fopen(path, "rb");
+	if(file == NULL) {
+		CZLog(CZLogLevelError, "Can't open module %s of kernel %s.", path, desc->name);
+		return -1;
+	}
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	char *image = (char*)malloc(size + 1);
+	if((size <= 0) || (image == NULL) || (fread(image, 1, size, file) != (size_t)size)) {
+		CZLog(CZLogLevelError, "Can't read module %s of kernel %s.", path, desc->name);
+		free(image);
+		fclose(file);
+		return -1;
+	}
+	image[size] = 0;
+	fclose(file);
+
+	desc->image = image;
+	return 0;
+}
+
+/*!	\brief Check and finish kernel description read from manifest.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZKernelFinish(
+	const char *manifest,		/*!<[in] Manifest file name. */
+	struct CZKernelDesc *desc	/*!<[in,out] Kernel description. */
+) {
+
+	if((desc->module[0] == 0) || (desc->function[0] == 0)) {
+		CZLog(CZLogLevelError, "Kernel %s has no module or function in %s.", desc->name, manifest);
+		return -1;
+	}
+
+	return CZKernelLoadImage(manifest, desc);
+}
+
+/*!	\brief Read manifest of user kernels.
+	Kernels of previous manifest are dropped. Up to
+	#CZ_USER_KERNELS_MAX kernels are read. Kernels are run by
+	CZKernelCalcDevice() if \a CZTestUser test is selected.
+	\return number of kernels, \a -1 in case of error.
+*/
+int CZKernelLoadManifest(
+	const char *fileName		/*!<[in] Manifest file name. */
+) {
+	char line[CZ_KERNEL_LINE_LEN];
+	struct CZKernelDesc *desc = NULL;
+	int lineNum = 0;
+	int err = 0;
+
+	for(int i = 0; i < CZKernelNum; i++)
+		free(CZKernels[i].image);
+	CZKernelNum = 0;
+
+	FILE *file = fopen(fileName, "r");
+	if(file == NULL) {
+		CZLog(CZLogLevelError, "Can't open kernel manifest %s.", fileName);
+		return -1;
+	}
+
+	while(fgets(line, sizeof(line), file) != NULL) {
+		char *str = CZKernelTrim(line);
+		int res = 0;
+
+		lineNum++;
+
+		if((*str == 0) || (*str == '#'))
+			continue;
+
+		if(*str == '[') {
+			if((desc != NULL) && (CZKernelFinish(fileName, desc) != 0)) {
+				err = 1;
+				desc = NULL;
+				break;
+			}
+			if(CZKernelNum >= CZ_USER_KERNELS_MAX) {
+				CZLog(CZLogLevelWarning, "Only %d kernels are read from %s.", CZ_USER_KERNELS_MAX, fileName);
+				desc = NULL;
+				break;
+			}
+			desc = &CZKernels[CZKernelNum++];
+			memset(desc, 0, sizeof(*desc));
+			desc->grid[0] = desc->grid[1] = desc->grid[2] = 1;
+			desc->block[0] = desc->block[1] = desc->block[2] = 1;
+			desc->launches = CZ_KERNEL_LAUNCHES;
+			snprintf(desc->name, sizeof(desc->name), "%.*s", (int)strcspn(str + 1, "]"), str + 1);
+			continue;
+		}
+
+		char *value = strchr(str, '=');
+		if((desc == NULL) || (value == NULL)) {
+			CZLog(CZLogLevelError, "Syntax error in %s:%d.", fileName, lineNum);
+			err = 1;
+			break;
+		}
+		*value++ = 0;
+		str = CZKernelTrim(str);
+		value = CZKernelTrim(value);
+
+		if(strcmp(str, "module") == 0)
+			snprintf(desc->module, sizeof(desc->module), "%s", value);
+		else if(strcmp(str, "function") == 0)
+			snprintf(desc->function, sizeof(desc->function), "%s", value);
+		else if(strcmp(str, "grid") == 0)
+			res = CZKernelReadDim(value, desc->grid);
+		else if(strcmp(str, "block") == 0)
+			res = CZKernelReadDim(value, desc->block);
+		else if(strcmp(str, "shared") == 0)
+			desc->shared = (unsigned int)strtoul(value, NULL, 0);
+		else if(strcmp(str, "arg") == 0)
+			res = CZKernelReadArg(value, desc);
+		else if(strcmp(str, "ops") == 0)
+			desc->ops = strtod(value, NULL);
+		else if(strcmp(str, "bytes") == 0)
+			desc->bytes = strtod(value, NULL);
+		else if(strcmp(str, "launches") == 0)
+			res = ((desc->launches = atoi(value)) > 0)? 0: -1;
+		else
+			res = -1;
+
+		if(res != 0) {
+			CZLog(CZLogLevelError, "Bad value of %s in %s:%d.", str, fileName, lineNum);
+			err = 1;
+			break;
+		}
+	}
+
+	fclose(file);
+
+	if((err == 0) && (desc != NULL) && (CZKernelFinish(fileName, desc) != 0))
+		err = 1;
+
+	if(err != 0) {
+		for(int i = 0; i < CZKernelNum; i++)
+			free(CZKernels[i].image);
+		CZKernelNum = 0;
+		return -1;
+	}
+
+	CZLog(CZLogLevelLow, "%d user kernel(s) read from %s.", CZKernelNum, fileName);
+	return CZKernelNum;
+}
+
+/*!	\brief Get number of user kernels.
+	\return number of kernels read from manifest.
+*/
+int CZKernelCount(void) {
+	return CZKernelNum;
+}
+
+/*!	\brief Load, launch and time one user kernel.
+	Kernel is launched once to warm up, then \a desc->launches times in
+	a row between two events. Number of launches is reduced to fit into
+	time limit of the device.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZKernelRun(
+	struct CZDeviceInfo *info,	/*!<[in,out] CUDA-device information. */
+	const struct CZKernelDesc *desc,	/*!<[in] Kernel description. */
+	struct CZDeviceInfoUserKernel *res	/*!<[out] Kernel results. */
+) {
+	char errorLog[CZ_KERNEL_LOG_LEN];
+	int options[2] = {CU_JIT_ERROR_LOG_BUFFER, CU_JIT_ERROR_LOG_BUFFER_SIZE_BYTES};
+	void *optionValues[2] = {errorLog, (void*)(size_t)sizeof(errorLog)};
+	union {
+		CUdeviceptr	ptr;
+		int		i;
+		long long	l;
+		float		f;
+		double		d;
+	} values[CZ_KERNEL_ARGS_MAX];
+	void *params[CZ_KERNEL_ARGS_MAX];
+	CUmodule module = NULL;
+	CUfunction func;
+	CUevent start = NULL;
+	CUevent stop = NULL;
+	float warmMs = 0;
+	float deviceMs = 0;
+	int launches = desc->launches;
+	int r = -1;
+	int i;
+
+	memset(values, 0, sizeof(values));
+	errorLog[0] = 0;
+	snprintf(res->name, sizeof(res->name), "%s", desc->name);
+
+	if(p_cuModuleLoadDataEx(&module, desc->image, 2, options, optionValues) != CUDA_SUCCESS) {
+		CZLog(CZLogLevelError, "Can't load module of kernel %s: %s", desc->name, errorLog);
+		return -1;
+	}
+
+	CZ_CU_CALL(p_cuModuleGetFunction(&func, module, desc->function),
+		goto cleanup);
+
+	for(i = 0; i < desc->argNum; i++) {
+		switch(desc->argType[i]) {
+		case CZKernelArgBuffer:
+			CZ_CU_CALL(p_cuMemAlloc_v2(&values[i].ptr, (size_t)desc->argValue[i]),
+				goto cleanup);
+			CZ_CU_CALL(p_cuMemsetD8_v2(values[i].ptr, 0, (size_t)desc->argValue[i]),
+				goto cleanup);
+			break;
+		case CZKernelArgInt:	values[i].i = (int)desc->argValue[i]; break;
+		case CZKernelArgLong:	values[i].l = (long long)desc->argValue[i]; break;
+		case CZKernelArgFloat:	values[i].f = (float)desc->argValue[i]; break;
+		case CZKernelArgDouble:	values[i].d = desc->argValue[i]; break;
+		}
+		params[i] = &values[i];
+	}
+
+	CZ_CU_CALL(p_cuEventCreate(&start, 0),
+		goto cleanup);
+	CZ_CU_CALL(p_cuEventCreate(&stop, 0),
+		goto cleanup);
+
+#define CZ_KERNEL_LAUNCH() \
+	p_cuLaunchKernel(func, desc->grid[0], desc->grid[1], desc->grid[2], \
+		desc->block[0], desc->block[1], desc->block[2], desc->shared, NULL, params, NULL)
+
+	/* The first launch also loads the kernel to device. */
+	CZ_CU_CALL(p_cuEventRecord(start, NULL),
+		goto cleanup);
+	CZ_CU_CALL(CZ_KERNEL_LAUNCH(),
+		goto cleanup);
+	CZ_CU_CALL(p_cuEventRecord(stop, NULL),
+		goto cleanup);
+	CZ_CU_CALL(p_cuEventSynchronize(stop),
+		goto cleanup);
+	CZ_CU_CALL(p_cuEventElapsedTime(&warmMs, start, stop),
+		goto cleanup);
+
+	if((info->timeLimit > 0) && (warmMs > 0) && (warmMs * launches > info->timeLimit)) {
+		launches = (int)(info->timeLimit / warmMs);
+		if(launches < 1)
+			launches = 1;
+		info->partialMask |= CZTestUser;
+	}
+
+	{
+		void *sampler = CZNvmlSampleStart(info);
+		double startUs = CZTraceTimeUs();
+		QElapsedTimer timer;
+		timer.start();
+
+		CZ_CU_CALL(p_cuEventRecord(start, NULL),
+			CZNvmlSampleStop(sampler, &res->time.tele);
+			goto cleanup);
+		for(i = 0; i < launches; i++) {
+			if((info->abortFlag != NULL) && (*info->abortFlag != 0)) {
+				info->partialMask |= CZTestUser;
+				break;
+			}
+			CZ_CU_CALL(CZ_KERNEL_LAUNCH(),
+				CZNvmlSampleStop(sampler, &res->time.tele);
+				goto cleanup);
+		}
+		launches = i;
+		CZ_CU_CALL(p_cuEventRecord(stop, NULL),
+			CZNvmlSampleStop(sampler, &res->time.tele);
+			goto cleanup);
+		CZ_CU_CALL(p_cuEventSynchronize(stop),
+			CZNvmlSampleStop(sampler, &res->time.tele);
+			goto cleanup);
+
+		res->time.wallMs = (float)(timer.nsecsElapsed() / 1000000.0);
+		CZNvmlSampleStop(sampler, &res->time.tele);
+
+		CZ_CU_CALL(p_cuEventElapsedTime(&deviceMs, start, stop),
+			goto cleanup);
+
+		CZTraceDeviceSpan("user", desc->name, info->num, startUs, deviceMs * 1000.0);
+	}
+
+#undef CZ_KERNEL_LAUNCH
+
+	if((launches == 0) || (deviceMs == 0))
+		goto cleanup;
+
+	res->launches = launches;
+	res->launchUs = deviceMs * 1000 / launches;
+	res->calc = (float)(desc->ops * launches / deviceMs);
+	res->band = (float)(desc->bytes * launches * 1000 / ((double)deviceMs * 1024));
+	res->time.deviceMs = deviceMs;
+	res->time.amount = (desc->bytes != 0)? desc->bytes * launches: desc->ops * launches;
+
+	CZLogKV(CZLogLevelLow, "user-kernel", "dev=%d name=%s launches=%d launch_us=%f kops=%f kibs=%f",
+		info->num, desc->name, launches, res->launchUs, res->calc, res->band);
+
+	r = 0;
+
+cleanup:
+	if(start != NULL)
+		p_cuEventDestroy_v2(start);
+	if(stop != NULL)
+		p_cuEventDestroy_v2(stop);
+	for(i = 0; i < desc->argNum; i++) {
+		if((desc->argType[i] == CZKernelArgBuffer) && (values[i].ptr != 0))
+			p_cuMemFree_v2(values[i].ptr);
+	}
+	p_cuModuleUnload(module);
+
+	return r;
+}
+
+/*!	\brief Run user kernels on CUDA-device.
+	Kernels run in primary context of the device, the same one CUDA
+	runtime uses. Kernels which fail are skipped. Results are reset if
+	\a CZTestUser is not selected.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZKernelCalcDevice(
+	struct CZDeviceInfo *info	/*!<[in,out] CUDA-device information. */
+) {
+	CUdevice dev;
+	CUcontext ctx;
+
+	memset(&info->user, 0, sizeof(info->user));
+	info->partialMask &= ~CZTestUser;
+
+	if(((info->testMask & CZTestUser) == 0) || (CZKernelNum == 0) || (info->deviceType != CZDeviceTypeCuda))
+		return 0;
+
+	if(!CZKernelIsInit())
+		return -1;
+
+	CZ_CU_CALL(p_cuDeviceGet(&dev, info->num),
+		return -1);
+	CZ_CU_CALL(p_cuDevicePrimaryCtxRetain(&ctx, dev),
+		return -1);
+	CZ_CU_CALL(p_cuCtxPushCurrent_v2(ctx),
+		p_cuDevicePrimaryCtxRelease(dev);
+		return -1);
+
+	CZLog(CZLogLevelLow, "Starting user kernels on %s.", info->deviceName);
+
+	for(int i = 0; i < CZKernelNum; i++) {
+		if((info->abortFlag != NULL) && (*info->abortFlag != 0)) {
+			info->partialMask |= CZTestUser;
+			break;
+		}
+		if(CZKernelRun(info, &CZKernels[i], &info->user.kernel[info->user.num]) == 0)
+			info->user.num++;
+		else
+			memset(&info->user.kernel[info->user.num], 0, sizeof(info->user.kernel[0]));
+	}
+
+	p_cuCtxPopCurrent_v2(&ctx);
+	p_cuDevicePrimaryCtxRelease(dev);
+
+	return 0;
+}
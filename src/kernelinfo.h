@@ -0,0 +1,25 @@
+/*!	\file kernelinfo.h
+	\brief User kernel test definition.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#ifndef CZ_KERNELINFO_H
+#define CZ_KERNELINFO_H
+
+#include "cudainfo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int CZKernelLoadManifest(const char *fileName);
+int CZKernelCount(void);
+int CZKernelCalcDevice(struct CZDeviceInfo *info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//CZ_KERNELINFO_H
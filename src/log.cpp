@@ -6,37 +6,125 @@
 */
 
 #include <QString>
+#include <QThread>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QElapsedTimer>
 
 #include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "log.h"
 
-#define CZ_LOG_BUFFER_LENGTH		4096	/*!< Log bufer size. */
-#define CZ_LOG_DEFAULT_LEVEL		CZLogLevelHigh	/*!< Default logging level. */
+#if defined(_MSC_VER) && (_MSC_VER < 1900)
+#define vsnprintf _vsnprintf
+#endif
 
-/*!	\brief Logging function.
+#define CZ_LOG_TEXT_LENGTH		512	/*!< Length of log record text. */
+#define CZ_LOG_EVENT_LENGTH		32	/*!< Length of log record event name. */
+#define CZ_LOG_RING_SIZE		1024	/*!< Number of records in log ring buffer. Must be power of 2. */
+#define CZ_LOG_WRITER_PERIOD		10	/*!< Period of log writer polling (ms). */
+#define CZ_LOG_LEVEL_ENV		"CZ_LOG_LEVEL"	/*!< Environment variable with logging level. */
+
+/*!	\def CZ_LOG_DEFAULT_LEVEL
+	\brief Default logging level.
 */
-void CZLog(
-	CZLogLevel level,		/*!<[in] Log level value. */
-	const char *fmt,		/*!<[in] printf()-like format string. */
-	...				/* Additional arguments for printout. */
+#ifdef QT_NO_DEBUG
+#define CZ_LOG_DEFAULT_LEVEL		CZLogLevelHigh
+#else
+#define CZ_LOG_DEFAULT_LEVEL		CZLogLevelLow
+#endif//QT_NO_DEBUG
+
+volatile int CZLogCurrentLevel = CZ_LOG_DEFAULT_LEVEL;
+
+/*!	\brief Log record.
+	Records are passed from logging threads to the writer thread.
+*/
+struct CZLogRecord {
+	QAtomicInt	sequence;			/*!< Sequence number of ring buffer slot. */
+	qint64		time;				/*!< Time of record in ns since logging start. */
+	quintptr	thread;				/*!< ID of thread that made the record. */
+	CZLogLevel	level;				/*!< Log level value. */
+	char		event[CZ_LOG_EVENT_LENGTH];	/*!< Event name, empty for plain messages. */
+	char		text[CZ_LOG_TEXT_LENGTH];	/*!< Message text or key=value fields of event. */
+};
+
+/*!	\brief Bounded lock-free ring buffer of log records.
+	Any thread may put records in, only the writer thread takes them out.
+	Each slot has a sequence number: it is equal to the position of
+	the slot for a free slot and to the position plus one for a filled
+	slot. Records are dropped if the buffer is full.
+*/
+static struct CZLogRecord CZLogRing[CZ_LOG_RING_SIZE];
+static QAtomicInt CZLogEnqueuePos;	/*!< Next position to put record in. */
+static int CZLogDequeuePos = 0;		/*!< Next position to take record out. */
+static QAtomicInt CZLogDropped;		/*!< Number of records dropped because of full buffer. */
+static QAtomicInt CZLogPutting;		/*!< Number of threads putting records in ring buffer. */
+static QElapsedTimer CZLogTimer;	/*!< Time base of log records. Started by CZLogStart(). */
+
+/*!	\brief Atomic read of integer with acquire semantics.
+*/
+static inline int CZLogAtomicLoad(
+	QAtomicInt &value		/*!<[in] Atomic value. */
+) {
+#if QT_VERSION < 0x050000
+	return value.fetchAndAddAcquire(0);
+#else
+	return value.loadAcquire();
+#endif//QT_VERSION
+}
+
+/*!	\brief Background log writer thread.
+*/
+class CZLogWriter: public QThread {
+
+public:
+	CZLogWriter();
+	void stop();
+
+protected:
+	void run();
+
+private:
+	QAtomicInt stopFlag;
+};
+
+/*!	\brief Log writer thread. \a NULL if records are written synchronously.
+*/
+static QAtomicPointer<CZLogWriter> CZLogWriterThread;
+
+/*!	\brief Atomic read of log writer thread pointer with acquire semantics.
+*/
+static inline CZLogWriter *CZLogWriterLoad(void) {
+#if QT_VERSION < 0x050000
+	return CZLogWriterThread.fetchAndAddAcquire(0);
+#else
+	return CZLogWriterThread.loadAcquire();
+#endif//QT_VERSION
+}
+
+/*!	\brief Output one log record.
+*/
+static void CZLogOutput(
+	const struct CZLogRecord &record	/*!<[in] Record to be printed. */
 ) {
 	QString buf;
 
-#ifdef QT_NO_DEBUG
-	if(level > CZ_LOG_DEFAULT_LEVEL) {
-		return;
-	}
-#endif
+	buf.sprintf("t=%.6f tid=%llu lvl=%d ",
+		(double)record.time / 1000000000.0,
+		(unsigned long long)record.thread,
+		(int)record.level);
 
-	va_list ap;
-	va_start(ap, fmt);
-	if(fmt)
-		buf.vsprintf(fmt, ap);
-	va_end(ap);
+	if(record.event[0] != 0) {
+		buf += QString("event=%1 %2").arg(record.event).arg(record.text);
+	} else {
+		buf += QString("msg=\"%1\"").arg(record.text);
+	}
 
 	QtMsgType type;
-	switch(level) {
+	switch(record.level) {
 	case CZLogLevelFatal:
 		type = QtFatalMsg;
 		break;
@@ -58,3 +146,229 @@ void CZLog(
 	qt_message_output(type, context, buf.toLocal8Bit().constData());
 #endif//QT_VERSION 
 }
+
+/*!	\brief Take all records out of ring buffer and print them.
+	This function is called by the writer thread only.
+*/
+static void CZLogFlush(void) {
+
+	forever {
+		struct CZLogRecord *record = &CZLogRing[CZLogDequeuePos & (CZ_LOG_RING_SIZE - 1)];
+
+		if(CZLogAtomicLoad(record->sequence) != CZLogDequeuePos + 1)
+			break;
+
+		CZLogOutput(*record);
+
+		record->sequence.fetchAndStoreRelease(CZLogDequeuePos + CZ_LOG_RING_SIZE);
+		CZLogDequeuePos++;
+	}
+
+	int dropped = CZLogDropped.fetchAndStoreOrdered(0);
+	if(dropped != 0) {
+		struct CZLogRecord record;
+		record.time = CZLogTimer.nsecsElapsed();
+		record.thread = (quintptr)QThread::currentThreadId();
+		record.level = CZLogLevelWarning;
+		record.event[0] = 0;
+		sprintf(record.text, "%d log records dropped.", dropped);
+		CZLogOutput(record);
+	}
+}
+
+/*!	\brief Creates log writer thread.
+*/
+CZLogWriter::CZLogWriter() {
+	stopFlag = 0;
+}
+
+/*!	\brief Stops log writer thread.
+	All records put before this call are printed.
+*/
+void CZLogWriter::stop() {
+	stopFlag.fetchAndStoreOrdered(1);
+	wait();
+}
+
+/*!	\brief Main work function of log writer thread.
+*/
+void CZLogWriter::run() {
+
+	while(CZLogAtomicLoad(stopFlag) == 0) {
+		CZLogFlush();
+		msleep(CZ_LOG_WRITER_PERIOD);
+	}
+
+	CZLogFlush();
+}
+
+/*!	\brief Put a record in log.
+	Formatting is done with plain vsnprintf() in the calling thread.
+	If the writer thread is running the record is passed through the
+	ring buffer, otherwise it is printed immediately. Threads putting
+	records in ring buffer are counted, so CZLogStop() can wait for them
+	before the final flush.
+*/
+static void CZLogPut(
+	CZLogLevel level,		/*!<[in] Log level value. */
+	const char *event,		/*!<[in] Event name or \a NULL for plain messages. */
+	const char *fmt,		/*!<[in] printf()-like format string. */
+	va_list ap			/*!<[in] Additional arguments for printout. */
+) {
+	struct CZLogRecord local;
+	struct CZLogRecord *record = &local;
+	int pos = 0;
+
+	bool async = false;
+
+	if(level != CZLogLevelFatal) {
+		CZLogPutting.fetchAndAddOrdered(1);
+		async = (CZLogWriterLoad() != NULL);
+		if(!async)
+			CZLogPutting.fetchAndAddOrdered(-1);
+	}
+
+	if(async) {
+		pos = CZLogAtomicLoad(CZLogEnqueuePos);
+		forever {
+			record = &CZLogRing[pos & (CZ_LOG_RING_SIZE - 1)];
+			int diff = CZLogAtomicLoad(record->sequence) - pos;
+			if(diff == 0) {
+				if(CZLogEnqueuePos.testAndSetOrdered(pos, pos + 1))
+					break;
+				pos = CZLogAtomicLoad(CZLogEnqueuePos);
+			} else if(diff < 0) {
+				CZLogDropped.fetchAndAddOrdered(1);
+				CZLogPutting.fetchAndAddOrdered(-1);
+				return;
+			} else {
+				pos = CZLogAtomicLoad(CZLogEnqueuePos);
+			}
+		}
+	}
+
+	record->time = CZLogTimer.isValid()? CZLogTimer.nsecsElapsed(): 0;
+	record->thread = (quintptr)QThread::currentThreadId();
+	record->level = level;
+	record->event[0] = 0;
+	if(event != NULL) {
+		strncpy(record->event, event, CZ_LOG_EVENT_LENGTH - 1);
+		record->event[CZ_LOG_EVENT_LENGTH - 1] = 0;
+	}
+	record->text[0] = 0;
+	if(fmt != NULL)
+		vsnprintf(record->text, CZ_LOG_TEXT_LENGTH, fmt, ap);
+	record->text[CZ_LOG_TEXT_LENGTH - 1] = 0;
+
+	if(async) {
+		record->sequence.fetchAndStoreRelease(pos + 1);
+		CZLogPutting.fetchAndAddOrdered(-1);
+	} else {
+		CZLogOutput(*record);
+	}
+}
+
+/*!	\brief Set logging level.
+*/
+void CZLogSetLevel(
+	CZLogLevel level		/*!<[in] New log level value. */
+) {
+	CZLogCurrentLevel = level;
+}
+
+/*!	\brief Get logging level.
+	\return current logging level.
+*/
+CZLogLevel CZLogGetLevel(void) {
+	return (CZLogLevel)CZLogCurrentLevel;
+}
+
+/*!	\brief Start background log writer.
+	Logging level is taken from environment variable \a CZ_LOG_LEVEL if
+	it is set. Time base of log records is started by the first call,
+	records put before it have zero time.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZLogStart(void) {
+
+	const char *env = getenv(CZ_LOG_LEVEL_ENV);
+	if(env != NULL)
+		CZLogSetLevel((CZLogLevel)atoi(env));
+
+	if(!CZLogTimer.isValid())
+		CZLogTimer.start();
+
+	if(CZLogWriterLoad() != NULL)
+		return 0;
+
+	for(int i = 0; i < CZ_LOG_RING_SIZE; i++) {
+		CZLogRing[i].sequence.fetchAndStoreOrdered(i);
+	}
+	CZLogEnqueuePos.fetchAndStoreOrdered(0);
+	CZLogDequeuePos = 0;
+
+	CZLogWriter *writer = new CZLogWriter();
+	if(writer == NULL)
+		return -1;
+	writer->start(QThread::LowPriority);
+
+	CZLogWriterThread.fetchAndStoreOrdered(writer);
+
+	return 0;
+}
+
+/*!	\brief Stop background log writer.
+	Ring buffer stops accepting records first, then threads still putting
+	records in it are waited for and all pending records are printed.
+	Further records are printed synchronously.
+*/
+void CZLogStop(void) {
+
+	CZLogWriter *writer = CZLogWriterThread.fetchAndStoreOrdered(NULL);
+
+	if(writer == NULL)
+		return;
+
+	while(CZLogAtomicLoad(CZLogPutting) != 0)
+		QThread::yieldCurrentThread();
+
+	writer->stop();
+	delete writer;
+}
+
+/*!	\brief Logging function.
+*/
+void CZLog(
+	CZLogLevel level,		/*!<[in] Log level value. */
+	const char *fmt,		/*!<[in] printf()-like format string. */
+	...				/* Additional arguments for printout. */
+) {
+	if(!CZLogEnabled(level)) {
+		return;
+	}
+
+	va_list ap;
+	va_start(ap, fmt);
+	CZLogPut(level, NULL, fmt, ap);
+	va_end(ap);
+}
+
+/*!	\brief Structured logging function.
+	Logs \a event with fields given as \a key=value pairs separated
+	by spaces, e.g. CZLogKV(CZLogLevelLow, "copy-loop", "loop=%d ms=%f", i, ms).
+*/
+void CZLogKV(
+	CZLogLevel level,		/*!<[in] Log level value. */
+	const char *event,		/*!<[in] Event name. */
+	const char *fmt,		/*!<[in] printf()-like format string of fields. */
+	...				/* Additional arguments for printout. */
+) {
+	if(!CZLogEnabled(level)) {
+		return;
+	}
+
+	va_list ap;
+	va_start(ap, fmt);
+	CZLogPut(level, event, fmt, ap);
+	va_end(ap);
+}
@@ -23,12 +23,35 @@ typedef enum {
 	CZLogLevelLow = 2,		/*!< Not important information. */
 } CZLogLevel;
 
+/*!	\brief Current logging level.
+	Use CZLogSetLevel() to change it.
+*/
+extern volatile int CZLogCurrentLevel;
+
+/*!	\def CZLogEnabled(level)
+	\brief Cheap check if messages of given \a level are logged.
+	Use it to skip preparation of expensive log arguments.
+*/
+#define CZLogEnabled(level)	((int)(level) <= CZLogCurrentLevel)
+
+void CZLogSetLevel(CZLogLevel level);
+CZLogLevel CZLogGetLevel(void);
+
+int CZLogStart(void);
+void CZLogStop(void);
+
 void CZLog(CZLogLevel level, const char *fmt, ...)
 #if defined(Q_CC_GNU) && !defined(__INSURE__)
 	__attribute__ ((format (printf, 2, 3)))
 #endif
 ;
 
+void CZLogKV(CZLogLevel level, const char *event, const char *fmt, ...)
+#if defined(Q_CC_GNU) && !defined(__INSURE__)
+	__attribute__ ((format (printf, 3, 4)))
+#endif
+;
+
 #ifdef __cplusplus
 }
 #endif
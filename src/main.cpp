@@ -9,9 +9,20 @@
 #include <QMessageBox>
 #include <QDebug>
 
+#include <stdio.h>
+
 #include "log.h"
+#include "trace.h"
 #include "czdialog.h"
+#include "czconsole.h"
+#include "czfleet.h"
+#include "czhtmlreport.h"
 #include "cudainfo.h"
+#include "kernelinfo.h"
+#include "coldstart.h"
+#include "contend.h"
+#include "ingest.h"
+#include "testconfig.h"
 #include "version.h"
 
 /*!	\brief Call function that checks CUDA presents.
@@ -45,6 +56,71 @@ int getCudaDeviceNum() {
 	return res;
 }
 
+/*!	\brief Print command line usage information.
+*/
+static void printUsage(
+	const char *name	/*!<[in] Name of executable. */
+) {
+	fprintf(stderr,
+		CZ_NAME_SHORT " " CZ_VERSION "\n"
+		"Usage: %s [options]\n"
+		"Options:\n"
+		"  --tests=<list>    Run only listed tests. List is comma separated\n"
+		"                    names of hd-page, hd-pin, dh-page, dh-pin, dd,\n"
+		"                    sweep, staged, hostmem, float, double, int32,\n"
+		"                    int24, int64, memory, alloc, user, coldstart,\n"
+		"                    contend, aggregate, ingest, copy, calc, all. Copy\n"
+		"                    sweep, staged copy study, host memory policy\n"
+		"                    study, memory, allocation, cold-start,\n"
+		"                    contention, aggregate and ingest tests are run\n"
+		"                    only if listed.\n"
+		"                    Contention test runs other listed copy and\n"
+		"                    calculation tests, or all of them, in several\n"
+		"                    processes at once. Aggregate test runs pinned\n"
+		"                    copies on all CUDA devices at once, only with\n"
+		"                    --report.\n"
+		"  --kernels=<file>  Run user kernels described in manifest file on\n"
+		"                    CUDA devices.\n"
+		"  --ingest=<file>   Stream file into memory of CUDA devices, or of\n"
+		"                    host CPU device with --cpu, and find the slower\n"
+		"                    of read and copy stages.\n"
+		"  --profile=<name>  Set test parameters of profile quick, standard\n"
+		"                    or burn-in. Default profile is standard.\n"
+		"  --config=<file>   Set test parameters from config file.\n"
+		"  --set=<list>      Set test parameters from comma separated list of\n"
+		"                    key=value pairs. Keys are copy-size, copy-loops,\n"
+		"                    calc-block-loops, calc-loops, calc-threads,\n"
+		"                    time-limit (ms, 0 for no limit) and copy-verify\n"
+		"                    (1 to verify transferred data with checksums),\n"
+		"                    stage-chunk-min, stage-chunk-max and stage-depth\n"
+		"                    (staged copy study), cold-runs (number of child\n"
+		"                    processes of each module loading mode of\n"
+		"                    cold-start test), contend-procs (number of\n"
+		"                    processes of contention test), aggregate-devices\n"
+		"                    (bit mask of CUDA devices of aggregate test, 0\n"
+		"                    for all devices), ingest-chunk and ingest-depth\n"
+		"                    (chunk size and number of chunks in flight of\n"
+		"                    storage ingest test).\n"
+		"  --report[=<file>] Run tests without GUI and print report to file\n"
+		"                    or to standard output.\n"
+		"  --html[=<file>]   Run tests without GUI and write HTML report with\n"
+		"                    charts to file or to standard output.\n"
+		"  --runs=<n>        Run tests n times on each device for HTML report.\n"
+		"  --cpu             Add host CPU device to report.\n"
+		"  --cpu-baseline    Same as --cpu.\n"
+		"  --opencl          Add OpenCL devices to report.\n"
+		"  --fleet=<list>    Summarize reports of many devices and print\n"
+		"                    outliers to file given with --report or to\n"
+		"                    standard output. List is comma separated names\n"
+		"                    of report files and directories.\n"
+		"  --trace=<file>    Write timeline of tests to file in Chrome trace\n"
+		"                    format (chrome://tracing, ui.perfetto.dev).\n"
+		"  --log-level=<n>   Set logging level from -3 (fatal errors only)\n"
+		"                    to 2 (all messages).\n"
+		"  --help            Print this help.\n",
+		name);
+}
+
 #ifdef Q_OS_WIN
 #include <Windows.h>
 /*!	\brief Sleep function.
@@ -62,6 +138,141 @@ int main(
 	int argc,		/*!<[in] Count of command line arguments. */
 	char *argv[]		/*!<[in] List of command line arguments. */
 ) {
+	int testMask = CZTestAll;
+	bool consoleReport = false;
+	bool htmlReport = false;
+	int runs = 1;
+	bool cpuDevice = false;
+	bool clDevices = false;
+	QString reportFile;
+	QString traceFile;
+	QString kernelFile;
+	QString ingestFile;
+	struct CZTestConfig config;
+	QStringList fleetInputs;
+
+	CZLogStart();
+	CZConfigDefault(&config);
+
+	for(int i = 1; i < argc; i++) {
+		QString arg = QString::fromLocal8Bit(argv[i]);
+
+		if(arg.startsWith("--cold-child=")) {
+			/* Child process of cold-start test, see CZColdCalcDevice(). */
+			int res = CZColdChild(arg.mid(13).toInt());
+			CZLogStop();
+			return res;
+		} else if(arg.startsWith("--contend-child=")) {
+			/* Worker process of contention test, see CZContendCalcDevice(). */
+			int res = CZContendChild(arg.mid(16).toLocal8Bit().constData());
+			CZLogStop();
+			return res;
+		} else if(arg.startsWith("--tests=")) {
+			testMask = CZCudaDeviceInfo::parseTestMask(arg.mid(8));
+			if(testMask <= 0) {
+				printUsage(argv[0]);
+				CZLogStop();
+				return 1;
+			}
+		} else if(arg == "--report") {
+			consoleReport = true;
+		} else if(arg.startsWith("--report=")) {
+			consoleReport = true;
+			reportFile = arg.mid(9);
+		} else if(arg == "--html") {
+			htmlReport = true;
+		} else if(arg.startsWith("--html=")) {
+			htmlReport = true;
+			reportFile = arg.mid(7);
+		} else if(arg.startsWith("--runs=")) {
+			runs = arg.mid(7).toInt();
+			if(runs <= 0) {
+				printUsage(argv[0]);
+				CZLogStop();
+				return 1;
+			}
+		} else if((arg == "--cpu") || (arg == "--cpu-baseline")) {
+			cpuDevice = true;
+		} else if(arg == "--opencl") {
+			clDevices = true;
+		} else if(arg.startsWith("--fleet=")) {
+			fleetInputs = arg.mid(8).split(',', QString::SkipEmptyParts);
+		} else if(arg.startsWith("--profile=") || arg.startsWith("--config=") || arg.startsWith("--set=")) {
+			QByteArray value = arg.mid(arg.indexOf('=') + 1).toLocal8Bit();
+			int r = arg.startsWith("--profile=")? CZConfigProfile(&config, value.constData()):
+				arg.startsWith("--config=")? CZConfigLoad(&config, value.constData()):
+				CZConfigParse(&config, value.constData());
+			if(r != 0) {
+				printUsage(argv[0]);
+				CZLogStop();
+				return 1;
+			}
+		} else if(arg.startsWith("--kernels=")) {
+			kernelFile = arg.mid(10);
+		} else if(arg.startsWith("--ingest=")) {
+			ingestFile = arg.mid(9);
+		} else if(arg.startsWith("--trace=")) {
+			traceFile = arg.mid(8);
+		} else if(arg.startsWith("--log-level=")) {
+			CZLogSetLevel((CZLogLevel)arg.mid(12).toInt());
+		} else if((arg == "--help") || (arg == "-h")) {
+			printUsage(argv[0]);
+			CZLogStop();
+			return 0;
+		}
+	}
+
+	CZCudaDeviceInfo::setDefaultConfig(config);
+
+	if((testMask & CZTestAggregate) && !consoleReport && fleetInputs.isEmpty()) {
+		CZLog(CZLogLevelError, "Aggregate test runs only with --report, GUI and HTML report have no place for it.");
+		printUsage(argv[0]);
+		CZLogStop();
+		return 1;
+	}
+
+	if(!kernelFile.isEmpty()) {
+		if(CZKernelLoadManifest(kernelFile.toLocal8Bit().constData()) < 0) {
+			CZLogStop();
+			return 1;
+		}
+		testMask |= CZTestUser;
+	}
+
+	if(!ingestFile.isEmpty()) {
+		CZIngestSetFile(ingestFile.toLocal8Bit().constData());
+		testMask |= CZTestIngest;
+	}
+
+	if(!traceFile.isEmpty()) {
+		if(CZTraceStart(traceFile.toLocal8Bit().constData()) != 0) {
+			CZLog(CZLogLevelError, "Can't start tracing to %s.", traceFile.toLocal8Bit().constData());
+		}
+	}
+
+	if(!fleetInputs.isEmpty()) {
+		QCoreApplication app(argc, argv);
+		int res = CZFleetReport(fleetInputs, reportFile);
+		CZTraceStop();
+		CZLogStop();
+		return res;
+	}
+
+	if(htmlReport) {
+		QCoreApplication app(argc, argv);
+		int res = CZHtmlReport(testMask, reportFile, runs, cpuDevice, clDevices);
+		CZTraceStop();
+		CZLogStop();
+		return res;
+	}
+
+	if(consoleReport) {
+		QCoreApplication app(argc, argv);
+		int res = CZConsoleReport(testMask, reportFile, cpuDevice, clDevices);
+		CZTraceStop();
+		CZLogStop();
+		return res;
+	}
 
 	QApplication app(argc, argv);
 
@@ -77,23 +288,23 @@ int main(
 	splash->showMessage(QObject::tr("Checking CUDA ..."),
 		Qt::AlignLeft | Qt::AlignBottom);
 	app.processEvents();
+	int devs = 0;
 	if(!testCudaPresent()) {
-		QMessageBox::critical(0, QObject::tr(CZ_NAME_LONG),
+		QMessageBox::warning(0, QObject::tr(CZ_NAME_LONG),
 			QObject::tr("CUDA not found!") + "\n" +
-			QObject::tr("Please update your NVIDIA driver and try again!"));
-		delete splash;
-		exit(1);
-	}
+			QObject::tr("Please update your NVIDIA driver and try again!") + "\n" +
+			QObject::tr("Only OpenCL devices and host CPU will be tested."));
+	} else {
 
-//	sleep(5);
+//		sleep(5);
 
-	int devs = getCudaDeviceNum();
-	if(devs == 0) {
-		QMessageBox::critical(0, QObject::tr(CZ_NAME_LONG),
-			QObject::tr("No compatible CUDA devices found!") + "\n" +
-			QObject::tr("Please update your NVIDIA driver and try again!"));
-		delete splash;
-		exit(1);
+		devs = getCudaDeviceNum();
+		if(devs == 0) {
+			QMessageBox::warning(0, QObject::tr(CZ_NAME_LONG),
+				QObject::tr("No compatible CUDA devices found!") + "\n" +
+				QObject::tr("Please update your NVIDIA driver and try again!") + "\n" +
+				QObject::tr("Only OpenCL devices and host CPU will be tested."));
+		}
 	}
 
 	splash->setPixmap(pixmap2);
@@ -104,14 +315,18 @@ int main(
 //	sleep(5);
 
 	splash->setPixmap(pixmap3);
-	CZDialog window;
+	CZDialog window(testMask);
 	window.show(); 
 	splash->finish(&window);
 
 	app.connect(&app, SIGNAL(lastWindowClosed()), &app, SLOT(quit()));
 
 	delete splash;
-	return app.exec();
+	int res = app.exec();
 
 	CZLog(CZLogLevelHigh, "CUDA-Z Stopped!");
+	CZTraceStop();
+	CZLogStop();
+
+	return res;
 }
@@ -0,0 +1,432 @@
+/*!	\file nvmlinfo.cpp
+	\brief NVML telemetry source file.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <QThread>
+#include <QMutex>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#elif !defined(Q_OS_MAC)
+#include <dlfcn.h>
+#endif
+
+#include "log.h"
+#include "nvmlinfo.h"
+
+#if defined(Q_OS_WIN)
+#define CZ_NVML_DLL_FNAME	"nvml.dll"		/*!< NVML dll file name. */
+#define CZ_NVML_DLL_FNAME_SMI	"C:\\Program Files\\NVIDIA Corporation\\NVSMI\\nvml.dll"	/*!< NVML dll file name of old drivers. */
+#else
+#define CZ_NVML_DLL_FNAME	"libnvidia-ml.so.1"	/*!< NVML library file name. */
+#endif
+
+#define CZ_NVML_DLL_ENV		"CZ_NVML_LIBRARY"	/*!< Environment variable overriding NVML library file name. */
+#define CZ_NVML_SAMPLE_MS	20			/*!< Sampling period in ms. */
+#define CZ_NVML_BUS_ID_LEN	32			/*!< Length of PCI bus id string. */
+
+/*	NVML types and constants used here. They are copied from nvml.h
+	so NVML SDK is not needed to build the program.
+*/
+typedef int nvmlReturn_t;
+typedef struct nvmlDevice_st *nvmlDevice_t;
+
+#define NVML_SUCCESS			0
+#define NVML_CLOCK_SM			1
+#define NVML_CLOCK_MEM			2
+#define NVML_TEMPERATURE_GPU		0
+#define NVML_MEMORY_ERROR_TYPE_CORRECTED	0
+#define NVML_MEMORY_ERROR_TYPE_UNCORRECTED	1
+#define NVML_VOLATILE_ECC		0
+
+/*!	\brief List of NVML functions used here.
+	Each item gives return type, name and arguments of function.
+*/
+#define CZ_NVML_FUNC_LIST \
+	CZ_NVML_FUNC(nvmlReturn_t, nvmlInit_v2, (void)) \
+	CZ_NVML_FUNC(nvmlReturn_t, nvmlDeviceGetHandleByPciBusId_v2, (const char *pciBusId, nvmlDevice_t *device)) \
+	CZ_NVML_FUNC(nvmlReturn_t, nvmlDeviceGetClockInfo, (nvmlDevice_t device, int type, unsigned int *clock)) \
+	CZ_NVML_FUNC(nvmlReturn_t, nvmlDeviceGetPowerUsage, (nvmlDevice_t device, unsigned int *power)) \
+	CZ_NVML_FUNC(nvmlReturn_t, nvmlDeviceGetTemperature, (nvmlDevice_t device, int sensor, unsigned int *temp)) \
+	CZ_NVML_FUNC(nvmlReturn_t, nvmlDeviceGetCurrentClocksThrottleReasons, (nvmlDevice_t device, unsigned long long *reasons)) \
+	CZ_NVML_FUNC(nvmlReturn_t, nvmlDeviceGetTotalEccErrors, (nvmlDevice_t device, int errorType, int counterType, unsigned long long *count))
+
+/*	Prototypes of NVML functions \a <name>_t and pointers to them
+	\a p_<name>. Pointers are initializaed by CZNvmlIsInit().
+*/
+#define CZ_NVML_FUNC(ret, name, args) \
+	typedef ret (*name##_t) args; \
+	static name##_t p_##name = NULL;
+CZ_NVML_FUNC_LIST
+#undef CZ_NVML_FUNC
+
+static QMutex CZNvmlMutex;		/*!< Lock of NVML library loading. */
+
+/*!	\brief Check if NVML library is loaded and initialized.
+	This function loads NVML library, finds all functions of
+	\a CZ_NVML_FUNC_LIST and initializes NVML. Library name may be
+	overridden with environment variable #CZ_NVML_DLL_ENV, e.g. to use
+	a stub library. NVML is not available on Mac OS X.
+	Devices are tested in parallel threads, so the library is loaded
+	under lock, which also publishes function pointers to other threads.
+	\return \a true in case of success, \a false in case of error.
+*/
+static bool CZNvmlIsInit(void) {
+	static int state = 0;
+	QMutexLocker locker(&CZNvmlMutex);
+
+	if(state != 0)
+		return state > 0;
+
+	state = -1;
+
+#if defined(Q_OS_MAC)
+	return false;
+#else
+	const char *fname = getenv(CZ_NVML_DLL_ENV);
+	if((fname == NULL) || (*fname == 0))
+		fname = CZ_NVML_DLL_FNAME;
+
+#if defined(Q_OS_WIN)
+	HMODULE hDll = LoadLibraryA(fname);
+	if(hDll == NULL)
+		hDll = LoadLibraryA(CZ_NVML_DLL_FNAME_SMI);
+#define CZ_NVML_SYMBOL(name) GetProcAddress(hDll, name)
+#else
+	void *hDll = dlopen(fname, RTLD_LAZY);
+#define CZ_NVML_SYMBOL(name) dlsym(hDll, name)
+#endif
+
+	if(hDll == NULL) {
+		CZLog(CZLogLevelLow, "Can't load NVML library.");
+		return false;
+	}
+
+#define CZ_NVML_FUNC(ret, name, args) \
+	p_##name = (name##_t)CZ_NVML_SYMBOL(#name); \
+	if(p_##name == NULL) { \
+		CZLog(CZLogLevelError, "Can't find function %s in NVML library.", #name); \
+		return false; \
+	}
+CZ_NVML_FUNC_LIST
+#undef CZ_NVML_FUNC
+#undef CZ_NVML_SYMBOL
+
+	nvmlReturn_t res = p_nvmlInit_v2();
+	if(res != NVML_SUCCESS) {
+		CZLog(CZLogLevelWarning, "Can't initialize NVML: %d.", res);
+		return false;
+	}
+
+	CZLog(CZLogLevelLow, "NVML is initialized.");
+
+	state = 1;
+	return true;
+#endif//Q_OS_MAC
+}
+
+/*!	\brief Check if NVML is present here.
+	\return \a true if NVML library is loaded, \a false otherwise.
+*/
+bool CZNvmlCheck(void) {
+	return CZNvmlIsInit();
+}
+
+/*!	\brief Telemetry sampling thread.
+	Thread samples device every #CZ_NVML_SAMPLE_MS ms until it is
+	stopped. At least one sample is taken.
+*/
+class CZNvmlSampler: public QThread {
+
+public:
+	CZNvmlSampler(nvmlDevice_t device);
+
+	void stop();
+	void result(struct CZDeviceInfoTele *tele) const;
+
+protected:
+	void run();
+
+private:
+	nvmlDevice_t device;
+	volatile int stopFlag;
+	int samples;
+	int smClockNum;
+	double smClockSum;
+	unsigned int smClockMin;
+	int memClockNum;
+	double memClockSum;
+	int powerNum;
+	double powerSum;
+	unsigned int powerMax;
+	unsigned int tempMax;
+	unsigned long long throttle;
+
+	void sample();
+};
+
+/*!	\brief Creates telemetry sampling thread.
+*/
+CZNvmlSampler::CZNvmlSampler(
+	nvmlDevice_t device		/*!<[in] NVML device handle. */
+) {
+	this->device = device;
+	stopFlag = 0;
+	samples = 0;
+	smClockNum = 0;
+	smClockSum = 0;
+	smClockMin = 0;
+	memClockNum = 0;
+	memClockSum = 0;
+	powerNum = 0;
+	powerSum = 0;
+	powerMax = 0;
+	tempMax = 0;
+	throttle = 0;
+}
+
+/*!	\brief Stop sampling and wait for the thread.
+*/
+void CZNvmlSampler::stop() {
+	stopFlag = 1;
+	wait();
+}
+
+/*!	\brief Take one sample of device telemetry.
+	Values which device does not support are skipped.
+*/
+void CZNvmlSampler::sample() {
+	unsigned int value;
+	unsigned long long reasons;
+
+	if(p_nvmlDeviceGetClockInfo(device, NVML_CLOCK_SM, &value) == NVML_SUCCESS) {
+		smClockSum += value;
+		if((smClockNum == 0) || (value < smClockMin))
+			smClockMin = value;
+		smClockNum++;
+	}
+
+	if(p_nvmlDeviceGetClockInfo(device, NVML_CLOCK_MEM, &value) == NVML_SUCCESS) {
+		memClockSum += value;
+		memClockNum++;
+	}
+
+	if(p_nvmlDeviceGetPowerUsage(device, &value) == NVML_SUCCESS) {
+		powerSum += value;
+		if(value > powerMax)
+			powerMax = value;
+		powerNum++;
+	}
+
+	if(p_nvmlDeviceGetTemperature(device, NVML_TEMPERATURE_GPU, &value) == NVML_SUCCESS) {
+		if(value > tempMax)
+			tempMax = value;
+	}
+
+	if(p_nvmlDeviceGetCurrentClocksThrottleReasons(device, &reasons) == NVML_SUCCESS)
+		throttle |= reasons;
+
+	samples++;
+}
+
+/*!	\brief Main work function of the thread.
+*/
+void CZNvmlSampler::run() {
+	do {
+		sample();
+		if(stopFlag)
+			break;
+		msleep(CZ_NVML_SAMPLE_MS);
+	} while(!stopFlag);
+}
+
+/*!	\brief Get telemetry summary of taken samples.
+*/
+void CZNvmlSampler::result(
+	struct CZDeviceInfoTele *tele	/*!<[out] Telemetry summary. */
+) const {
+	tele->samples = samples;
+	tele->smClock = (smClockNum == 0)? 0: (float)(smClockSum / smClockNum);
+	tele->smClockMin = (float)smClockMin;
+	tele->memClock = (memClockNum == 0)? 0: (float)(memClockSum / memClockNum);
+	tele->power = (powerNum == 0)? 0: (float)(powerSum / powerNum / 1000.0);
+	tele->powerMax = (float)(powerMax / 1000.0);
+	tele->temperature = (float)tempMax;
+	tele->throttle = (int)(throttle & CZThrottleAll);
+}
+
+/*!	\brief Find NVML handle of device.
+	Device is found in NVML by its PCI address. This works for
+	CUDA-devices only.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZNvmlFindDevice(
+	const struct CZDeviceInfo *info,	/*!<[in] Device information. */
+	nvmlDevice_t *device		/*!<[out] NVML device handle. */
+) {
+	char busId[CZ_NVML_BUS_ID_LEN];
+	nvmlReturn_t res;
+
+	if((info == NULL) || (info->deviceType != CZDeviceTypeCuda))
+		return -1;
+
+	if(!CZNvmlIsInit())
+		return -1;
+
+	snprintf(busId, sizeof(busId), "%04x:%02x:%02x.0",
+		info->core.pciDomainID, info->core.pciBusID, info->core.pciDeviceID);
+
+	res = p_nvmlDeviceGetHandleByPciBusId_v2(busId, device);
+	if(res != NVML_SUCCESS) {
+		CZLog(CZLogLevelLow, "Can't find %s (%s) in NVML: %d.", info->deviceName, busId, res);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*!	\brief Start sampling of device telemetry.
+	\return sampler to be passed to CZNvmlSampleStop(), \a NULL if
+	telemetry of the device is not available.
+*/
+void *CZNvmlSampleStart(
+	const struct CZDeviceInfo *info	/*!<[in] Device information. */
+) {
+	nvmlDevice_t device;
+
+	if(CZNvmlFindDevice(info, &device) != 0)
+		return NULL;
+
+	CZNvmlSampler *sampler = new CZNvmlSampler(device);
+	sampler->start();
+
+	return sampler;
+}
+
+/*!	\brief Stop sampling of device telemetry.
+	\a tele is cleared if \a sampler is \a NULL.
+*/
+void CZNvmlSampleStop(
+	void *sampler,			/*!<[in] Sampler returned by CZNvmlSampleStart(). */
+	struct CZDeviceInfoTele *tele	/*!<[out] Telemetry summary. */
+) {
+	CZNvmlSampler *s = (CZNvmlSampler*)sampler;
+
+	memset(tele, 0, sizeof(*tele));
+
+	if(s == NULL)
+		return;
+
+	s->stop();
+	s->result(tele);
+	delete s;
+
+	CZLogKV(CZLogLevelLow, "nvml-tele", "samples=%d sm_mhz=%f sm_min_mhz=%f mem_mhz=%f power_w=%f power_max_w=%f temp_c=%f throttle=0x%x",
+		tele->samples, tele->smClock, tele->smClockMin, tele->memClock,
+		tele->power, tele->powerMax, tele->temperature, tele->throttle);
+}
+
+/*!	\brief Read ECC error counters of device.
+	Volatile counters are read, they are reset when driver is reloaded.
+	\return \a 0 in case of success, \a -1 if counters are not
+	available, e.g. if ECC is disabled.
+*/
+int CZNvmlReadEcc(
+	const struct CZDeviceInfo *info,	/*!<[in] Device information. */
+	double *corrected,		/*!<[out] Number of corrected errors. */
+	double *uncorrected		/*!<[out] Number of uncorrected errors. */
+) {
+	nvmlDevice_t device;
+	unsigned long long count;
+	nvmlReturn_t res;
+
+	if(CZNvmlFindDevice(info, &device) != 0)
+		return -1;
+
+	res = p_nvmlDeviceGetTotalEccErrors(device, NVML_MEMORY_ERROR_TYPE_CORRECTED, NVML_VOLATILE_ECC, &count);
+	if(res != NVML_SUCCESS) {
+		CZLog(CZLogLevelLow, "Can't read ECC counters of %s: %d.", info->deviceName, res);
+		return -1;
+	}
+	*corrected = (double)count;
+
+	res = p_nvmlDeviceGetTotalEccErrors(device, NVML_MEMORY_ERROR_TYPE_UNCORRECTED, NVML_VOLATILE_ECC, &count);
+	if(res != NVML_SUCCESS) {
+		CZLog(CZLogLevelLow, "Can't read ECC counters of %s: %d.", info->deviceName, res);
+		return -1;
+	}
+	*uncorrected = (double)count;
+
+	return 0;
+}
+
+/*!	\brief Get name of throttle reason.
+	\return name of reason, \a NULL if reason is unknown.
+*/
+const char *CZNvmlThrottleName(
+	int reason			/*!<[in] Throttle reason. See enum #CZThrottle. */
+) {
+	switch(reason) {
+	case CZThrottleIdle:		return "Idle";
+	case CZThrottleAppClocks:	return "Application Clocks";
+	case CZThrottleSwPower:		return "Power Cap";
+	case CZThrottleHwSlowdown:	return "HW Slowdown";
+	case CZThrottleSyncBoost:	return "Sync Boost";
+	case CZThrottleSwThermal:	return "SW Thermal";
+	case CZThrottleHwThermal:	return "HW Thermal";
+	case CZThrottleHwPowerBrake:	return "HW Power Brake";
+	case CZThrottleDisplayClocks:	return "Display Clocks";
+	default:			return NULL;
+	}
+}
+
+/*!	\brief Check if device was throttled while test was running.
+	Idle and clock settings don't count, only slowdown of busy device.
+	\return \a true if test result is throttled, \a false otherwise.
+*/
+bool CZNvmlIsThrottled(
+	const struct CZDeviceInfoTele *tele	/*!<[in] Telemetry of test. */
+) {
+	return (tele != NULL) && ((tele->throttle & CZThrottleSlowdown) != 0);
+}
+
+/*!	\brief Get names of reasons that limited device clocks.
+	Idle reason is skipped.
+	\return number of names put into \a names.
+*/
+int CZNvmlThrottleReasons(
+	const struct CZDeviceInfoTele *tele,	/*!<[in] Telemetry of test. */
+	const char **names,		/*!<[out] Names of reasons. */
+	int num				/*!<[in] Size of \a names. */
+) {
+	int found = 0;
+
+	if(tele == NULL)
+		return 0;
+
+	for(int reason = 1; (reason <= CZThrottleAll) && (found < num); reason <<= 1) {
+		if((tele->throttle & reason & ~CZThrottleIdle) && (CZNvmlThrottleName(reason) != NULL))
+			names[found++] = CZNvmlThrottleName(reason);
+	}
+
+	return found;
+}
+
+/*!	\brief Get test result per watt of average power draw.
+	\return \a value per watt, \a 0 if power is unknown.
+*/
+float CZNvmlPerWatt(
+	float value,			/*!<[in] Test result. */
+	const struct CZDeviceInfoTele *tele	/*!<[in] Telemetry of test. */
+) {
+	if((tele == NULL) || (tele->power == 0))
+		return 0;
+	return value / tele->power;
+}
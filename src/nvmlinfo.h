@@ -0,0 +1,32 @@
+/*!	\file nvmlinfo.h
+	\brief NVML telemetry definition.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#ifndef CZ_NVMLINFO_H
+#define CZ_NVMLINFO_H
+
+#include "cudainfo.h"
+
+#define CZ_NVML_REASONS_MAX	16	/*!< Max number of reasons returned by CZNvmlThrottleReasons(). */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool CZNvmlCheck(void);
+void *CZNvmlSampleStart(const struct CZDeviceInfo *info);
+void CZNvmlSampleStop(void *sampler, struct CZDeviceInfoTele *tele);
+int CZNvmlReadEcc(const struct CZDeviceInfo *info, double *corrected, double *uncorrected);
+const char *CZNvmlThrottleName(int reason);
+bool CZNvmlIsThrottled(const struct CZDeviceInfoTele *tele);
+int CZNvmlThrottleReasons(const struct CZDeviceInfoTele *tele, const char **names, int num);
+float CZNvmlPerWatt(float value, const struct CZDeviceInfoTele *tele);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//CZ_NVMLINFO_H
@@ -0,0 +1,321 @@
+/*!	\file pciinfo.cpp
+	\brief PCI Express link information source file.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <QtGlobal>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(Q_OS_LINUX)
+#include <limits.h>
+#endif
+
+#include "log.h"
+#include "pciinfo.h"
+
+#define CZ_PCI_SYSFS_ROOT	"/sys"			/*!< Default root of sysfs. */
+#define CZ_PCI_SYSFS_ROOT_ENV	"CZ_SYSFS_ROOT"		/*!< Environment variable overriding root of sysfs. */
+#define CZ_PCI_DEVICES_DIR	"/bus/pci/devices"	/*!< Directory of PCI devices in sysfs. */
+#define CZ_PCI_PATH_LEN		1024			/*!< Length of sysfs file name. */
+#define CZ_PCI_PATH_DEPTH	16			/*!< Max number of PCI devices between device and root complex. */
+#define CZ_PCI_SLOW_PERCENT	60			/*!< Pinned copy rate below this percentage of link bandwidth is low. */
+
+/*!	\brief PCI Express generations.
+	Efficiency is the part of raw transfer rate left after line encoding.
+*/
+static const struct {
+	int		gen;			/*!< PCIe generation. */
+	double		rate;			/*!< Transfer rate of one lane in GT/s. */
+	double		efficiency;		/*!< Line encoding efficiency. */
+} CZPciGens[] = {
+	{1,	2.5,	8.0 / 10.0},
+	{2,	5.0,	8.0 / 10.0},
+	{3,	8.0,	128.0 / 130.0},
+	{4,	16.0,	128.0 / 130.0},
+	{5,	32.0,	128.0 / 130.0},
+	{6,	64.0,	242.0 / 256.0},
+};
+
+/*!	\brief Root of sysfs, empty if it is not set yet.
+*/
+static char CZPciSysfsRoot[CZ_PCI_PATH_LEN] = "";
+
+/*!	\brief Set root of sysfs.
+	Default root is #CZ_PCI_SYSFS_ROOT or the value of environment
+	variable #CZ_PCI_SYSFS_ROOT_ENV. Other root is useful to read a copy
+	of sysfs tree.
+*/
+void CZPciSetSysfsRoot(
+	const char *root		/*!<[in] Root directory, \a NULL to reset to default one. */
+) {
+	if(root == NULL)
+		CZPciSysfsRoot[0] = 0;
+	else
+		snprintf(CZPciSysfsRoot, sizeof(CZPciSysfsRoot), "%s", root);
+}
+
+/*!	\brief Get root of sysfs.
+	\return root directory.
+*/
+static const char *CZPciGetSysfsRoot(void) {
+
+	if(CZPciSysfsRoot[0] == 0) {
+		const char *env = getenv(CZ_PCI_SYSFS_ROOT_ENV);
+		CZPciSetSysfsRoot(((env != NULL) && (*env != 0))? env: CZ_PCI_SYSFS_ROOT);
+	}
+
+	return CZPciSysfsRoot;
+}
+
+/*!	\brief Get theoretical bandwidth of PCI Express link in one direction.
+	\return bandwidth in bytes per second, \a 0 if link is unknown.
+*/
+double CZPciLinkBandwidth(
+	int gen,			/*!<[in] PCIe generation. */
+	int width			/*!<[in] Number of lanes. */
+) {
+	for(unsigned int i = 0; i < sizeof(CZPciGens) / sizeof(CZPciGens[0]); i++) {
+		if(CZPciGens[i].gen == gen)
+			return CZPciGens[i].rate * 1.0e9 * CZPciGens[i].efficiency / 8.0 * width;
+	}
+	return 0;
+}
+
+#if defined(Q_OS_LINUX)
+/*!	\brief PCI Express link read from sysfs.
+*/
+struct CZPciLink {
+	int		gen;			/*!< Current generation, 0 if unknown. */
+	int		width;			/*!< Current number of lanes, 0 if unknown. */
+	int		maxGen;			/*!< Maximal generation, 0 if unknown. */
+	int		maxWidth;		/*!< Maximal number of lanes, 0 if unknown. */
+};
+
+/*!	\brief Get PCIe generation of transfer rate.
+	\return generation, \a 0 if rate is unknown.
+*/
+static int CZPciGenFind(
+	double speed			/*!<[in] Transfer rate in GT/s. */
+) {
+	for(unsigned int i = 0; i < sizeof(CZPciGens) / sizeof(CZPciGens[0]); i++) {
+		if((speed > CZPciGens[i].rate - 0.1) && (speed < CZPciGens[i].rate + 0.1))
+			return CZPciGens[i].gen;
+	}
+	return 0;
+}
+
+/*!	\brief Read one number from sysfs file of PCI device.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZPciReadValue(
+	const char *dir,		/*!<[in] Directory of PCI device. */
+	const char *name,		/*!<[in] Name of file. */
+	double *value			/*!<[out] Value. */
+) {
+	char path[CZ_PCI_PATH_LEN];
+	FILE *file;
+	int res;
+
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+
+	file = fopen(path, "r");
+	if(file == NULL)
+		return -1;
+
+	res = fscanf(file, "%lf", value);
+	fclose(file);
+
+	return (res == 1)? 0: -1;
+}
+
+/*!	\brief Read PCI Express link of PCI device.
+	Maximal values are optional.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZPciReadLinkDir(
+	const char *dir,		/*!<[in] Directory of PCI device. */
+	struct CZPciLink *link		/*!<[out] Link. */
+) {
+	double value;
+
+	memset(link, 0, sizeof(*link));
+
+	if(CZPciReadValue(dir, "current_link_speed", &value) != 0)
+		return -1;
+	link->gen = CZPciGenFind(value);
+	if(CZPciReadValue(dir, "current_link_width", &value) != 0)
+		return -1;
+	link->width = (int)value;
+
+	if(CZPciReadValue(dir, "max_link_speed", &value) == 0)
+		link->maxGen = CZPciGenFind(value);
+	if(CZPciReadValue(dir, "max_link_width", &value) == 0)
+		link->maxWidth = (int)value;
+
+	return 0;
+}
+
+/*!	\brief Check if name of directory is a PCI address.
+	\return \a true if \a dir ends with PCI address, \a false otherwise.
+*/
+static bool CZPciIsAddressDir(
+	const char *dir			/*!<[in] Directory. */
+) {
+	const char *base = strrchr(dir, '/');
+	unsigned int domain, bus, device, function;
+	char end;
+
+	base = (base == NULL)? dir: base + 1;
+	return sscanf(base, "%x:%x:%x.%x%c", &domain, &bus, &device, &function, &end) == 4;
+}
+#endif//Q_OS_LINUX
+
+/*!	\brief Read PCI Express links of device.
+	Device is found by its PCI address. Links of the device and of all
+	bridges above it up to root port are read from sysfs on Linux. The
+	slowest of them limits transfer rate of the device. A link is
+	degraded if it runs slower or narrower than both its ends support.
+	Links are left unknown on other platforms.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZPciReadLink(
+	struct CZDeviceInfo *info	/*!<[in,out] Device information. */
+) {
+
+	if(info == NULL)
+		return -1;
+
+	info->core.pciLinkGen = 0;
+	info->core.pciLinkWidth = 0;
+	info->core.pciLinkMaxGen = 0;
+	info->core.pciLinkMaxWidth = 0;
+	info->core.pciPathGen = 0;
+	info->core.pciPathWidth = 0;
+	info->core.pciPathDegraded = 0;
+
+#if defined(Q_OS_LINUX)
+	char path[CZ_PCI_PATH_LEN];
+	char real[PATH_MAX];
+	struct CZPciLink links[CZ_PCI_PATH_DEPTH];
+	int num = 0;
+	double pathBandwidth = 0;
+
+	snprintf(path, sizeof(path), "%s" CZ_PCI_DEVICES_DIR "/%04x:%02x:%02x.0", CZPciGetSysfsRoot(),
+		info->core.pciDomainID, info->core.pciBusID, info->core.pciDeviceID);
+
+	if(realpath(path, real) == NULL)
+		snprintf(real, sizeof(real), "%s", path);
+
+	/* Walk from the device up to root port. */
+	while((num < CZ_PCI_PATH_DEPTH) && CZPciIsAddressDir(real)) {
+		if(CZPciReadLinkDir(real, &links[num]) != 0) {
+			if(num == 0)
+				return -1;
+			break;
+		}
+		num++;
+		*strrchr(real, '/') = 0;
+	}
+
+	if(num == 0)
+		return -1;
+
+	info->core.pciLinkGen = links[0].gen;
+	info->core.pciLinkWidth = links[0].width;
+	info->core.pciLinkMaxGen = links[0].maxGen;
+	info->core.pciLinkMaxWidth = links[0].maxWidth;
+
+	/* Each link is seen from both ends: entry i is the upstream facing
+	   device, entry i + 1 is the downstream port above it. */
+	for(int i = 0; i < num; i += 2) {
+		double bandwidth = CZPciLinkBandwidth(links[i].gen, links[i].width);
+		if((bandwidth != 0) && ((pathBandwidth == 0) || (bandwidth < pathBandwidth))) {
+			pathBandwidth = bandwidth;
+			info->core.pciPathGen = links[i].gen;
+			info->core.pciPathWidth = links[i].width;
+		}
+
+		int maxGen = links[i].maxGen;
+		int maxWidth = links[i].maxWidth;
+		if(i + 1 < num) {
+			if((links[i + 1].maxGen != 0) && ((maxGen == 0) || (links[i + 1].maxGen < maxGen)))
+				maxGen = links[i + 1].maxGen;
+			if((links[i + 1].maxWidth != 0) && ((maxWidth == 0) || (links[i + 1].maxWidth < maxWidth)))
+				maxWidth = links[i + 1].maxWidth;
+		}
+		if((links[i].gen < maxGen) || (links[i].width < maxWidth)) {
+			info->core.pciPathDegraded = 1;
+			CZLog(CZLogLevelWarning, "Link %d on PCIe path of %s runs at Gen%d x%d, capable of Gen%d x%d.",
+				i / 2, info->deviceName, links[i].gen, links[i].width, maxGen, maxWidth);
+		}
+	}
+
+	CZLog(CZLogLevelLow, "PCIe link of %s: Gen%d x%d (max Gen%d x%d), path Gen%d x%d over %d link(s).",
+		info->deviceName, info->core.pciLinkGen, info->core.pciLinkWidth,
+		info->core.pciLinkMaxGen, info->core.pciLinkMaxWidth,
+		info->core.pciPathGen, info->core.pciPathWidth, (num + 1) / 2);
+
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+/*!	\brief Get NUMA node the device is attached to.
+	\return index of NUMA node, \a -1 if it is unknown.
+*/
+int CZPciNumaNode(
+	const struct CZDeviceInfo *info	/*!<[in] Device information. */
+) {
+#if defined(Q_OS_LINUX)
+	char path[CZ_PCI_PATH_LEN];
+	double node;
+
+	snprintf(path, sizeof(path), "%s" CZ_PCI_DEVICES_DIR "/%04x:%02x:%02x.0", CZPciGetSysfsRoot(),
+		info->core.pciDomainID, info->core.pciBusID, info->core.pciDeviceID);
+
+	if(CZPciReadValue(path, "numa_node", &node) != 0)
+		return -1;
+
+	return (int)node;
+#else
+	(void)info;
+	return -1;
+#endif
+}
+
+/*!	\brief Check PCI Express link of device.
+	Pinned copy rates are compared with bandwidth of the slowest link
+	between the device and root port.
+	\return mask of link problems. See enum #CZPciLinkState.
+*/
+int CZPciCheckLink(
+	const struct CZDeviceInfo *info	/*!<[in] Device information. */
+) {
+	int state = 0;
+	double bandwidth;
+
+	if(info == NULL)
+		return 0;
+
+	if(info->core.pciPathDegraded)
+		state |= CZPciLinkDegraded;
+
+	if(CZPciLinkBandwidth(info->core.pciPathGen, info->core.pciPathWidth) <
+		CZPciLinkBandwidth(info->core.pciLinkGen, info->core.pciLinkWidth))
+		state |= CZPciLinkBottleneck;
+
+	bandwidth = CZPciLinkBandwidth(info->core.pciPathGen, info->core.pciPathWidth) / 1024.0;
+	if(bandwidth != 0) {
+		if(((info->band.copyHDPin != 0) && (info->band.copyHDPin < bandwidth * CZ_PCI_SLOW_PERCENT / 100)) ||
+			((info->band.copyDHPin != 0) && (info->band.copyDHPin < bandwidth * CZ_PCI_SLOW_PERCENT / 100)))
+			state |= CZPciLinkSlow;
+	}
+
+	return state;
+}
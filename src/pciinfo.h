@@ -0,0 +1,35 @@
+/*!	\file pciinfo.h
+	\brief PCI Express link information definition.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#ifndef CZ_PCIINFO_H
+#define CZ_PCIINFO_H
+
+#include "cudainfo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!	\brief Problems of PCI Express link found by CZPciCheckLink().
+*/
+enum CZPciLinkState {
+	CZPciLinkDegraded = (1 << 0),		/*!< Link runs below its speed or width capability. */
+	CZPciLinkBottleneck = (1 << 1),		/*!< Upstream link is slower than link of device. */
+	CZPciLinkSlow = (1 << 2),		/*!< Measured pinned copy rate is low for the link. */
+};
+
+void CZPciSetSysfsRoot(const char *root);
+int CZPciReadLink(struct CZDeviceInfo *info);
+double CZPciLinkBandwidth(int gen, int width);
+int CZPciCheckLink(const struct CZDeviceInfo *info);
+int CZPciNumaNode(const struct CZDeviceInfo *info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//CZ_PCIINFO_H
@@ -0,0 +1,199 @@
+/*!	\file peakinfo.cpp
+	\brief Theoretical peak performance source file.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <string.h>
+
+#include "log.h"
+#include "peakinfo.h"
+#include "pciinfo.h"
+
+/*!	\brief Architectures of CUDA-devices.
+	Rates are taken from arithmetic instruction throughput tables of
+	CUDA C Programming Guide. Table must be sorted by compute capability.
+*/
+static const struct CZArchInfo CZArchTable[] = {
+	{1, 0,	"Tesla",	8,	0,	0,	8},	/* G80 */
+	{1, 1,	"Tesla",	8,	0,	0,	8},	/* G8x, G9x */
+	{1, 2,	"Tesla",	8,	0,	0,	8},	/* GT21x */
+	{1, 3,	"Tesla",	8,	1,	0,	8},	/* GT200 */
+	{2, 0,	"Fermi",	32,	16,	16,	16},	/* GF100, GF110 */
+	{2, 1,	"Fermi",	48,	4,	16,	16},	/* GF10x, GF11x */
+	{3, 0,	"Kepler",	192,	8,	32,	32},	/* GK10x */
+	{3, 2,	"Kepler",	192,	8,	32,	32},	/* Tegra K1 */
+	{3, 5,	"Kepler",	192,	64,	32,	32},	/* GK11x, GK208 */
+	{3, 7,	"Kepler",	192,	64,	32,	32},	/* GK210 */
+	{5, 0,	"Maxwell",	128,	4,	0,	0},	/* GM10x */
+	{5, 2,	"Maxwell",	128,	4,	0,	0},	/* GM20x */
+	{5, 3,	"Maxwell",	128,	4,	0,	0},	/* Tegra X1 */
+	{6, 0,	"Pascal",	64,	32,	0,	0},	/* GP100 */
+	{6, 1,	"Pascal",	128,	4,	0,	0},	/* GP10x */
+	{6, 2,	"Pascal",	128,	4,	0,	0},	/* Tegra X2 */
+	{7, 0,	"Volta",	64,	32,	64,	64},	/* GV100 */
+	{7, 2,	"Volta",	64,	32,	64,	64},	/* Xavier */
+	{7, 5,	"Turing",	64,	2,	64,	64},	/* TU10x */
+	{8, 0,	"Ampere",	64,	32,	64,	64},	/* GA100 */
+	{8, 6,	"Ampere",	128,	2,	64,	64},	/* GA10x */
+	{8, 7,	"Ampere",	128,	2,	64,	64},	/* Orin */
+	{8, 9,	"Ada",		128,	2,	64,	64},	/* AD10x */
+	{9, 0,	"Hopper",	128,	64,	64,	64},	/* GH100 */
+	{10, 0,	"Blackwell",	128,	64,	64,	64},	/* GB100 */
+	{10, 3,	"Blackwell",	128,	2,	64,	64},	/* GB300 */
+	{11, 0,	"Blackwell",	128,	2,	64,	64},	/* Thor */
+	{12, 0,	"Blackwell",	128,	2,	64,	64},	/* GB20x */
+	{12, 1,	"Blackwell",	128,	2,	64,	64},	/* GB10 */
+};
+
+/*!	\brief Find architecture of CUDA-device.
+	Unknown minor revision is served by the closest lower revision of
+	the same major one, unknown newer architecture is served by the last
+	known architecture.
+	\return description of architecture, \a NULL if architecture is unknown.
+*/
+const struct CZArchInfo *CZArchFind(
+	int major,			/*!<[in] Major compute capability. */
+	int minor			/*!<[in] Minor compute capability. */
+) {
+	const struct CZArchInfo *arch = NULL;
+	int num = sizeof(CZArchTable) / sizeof(CZArchTable[0]);
+
+	if(major <= 0)
+		return NULL;
+
+	for(int i = 0; i < num; i++) {
+		if((CZArchTable[i].major > major) ||
+			((CZArchTable[i].major == major) && (CZArchTable[i].minor > minor)))
+			break;
+		arch = &CZArchTable[i];
+	}
+
+	if((arch != NULL) && (arch->major != major) && (major < CZArchTable[num - 1].major))
+		return NULL;
+
+	return arch;
+}
+
+/*!	\brief Calculate theoretical peak performance of device.
+	Memory bandwidth is counted for double data rate memory, PCIe
+	bandwidth is counted for the slowest link between device and root
+	port. Calculation peaks are known
+	for CUDA-devices only. 64-bit integer multiply-add is emulated on
+	all CUDA-devices, so it has no peak.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZPeakCalc(
+	struct CZDeviceInfo *info	/*!<[in,out] Device information. */
+) {
+	const struct CZArchInfo *arch;
+	double clockRate;
+
+	if(info == NULL)
+		return -1;
+
+	memset(&info->peak, 0, sizeof(info->peak));
+
+	info->peak.memBandwidth = (float)(
+		2.0 *
+		(double)info->mem.memoryClockRate * 1000.0 *
+		(double)(info->mem.memoryBusWidth / 8) /
+		1024.0);
+
+	info->peak.pciBandwidth = (float)(CZPciLinkBandwidth(info->core.pciPathGen, info->core.pciPathWidth) / 1024.0);
+
+	if(info->deviceType != CZDeviceTypeCuda)
+		return 0;
+
+	arch = CZArchFind(info->major, info->minor);
+	if(arch == NULL) {
+		CZLog(CZLogLevelWarning, "Unknown architecture %d.%d of %s.", info->major, info->minor, info->deviceName);
+		return 0;
+	}
+
+	clockRate = 2.0 * (double)info->core.muliProcCount * (double)info->core.clockRate;
+
+	info->peak.calcFloat = (float)(clockRate * arch->coresPerSM);
+	info->peak.calcDouble = (float)(clockRate * arch->doublePerSM);
+	info->peak.calcInteger32 = (float)(clockRate * arch->integer32PerSM);
+	info->peak.calcInteger24 = (float)(clockRate * arch->integer24PerSM);
+	info->peak.calcInteger64 = 0;
+
+	CZLog(CZLogLevelLow, "Peaks of %s (%s): memory %f KiB/s, PCIe %f KiB/s, float %f KFOPS.",
+		info->deviceName, arch->name, info->peak.memBandwidth, info->peak.pciBandwidth, info->peak.calcFloat);
+
+	return 0;
+}
+
+/*!	\brief Get theoretical peak of test result.
+	Host to device and device to host copies are limited by PCIe link.
+	Device to device copy reads and writes memory, so its peak is half
+	of memory bandwidth.
+	\return peak in units of test result, \a 0 if peak is unknown.
+*/
+float CZPeakValue(
+	const struct CZDeviceInfo *info,	/*!<[in] Device information. */
+	int test			/*!<[in] Test identifier. See enum #CZTest. */
+) {
+
+	if(info == NULL)
+		return 0;
+
+	switch(test) {
+	case CZTestCopyHDPage:
+	case CZTestCopyHDPin:
+	case CZTestCopyDHPage:
+	case CZTestCopyDHPin:		return info->peak.pciBandwidth;
+	case CZTestCopyDD:		return info->peak.memBandwidth / 2;
+	case CZTestCalcFloat:		return info->peak.calcFloat;
+	case CZTestCalcDouble:		return info->peak.calcDouble;
+	case CZTestCalcInteger32:	return info->peak.calcInteger32;
+	case CZTestCalcInteger24:	return info->peak.calcInteger24;
+	case CZTestCalcInteger64:	return info->peak.calcInteger64;
+	case CZTestMemory:		return info->peak.memBandwidth;
+	default:			return 0;
+	}
+}
+
+/*!	\brief Get result of test.
+	\return result in KB/s, KFOPS or KOPS, \a 0 if test was not run.
+*/
+float CZTestValue(
+	const struct CZDeviceInfo *info,	/*!<[in] Device information. */
+	int test			/*!<[in] Test identifier. See enum #CZTest. */
+) {
+
+	if(info == NULL)
+		return 0;
+
+	switch(test) {
+	case CZTestCopyHDPage:		return info->band.copyHDPage;
+	case CZTestCopyHDPin:		return info->band.copyHDPin;
+	case CZTestCopyDHPage:		return info->band.copyDHPage;
+	case CZTestCopyDHPin:		return info->band.copyDHPin;
+	case CZTestCopyDD:		return info->band.copyDD;
+	case CZTestCalcFloat:		return info->perf.calcFloat;
+	case CZTestCalcDouble:		return info->perf.calcDouble;
+	case CZTestCalcInteger32:	return info->perf.calcInteger32;
+	case CZTestCalcInteger24:	return info->perf.calcInteger24;
+	case CZTestCalcInteger64:	return info->perf.calcInteger64;
+	case CZTestMemory:		return info->memTest.band;
+	default:			return 0;
+	}
+}
+
+/*!	\brief Get test result as a percentage of theoretical peak.
+	\return percentage, \a 0 if test was not run or peak is unknown.
+*/
+float CZPeakPercent(
+	const struct CZDeviceInfo *info,	/*!<[in] Device information. */
+	int test			/*!<[in] Test identifier. See enum #CZTest. */
+) {
+	float peak = CZPeakValue(info, test);
+
+	if(peak == 0)
+		return 0;
+
+	return 100.0f * CZTestValue(info, test) / peak;
+}
@@ -0,0 +1,42 @@
+/*!	\file peakinfo.h
+	\brief Theoretical peak performance definition.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#ifndef CZ_PEAKINFO_H
+#define CZ_PEAKINFO_H
+
+#include "cudainfo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!	\brief Description of CUDA-device architecture.
+	Rates are numbers of multiply-add operations one multiprocessor
+	issues per clock. Rate is \a 0 if there is no native instruction
+	and the operation is emulated with several instructions.
+*/
+struct CZArchInfo {
+	int		major;			/*!< Major compute capability. */
+	int		minor;			/*!< Minor compute capability. */
+	const char	*name;			/*!< Name of architecture. */
+	int		coresPerSM;		/*!< CUDA cores per multiprocessor, same as single-precision rate. */
+	int		doublePerSM;		/*!< Double-precision rate. */
+	int		integer32PerSM;		/*!< 32-bit integer rate. */
+	int		integer24PerSM;		/*!< 24-bit integer rate. */
+};
+
+const struct CZArchInfo *CZArchFind(int major, int minor);
+int CZPeakCalc(struct CZDeviceInfo *info);
+float CZPeakValue(const struct CZDeviceInfo *info, int test);
+float CZTestValue(const struct CZDeviceInfo *info, int test);
+float CZPeakPercent(const struct CZDeviceInfo *info, int test);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//CZ_PEAKINFO_H
@@ -0,0 +1,259 @@
+/*!	\file testconfig.cpp
+	\brief Test parameters and profiles source file.
+	Parameters are set by name as \a key=value pairs. Config file has
+	one pair per line, lines starting with \a # are comments. Key
+	\a profile loads all parameters of named profile, so it usually goes
+	first:
+	\code
+	profile = standard
+	copy-size = 32M
+	time-limit = 1000
+	\endcode
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log.h"
+#include "testconfig.h"
+
+#define CZ_CONFIG_LINE_LEN	1024			/*!< Length of config file line. */
+#define CZ_CONFIG_PROFILE_DEF	1			/*!< Index of default profile. */
+
+/*!	\brief Named profiles of test parameters.
+	\a quick is a sub-second health check for job prologues,
+	\a standard is the classic set of parameters, \a burn-in runs each
+	test for a minute to soak the device and verifies transferred data.
+*/
+static const struct {
+	const char	*name;			/*!< Name of profile. */
+	int		copyBufSize;		/*!< Transfer buffer size in bytes. */
+	int		copyLoops;		/*!< Number of loops of transfer test. */
+	int		calcBlockLoops;		/*!< Maximal number of loops of calculation loop. */
+	int		calcLoops;		/*!< Number of loops of performance test. */
+	int		timeLimit;		/*!< Time limit of each test in ms. */
+	int		copyVerify;		/*!< Verify transferred data. */
+} CZConfigProfiles[] = {
+	{"quick",	4 * (1 << 20),		2,			4,			2,			50,			0},
+	{"standard",	CZ_COPY_BUF_SIZE,	CZ_COPY_LOOPS_NUM,	CZ_CALC_BLOCK_LOOPS,	CZ_CALC_LOOPS_NUM,	CZ_TEST_TIME_LIMIT,	0},
+	{"burn-in",	64 * (1 << 20),		100000,			CZ_CALC_BLOCK_LOOPS,	100000,			60000,			1},
+};
+
+/*!	\brief Parameters which can be set by name.
+*/
+static const struct {
+	const char	*name;			/*!< Name of parameter. */
+	size_t		offset;			/*!< Offset of parameter in struct #CZTestConfig. */
+	int		min;			/*!< Minimal value. */
+	int		max;			/*!< Maximal value. */
+} CZConfigKeys[] = {
+	{"copy-size",		offsetof(struct CZTestConfig, copyBufSize),	64 * (1 << 10),	1 << 30},
+	{"copy-loops",		offsetof(struct CZTestConfig, copyLoops),	1,		1000000},
+	{"calc-block-loops",	offsetof(struct CZTestConfig, calcBlockLoops),	1,		1024},
+	{"calc-loops",		offsetof(struct CZTestConfig, calcLoops),	1,		1000000},
+	{"calc-threads",	offsetof(struct CZTestConfig, calcThreads),	0,		1024},
+	{"time-limit",		offsetof(struct CZTestConfig, timeLimit),	0,		24 * 3600 * 1000},
+	{"copy-verify",		offsetof(struct CZTestConfig, copyVerify),	0,		1},
+	{"stage-chunk-min",	offsetof(struct CZTestConfig, stageChunkMin),	4 * (1 << 10),	1 << 30},
+	{"stage-chunk-max",	offsetof(struct CZTestConfig, stageChunkMax),	4 * (1 << 10),	1 << 30},
+	{"stage-depth",		offsetof(struct CZTestConfig, stageDepth),	1,		CZ_STAGE_DEPTHS_MAX},
+	{"cold-runs",		offsetof(struct CZTestConfig, coldRuns),	1,		1000},
+	{"contend-procs",	offsetof(struct CZTestConfig, contendProcs),	2,		CZ_CONTEND_PROCS_MAX},
+	{"aggregate-devices",	offsetof(struct CZTestConfig, aggregateDevices),	0,		0x7fffffff},
+	{"ingest-chunk",	offsetof(struct CZTestConfig, ingestChunk),	4 * (1 << 10),	1 << 30},
+	{"ingest-depth",	offsetof(struct CZTestConfig, ingestDepth),	1,		CZ_INGEST_DEPTH_MAX},
+};
+
+/*!	\brief Set default test parameters.
+	Defaults are parameters of \a standard profile.
+*/
+void CZConfigDefault(
+	struct CZTestConfig *config	/*!<[out] Test parameters. */
+) {
+	CZConfigProfile(config, CZConfigProfiles[CZ_CONFIG_PROFILE_DEF].name);
+}
+
+/*!	\brief Set test parameters of named profile.
+	\return \a 0 in case of success, \a -1 if profile is unknown.
+*/
+int CZConfigProfile(
+	struct CZTestConfig *config,	/*!<[out] Test parameters. */
+	const char *name		/*!<[in] Name of profile. */
+) {
+	for(int i = 0; i < (int)(sizeof(CZConfigProfiles) / sizeof(CZConfigProfiles[0])); i++) {
+		if(strcmp(name, CZConfigProfiles[i].name) == 0) {
+			memset(config, 0, sizeof(*config));
+			config->profile = i;
+			config->copyBufSize = CZConfigProfiles[i].copyBufSize;
+			config->copyLoops = CZConfigProfiles[i].copyLoops;
+			config->calcBlockLoops = CZConfigProfiles[i].calcBlockLoops;
+			config->calcLoops = CZConfigProfiles[i].calcLoops;
+			config->timeLimit = CZConfigProfiles[i].timeLimit;
+			config->copyVerify = CZConfigProfiles[i].copyVerify;
+			config->stageChunkMin = CZ_STAGE_CHUNK_MIN;
+			config->stageChunkMax = CZ_STAGE_CHUNK_MAX;
+			config->stageDepth = CZ_STAGE_DEPTH;
+			config->coldRuns = CZ_COLD_RUNS;
+			config->contendProcs = CZ_CONTEND_PROCS;
+			config->ingestChunk = CZ_INGEST_CHUNK;
+			config->ingestDepth = CZ_INGEST_DEPTH;
+			return 0;
+		}
+	}
+
+	CZLog(CZLogLevelError, "Unknown test profile %s!", name);
+	return -1;
+}
+
+/*!	\brief Get name of profile.
+	\return name of profile, \a NULL if \a index is out of range.
+*/
+const char *CZConfigProfileName(
+	int index			/*!<[in] Index of profile. */
+) {
+	if((index < 0) || (index >= (int)(sizeof(CZConfigProfiles) / sizeof(CZConfigProfiles[0]))))
+		return NULL;
+	return CZConfigProfiles[index].name;
+}
+
+/*!	\brief Set one test parameter by name.
+	Value may have \a K, \a M or \a G suffix. Key \a profile sets all
+	parameters of the profile.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZConfigSet(
+	struct CZTestConfig *config,	/*!<[in,out] Test parameters. */
+	const char *key,		/*!<[in] Name of parameter. */
+	const char *value		/*!<[in] Value of parameter. */
+) {
+	char *end;
+
+	if(strcmp(key, "profile") == 0)
+		return CZConfigProfile(config, value);
+
+	double num = strtod(value, &end);
+	switch(*end) {
+	case 'K': case 'k':	num *= 1 << 10; end++; break;
+	case 'M': case 'm':	num *= 1 << 20; end++; break;
+	case 'G': case 'g':	num *= 1 << 30; end++; break;
+	}
+
+	for(unsigned int i = 0; i < sizeof(CZConfigKeys) / sizeof(CZConfigKeys[0]); i++) {
+		if(strcmp(key, CZConfigKeys[i].name) != 0)
+			continue;
+
+		if((end == value) || (*end != 0) || (num < CZConfigKeys[i].min) || (num > CZConfigKeys[i].max)) {
+			CZLog(CZLogLevelError, "Bad value %s of test parameter %s! Range is %d to %d.",
+				value, key, CZConfigKeys[i].min, CZConfigKeys[i].max);
+			return -1;
+		}
+
+		*(int*)((char*)config + CZConfigKeys[i].offset) = (int)num;
+		return 0;
+	}
+
+	CZLog(CZLogLevelError, "Unknown test parameter %s!", key);
+	return -1;
+}
+
+/*!	\brief Remove spaces from both ends of string.
+	\return pointer to the first non-space character.
+*/
+static char *CZConfigTrim(
+	char *str			/*!<[in,out] String. */
+) {
+	while((*str == ' ') || (*str == '\t'))
+		str++;
+
+	char *end = str + strlen(str);
+	while((end > str) && ((end[-1] == ' ') || (end[-1] == '\t') || (end[-1] == '\n') || (end[-1] == '\r')))
+		end--;
+	*end = 0;
+
+	return str;
+}
+
+/*!	\brief Set test parameters from one \a key=value pair.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+static int CZConfigSetPair(
+	struct CZTestConfig *config,	/*!<[in,out] Test parameters. */
+	char *pair			/*!<[in,out] Text of pair. It is modified. */
+) {
+	char *value = strchr(pair, '=');
+
+	if(value == NULL) {
+		CZLog(CZLogLevelError, "Test parameter %s has no value!", CZConfigTrim(pair));
+		return -1;
+	}
+	*value++ = 0;
+
+	return CZConfigSet(config, CZConfigTrim(pair), CZConfigTrim(value));
+}
+
+/*!	\brief Set test parameters from comma separated list of
+	\a key=value pairs.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZConfigParse(
+	struct CZTestConfig *config,	/*!<[in,out] Test parameters. */
+	const char *list		/*!<[in] List of parameters. */
+) {
+	char buf[CZ_CONFIG_LINE_LEN];
+	char *pair = buf;
+
+	snprintf(buf, sizeof(buf), "%s", list);
+
+	while(pair != NULL) {
+		char *next = strchr(pair, ',');
+		if(next != NULL)
+			*next++ = 0;
+		if((*CZConfigTrim(pair) != 0) && (CZConfigSetPair(config, pair) != 0))
+			return -1;
+		pair = next;
+	}
+
+	return 0;
+}
+
+/*!	\brief Set test parameters from config file.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZConfigLoad(
+	struct CZTestConfig *config,	/*!<[in,out] Test parameters. */
+	const char *fileName		/*!<[in] Config file name. */
+) {
+	char line[CZ_CONFIG_LINE_LEN];
+	int lineNum = 0;
+	int res = 0;
+
+	FILE *file = fopen(fileName, "r");
+	if(file == NULL) {
+		CZLog(CZLogLevelError, "Can't open config file %s.", fileName);
+		return -1;
+	}
+
+	while(fgets(line, sizeof(line), file) != NULL) {
+		char *str = CZConfigTrim(line);
+
+		lineNum++;
+
+		if((*str == 0) || (*str == '#'))
+			continue;
+
+		if(CZConfigSetPair(config, str) != 0) {
+			CZLog(CZLogLevelError, "Error in %s:%d.", fileName, lineNum);
+			res = -1;
+			break;
+		}
+	}
+
+	fclose(file);
+
+	return res;
+}
@@ -0,0 +1,28 @@
+/*!	\file testconfig.h
+	\brief Test parameters and profiles definition.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#ifndef CZ_TESTCONFIG_H
+#define CZ_TESTCONFIG_H
+
+#include "cudainfo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void CZConfigDefault(struct CZTestConfig *config);
+int CZConfigProfile(struct CZTestConfig *config, const char *name);
+const char *CZConfigProfileName(int index);
+int CZConfigSet(struct CZTestConfig *config, const char *key, const char *value);
+int CZConfigParse(struct CZTestConfig *config, const char *list);
+int CZConfigLoad(struct CZTestConfig *config, const char *fileName);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//CZ_TESTCONFIG_H
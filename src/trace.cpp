@@ -0,0 +1,320 @@
+/*!	\file trace.cpp
+	\brief Timeline tracing source file.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <QThread>
+#include <QMutex>
+#include <QVector>
+#include <QElapsedTimer>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "log.h"
+#include "trace.h"
+
+#define CZ_TRACE_EVENTS_MAX		(1 << 20)	/*!< Max number of kept trace events. */
+#define CZ_TRACE_CAT_LENGTH		16	/*!< Length of event category. */
+#define CZ_TRACE_NAME_LENGTH		64	/*!< Length of event name. */
+#define CZ_TRACE_FILE_LENGTH		1024	/*!< Length of trace file name. */
+
+#define CZ_TRACE_PID_HOST		1	/*!< Trace process ID of host threads. */
+#define CZ_TRACE_PID_DEVICE		2	/*!< Trace process ID of device timelines. */
+
+volatile int CZTraceActive = 0;
+
+/*!	\brief Trace event.
+*/
+struct CZTraceEvent {
+	char		ph;				/*!< Chrome trace event phase: B, E, X, i or M. */
+	char		cat[CZ_TRACE_CAT_LENGTH];	/*!< Event category. */
+	char		name[CZ_TRACE_NAME_LENGTH];	/*!< Event name. */
+	int		dev;				/*!< Device index or -1. */
+	int		pid;				/*!< Trace process ID. */
+	quintptr	tid;				/*!< Trace thread ID. */
+	double		ts;				/*!< Timestamp in us since process start. */
+	double		dur;				/*!< Duration in us of X event. */
+};
+
+static QMutex CZTraceMutex;			/*!< Lock of trace event list. */
+static QVector<struct CZTraceEvent> CZTraceEvents;	/*!< List of trace events. */
+static int CZTraceDropped = 0;			/*!< Number of events dropped because of full list. */
+static QElapsedTimer CZTraceTimer;		/*!< Time base of trace events. */
+
+/*!	\brief Starts time base of trace events with the process.
+	Time base is never restarted, so span start times taken before
+	CZTraceStart() stay valid.
+*/
+static struct CZTraceTimerStart {
+	CZTraceTimerStart() { CZTraceTimer.start(); }
+} CZTraceTimerStarted;
+static char CZTraceFileName[CZ_TRACE_FILE_LENGTH];	/*!< Trace output file name. */
+
+/*!	\brief Add event to trace.
+*/
+static void CZTraceAdd(
+	char ph,			/*!<[in] Event phase. */
+	const char *cat,		/*!<[in] Event category. */
+	const char *name,		/*!<[in] Event name. */
+	int dev,			/*!<[in] Device index or -1. */
+	int pid,			/*!<[in] Trace process ID. */
+	quintptr tid,			/*!<[in] Trace thread ID. */
+	double ts,			/*!<[in] Timestamp in us. */
+	double dur			/*!<[in] Duration in us. */
+) {
+	struct CZTraceEvent event;
+
+	event.ph = ph;
+	strncpy(event.cat, (cat != NULL)? cat: "", CZ_TRACE_CAT_LENGTH - 1);
+	event.cat[CZ_TRACE_CAT_LENGTH - 1] = 0;
+	strncpy(event.name, (name != NULL)? name: "", CZ_TRACE_NAME_LENGTH - 1);
+	event.name[CZ_TRACE_NAME_LENGTH - 1] = 0;
+	event.dev = dev;
+	event.pid = pid;
+	event.tid = tid;
+	event.ts = ts;
+	event.dur = dur;
+
+	CZTraceMutex.lock();
+	if(CZTraceEvents.size() < CZ_TRACE_EVENTS_MAX) {
+		CZTraceEvents.append(event);
+	} else {
+		CZTraceDropped++;
+	}
+	CZTraceMutex.unlock();
+}
+
+/*!	\brief Write string to trace file as JSON string.
+*/
+static void CZTraceWriteString(
+	FILE *file,			/*!<[in,out] Trace file. */
+	const char *str			/*!<[in] String to write. */
+) {
+	fputc('"', file);
+	for(; *str != 0; str++) {
+		unsigned char c = (unsigned char)*str;
+		if((c == '"') || (c == '\\')) {
+			fputc('\\', file);
+			fputc(c, file);
+		} else if(c < 0x20) {
+			fprintf(file, "\\u%04x", c);
+		} else {
+			fputc(c, file);
+		}
+	}
+	fputc('"', file);
+}
+
+/*!	\brief Write one event to trace file.
+*/
+static void CZTraceWriteEvent(
+	FILE *file,			/*!<[in,out] Trace file. */
+	const struct CZTraceEvent &event	/*!<[in] Event to write. */
+) {
+	fprintf(file, ",\n{\"ph\":\"%c\",\"pid\":%d,\"tid\":%llu,\"ts\":%.3f",
+		event.ph, event.pid, (unsigned long long)event.tid, event.ts);
+
+	if(event.ph == 'M') {
+		fprintf(file, ",\"name\":\"thread_name\",\"args\":{\"name\":");
+		CZTraceWriteString(file, event.name);
+		fprintf(file, "}}");
+		return;
+	}
+
+	fprintf(file, ",\"cat\":");
+	CZTraceWriteString(file, event.cat);
+	fprintf(file, ",\"name\":");
+	CZTraceWriteString(file, event.name);
+	if(event.ph == 'X')
+		fprintf(file, ",\"dur\":%.3f", event.dur);
+	if(event.ph == 'i')
+		fprintf(file, ",\"s\":\"t\"");
+	if(event.dev >= 0)
+		fprintf(file, ",\"args\":{\"dev\":%d}", event.dev);
+	fprintf(file, "}");
+}
+
+/*!	\brief Start tracing.
+	Events are kept in memory and written to \a fileName in Chrome
+	trace JSON format by CZTraceStop().
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZTraceStart(
+	const char *fileName		/*!<[in] Name of trace file. */
+) {
+	if((fileName == NULL) || (fileName[0] == 0))
+		return -1;
+
+	if(CZTraceEnabled())
+		return 0;
+
+	strncpy(CZTraceFileName, fileName, CZ_TRACE_FILE_LENGTH - 1);
+	CZTraceFileName[CZ_TRACE_FILE_LENGTH - 1] = 0;
+
+	CZTraceMutex.lock();
+	CZTraceEvents.clear();
+	CZTraceDropped = 0;
+	CZTraceMutex.unlock();
+
+	CZTraceActive = 1;
+
+	CZLog(CZLogLevelModerate, "Tracing to %s started.", CZTraceFileName);
+
+	CZTraceThreadName("Main thread");
+
+	return 0;
+}
+
+/*!	\brief Stop tracing and write trace file.
+	\return \a 0 in case of success, \a -1 in case of error.
+*/
+int CZTraceStop(void) {
+
+	if(!CZTraceEnabled())
+		return 0;
+
+	CZTraceActive = 0;
+
+	FILE *file = fopen(CZTraceFileName, "w");
+	if(file == NULL) {
+		CZLog(CZLogLevelError, "Can't open trace file %s.", CZTraceFileName);
+		return -1;
+	}
+
+	CZTraceMutex.lock();
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	fprintf(file, "\n{\"ph\":\"M\",\"pid\":%d,\"name\":\"process_name\",\"args\":{\"name\":\"Host\"}}",
+		CZ_TRACE_PID_HOST);
+	fprintf(file, ",\n{\"ph\":\"M\",\"pid\":%d,\"name\":\"process_name\",\"args\":{\"name\":\"CUDA Devices\"}}",
+		CZ_TRACE_PID_DEVICE);
+
+	QVector<int> devs;
+	for(int i = 0; i < CZTraceEvents.size(); i++) {
+		const struct CZTraceEvent &event = CZTraceEvents.at(i);
+		if((event.pid == CZ_TRACE_PID_DEVICE) && !devs.contains(event.dev)) {
+			devs.append(event.dev);
+			fprintf(file, ",\n{\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":\"Device %d\"}}",
+				CZ_TRACE_PID_DEVICE, event.dev, event.dev);
+		}
+		CZTraceWriteEvent(file, event);
+	}
+
+	fprintf(file, "\n]}\n");
+
+	if(CZTraceDropped != 0) {
+		CZLog(CZLogLevelWarning, "%d trace events dropped.", CZTraceDropped);
+	}
+
+	CZLog(CZLogLevelModerate, "Trace of %d events is written to %s.",
+		CZTraceEvents.size(), CZTraceFileName);
+
+	CZTraceEvents.clear();
+	CZTraceMutex.unlock();
+
+	fclose(file);
+
+	return 0;
+}
+
+/*!	\brief Current time of trace time base.
+	Time is read whether tracing is active or not, only emission of
+	events depends on CZTraceEnabled(). The value is meant as start time
+	of CZTraceHostSpan() and CZTraceDeviceSpan(). Tests measure their
+	results with their own timers, so results do not depend on tracing.
+	\return time in us since process start.
+*/
+double CZTraceTimeUs(void) {
+	return (double)CZTraceTimer.nsecsElapsed() / 1000.0;
+}
+
+/*!	\brief Set name of calling thread in trace.
+*/
+void CZTraceThreadName(
+	const char *name		/*!<[in] Thread name. */
+) {
+	if(!CZTraceEnabled())
+		return;
+	CZTraceAdd('M', NULL, name, -1, CZ_TRACE_PID_HOST,
+		(quintptr)QThread::currentThreadId(), CZTraceTimeUs(), 0);
+}
+
+/*!	\brief Begin of host phase in calling thread.
+	Should be paired with CZTraceEnd().
+*/
+void CZTraceBegin(
+	const char *cat,		/*!<[in] Event category. */
+	const char *name,		/*!<[in] Event name. */
+	int dev				/*!<[in] Device index or -1. */
+) {
+	if(!CZTraceEnabled())
+		return;
+	CZTraceAdd('B', cat, name, dev, CZ_TRACE_PID_HOST,
+		(quintptr)QThread::currentThreadId(), CZTraceTimeUs(), 0);
+}
+
+/*!	\brief End of host phase in calling thread.
+*/
+void CZTraceEnd(
+	const char *cat,		/*!<[in] Event category. */
+	const char *name,		/*!<[in] Event name. */
+	int dev				/*!<[in] Device index or -1. */
+) {
+	if(!CZTraceEnabled())
+		return;
+	CZTraceAdd('E', cat, name, dev, CZ_TRACE_PID_HOST,
+		(quintptr)QThread::currentThreadId(), CZTraceTimeUs(), 0);
+}
+
+/*!	\brief Instant event in calling thread.
+*/
+void CZTraceInstant(
+	const char *cat,		/*!<[in] Event category. */
+	const char *name,		/*!<[in] Event name. */
+	int dev				/*!<[in] Device index or -1. */
+) {
+	if(!CZTraceEnabled())
+		return;
+	CZTraceAdd('i', cat, name, dev, CZ_TRACE_PID_HOST,
+		(quintptr)QThread::currentThreadId(), CZTraceTimeUs(), 0);
+}
+
+/*!	\brief Host phase of calling thread that started at \a startUs
+	and ends now.
+	Useful for code with many exit points where a pair of
+	CZTraceBegin() and CZTraceEnd() is hard to keep balanced.
+*/
+void CZTraceHostSpan(
+	const char *cat,		/*!<[in] Event category. */
+	const char *name,		/*!<[in] Event name. */
+	int dev,			/*!<[in] Device index or -1. */
+	double startUs			/*!<[in] Start time returned by CZTraceTimeUs(). */
+) {
+	if(!CZTraceEnabled())
+		return;
+	double nowUs = CZTraceTimeUs();
+	CZTraceAdd('X', cat, name, dev, CZ_TRACE_PID_HOST,
+		(quintptr)QThread::currentThreadId(), startUs, nowUs - startUs);
+}
+
+/*!	\brief Phase on device timeline.
+	Device time is measured with CUDA events, so it has no common
+	time base with host. The phase is placed at host time \a startUs
+	when its start event was recorded and lasts \a durUs measured
+	on device.
+*/
+void CZTraceDeviceSpan(
+	const char *cat,		/*!<[in] Event category. */
+	const char *name,		/*!<[in] Event name. */
+	int dev,			/*!<[in] Device index. */
+	double startUs,			/*!<[in] Host time of start event. */
+	double durUs			/*!<[in] Duration measured on device in us. */
+) {
+	if(!CZTraceEnabled())
+		return;
+	CZTraceAdd('X', cat, name, dev, CZ_TRACE_PID_DEVICE,
+		(quintptr)dev, startUs, durUs);
+}
@@ -0,0 +1,42 @@
+/*!	\file trace.h
+	\brief Timeline tracing definitions header.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#ifndef CZ_TRACE_H
+#define CZ_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!	\brief Tracing activity flag.
+	It is set between CZTraceStart() and CZTraceStop().
+*/
+extern volatile int CZTraceActive;
+
+/*!	\def CZTraceEnabled()
+	\brief Cheap check if tracing is active.
+	All trace functions return immediately if tracing is not active.
+*/
+#define CZTraceEnabled()	(CZTraceActive != 0)
+
+int CZTraceStart(const char *fileName);
+int CZTraceStop(void);
+
+double CZTraceTimeUs(void);
+
+void CZTraceThreadName(const char *name);
+void CZTraceBegin(const char *cat, const char *name, int dev);
+void CZTraceEnd(const char *cat, const char *name, int dev);
+void CZTraceInstant(const char *cat, const char *name, int dev);
+void CZTraceHostSpan(const char *cat, const char *name, int dev, double startUs);
+void CZTraceDeviceSpan(const char *cat, const char *name, int dev, double startUs, double durUs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//CZ_TRACE_H
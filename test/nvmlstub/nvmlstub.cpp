@@ -0,0 +1,156 @@
+/*!	\file nvmlstub.cpp
+	\brief Stub NVML library source file.
+	The library exports NVML functions used by nvmlinfo.cpp and
+	returns values of script set by CZNvmlStubSet(). Load it with
+	CZ_NVML_LIBRARY environment variable.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <string.h>
+
+#include "nvmlstub.h"
+
+#define NVML_SUCCESS			0
+#define NVML_ERROR_INVALID_ARGUMENT	2
+#define NVML_ERROR_NOT_SUPPORTED	3
+#define NVML_ERROR_NOT_FOUND		6
+#define NVML_CLOCK_SM			1
+#define NVML_CLOCK_MEM			2
+#define NVML_MEMORY_ERROR_TYPE_CORRECTED	0
+
+#define CZ_NVML_STUB_DEVICE	((nvmlDevice_t)&CZNvmlStubState)	/*!< Handle of the only device. */
+
+typedef int nvmlReturn_t;
+typedef struct nvmlDevice_st *nvmlDevice_t;
+
+/*!	\brief State of stub library.
+*/
+static struct {
+	struct CZNvmlStubScript	script;		/*!< Current script. */
+	int		smClockCalls;		/*!< Number of SM clock queries. */
+	int		memClockCalls;		/*!< Number of memory clock queries. */
+	int		powerCalls;		/*!< Number of power queries. */
+	int		temperatureCalls;	/*!< Number of temperature queries. */
+	int		throttleCalls;		/*!< Number of throttle reason queries. */
+} CZNvmlStubState;
+
+/*!	\brief Get next scripted value.
+	\return \a NVML_SUCCESS, \a NVML_ERROR_NOT_SUPPORTED if series is empty.
+*/
+static nvmlReturn_t CZNvmlStubNext(
+	const struct CZNvmlStubSeries &series,	/*!<[in] Series of values. */
+	int *calls,			/*!<[in,out] Number of calls. */
+	unsigned long long *value	/*!<[out] Value. */
+) {
+	int i = *calls;
+
+	if(series.num == 0)
+		return NVML_ERROR_NOT_SUPPORTED;
+
+	*value = series.value[(i < series.num)? i: series.num - 1];
+	*calls = i + 1;
+	return NVML_SUCCESS;
+}
+
+extern "C" {
+
+/*!	\brief Set script and reset call counters.
+	Call it before the sampler thread starts.
+*/
+void CZNvmlStubSet(
+	const struct CZNvmlStubScript *script	/*!<[in] Script. */
+) {
+	memset(&CZNvmlStubState, 0, sizeof(CZNvmlStubState));
+	CZNvmlStubState.script = *script;
+}
+
+/*!	\brief Get number of samples taken from the device.
+	Throttle reasons are the last query of sample.
+	\return number of throttle reason queries.
+*/
+int CZNvmlStubCalls(void) {
+	return __sync_fetch_and_add(&CZNvmlStubState.throttleCalls, 0);
+}
+
+nvmlReturn_t nvmlInit_v2(void) {
+	return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetHandleByPciBusId_v2(const char *pciBusId, nvmlDevice_t *device) {
+	if(strcmp(pciBusId, CZNvmlStubState.script.busId) != 0)
+		return NVML_ERROR_NOT_FOUND;
+	*device = CZ_NVML_STUB_DEVICE;
+	return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetClockInfo(nvmlDevice_t device, int type, unsigned int *clock) {
+	unsigned long long value;
+	nvmlReturn_t res;
+
+	if(device != CZ_NVML_STUB_DEVICE)
+		return NVML_ERROR_INVALID_ARGUMENT;
+	if(type == NVML_CLOCK_SM)
+		res = CZNvmlStubNext(CZNvmlStubState.script.smClock, &CZNvmlStubState.smClockCalls, &value);
+	else if(type == NVML_CLOCK_MEM)
+		res = CZNvmlStubNext(CZNvmlStubState.script.memClock, &CZNvmlStubState.memClockCalls, &value);
+	else
+		return NVML_ERROR_INVALID_ARGUMENT;
+	if(res == NVML_SUCCESS)
+		*clock = (unsigned int)value;
+	return res;
+}
+
+nvmlReturn_t nvmlDeviceGetPowerUsage(nvmlDevice_t device, unsigned int *power) {
+	unsigned long long value;
+	nvmlReturn_t res;
+
+	if(device != CZ_NVML_STUB_DEVICE)
+		return NVML_ERROR_INVALID_ARGUMENT;
+	res = CZNvmlStubNext(CZNvmlStubState.script.power, &CZNvmlStubState.powerCalls, &value);
+	if(res == NVML_SUCCESS)
+		*power = (unsigned int)value;
+	return res;
+}
+
+nvmlReturn_t nvmlDeviceGetTemperature(nvmlDevice_t device, int sensor, unsigned int *temp) {
+	unsigned long long value;
+	nvmlReturn_t res;
+
+	(void)sensor;
+	if(device != CZ_NVML_STUB_DEVICE)
+		return NVML_ERROR_INVALID_ARGUMENT;
+	res = CZNvmlStubNext(CZNvmlStubState.script.temperature, &CZNvmlStubState.temperatureCalls, &value);
+	if(res == NVML_SUCCESS)
+		*temp = (unsigned int)value;
+	return res;
+}
+
+nvmlReturn_t nvmlDeviceGetCurrentClocksThrottleReasons(nvmlDevice_t device, unsigned long long *reasons) {
+	unsigned long long value;
+	int calls;
+	nvmlReturn_t res;
+
+	if(device != CZ_NVML_STUB_DEVICE)
+		return NVML_ERROR_INVALID_ARGUMENT;
+	calls = CZNvmlStubState.throttleCalls;
+	res = CZNvmlStubNext(CZNvmlStubState.script.throttle, &calls, &value);
+	if(res == NVML_SUCCESS)
+		*reasons = value;
+	__sync_fetch_and_add(&CZNvmlStubState.throttleCalls, 1);
+	return res;
+}
+
+nvmlReturn_t nvmlDeviceGetTotalEccErrors(nvmlDevice_t device, int errorType, int counterType, unsigned long long *count) {
+	int calls = 0;
+
+	(void)counterType;
+	if(device != CZ_NVML_STUB_DEVICE)
+		return NVML_ERROR_INVALID_ARGUMENT;
+	if(errorType == NVML_MEMORY_ERROR_TYPE_CORRECTED)
+		return CZNvmlStubNext(CZNvmlStubState.script.eccCorrected, &calls, count);
+	return CZNvmlStubNext(CZNvmlStubState.script.eccUncorrected, &calls, count);
+}
+
+}
@@ -0,0 +1,56 @@
+/*!	\file nvmlstub.h
+	\brief Stub NVML library definition.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#ifndef CZ_NVMLSTUB_H
+#define CZ_NVMLSTUB_H
+
+#define CZ_NVML_STUB_VALUES	8	/*!< Max number of scripted values of one series. */
+#define CZ_NVML_STUB_BUS_ID_LEN	32	/*!< Length of PCI bus id string. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!	\brief Scripted values of one NVML query.
+	Call \a i returns value \a i, the last value is repeated after
+	the end of series. Query is not supported if series is empty.
+*/
+struct CZNvmlStubSeries {
+	int		num;			/*!< Number of values. */
+	unsigned long long	value[CZ_NVML_STUB_VALUES];	/*!< Values. */
+};
+
+/*!	\brief Script of stub NVML library.
+	Only one device with bus id \a busId is present.
+*/
+struct CZNvmlStubScript {
+	char		busId[CZ_NVML_STUB_BUS_ID_LEN];	/*!< PCI bus id of the device. */
+	struct CZNvmlStubSeries	smClock;	/*!< SM clock in MHz. */
+	struct CZNvmlStubSeries	memClock;	/*!< Memory clock in MHz. */
+	struct CZNvmlStubSeries	power;		/*!< Power draw in mW. */
+	struct CZNvmlStubSeries	temperature;	/*!< Temperature in degrees Celsius. */
+	struct CZNvmlStubSeries	throttle;	/*!< Throttle reasons. */
+	struct CZNvmlStubSeries	eccCorrected;	/*!< Corrected ECC errors. */
+	struct CZNvmlStubSeries	eccUncorrected;	/*!< Uncorrected ECC errors. */
+};
+
+/*!	\brief Type of CZNvmlStubSet() to find it with dlsym().
+*/
+typedef void (*CZNvmlStubSet_t)(const struct CZNvmlStubScript *script);
+
+/*!	\brief Type of CZNvmlStubCalls() to find it with dlsym().
+*/
+typedef int (*CZNvmlStubCalls_t)(void);
+
+void CZNvmlStubSet(const struct CZNvmlStubScript *script);
+int CZNvmlStubCalls(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//CZ_NVMLSTUB_H
@@ -0,0 +1,16 @@
+#	\file nvmlstub.pro
+#	\brief Stub NVML library project file.
+#	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+#	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+#	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+
+TEMPLATE = lib
+TARGET = nvmlstub
+CONFIG += plugin warn_on
+CONFIG -= qt
+
+# Put it next to nvmltest, which loads it from its own folder.
+DESTDIR = $$OUT_PWD/../nvmltest
+
+HEADERS = nvmlstub.h
+SOURCES = nvmlstub.cpp
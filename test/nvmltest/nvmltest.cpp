@@ -0,0 +1,302 @@
+/*!	\file nvmltest.cpp
+	\brief Checks of NVML telemetry against stub NVML library.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <dlfcn.h>
+
+#include "log.h"
+#include "nvmlinfo.h"
+#include "nvmlstub.h"
+
+#define CZ_TEST_PATH_LEN	1024			/*!< Length of library file name. */
+#define CZ_TEST_BUS_ID		"0000:01:00.0"		/*!< PCI bus id of stub device. */
+#define CZ_TEST_WAIT_MS		5000			/*!< Max time to wait for samples in ms. */
+
+/*!	\brief Check condition and count failure.
+*/
+#define CZ_CHECK(fixture, cond) do { \
+	if(!(cond)) { \
+		fprintf(stderr, "%s: check failed: %s\n", (fixture), #cond); \
+		failed++; \
+	} \
+} while(0)
+
+/*!	\brief Check that floating point value is close to expected one.
+*/
+#define CZ_CHECK_NEAR(fixture, value, expected) \
+	CZ_CHECK(fixture, fabs((double)(value) - (double)(expected)) < 0.01)
+
+/*!	\brief Number of failed checks.
+*/
+static int failed = 0;
+
+static CZNvmlStubSet_t CZTestStubSet = NULL;		/*!< Script setter of stub library. */
+static CZNvmlStubCalls_t CZTestStubCalls = NULL;	/*!< Sample counter of stub library. */
+
+/*!	\brief Fill series of scripted values.
+*/
+static void CZTestSeries(
+	struct CZNvmlStubSeries *series,	/*!<[out] Series. */
+	int num,			/*!<[in] Number of values. */
+	const unsigned long long *value	/*!<[in] Values. */
+) {
+	series->num = num;
+	for(int i = 0; i < num; i++)
+		series->value[i] = value[i];
+}
+
+/*!	\brief Make information of CUDA-device at stub bus id.
+*/
+static void CZTestDevice(
+	struct CZDeviceInfo *info	/*!<[out] Device information. */
+) {
+	memset(info, 0, sizeof(*info));
+	info->deviceType = CZDeviceTypeCuda;
+	info->core.pciDomainID = 0;
+	info->core.pciBusID = 1;
+	info->core.pciDeviceID = 0;
+	snprintf(info->deviceName, sizeof(info->deviceName), "Stub Device");
+}
+
+/*!	\brief Sample stub device until at least \a num samples are taken.
+	\return \a 0 in case of success, \a -1 if sampling didn't start.
+*/
+static int CZTestSample(
+	int num,			/*!<[in] Number of samples to wait for. */
+	struct CZDeviceInfoTele *tele	/*!<[out] Telemetry summary. */
+) {
+	struct CZDeviceInfo info;
+	void *sampler;
+
+	CZTestDevice(&info);
+	sampler = CZNvmlSampleStart(&info);
+	if(sampler == NULL)
+		return -1;
+
+	for(int ms = 0; (ms < CZ_TEST_WAIT_MS) && (CZTestStubCalls() < num); ms++)
+		usleep(1000);
+
+	CZNvmlSampleStop(sampler, tele);
+	return 0;
+}
+
+/*!	\brief Samples with changing values.
+	Last value of each series is repeated after the end of series,
+	so averages depend on the number of samples taken.
+*/
+static void CZTestSampling(void) {
+	static const unsigned long long smClock[] = {1500, 1200, 1400};
+	static const unsigned long long memClock[] = {5000};
+	static const unsigned long long power[] = {100000, 300000, 200000};
+	static const unsigned long long temperature[] = {60, 75, 70};
+	static const unsigned long long throttle[] = {0, CZThrottleSwPower, 0x10000};
+	const char *name = "sampling";
+	struct CZNvmlStubScript script;
+	struct CZDeviceInfoTele tele;
+	const char *reasons[CZ_NVML_REASONS_MAX];
+
+	memset(&script, 0, sizeof(script));
+	snprintf(script.busId, sizeof(script.busId), CZ_TEST_BUS_ID);
+	CZTestSeries(&script.smClock, 3, smClock);
+	CZTestSeries(&script.memClock, 1, memClock);
+	CZTestSeries(&script.power, 3, power);
+	CZTestSeries(&script.temperature, 3, temperature);
+	CZTestSeries(&script.throttle, 3, throttle);
+	CZTestStubSet(&script);
+
+	CZ_CHECK(name, CZTestSample(3, &tele) == 0);
+	CZ_CHECK(name, tele.samples >= 3);
+	if(tele.samples < 3)
+		return;
+
+	int n = tele.samples;
+	CZ_CHECK_NEAR(name, tele.smClock, (1500.0 + 1200.0 + 1400.0 * (n - 2)) / n);
+	CZ_CHECK_NEAR(name, tele.smClockMin, 1200);
+	CZ_CHECK_NEAR(name, tele.memClock, 5000);
+	CZ_CHECK_NEAR(name, tele.power, (100.0 + 300.0 + 200.0 * (n - 2)) / n);
+	CZ_CHECK_NEAR(name, tele.powerMax, 300);
+	CZ_CHECK_NEAR(name, tele.temperature, 75);
+	CZ_CHECK(name, tele.throttle == CZThrottleSwPower);
+
+	CZ_CHECK(name, CZNvmlIsThrottled(&tele));
+	CZ_CHECK(name, CZNvmlThrottleReasons(&tele, reasons, CZ_NVML_REASONS_MAX) == 1);
+	CZ_CHECK(name, strcmp(reasons[0], "Power Cap") == 0);
+	CZ_CHECK_NEAR(name, CZNvmlPerWatt(1000, &tele), 1000 / tele.power);
+}
+
+/*!	\brief Device which supports temperature only.
+*/
+static void CZTestUnsupported(void) {
+	static const unsigned long long temperature[] = {50};
+	const char *name = "unsupported";
+	struct CZNvmlStubScript script;
+	struct CZDeviceInfoTele tele;
+	const char *reasons[CZ_NVML_REASONS_MAX];
+
+	memset(&script, 0, sizeof(script));
+	snprintf(script.busId, sizeof(script.busId), CZ_TEST_BUS_ID);
+	CZTestSeries(&script.temperature, 1, temperature);
+	CZTestStubSet(&script);
+
+	CZ_CHECK(name, CZTestSample(2, &tele) == 0);
+	CZ_CHECK(name, tele.samples >= 1);
+	CZ_CHECK(name, tele.smClock == 0);
+	CZ_CHECK(name, tele.smClockMin == 0);
+	CZ_CHECK(name, tele.memClock == 0);
+	CZ_CHECK(name, tele.power == 0);
+	CZ_CHECK(name, tele.powerMax == 0);
+	CZ_CHECK_NEAR(name, tele.temperature, 50);
+	CZ_CHECK(name, tele.throttle == 0);
+
+	CZ_CHECK(name, !CZNvmlIsThrottled(&tele));
+	CZ_CHECK(name, CZNvmlThrottleReasons(&tele, reasons, CZ_NVML_REASONS_MAX) == 0);
+	CZ_CHECK(name, CZNvmlPerWatt(1000, &tele) == 0);
+}
+
+/*!	\brief Devices which are not found in NVML.
+	Telemetry is cleared if there is no sampler.
+*/
+static void CZTestNoDevice(void) {
+	const char *name = "no device";
+	struct CZNvmlStubScript script;
+	struct CZDeviceInfo info;
+	struct CZDeviceInfoTele tele;
+
+	memset(&script, 0, sizeof(script));
+	snprintf(script.busId, sizeof(script.busId), "0000:02:00.0");
+	CZTestStubSet(&script);
+
+	CZTestDevice(&info);
+	CZ_CHECK(name, CZNvmlSampleStart(&info) == NULL);
+
+	snprintf(script.busId, sizeof(script.busId), CZ_TEST_BUS_ID);
+	CZTestStubSet(&script);
+
+	info.deviceType = CZDeviceTypeOpenCL;
+	CZ_CHECK(name, CZNvmlSampleStart(&info) == NULL);
+	CZ_CHECK(name, CZNvmlSampleStart(NULL) == NULL);
+
+	memset(&tele, 0xff, sizeof(tele));
+	CZNvmlSampleStop(NULL, &tele);
+	CZ_CHECK(name, tele.samples == 0);
+	CZ_CHECK(name, tele.power == 0);
+	CZ_CHECK(name, tele.throttle == 0);
+}
+
+/*!	\brief Names of throttle reasons.
+	Idle and unknown reasons are skipped, clock settings don't mark
+	result as throttled.
+*/
+static void CZTestAnnotation(void) {
+	const char *name = "annotation";
+	struct CZDeviceInfoTele tele;
+	const char *reasons[CZ_NVML_REASONS_MAX];
+
+	memset(&tele, 0, sizeof(tele));
+	tele.throttle = CZThrottleIdle;
+	CZ_CHECK(name, !CZNvmlIsThrottled(&tele));
+	CZ_CHECK(name, CZNvmlThrottleReasons(&tele, reasons, CZ_NVML_REASONS_MAX) == 0);
+
+	tele.throttle = CZThrottleIdle | CZThrottleAppClocks;
+	CZ_CHECK(name, !CZNvmlIsThrottled(&tele));
+	CZ_CHECK(name, CZNvmlThrottleReasons(&tele, reasons, CZ_NVML_REASONS_MAX) == 1);
+	CZ_CHECK(name, strcmp(reasons[0], "Application Clocks") == 0);
+
+	tele.throttle = CZThrottleHwThermal | CZThrottleIdle | CZThrottleSwPower;
+	CZ_CHECK(name, CZNvmlIsThrottled(&tele));
+	CZ_CHECK(name, CZNvmlThrottleReasons(&tele, reasons, CZ_NVML_REASONS_MAX) == 2);
+	CZ_CHECK(name, strcmp(reasons[0], "Power Cap") == 0);
+	CZ_CHECK(name, strcmp(reasons[1], "HW Thermal") == 0);
+	CZ_CHECK(name, CZNvmlThrottleReasons(&tele, reasons, 1) == 1);
+
+	tele.power = 250;
+	CZ_CHECK_NEAR(name, CZNvmlPerWatt(1000, &tele), 4);
+	CZ_CHECK(name, CZNvmlPerWatt(1000, NULL) == 0);
+	CZ_CHECK(name, !CZNvmlIsThrottled(NULL));
+}
+
+/*!	\brief ECC counters.
+*/
+static void CZTestEcc(void) {
+	static const unsigned long long corrected[] = {3};
+	static const unsigned long long uncorrected[] = {1};
+	const char *name = "ecc";
+	struct CZNvmlStubScript script;
+	struct CZDeviceInfo info;
+	double c = -1, u = -1;
+
+	memset(&script, 0, sizeof(script));
+	snprintf(script.busId, sizeof(script.busId), CZ_TEST_BUS_ID);
+	CZTestStubSet(&script);
+
+	CZTestDevice(&info);
+	CZ_CHECK(name, CZNvmlReadEcc(&info, &c, &u) == -1);
+
+	CZTestSeries(&script.eccCorrected, 1, corrected);
+	CZTestSeries(&script.eccUncorrected, 1, uncorrected);
+	CZTestStubSet(&script);
+
+	CZ_CHECK(name, CZNvmlReadEcc(&info, &c, &u) == 0);
+	CZ_CHECK(name, c == 3);
+	CZ_CHECK(name, u == 1);
+}
+
+/*!	\brief Run checks of NVML telemetry.
+	Stub library is taken from the folder of executable unless
+	CZ_NVML_LIBRARY environment variable is set.
+	\return \a 0 if all checks pass, \a 1 otherwise.
+*/
+int main(
+	int argc,			/*!<[in] Number of arguments. */
+	char *argv[]			/*!<[in] Arguments. */
+) {
+	char path[CZ_TEST_PATH_LEN];
+	const char *base;
+	void *lib;
+
+	(void)argc;
+
+	base = strrchr(argv[0], '/');
+	if(base == NULL)
+		snprintf(path, sizeof(path), "./libnvmlstub.so");
+	else
+		snprintf(path, sizeof(path), "%.*s/libnvmlstub.so", (int)(base - argv[0]), argv[0]);
+	setenv("CZ_NVML_LIBRARY", path, 0);
+
+	lib = dlopen(getenv("CZ_NVML_LIBRARY"), RTLD_NOW);
+	if(lib == NULL) {
+		fprintf(stderr, "Can't load stub NVML library: %s\n", dlerror());
+		return 2;
+	}
+	CZTestStubSet = (CZNvmlStubSet_t)dlsym(lib, "CZNvmlStubSet");
+	CZTestStubCalls = (CZNvmlStubCalls_t)dlsym(lib, "CZNvmlStubCalls");
+	if((CZTestStubSet == NULL) || (CZTestStubCalls == NULL)) {
+		fprintf(stderr, "Stub NVML library has no script functions\n");
+		return 2;
+	}
+
+	CZLogSetLevel(CZLogLevelFatal);
+
+	CZ_CHECK("init", CZNvmlCheck());
+
+	CZTestSampling();
+	CZTestUnsupported();
+	CZTestNoDevice();
+	CZTestAnnotation();
+	CZTestEcc();
+
+	if(failed != 0) {
+		fprintf(stderr, "%d check(s) failed\n", failed);
+		return 1;
+	}
+	printf("All checks passed\n");
+	return 0;
+}
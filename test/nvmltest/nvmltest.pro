@@ -0,0 +1,22 @@
+#	\file nvmltest.pro
+#	\brief NVML telemetry checks project file.
+#	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+#	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+#	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+
+TEMPLATE = app
+TARGET = nvmltest
+QT = core
+CONFIG += console warn_on testcase
+CONFIG -= app_bundle
+
+CZ_SOURCE_DIR = $$PWD/../..
+
+INCLUDEPATH += $$CZ_SOURCE_DIR/src ../nvmlstub
+HEADERS = $$CZ_SOURCE_DIR/src/log.h \
+	$$CZ_SOURCE_DIR/src/nvmlinfo.h \
+	../nvmlstub/nvmlstub.h
+SOURCES = nvmltest.cpp \
+	$$CZ_SOURCE_DIR/src/log.cpp \
+	$$CZ_SOURCE_DIR/src/nvmlinfo.cpp
+LIBS += -ldl
@@ -0,0 +1,333 @@
+/*!	\file pcitest.cpp
+	\brief Checks of PCI Express link information against sysfs fixtures.
+	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "log.h"
+#include "pciinfo.h"
+
+#define CZ_TEST_PATH_LEN	1024			/*!< Length of fixture file name. */
+
+/*!	\brief Check condition and count failure.
+*/
+#define CZ_CHECK(fixture, cond) do { \
+	if(!(cond)) { \
+		fprintf(stderr, "%s: check failed: %s\n", (fixture), #cond); \
+		failed++; \
+	} \
+} while(0)
+
+/*!	\brief PCI device of sysfs fixture.
+	Missing maximal values are not written.
+*/
+struct CZTestNode {
+	const char	*address;		/*!< PCI address. */
+	double		speed;			/*!< Current transfer rate in GT/s. */
+	int		width;			/*!< Current number of lanes. */
+	double		maxSpeed;		/*!< Maximal transfer rate in GT/s, 0 if missing. */
+	int		maxWidth;		/*!< Maximal number of lanes, 0 if missing. */
+};
+
+/*!	\brief Number of failed checks.
+*/
+static int failed = 0;
+
+/*!	\brief Write one value into file of fixture.
+*/
+static void CZTestWrite(
+	const char *dir,		/*!<[in] Directory. */
+	const char *name,		/*!<[in] Name of file. */
+	const char *value		/*!<[in] Value. */
+) {
+	char path[CZ_TEST_PATH_LEN];
+	FILE *file;
+
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	file = fopen(path, "w");
+	if(file == NULL) {
+		perror(path);
+		exit(2);
+	}
+	fprintf(file, "%s\n", value);
+	fclose(file);
+}
+
+/*!	\brief Make sysfs fixture tree.
+	Devices are listed from root port down to the GPU. The GPU is
+	linked from bus/pci/devices like in real sysfs.
+*/
+static void CZTestMakeTree(
+	const char *root,		/*!<[in] Root of fixture. */
+	const struct CZTestNode *nodes,	/*!<[in] Devices. */
+	int num,			/*!<[in] Number of devices. */
+	int numaNode			/*!<[in] NUMA node of the GPU. */
+) {
+	char dir[CZ_TEST_PATH_LEN];
+	char link[CZ_TEST_PATH_LEN];
+	char value[64];
+
+	mkdir(root, 0755);
+	snprintf(dir, sizeof(dir), "%s/bus", root);
+	mkdir(dir, 0755);
+	snprintf(dir, sizeof(dir), "%s/bus/pci", root);
+	mkdir(dir, 0755);
+	snprintf(dir, sizeof(dir), "%s/bus/pci/devices", root);
+	mkdir(dir, 0755);
+	snprintf(dir, sizeof(dir), "%s/devices", root);
+	mkdir(dir, 0755);
+	snprintf(dir, sizeof(dir), "%s/devices/pci0000:00", root);
+	mkdir(dir, 0755);
+
+	for(int i = 0; i < num; i++) {
+		size_t len = strlen(dir);
+		snprintf(dir + len, sizeof(dir) - len, "/%s", nodes[i].address);
+		mkdir(dir, 0755);
+
+		snprintf(value, sizeof(value), "%.1f GT/s PCIe", nodes[i].speed);
+		CZTestWrite(dir, "current_link_speed", value);
+		snprintf(value, sizeof(value), "%d", nodes[i].width);
+		CZTestWrite(dir, "current_link_width", value);
+		if(nodes[i].maxSpeed != 0) {
+			snprintf(value, sizeof(value), "%.1f GT/s PCIe", nodes[i].maxSpeed);
+			CZTestWrite(dir, "max_link_speed", value);
+		}
+		if(nodes[i].maxWidth != 0) {
+			snprintf(value, sizeof(value), "%d", nodes[i].maxWidth);
+			CZTestWrite(dir, "max_link_width", value);
+		}
+	}
+
+	snprintf(value, sizeof(value), "%d", numaNode);
+	CZTestWrite(dir, "numa_node", value);
+
+	snprintf(link, sizeof(link), "%s/bus/pci/devices/%s", root, nodes[num - 1].address);
+	if(symlink(dir, link) != 0) {
+		perror(link);
+		exit(2);
+	}
+}
+
+/*!	\brief Remove sysfs fixture tree.
+*/
+static void CZTestRemoveTree(
+	const char *root		/*!<[in] Root of fixture. */
+) {
+	char cmd[CZ_TEST_PATH_LEN];
+
+	snprintf(cmd, sizeof(cmd), "rm -rf '%s'", root);
+	if(system(cmd) != 0)
+		fprintf(stderr, "Can't remove %s\n", root);
+}
+
+/*!	\brief Read links of GPU of fixture.
+	\return result of CZPciReadLink().
+*/
+static int CZTestReadLink(
+	const char *root,		/*!<[in] Root of fixture. */
+	const struct CZTestNode *nodes,	/*!<[in] Devices. */
+	int num,			/*!<[in] Number of devices. */
+	struct CZDeviceInfo *info	/*!<[out] Device information. */
+) {
+	unsigned int domain, bus, device, function;
+
+	memset(info, 0, sizeof(*info));
+	sscanf(nodes[num - 1].address, "%x:%x:%x.%x", &domain, &bus, &device, &function);
+	info->core.pciDomainID = domain;
+	info->core.pciBusID = bus;
+	info->core.pciDeviceID = device;
+	snprintf(info->deviceName, sizeof(info->deviceName), "%s", nodes[num - 1].address);
+
+	CZPciSetSysfsRoot(root);
+	return CZPciReadLink(info);
+}
+
+/*!	\brief GPU connected directly to root port.
+*/
+static void CZTestRootPort(
+	const char *base		/*!<[in] Directory of fixtures. */
+) {
+	static const struct CZTestNode nodes[] = {
+		{"0000:00:01.0",	16.0,	16,	16.0,	16},
+		{"0000:01:00.0",	16.0,	16,	16.0,	16},
+	};
+	const int num = sizeof(nodes) / sizeof(nodes[0]);
+	const char *name = "root port";
+	struct CZDeviceInfo info;
+	char root[CZ_TEST_PATH_LEN];
+
+	snprintf(root, sizeof(root), "%s/root", base);
+	CZTestMakeTree(root, nodes, num, 1);
+
+	CZ_CHECK(name, CZTestReadLink(root, nodes, num, &info) == 0);
+	CZ_CHECK(name, info.core.pciLinkGen == 4);
+	CZ_CHECK(name, info.core.pciLinkWidth == 16);
+	CZ_CHECK(name, info.core.pciLinkMaxGen == 4);
+	CZ_CHECK(name, info.core.pciLinkMaxWidth == 16);
+	CZ_CHECK(name, info.core.pciPathGen == 4);
+	CZ_CHECK(name, info.core.pciPathWidth == 16);
+	CZ_CHECK(name, info.core.pciPathDegraded == 0);
+	CZ_CHECK(name, CZPciCheckLink(&info) == 0);
+	CZ_CHECK(name, CZPciNumaNode(&info) == 1);
+
+	CZTestRemoveTree(root);
+}
+
+/*!	\brief GPU behind PCIe switch.
+	The switch downstream port supports Gen5, but the GPU supports
+	Gen4 only, so Gen4 on their link is not a degradation. The switch
+	uplink is Gen5 x4 and limits the path.
+*/
+static void CZTestSwitch(
+	const char *base		/*!<[in] Directory of fixtures. */
+) {
+	static const struct CZTestNode nodes[] = {
+		{"0000:00:01.0",	32.0,	4,	32.0,	16},	/* Root port. */
+		{"0000:01:00.0",	32.0,	4,	32.0,	4},	/* Switch upstream port. */
+		{"0000:02:00.0",	16.0,	16,	32.0,	16},	/* Switch downstream port. */
+		{"0000:03:00.0",	16.0,	16,	16.0,	16},	/* GPU. */
+	};
+	const int num = sizeof(nodes) / sizeof(nodes[0]);
+	const char *name = "switch";
+	struct CZDeviceInfo info;
+	char root[CZ_TEST_PATH_LEN];
+
+	snprintf(root, sizeof(root), "%s/switch", base);
+	CZTestMakeTree(root, nodes, num, 0);
+
+	CZ_CHECK(name, CZTestReadLink(root, nodes, num, &info) == 0);
+	CZ_CHECK(name, info.core.pciLinkGen == 4);
+	CZ_CHECK(name, info.core.pciLinkWidth == 16);
+	CZ_CHECK(name, info.core.pciPathGen == 5);
+	CZ_CHECK(name, info.core.pciPathWidth == 4);
+	CZ_CHECK(name, info.core.pciPathDegraded == 0);
+	CZ_CHECK(name, CZPciCheckLink(&info) == CZPciLinkBottleneck);
+	CZ_CHECK(name, CZPciNumaNode(&info) == 0);
+
+	CZTestRemoveTree(root);
+}
+
+/*!	\brief GPU link trained below capability of both ends.
+*/
+static void CZTestDowntrained(
+	const char *base		/*!<[in] Directory of fixtures. */
+) {
+	static const struct CZTestNode nodes[] = {
+		{"0000:00:03.0",	2.5,	8,	16.0,	16},
+		{"0000:05:00.0",	2.5,	8,	16.0,	16},
+	};
+	const int num = sizeof(nodes) / sizeof(nodes[0]);
+	const char *name = "downtrained";
+	struct CZDeviceInfo info;
+	char root[CZ_TEST_PATH_LEN];
+
+	snprintf(root, sizeof(root), "%s/downtrained", base);
+	CZTestMakeTree(root, nodes, num, 0);
+
+	CZ_CHECK(name, CZTestReadLink(root, nodes, num, &info) == 0);
+	CZ_CHECK(name, info.core.pciLinkGen == 1);
+	CZ_CHECK(name, info.core.pciLinkWidth == 8);
+	CZ_CHECK(name, info.core.pciLinkMaxGen == 4);
+	CZ_CHECK(name, info.core.pciLinkMaxWidth == 16);
+	CZ_CHECK(name, info.core.pciPathGen == 1);
+	CZ_CHECK(name, info.core.pciPathWidth == 8);
+	CZ_CHECK(name, info.core.pciPathDegraded == 1);
+	CZ_CHECK(name, (CZPciCheckLink(&info) & CZPciLinkDegraded) != 0);
+
+	CZTestRemoveTree(root);
+}
+
+/*!	\brief Devices without max_link_speed and max_link_width.
+	Capability of the other end is used if one end doesn't report it.
+	Link is not degraded if neither end reports it.
+*/
+static void CZTestMissingMax(
+	const char *base		/*!<[in] Directory of fixtures. */
+) {
+	static const struct CZTestNode none[] = {
+		{"0000:00:01.0",	8.0,	16,	0,	0},
+		{"0000:01:00.0",	8.0,	16,	0,	0},
+	};
+	static const struct CZTestNode port[] = {
+		{"0000:00:01.0",	8.0,	8,	16.0,	16},
+		{"0000:01:00.0",	8.0,	8,	0,	0},
+	};
+	const char *name = "missing max";
+	struct CZDeviceInfo info;
+	char root[CZ_TEST_PATH_LEN];
+
+	snprintf(root, sizeof(root), "%s/missing", base);
+	CZTestMakeTree(root, none, 2, 0);
+
+	CZ_CHECK(name, CZTestReadLink(root, none, 2, &info) == 0);
+	CZ_CHECK(name, info.core.pciLinkGen == 3);
+	CZ_CHECK(name, info.core.pciLinkWidth == 16);
+	CZ_CHECK(name, info.core.pciLinkMaxGen == 0);
+	CZ_CHECK(name, info.core.pciLinkMaxWidth == 0);
+	CZ_CHECK(name, info.core.pciPathGen == 3);
+	CZ_CHECK(name, info.core.pciPathDegraded == 0);
+
+	CZTestRemoveTree(root);
+
+	snprintf(root, sizeof(root), "%s/missing-device", base);
+	CZTestMakeTree(root, port, 2, 0);
+
+	CZ_CHECK(name, CZTestReadLink(root, port, 2, &info) == 0);
+	CZ_CHECK(name, info.core.pciLinkMaxGen == 0);
+	CZ_CHECK(name, info.core.pciPathDegraded == 1);
+
+	CZTestRemoveTree(root);
+}
+
+/*!	\brief Device absent from sysfs.
+*/
+static void CZTestAbsent(
+	const char *base		/*!<[in] Directory of fixtures. */
+) {
+	static const struct CZTestNode nodes[] = {
+		{"0000:0a:00.0",	16.0,	16,	16.0,	16},
+	};
+	const char *name = "absent";
+	struct CZDeviceInfo info;
+
+	CZ_CHECK(name, CZTestReadLink(base, nodes, 1, &info) != 0);
+	CZ_CHECK(name, info.core.pciLinkGen == 0);
+	CZ_CHECK(name, CZPciNumaNode(&info) == -1);
+}
+
+/*!	\brief Run checks of PCI Express link information.
+	\return \a 0 if all checks pass, \a 1 otherwise.
+*/
+int main(void) {
+	char base[] = "/tmp/cz-pcitest-XXXXXX";
+
+	if(mkdtemp(base) == NULL) {
+		perror("mkdtemp");
+		return 2;
+	}
+
+	CZLogSetLevel(CZLogLevelFatal);
+
+	CZTestRootPort(base);
+	CZTestSwitch(base);
+	CZTestDowntrained(base);
+	CZTestMissingMax(base);
+	CZTestAbsent(base);
+
+	CZPciSetSysfsRoot(NULL);
+	CZTestRemoveTree(base);
+
+	if(failed != 0) {
+		fprintf(stderr, "%d check(s) failed\n", failed);
+		return 1;
+	}
+	printf("All checks passed\n");
+	return 0;
+}
@@ -0,0 +1,20 @@
+#	\file pcitest.pro
+#	\brief PCI Express link checks project file.
+#	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+#	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+#	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+
+TEMPLATE = app
+TARGET = pcitest
+QT = core
+CONFIG += console warn_on testcase
+CONFIG -= app_bundle
+
+CZ_SOURCE_DIR = $$PWD/../..
+
+INCLUDEPATH += $$CZ_SOURCE_DIR/src
+HEADERS = $$CZ_SOURCE_DIR/src/log.h \
+	$$CZ_SOURCE_DIR/src/pciinfo.h
+SOURCES = pcitest.cpp \
+	$$CZ_SOURCE_DIR/src/log.cpp \
+	$$CZ_SOURCE_DIR/src/pciinfo.cpp
@@ -0,0 +1,11 @@
+#	\file test.pro
+#	\brief CUDA-Z checks project file.
+#	\author Andriy Golovnya <andriy.golovnya@gmail.com> http://redscorp.net/
+#	\url http://cuda-z.sf.net/ http://sf.net/projects/cuda-z/
+#	\license GPLv3 http://www.gnu.org/licenses/gpl-3.0.html
+#
+#	Build and run with: qmake test.pro && make check
+
+TEMPLATE = subdirs
+linux:SUBDIRS += pcitest nvmlstub nvmltest
+nvmltest.depends = nvmlstub